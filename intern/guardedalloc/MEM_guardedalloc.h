@@ -298,6 +298,12 @@ void MEM_use_lockfree_allocator(void);
  */
 void MEM_use_guarded_allocator(void);
 
+/**
+ * Use transparent huge pages for large allocations of the lock-free allocator, which reduces TLB
+ * misses when processing large arrays. Only has an effect on Linux.
+ */
+void MEM_use_huge_pages(bool use);
+
 /** \} */
 
 #ifdef __cplusplus
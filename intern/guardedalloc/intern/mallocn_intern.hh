@@ -88,6 +88,28 @@ void aligned_free(void *ptr);
 extern bool leak_detector_has_run;
 extern char free_after_leak_detection_message[];
 
+/**
+ * Blocks up to this size, including the #MemHead, are reused through a per-thread cache, when
+ * enabled with `WITH_MEM_THREAD_CACHE`.
+ */
+#define MEM_BLOCK_SMALL_MAX_SIZE 1024
+#define MEM_BLOCK_SIZE_CLASSES_NUM 20
+/** Alignment of blocks returned by #mem_block_alloc, the alignment `malloc` guarantees. */
+#define MEM_BLOCK_ALIGNMENT (2 * sizeof(void *))
+
+/**
+ * Allocate a block for the lock-free allocator, with the same alignment as `malloc`. Small blocks
+ * are taken from the cache of the current thread when possible, see `mallocn_thread_cache.cc`.
+ * The block must be freed with #mem_block_free, passing the same size.
+ */
+void *mem_block_alloc(size_t size);
+void *mem_block_calloc(size_t size);
+void mem_block_free(void *ptr, size_t size);
+/** Use huge pages for a large block allocated elsewhere, if enabled with #MEM_use_huge_pages. */
+void mem_block_advise_huge_pages(void *ptr, size_t size);
+/** Print allocation counts per size class of small blocks. */
+void mem_block_print_stats(void);
+
 void memory_usage_init(void);
 void memory_usage_block_alloc(size_t size);
 void memory_usage_block_free(size_t size);
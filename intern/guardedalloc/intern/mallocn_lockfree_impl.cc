@@ -171,10 +171,17 @@ void MEM_lockfree_freeN(void *vmemh, AllocationType allocation_type)
   }
   if (UNLIKELY(MEMHEAD_IS_ALIGNED(memh))) {
     MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
-    aligned_free(MEMHEAD_REAL_PTR(memh_aligned));
+    const size_t alignment = size_t(memh_aligned->alignment);
+    if (alignment <= MEM_BLOCK_ALIGNMENT) {
+      mem_block_free(MEMHEAD_REAL_PTR(memh_aligned),
+                     len + sizeof(*memh_aligned) + MEMHEAD_ALIGN_PADDING(alignment));
+    }
+    else {
+      aligned_free(MEMHEAD_REAL_PTR(memh_aligned));
+    }
   }
   else {
-    free(memh);
+    mem_block_free(memh, len + sizeof(*memh));
   }
 }
 
@@ -301,7 +308,7 @@ void *MEM_lockfree_callocN(size_t len, const char *str)
 
   len = SIZET_ALIGN_4(len);
 
-  memh = (MemHead *)calloc(1, len + sizeof(MemHead));
+  memh = (MemHead *)mem_block_calloc(len + sizeof(MemHead));
 
   if (LIKELY(memh)) {
     memh->len = len;
@@ -343,7 +350,7 @@ void *MEM_lockfree_mallocN(size_t len, const char *str)
 #endif
   len = SIZET_ALIGN_4(len);
 
-  memh = (MemHead *)malloc(len + sizeof(MemHead));
+  memh = (MemHead *)mem_block_alloc(len + sizeof(MemHead));
 
   if (LIKELY(memh)) {
 
@@ -421,8 +428,18 @@ void *MEM_lockfree_mallocN_aligned(size_t len,
 #endif
   len = SIZET_ALIGN_4(len);
 
-  MemHeadAligned *memh = (MemHeadAligned *)aligned_malloc(
-      len + extra_padding + sizeof(MemHeadAligned), alignment);
+  /* Alignments that `malloc` already guarantees can use the thread cache for small blocks. */
+  const size_t size = len + extra_padding + sizeof(MemHeadAligned);
+  MemHeadAligned *memh;
+  if (alignment <= MEM_BLOCK_ALIGNMENT) {
+    memh = (MemHeadAligned *)mem_block_alloc(size);
+  }
+  else {
+    memh = (MemHeadAligned *)aligned_malloc(size, alignment);
+    if (LIKELY(memh)) {
+      mem_block_advise_huge_pages(memh, size);
+    }
+  }
 
   if (LIKELY(memh)) {
     /* We keep padding in the beginning of MemHead,
@@ -534,6 +551,8 @@ void MEM_lockfree_printmemlist_stats()
       "\nFor more detailed per-block statistics run Blender with memory debugging command line "
       "argument.\n");
 
+  mem_block_print_stats();
+
 #ifdef HAVE_MALLOC_STATS
   printf("System Statistics:\n");
   malloc_stats();
@@ -0,0 +1,369 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup intern_mem
+ *
+ * Memory blocks for the lock-free allocator.
+ *
+ * Small blocks are rounded up to a fixed set of size classes. Freed small blocks are not returned
+ * to the system allocator immediately, but kept in a free list per size class in a cache that is
+ * local to the freeing thread. Later allocations of the same size class on that thread reuse them
+ * without any synchronization, which avoids contention in the system allocator when many threads
+ * allocate and free small blocks at the same time.
+ *
+ * Since the size class only depends on the requested size, a block can always be put into the
+ * cache of any thread, no matter which thread allocated it.
+ *
+ * The cache is opt-in with the `WITH_MEM_THREAD_CACHE` build option. Without it, small blocks use
+ * the system allocator directly.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#if defined(__linux__)
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif
+
+#include "MEM_guardedalloc.h"
+#include "mallocn_intern.hh"
+
+#include "../../source/blender/blenlib/BLI_strict_flags.h"
+
+/* The cache is only used when enabled with the `WITH_MEM_THREAD_CACHE` build option. Caching
+ * blocks hides use-after-free errors from memory checkers, so it's always disabled for those. */
+#if !defined(WITH_MEM_THREAD_CACHE) || defined(WITH_MEM_VALGRIND) || \
+    defined(__SANITIZE_ADDRESS__)
+#  define USE_THREAD_CACHE 0
+#elif defined(__has_feature)
+#  if __has_feature(address_sanitizer)
+#    define USE_THREAD_CACHE 0
+#  endif
+#endif
+#ifndef USE_THREAD_CACHE
+#  define USE_THREAD_CACHE 1
+#endif
+
+namespace {
+
+/**
+ * Sizes of the size classes: steps of 16 bytes up to 128 bytes, and four steps per power of two
+ * above that, which limits the wasted memory to 25% of the block size.
+ */
+constexpr size_t size_classes[MEM_BLOCK_SIZE_CLASSES_NUM] = {
+    16,  32,  48,  64,  80,  96,  112, 128, 160, 192,
+    224, 256, 320, 384, 448, 512, 640, 768, 896, MEM_BLOCK_SMALL_MAX_SIZE,
+};
+static_assert(size_classes[MEM_BLOCK_SIZE_CLASSES_NUM - 1] == MEM_BLOCK_SMALL_MAX_SIZE);
+
+/** Lookup table from `(size - 1) / 16` to the size class index. */
+struct SizeClassTable {
+  uint8_t indices[MEM_BLOCK_SMALL_MAX_SIZE / 16] = {};
+
+  constexpr SizeClassTable()
+  {
+    int size_class = 0;
+    for (size_t i = 0; i < MEM_BLOCK_SMALL_MAX_SIZE / 16; i++) {
+      while (size_classes[size_class] < (i + 1) * 16) {
+        size_class++;
+      }
+      indices[i] = uint8_t(size_class);
+    }
+  }
+};
+constexpr SizeClassTable size_class_table;
+
+[[maybe_unused]] int size_class_index(const size_t size)
+{
+  return size_class_table.indices[(std::max<size_t>(size, 1) - 1) / 16];
+}
+
+/** Cached blocks per size class are limited to this many bytes per thread. */
+constexpr size_t cache_max_bytes_per_class = 64 * 1024;
+
+/** Large blocks use transparent huge pages when enabled, see #MEM_use_huge_pages. */
+constexpr size_t huge_pages_min_size = 4 * 1024 * 1024;
+
+struct FreeBlock {
+  FreeBlock *next;
+};
+
+/**
+ * Counters of a size class. They are only modified by the thread that owns the cache, but may be
+ * read by other threads when printing statistics.
+ */
+struct SizeClassStats {
+  std::atomic<int64_t> allocs = 0;
+  /** Allocations that reused a cached block. */
+  std::atomic<int64_t> cache_hits = 0;
+  std::atomic<int64_t> frees = 0;
+  /** Blocks that were returned to the system allocator because the cache was full. */
+  std::atomic<int64_t> releases = 0;
+  std::atomic<int64_t> cached_num = 0;
+
+  void increment(std::atomic<int64_t> &value, const int64_t n = 1)
+  {
+    /* Avoid an atomic read-modify-write, only this thread writes the value. */
+    value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+  }
+
+  void add_to(SizeClassStats &other) const
+  {
+    other.allocs.fetch_add(this->allocs, std::memory_order_relaxed);
+    other.cache_hits.fetch_add(this->cache_hits, std::memory_order_relaxed);
+    other.frees.fetch_add(this->frees, std::memory_order_relaxed);
+    other.releases.fetch_add(this->releases, std::memory_order_relaxed);
+  }
+};
+
+struct SizeClassCache {
+  FreeBlock *free_list = nullptr;
+  size_t num = 0;
+  size_t max_num = 0;
+};
+
+/** Align to cache line size to avoid false sharing. */
+struct alignas(128) ThreadCache {
+  SizeClassCache classes[MEM_BLOCK_SIZE_CLASSES_NUM];
+  SizeClassStats stats[MEM_BLOCK_SIZE_CLASSES_NUM];
+
+  ThreadCache();
+  ~ThreadCache();
+};
+
+struct Global {
+  std::mutex caches_mutex;
+  /** All thread caches that currently exist. */
+  std::vector<ThreadCache *> caches;
+  /** Statistics of threads that exited already. */
+  SizeClassStats stats[MEM_BLOCK_SIZE_CLASSES_NUM];
+  std::atomic<int64_t> huge_page_allocs = 0;
+};
+
+Global &get_global()
+{
+  /* Never destructed, because blocks may still be freed during destruction of static data. */
+  static Global *global = new Global();
+  return *global;
+}
+
+/**
+ * Owns the cache of the thread and flushes it when the thread exits. The cache pointer itself is
+ * a trivially destructible thread-local, so that it stays valid while other thread-locals are
+ * destructed.
+ */
+struct ThreadCacheOwner {
+  ThreadCache *cache = nullptr;
+  ~ThreadCacheOwner();
+};
+
+/** Set after the cache of the thread has been destructed, to use the system allocator. */
+ThreadCache *const destructed_cache = reinterpret_cast<ThreadCache *>(uintptr_t(1));
+thread_local ThreadCache *thread_cache = nullptr;
+thread_local ThreadCacheOwner thread_cache_owner;
+
+ThreadCache::ThreadCache()
+{
+  for (int i = 0; i < MEM_BLOCK_SIZE_CLASSES_NUM; i++) {
+    this->classes[i].max_num = std::max<size_t>(cache_max_bytes_per_class / size_classes[i], 16);
+  }
+  Global &global = get_global();
+  std::lock_guard lock{global.caches_mutex};
+  global.caches.push_back(this);
+}
+
+ThreadCache::~ThreadCache()
+{
+  for (SizeClassCache &size_class : this->classes) {
+    while (FreeBlock *block = size_class.free_list) {
+      size_class.free_list = block->next;
+      free(block);
+    }
+  }
+  Global &global = get_global();
+  std::lock_guard lock{global.caches_mutex};
+  global.caches.erase(std::find(global.caches.begin(), global.caches.end(), this));
+  for (int i = 0; i < MEM_BLOCK_SIZE_CLASSES_NUM; i++) {
+    this->stats[i].add_to(global.stats[i]);
+  }
+}
+
+ThreadCacheOwner::~ThreadCacheOwner()
+{
+  delete this->cache;
+  thread_cache = destructed_cache;
+}
+
+[[maybe_unused]] ThreadCache *get_thread_cache()
+{
+  ThreadCache *cache = thread_cache;
+  if (LIKELY(cache != nullptr)) {
+    return cache == destructed_cache ? nullptr : cache;
+  }
+  cache = new ThreadCache();
+  thread_cache_owner.cache = cache;
+  thread_cache = cache;
+  return cache;
+}
+
+std::atomic<bool> use_huge_pages = false;
+
+void advise_huge_pages(void *ptr, const size_t size)
+{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  /* Only whole pages within the block can be advised. */
+  const uintptr_t page_size = uintptr_t(sysconf(_SC_PAGESIZE));
+  const uintptr_t begin = (uintptr_t(ptr) + page_size - 1) & ~(page_size - 1);
+  const uintptr_t end = (uintptr_t(ptr) + size) & ~(page_size - 1);
+  if (begin < end && madvise(reinterpret_cast<void *>(begin), end - begin, MADV_HUGEPAGE) == 0) {
+    get_global().huge_page_allocs.fetch_add(1, std::memory_order_relaxed);
+  }
+#else
+  (void)ptr;
+  (void)size;
+#endif
+}
+
+void *large_block_alloc(const size_t size, const bool zero)
+{
+  void *ptr = zero ? calloc(1, size) : malloc(size);
+  if (UNLIKELY(use_huge_pages.load(std::memory_order_relaxed)) && ptr &&
+      size >= huge_pages_min_size)
+  {
+    advise_huge_pages(ptr, size);
+  }
+  return ptr;
+}
+
+}  // namespace
+
+void *mem_block_alloc(const size_t size)
+{
+  if (size > MEM_BLOCK_SMALL_MAX_SIZE) {
+    return large_block_alloc(size, false);
+  }
+#if USE_THREAD_CACHE
+  const int index = size_class_index(size);
+  if (ThreadCache *cache = get_thread_cache()) {
+    SizeClassCache &size_class = cache->classes[index];
+    SizeClassStats &stats = cache->stats[index];
+    stats.increment(stats.allocs);
+    if (FreeBlock *block = size_class.free_list) {
+      size_class.free_list = block->next;
+      size_class.num--;
+      stats.increment(stats.cache_hits);
+      stats.increment(stats.cached_num, -1);
+      return block;
+    }
+  }
+  return malloc(size_classes[index]);
+#else
+  return malloc(size);
+#endif
+}
+
+void *mem_block_calloc(const size_t size)
+{
+  if (size > MEM_BLOCK_SMALL_MAX_SIZE) {
+    return large_block_alloc(size, true);
+  }
+#if USE_THREAD_CACHE
+  void *ptr = mem_block_alloc(size);
+  if (LIKELY(ptr)) {
+    memset(ptr, 0, size);
+  }
+  return ptr;
+#else
+  return calloc(1, size);
+#endif
+}
+
+void mem_block_free(void *ptr, const size_t size)
+{
+#if USE_THREAD_CACHE
+  if (size <= MEM_BLOCK_SMALL_MAX_SIZE) {
+    if (ThreadCache *cache = get_thread_cache()) {
+      const int index = size_class_index(size);
+      SizeClassCache &size_class = cache->classes[index];
+      SizeClassStats &stats = cache->stats[index];
+      stats.increment(stats.frees);
+      if (UNLIKELY(size_class.num == size_class.max_num)) {
+        /* Return half of the cached blocks to the system, so that the next frees don't have to
+         * go to the system allocator immediately again. */
+        const size_t release_num = size_class.max_num / 2;
+        for (size_t i = 0; i < release_num; i++) {
+          FreeBlock *block = size_class.free_list;
+          size_class.free_list = block->next;
+          free(block);
+        }
+        size_class.num -= release_num;
+        stats.increment(stats.releases, int64_t(release_num));
+        stats.increment(stats.cached_num, -int64_t(release_num));
+      }
+      FreeBlock *block = static_cast<FreeBlock *>(ptr);
+      block->next = size_class.free_list;
+      size_class.free_list = block;
+      size_class.num++;
+      stats.increment(stats.cached_num);
+      return;
+    }
+  }
+#else
+  (void)size;
+#endif
+  free(ptr);
+}
+
+void mem_block_advise_huge_pages(void *ptr, const size_t size)
+{
+  if (use_huge_pages.load(std::memory_order_relaxed) && size >= huge_pages_min_size) {
+    advise_huge_pages(ptr, size);
+  }
+}
+
+void mem_block_print_stats()
+{
+  Global &global = get_global();
+  std::lock_guard lock{global.caches_mutex};
+
+  SizeClassStats totals[MEM_BLOCK_SIZE_CLASSES_NUM];
+  for (int i = 0; i < MEM_BLOCK_SIZE_CLASSES_NUM; i++) {
+    global.stats[i].add_to(totals[i]);
+    for (const ThreadCache *cache : global.caches) {
+      cache->stats[i].add_to(totals[i]);
+      totals[i].cached_num.fetch_add(cache->stats[i].cached_num, std::memory_order_relaxed);
+    }
+  }
+
+  printf("\nSmall block statistics (%d threads):\n", int(global.caches.size()));
+  printf("%10s %14s %14s %14s %14s %10s\n", "size", "allocs", "cache hits", "frees", "releases",
+         "cached");
+  for (int i = 0; i < MEM_BLOCK_SIZE_CLASSES_NUM; i++) {
+    const SizeClassStats &stats = totals[i];
+    if (stats.allocs == 0 && stats.frees == 0) {
+      continue;
+    }
+    printf("%10zu %14lld %14lld %14lld %14lld %10lld\n",
+           size_classes[i],
+           (long long)stats.allocs,
+           (long long)stats.cache_hits,
+           (long long)stats.frees,
+           (long long)stats.releases,
+           (long long)stats.cached_num);
+  }
+  if (use_huge_pages) {
+    printf("Large blocks using huge pages: %lld\n", (long long)global.huge_page_allocs);
+  }
+}
+
+void MEM_use_huge_pages(const bool use)
+{
+  use_huge_pages.store(use, std::memory_order_relaxed);
+}
@@ -0,0 +1,88 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+#include "guardedalloc_test_base.h"
+
+namespace {
+
+/** Allocate blocks of many sizes, including ones above the largest size class. */
+void allocate_and_free_blocks(const int seed)
+{
+  std::vector<char *> blocks;
+  for (int iteration = 0; iteration < 4; iteration++) {
+    for (int size = 1; size < 2000; size += 7) {
+      char *block = static_cast<char *>(
+          (size + iteration) % 3 == 0 ? MEM_callocN(size_t(size), __func__) :
+                                        MEM_mallocN_aligned(size_t(size), 16, __func__));
+      EXPECT_EQ(MEM_allocN_len(block) % 4, 0);
+      EXPECT_GE(MEM_allocN_len(block), size_t(size));
+      if ((size + iteration) % 3 == 0) {
+        for (int i = 0; i < size; i++) {
+          EXPECT_EQ(block[i], 0);
+        }
+      }
+      memset(block, char(seed + size), size_t(size));
+      blocks.push_back(block);
+    }
+    /* Free half of the blocks, which are reused by the allocations of the next iteration. */
+    for (size_t i = 0; i < blocks.size(); i += 2) {
+      MEM_freeN(blocks[i]);
+      blocks[i] = nullptr;
+    }
+    std::vector<char *> remaining;
+    for (char *block : blocks) {
+      if (block) {
+        remaining.push_back(block);
+      }
+    }
+    blocks = std::move(remaining);
+  }
+  for (char *block : blocks) {
+    MEM_freeN(block);
+  }
+}
+
+}  // namespace
+
+TEST_F(LockFreeAllocatorTest, thread_cache_reuse)
+{
+  allocate_and_free_blocks(0);
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), 0);
+}
+
+TEST_F(LockFreeAllocatorTest, thread_cache_free_on_other_thread)
+{
+  std::vector<void *> blocks;
+  for (int i = 0; i < 1000; i++) {
+    blocks.push_back(MEM_mallocN(size_t(i % 100 + 1), __func__));
+  }
+  std::thread thread([&]() {
+    /* Blocks freed here end up in the cache of this thread, which is freed when it exits. */
+    for (void *block : blocks) {
+      MEM_freeN(block);
+    }
+    allocate_and_free_blocks(1);
+  });
+  thread.join();
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), 0);
+}
+
+TEST_F(LockFreeAllocatorTest, thread_cache_multiple_threads)
+{
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([i]() { allocate_and_free_blocks(i); });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), 0);
+}
@@ -814,6 +814,8 @@ class USERPREF_PT_system_memory(SystemPanel, CenterAlignMixIn, Panel):
         col = layout.column()
         col.prop(edit, "undo_steps", text="Undo Steps")
         col.prop(edit, "undo_memory_limit", text="Undo Memory Limit")
+        if prefs.view.show_developer_ui and prefs.experimental.use_undo_archive:
+            col.prop(edit, "undo_archive_memory_limit", text="Archive Memory Limit")
         col.prop(edit, "use_global_undo")
 
         layout.separator()
@@ -2889,6 +2891,15 @@ class USERPREF_PT_developer_tools(Panel):
                 ({"property": "use_eevee_debug"}, None),
                 ({"property": "use_extensions_debug"}, ("/blender/blender/issues/119521", "#119521")),
                 ({"property": "no_data_block_packing"}, ("/blender/blender/issues/132167", "#132167")),
+                ({"property": "use_blend_file_zero_copy"}, None),
+                ({"property": "use_lazy_library_data"}, None),
+                ({"property": "use_parallel_blend_file_write"}, None),
+                ({"property": "use_blend_file_deduplication"}, None),
+                ({"property": "use_incremental_undo"}, None),
+                ({"property": "use_undo_archive"}, None),
+                ({"property": "use_versioning_cache"}, None),
+                ({"property": "use_parallel_blend_file_read"}, None),
+                ({"property": "use_memory_cache_disk"}, None),
             ),
         )
 
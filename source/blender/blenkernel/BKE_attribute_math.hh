@@ -18,6 +18,7 @@
 #include "BLI_math_vector.h"
 #include "BLI_math_vector.hh"
 #include "BLI_offset_indices.hh"
+#include "BLI_simd.hh"
 
 #include "BKE_attribute.hh"
 
@@ -517,8 +518,34 @@ class ColorGeometry4fMixer {
   ColorGeometry4fMixer(MutableSpan<ColorGeometry4f> buffer,
                        const IndexMask &mask,
                        ColorGeometry4f default_color = ColorGeometry4f(0.0f, 0.0f, 0.0f, 1.0f));
-  void set(int64_t index, const ColorGeometry4f &color, float weight = 1.0f);
-  void mix_in(int64_t index, const ColorGeometry4f &color, float weight = 1.0f);
+  /* Defined inline, because these are called for every mixed value, e.g. in domain
+   * interpolation. */
+  void set(const int64_t index, const ColorGeometry4f &color, const float weight = 1.0f)
+  {
+#if BLI_HAVE_SSE2
+    _mm_storeu_ps(buffer_[index], _mm_mul_ps(_mm_loadu_ps(color), _mm_set1_ps(weight)));
+#else
+    buffer_[index] = ColorGeometry4f(
+        color.r * weight, color.g * weight, color.b * weight, color.a * weight);
+#endif
+    total_weights_[index] = weight;
+  }
+
+  void mix_in(const int64_t index, const ColorGeometry4f &color, const float weight = 1.0f)
+  {
+    ColorGeometry4f &output_color = buffer_[index];
+#if BLI_HAVE_SSE2
+    const __m128 weighted = _mm_mul_ps(_mm_loadu_ps(color), _mm_set1_ps(weight));
+    _mm_storeu_ps(output_color, _mm_add_ps(_mm_loadu_ps(output_color), weighted));
+#else
+    output_color.r += color.r * weight;
+    output_color.g += color.g * weight;
+    output_color.b += color.b * weight;
+    output_color.a += color.a * weight;
+#endif
+    total_weights_[index] += weight;
+  }
+
   void finalize();
   void finalize(const IndexMask &mask);
 };
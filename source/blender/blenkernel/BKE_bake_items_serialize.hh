@@ -253,4 +253,12 @@ std::optional<BakeState> deserialize_bake(std::istream &stream,
                                           const BlobReader &blob_reader,
                                           const BlobReadSharing &blob_sharing);
 
+/**
+ * Write a geometry including all its binary data to a single stream, e.g. to move it to a disk
+ * cache. Unlike with baking, references to data-blocks such as materials are not restored when
+ * reading the geometry back.
+ */
+bool serialize_geometry(const GeometrySet &geometry, std::ostream &stream);
+std::optional<GeometrySet> deserialize_geometry(std::istream &stream);
+
 }  // namespace blender::bke::bake
@@ -263,8 +263,9 @@ enum {
   G_DEBUG_XR = (1 << 23),                    /* XR/OpenXR messages */
   G_DEBUG_XR_TIME = (1 << 24),               /* XR/OpenXR timing messages */
 
-  G_DEBUG_GHOST = (1 << 25),  /* Debug GHOST module. */
-  G_DEBUG_WINTAB = (1 << 26), /* Debug Wintab. */
+  G_DEBUG_GHOST = (1 << 25),    /* Debug GHOST module. */
+  G_DEBUG_WINTAB = (1 << 26),   /* Debug Wintab. */
+  G_DEBUG_IO_STATS = (1 << 27), /* Blend-file reading and writing statistics. */
 };
 
 #define G_DEBUG_ALL \
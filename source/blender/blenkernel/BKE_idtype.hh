@@ -70,6 +70,16 @@ enum {
    * IDs have at least an 'extra user' (#ID_TAG_EXTRAUSER).
    */
   IDTYPE_FLAGS_NEVER_UNUSED = 1 << 6,
+  /**
+   * Indicates that the `blend_write` callback of the given IDType can be called from other
+   * threads, concurrently with the ones of other IDs. It must only modify the temporary copy of
+   * the ID it is given (not any data it shares with the original ID), and not access any global
+   * or runtime state that may be modified concurrently.
+   *
+   * This is used by the parallel blend-file writer, IDs of other types are written on the main
+   * thread.
+   */
+  IDTYPE_FLAGS_THREADSAFE_BLEND_WRITE = 1 << 7,
 };
 
 struct IDCacheKey {
@@ -45,6 +45,7 @@ struct BlendWriter;
 struct Depsgraph;
 struct GHash;
 struct ID;
+struct ID_LazyData;
 struct ID_Readfile_Data;
 struct Library;
 struct ListBase;
@@ -89,6 +90,12 @@ struct ID_Runtime {
    * freed and the pointer set to `nullptr`.
    */
   ID_Readfile_Data *readfile_data = nullptr;
+
+  /**
+   * Data of IDs linked with the "Lazy Library Data" option that is not read from the library
+   * file yet, see #BKE_libblock_lazy_data_ensure.
+   */
+  ID_LazyData *lazy_data = nullptr;
 };
 
 }  // namespace blender::bke::id
@@ -143,6 +150,13 @@ void BKE_libblock_init_empty(ID *id) ATTR_NONNULL(1);
  */
 void BKE_libblock_runtime_ensure(ID &id);
 
+/**
+ * Read the data of an ID linked with the "Lazy Library Data" option from its library file, if
+ * that was not done yet. Has to be called before accessing the data of linked IDs that may have
+ * been read lazily. Thread-safe, and cheap when the data is loaded already.
+ */
+void BKE_libblock_lazy_data_ensure(ID &id);
+
 /**
  * Reset the runtime counters used by ID remapping.
  */
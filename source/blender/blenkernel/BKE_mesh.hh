@@ -49,6 +49,20 @@ void corner_tris_calc_with_normals(Span<float3> vert_positions,
                                    Span<float3> face_normals,
                                    MutableSpan<int3> corner_tris);
 
+/**
+ * Update triangles from #corner_tris_calc for new positions of the same topology, reusing the
+ * existing array. Only the corner triangles of triangle faces are kept, all other faces are
+ * triangulated again, so the result is the same as calculating the triangles from scratch.
+ *
+ * \param face_normals: Optional pre-calculated face normals, the result is the same as
+ * #corner_tris_calc_with_normals then.
+ */
+void corner_tris_update(Span<float3> vert_positions,
+                        OffsetIndices<int> faces,
+                        Span<int> corner_verts,
+                        Span<float3> face_normals,
+                        MutableSpan<int3> corner_tris);
+
 void corner_tris_calc_face_indices(OffsetIndices<int> faces, MutableSpan<int> tri_faces);
 
 /**
@@ -108,6 +122,23 @@ void normals_calc_verts(Span<float3> vert_positions,
                         Span<float3> face_normals,
                         MutableSpan<float3> vert_normals);
 
+/**
+ * Like #normals_calc_faces and #normals_calc_verts, but only recalculate the normals of the
+ * elements in the mask, keeping the other values in the result arrays unchanged.
+ */
+void normals_calc_faces(Span<float3> vert_positions,
+                        OffsetIndices<int> faces,
+                        Span<int> corner_verts,
+                        const IndexMask &face_mask,
+                        MutableSpan<float3> face_normals);
+void normals_calc_verts(Span<float3> vert_positions,
+                        OffsetIndices<int> faces,
+                        Span<int> corner_verts,
+                        GroupedSpan<int> vert_to_face_map,
+                        Span<float3> face_normals,
+                        const IndexMask &vert_mask,
+                        MutableSpan<float3> vert_normals);
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
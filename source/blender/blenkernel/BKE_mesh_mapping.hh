@@ -276,6 +276,9 @@ namespace blender::bke::mesh {
 
 Array<int> build_corner_to_face_map(OffsetIndices<int> faces);
 
+void build_vert_to_edge_indices(Span<int2> edges,
+                                OffsetIndices<int> offsets,
+                                MutableSpan<int> edge_indices);
 GroupedSpan<int> build_vert_to_edge_map(Span<int2> edges,
                                         int verts_num,
                                         Array<int> &r_offsets,
@@ -302,6 +305,10 @@ GroupedSpan<int> build_edge_to_corner_map(Span<int> corner_edges,
                                           Array<int> &r_offsets,
                                           Array<int> &r_indices);
 
+void build_edge_to_face_indices(OffsetIndices<int> faces,
+                                Span<int> corner_edges,
+                                OffsetIndices<int> offsets,
+                                MutableSpan<int> face_indices);
 GroupedSpan<int> build_edge_to_face_map(OffsetIndices<int> faces,
                                         Span<int> corner_edges,
                                         int edges_num,
@@ -8,6 +8,8 @@
  * \ingroup bke
  */
 
+#include <array>
+#include <atomic>
 #include <memory>
 #include <variant>
 
@@ -15,6 +17,7 @@
 #include "BLI_bit_vector.hh"
 #include "BLI_bounds_types.hh"
 #include "BLI_implicit_sharing.hh"
+#include "BLI_implicit_sharing_ptr.hh"
 #include "BLI_kdopbvh.hh"
 #include "BLI_math_vector_types.hh"
 #include "BLI_mutex.hh"
@@ -116,17 +119,49 @@ class NormalsCache {
   void store_vector(Vector<float3> &&data);
 };
 
+/**
+ * Identifies the state of an implicitly shared topology array, without keeping it alive. The
+ * version changes when the array is modified in place.
+ */
+struct TopologyArrayState {
+  WeakImplicitSharingPtr sharing_info;
+  int64_t version = 0;
+
+  /** Whether the array is the one passed to #set, and hasn't been modified since. */
+  bool matches(const ImplicitSharingInfo *info) const;
+  void set(const ImplicitSharingInfo *info);
+};
+
+struct CornerTrisData {
+  Array<int3> tris;
+  /** The face offsets and corner vertex arrays the triangles were calculated for. */
+  std::array<TopologyArrayState, 2> topology;
+};
+
 struct TrianglesCache {
-  SharedCache<Array<int3>> data;
+  /**
+   * When only positions changed and the cache isn't shared, the previous triangulation stays in
+   * the cached data. Most faces are triangulated the same way for the new positions, so updating
+   * the previous triangulation is much faster than calculating it from scratch, see
+   * #mesh::corner_tris_update. It is only updated for the same topology arrays.
+   */
+  SharedCache<CornerTrisData> data;
+  /**
+   * The triangulation from before the positions changed, only referenced when #data was shared
+   * with other meshes, since tagging it dirty doesn't keep the data then.
+   */
+  SharedCache<CornerTrisData> previous_data;
   bool frozen = false;
   bool dirty_while_frozen = false;
 
-  /** Delay applying dirty tags from #tag_dirty() until #unfreeze is called. */
+  /** Delay applying dirty tags from #tag_positions_changed() until #unfreeze is called. */
   void freeze();
   /** Apply dirty tags from after #freeze, and make future dirty tags apply immediately. */
   void unfreeze();
-  /** Call instead of `data.tag_dirty()`. */
-  void tag_dirty();
+  /** Call instead of `data.tag_dirty()` when only positions changed. */
+  void tag_positions_changed();
+  /** Call instead of `data.tag_dirty()` when the topology changed. */
+  void tag_topology_changed();
 };
 
 struct MeshGroup {
@@ -204,6 +239,12 @@ struct MeshRuntime {
   SharedCache<std::unique_ptr<BVHTree, BVHTreeDeleter>> bvh_cache_loose_verts_no_hidden;
   SharedCache<std::unique_ptr<BVHTree, BVHTreeDeleter>> bvh_cache_loose_edges;
   SharedCache<std::unique_ptr<BVHTree, BVHTreeDeleter>> bvh_cache_loose_edges_no_hidden;
+  /**
+   * Set when the positions of this mesh changed. Only such meshes keep trees to refit them for
+   * the positions of later copies of the mesh, to avoid the memory cost for meshes that are never
+   * deformed.
+   */
+  bool bvh_refit_positions_changed = false;
 
   SharedCache<std::optional<int>> max_material_index;
   SharedCache<VectorSet<int>> used_material_indices;
@@ -267,6 +308,14 @@ struct MeshRuntime {
   SharedCache<Array<int>> vert_to_corner_map_cache;
   /** Cache of face indices for each face corner. */
   SharedCache<Array<int>> corner_to_face_map_cache;
+  /** Cache of offsets for the vert to edge map. */
+  SharedCache<Array<int>> vert_to_edge_offset_cache;
+  /** Cache of indices for vert to edge map. */
+  SharedCache<Array<int>> vert_to_edge_map_cache;
+  /** Cache of offsets for the edge to face map. */
+  SharedCache<Array<int>> edge_to_face_offset_cache;
+  /** Cache of indices for edge to face map. */
+  SharedCache<Array<int>> edge_to_face_map_cache;
   /** Cache of data about edges not used by faces. See #Mesh::loose_edges(). */
   SharedCache<LooseEdgeCache> loose_edges_cache;
   /** Cache of data about vertices not used by edges. See #Mesh::loose_verts(). */
@@ -22,6 +22,8 @@ class TopologyRefinerImpl;
 
 namespace blender::bke::subdiv {
 
+struct MeshCache;
+
 enum VtxBoundaryInterpolation {
   /** Do not interpolate boundaries. */
   SUBDIV_VTX_BOUNDARY_NONE,
@@ -191,6 +193,14 @@ struct Subdiv {
   /** Statistics for debugging. */
   SubdivStats stats;
 
+  /**
+   * Result of the last conversion to a mesh, used to only evaluate new positions when the coarse
+   * mesh is deforming. See #subdiv_to_mesh().
+   */
+  MeshCache *mesh_cache = nullptr;
+  /** Number of conversions to a mesh done with this subdivision surface. */
+  int to_mesh_num = 0;
+
   /** Cached values, are not supposed to be accessed directly. */
   struct {
     /**
@@ -63,6 +63,15 @@ void eval_limit_point_and_derivatives(Subdiv *subdiv,
 void eval_limit_point_and_normal(
     Subdiv *subdiv, int ptex_face_index, float u, float v, float3 &r_P, float3 &r_N);
 
+/**
+ * Evaluate many points at the limit surface at once, which is much faster than evaluating them
+ * one by one. The evaluation is multi-threaded.
+ */
+void eval_limit_points(Subdiv *subdiv,
+                       Span<int> ptex_face_indices,
+                       Span<float2> uvs,
+                       MutableSpan<float3> r_positions);
+
 /** Evaluate smoothly interpolated vertex data (such as ORCO). */
 void eval_vertex_data(
     Subdiv *subdiv, int ptex_face_index, float u, float v, float r_vertex_data[]);
@@ -30,9 +30,18 @@ struct ToMeshSettings {
   bool use_optimal_display = false;
 };
 
-/** Create real hi-res mesh from subdivision, all geometry is "real". */
+/**
+ * Create real hi-res mesh from subdivision, all geometry is "real".
+ *
+ * When the same subdivision surface is converted repeatedly and only the coarse positions change
+ * (e.g. an animated deformation), the previous result is reused and only the new vertex
+ * positions are evaluated.
+ */
 Mesh *subdiv_to_mesh(Subdiv *subdiv, const ToMeshSettings *settings, const Mesh *coarse_mesh);
 
+/** Free the result cached by #subdiv_to_mesh for the next conversion. */
+void mesh_cache_free(Subdiv *subdiv);
+
 /**
  * Interpolate a position along the `coarse_edge` at the relative `u` coordinate.
  * If `is_simple` is false, this will perform a B-Spline interpolation using the edge neighbors,
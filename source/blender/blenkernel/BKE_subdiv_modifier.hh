@@ -96,6 +96,23 @@ extern void (*BKE_subsurf_modifier_free_gpu_cache_cb)(blender::bke::subdiv::Subd
 blender::bke::subdiv::Subdiv *BKE_subsurf_modifier_subdiv_descriptor_ensure(
     SubsurfRuntimeData *runtime_data, const Mesh *mesh, bool for_draw_code);
 
+/**
+ * Clamp the subdivision levels of the whole object when the adaptive levels option of the
+ * modifier is enabled, so that its largest subdivided edge is not smaller than the adaptive
+ * subdivision size. The size is scaled by the Cycles dicing rate of the scene. In pixel space,
+ * edges outside of the camera view use the Cycles off-screen dicing scale.
+ *
+ * This is a single level per object, not a per-face level like Cycles adaptive subdivision.
+ *
+ * \param max_levels: The levels used without the option, which are never exceeded.
+ */
+int BKE_subsurf_modifier_adaptive_levels_get(const SubsurfModifierData *smd,
+                                             const Scene *scene,
+                                             const Object *object,
+                                             const Mesh *mesh,
+                                             bool use_render_params,
+                                             int max_levels);
+
 /**
  * Return the #ModifierMode required for the evaluation of the subsurf modifier,
  * which should be used to check if the modifier is enabled.
@@ -129,6 +129,11 @@ struct UndoType {
 
   bool (*step_encode)(bContext *C, Main *bmain, UndoStep *us);
   void (*step_decode)(bContext *C, Main *bmain, UndoStep *us, eUndoStepDir dir, bool is_final);
+  /**
+   * Optional, called for all steps before any of them is decoded. When it fails for a step, the
+   * undo or redo is canceled and the current state is kept.
+   */
+  bool (*step_decode_prepare)(UndoStep *us);
 
   /**
    * \note When freeing all steps,
@@ -15,6 +15,7 @@
 #include "BLI_fileops.h"
 #include "BLI_fileops_types.h"
 #include "BLI_listbase.h"
+#include "BLI_memory_cache.hh"
 #include "BLI_path_utils.hh"
 #include "BLI_string.h"
 #include "BLI_string_utils.hh"
@@ -1233,6 +1234,12 @@ void BKE_tempdir_init(const char *userdir)
               "Could not generate a temp session subdirectory, falling back to '%s'",
               g_app.temp_dirname_base);
   }
+
+  /* Values evicted from the memory cache are written to the session directory. */
+  char memory_cache_dir[FILE_MAX];
+  BLI_path_join(
+      memory_cache_dir, sizeof(memory_cache_dir), g_app.temp_dirname_session, "memory_cache");
+  blender::memory_cache::set_disk_cache_directory(memory_cache_dir);
 }
 
 const char *BKE_tempdir_session()
@@ -1247,6 +1254,9 @@ const char *BKE_tempdir_base()
 
 void BKE_tempdir_session_purge()
 {
+  /* Removes the files of the disk cache, also when the session directory can't be removed. */
+  blender::memory_cache::set_disk_cache_directory("");
+
   if (g_app.temp_dirname_session_can_be_deleted == false) {
     /* It's possible this path references an arbitrary location
      * in that case *never* recursively remove, see: #139585. */
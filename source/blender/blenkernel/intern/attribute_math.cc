@@ -90,29 +90,6 @@ ColorGeometry4fMixer::ColorGeometry4fMixer(MutableSpan<ColorGeometry4f> buffer,
   mask.foreach_index([&](const int64_t i) { buffer_[i] = zero; });
 }
 
-void ColorGeometry4fMixer::set(const int64_t index,
-                               const ColorGeometry4f &color,
-                               const float weight)
-{
-  buffer_[index].r = color.r * weight;
-  buffer_[index].g = color.g * weight;
-  buffer_[index].b = color.b * weight;
-  buffer_[index].a = color.a * weight;
-  total_weights_[index] = weight;
-}
-
-void ColorGeometry4fMixer::mix_in(const int64_t index,
-                                  const ColorGeometry4f &color,
-                                  const float weight)
-{
-  ColorGeometry4f &output_color = buffer_[index];
-  output_color.r += color.r * weight;
-  output_color.g += color.g * weight;
-  output_color.b += color.b * weight;
-  output_color.a += color.a * weight;
-  total_weights_[index] += weight;
-}
-
 void ColorGeometry4fMixer::finalize()
 {
   this->finalize(buffer_.index_range());
@@ -125,10 +102,14 @@ void ColorGeometry4fMixer::finalize(const IndexMask &mask)
     ColorGeometry4f &output_color = buffer_[i];
     if (weight > 0.0f) {
       const float weight_inv = 1.0f / weight;
+#if BLI_HAVE_SSE2
+      _mm_storeu_ps(output_color, _mm_mul_ps(_mm_loadu_ps(output_color), _mm_set1_ps(weight_inv)));
+#else
       output_color.r *= weight_inv;
       output_color.g *= weight_inv;
       output_color.b *= weight_inv;
       output_color.a *= weight_inv;
+#endif
     }
     else {
       output_color = default_color_;
@@ -411,6 +411,15 @@ static void read_shared_array(BlendDataReader &reader,
 {
   const char *func = __func__;
   *sharing_info = BLO_read_shared(&reader, data, [&]() -> const ImplicitSharingInfo * {
+    if (dna_attr_type >= int8_t(AttrType::Bool) && dna_attr_type < int8_t(AttrType::String)) {
+      /* Trivial types can be referenced from the file directly if possible. */
+      const CPPType &cpp_type = attribute_type_to_cpp_type(AttrType(dna_attr_type));
+      if (const ImplicitSharingInfo *mapped_sharing_info = BLO_read_mapped_array(
+              &reader, cpp_type.size * size, cpp_type.alignment, data))
+      {
+        return mapped_sharing_info;
+      }
+    }
     read_array_data(reader, dna_attr_type, size, data);
     if (*data == nullptr) {
       return nullptr;
@@ -1711,4 +1711,93 @@ std::optional<BakeState> deserialize_bake(std::istream &stream,
   return bake_state;
 }
 
+static void write_sized_bytes(std::ostream &stream, const StringRef data)
+{
+  const int64_t size = data.size();
+  stream.write(reinterpret_cast<const char *>(&size), sizeof(size));
+  stream.write(data.data(), size);
+}
+
+static std::optional<std::string> read_sized_bytes(std::istream &stream)
+{
+  int64_t size;
+  if (!stream.read(reinterpret_cast<char *>(&size), sizeof(size)) || size < 0) {
+    return std::nullopt;
+  }
+  std::string data(size, '\0');
+  if (!stream.read(data.data(), size)) {
+    return std::nullopt;
+  }
+  return data;
+}
+
+bool serialize_geometry(const GeometrySet &geometry, std::ostream &stream)
+{
+  /* The geometry is modified when preparing it, the copy is cheap because of implicit sharing. */
+  GeometrySet geometry_to_write = geometry;
+  GeometryBakeItem::prepare_geometry_for_bake(geometry_to_write, nullptr);
+  BakeState bake_state;
+  bake_state.items_by_id.add_new(
+      0, std::make_unique<GeometryBakeItem>(std::move(geometry_to_write)));
+
+  MemoryBlobWriter blob_writer{"geometry"};
+  BlobWriteSharing blob_sharing;
+  std::ostringstream meta_stream;
+  serialize_bake(bake_state, blob_writer, blob_sharing, meta_stream);
+
+  /* The meta data is followed by all blobs with their names. */
+  write_sized_bytes(stream, meta_stream.str());
+  const Map<std::string, MemoryBlobWriter::OutputStream> &blobs = blob_writer.get_stream_by_name();
+  const int64_t blobs_num = blobs.size();
+  stream.write(reinterpret_cast<const char *>(&blobs_num), sizeof(blobs_num));
+  for (const auto item : blobs.items()) {
+    write_sized_bytes(stream, item.key);
+    write_sized_bytes(stream, item.value.stream->str());
+  }
+  return stream.good();
+}
+
+std::optional<GeometrySet> deserialize_geometry(std::istream &stream)
+{
+  const std::optional<std::string> meta = read_sized_bytes(stream);
+  int64_t blobs_num;
+  if (!meta || !stream.read(reinterpret_cast<char *>(&blobs_num), sizeof(blobs_num)) ||
+      blobs_num < 0)
+  {
+    return std::nullopt;
+  }
+  Vector<std::pair<std::string, std::string>> blobs;
+  for ([[maybe_unused]] const int64_t i : IndexRange(blobs_num)) {
+    std::optional<std::string> name = read_sized_bytes(stream);
+    std::optional<std::string> data = read_sized_bytes(stream);
+    if (!name || !data) {
+      return std::nullopt;
+    }
+    blobs.append({std::move(*name), std::move(*data)});
+  }
+  /* The reader only references the blob data, which must not be moved anymore. */
+  MemoryBlobReader blob_reader;
+  for (const auto &[name, data] : blobs) {
+    blob_reader.add(name, Span(reinterpret_cast<const std::byte *>(data.data()), data.size()));
+  }
+
+  BlobReadSharing blob_sharing;
+  std::istringstream meta_stream{*meta};
+  std::optional<BakeState> bake_state = deserialize_bake(meta_stream, blob_reader, blob_sharing);
+  if (!bake_state) {
+    return std::nullopt;
+  }
+  const std::unique_ptr<BakeItem> *bake_item = bake_state->items_by_id.lookup_ptr(0);
+  if (!bake_item) {
+    return std::nullopt;
+  }
+  auto *geometry_item = dynamic_cast<GeometryBakeItem *>(bake_item->get());
+  if (!geometry_item) {
+    return std::nullopt;
+  }
+  GeometrySet geometry = std::move(geometry_item->geometry);
+  GeometryBakeItem::try_restore_data_blocks(geometry, nullptr);
+  return geometry;
+}
+
 }  // namespace blender::bke::bake
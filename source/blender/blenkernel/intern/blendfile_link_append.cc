@@ -113,7 +113,8 @@ static BlendHandle *link_append_context_library_blohandle_ensure(
                                                &lib_context.bf_reports);
     }
     else {
-      blo_handle = BLO_blendhandle_from_file(libname.c_str(), &lib_context.bf_reports);
+      blo_handle = BLO_blendhandle_from_file_for_link(libname.c_str(),
+                                                      &lib_context.bf_reports);
     }
     lib_context.blo_handle = blo_handle;
     lib_context.blo_handle_is_owned = true;
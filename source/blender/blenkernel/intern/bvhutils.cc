@@ -9,9 +9,12 @@
 #include "DNA_meshdata_types.h"
 #include "DNA_pointcloud_types.h"
 
+#include "BLI_map.hh"
 #include "BLI_math_geom.h"
+#include "BLI_task.hh"
 
 #include "BKE_attribute.hh"
+#include "BKE_blender.hh"
 #include "BKE_bvhutils.hh"
 #include "BKE_editmesh.hh"
 #include "BKE_mesh.hh"
@@ -443,7 +446,7 @@ static std::unique_ptr<BVHTree, BVHTreeDeleter> create_tree_from_verts(
   }
   verts_mask.foreach_index(
       [&](const int i) { BLI_bvhtree_insert(tree.get(), i, positions[i], 1); });
-  BLI_bvhtree_balance(tree.get());
+  BLI_bvhtree_balance_ex(tree.get(), BVH_BALANCE_WIDE);
   return tree;
 }
 
@@ -468,7 +471,7 @@ static std::unique_ptr<BVHTree, BVHTreeDeleter> create_tree_from_edges(
     copy_v3_v3(co[1], positions[edge[1]]);
     BLI_bvhtree_insert(tree.get(), edge_i, co[0], 2);
   });
-  BLI_bvhtree_balance(tree.get());
+  BLI_bvhtree_balance_ex(tree.get(), BVH_BALANCE_WIDE);
   return tree;
 }
 
@@ -497,7 +500,7 @@ static std::unique_ptr<BVHTree, BVHTreeDeleter> create_tree_from_legacy_faces(
     }
     BLI_bvhtree_insert(tree.get(), i, co[0], faces[i].v4 ? 4 : 3);
   }
-  BLI_bvhtree_balance(tree.get());
+  BLI_bvhtree_balance_ex(tree.get(), BVH_BALANCE_SAH | BVH_BALANCE_WIDE);
   return tree;
 }
 
@@ -516,7 +519,7 @@ static std::unique_ptr<BVHTree, BVHTreeDeleter> create_tree_from_tris(const Span
     copy_v3_v3(co[2], positions[corner_verts[corner_tris[tri][2]]]);
     BLI_bvhtree_insert(tree.get(), tri, co[0], 3);
   }
-  BLI_bvhtree_balance(tree.get());
+  BLI_bvhtree_balance_ex(tree.get(), BVH_BALANCE_SAH | BVH_BALANCE_WIDE);
   return tree;
 }
 
@@ -549,7 +552,7 @@ static std::unique_ptr<BVHTree, BVHTreeDeleter> create_tree_from_tris(
       BLI_bvhtree_insert(tree.get(), tri, co[0], 3);
     }
   });
-  BLI_bvhtree_balance(tree.get());
+  BLI_bvhtree_balance_ex(tree.get(), BVH_BALANCE_SAH | BVH_BALANCE_WIDE);
   return tree;
 }
 
@@ -566,6 +569,156 @@ BVHTreeFromMesh bvhtree_from_mesh_corner_tris_ex(const Span<float3> vert_positio
       corner_tris);
 }
 
+/** Sharing info of a generic attribute array, used to identify topology arrays. */
+static const ImplicitSharingInfo *attribute_sharing_info_get(const CustomData &data,
+                                                             const StringRef name)
+{
+  const int index = CustomData_get_named_layer_index_notype(&data, name);
+  return index == -1 ? nullptr : data.layers[index].sharing_info;
+}
+
+/** A tree kept for refitting, and the topology arrays it was built for. */
+struct BVHRefitTree {
+  std::unique_ptr<BVHTree, BVHTreeDeleter> tree;
+  std::array<TopologyArrayState, 2> topology;
+};
+
+/**
+ * BVH trees kept for meshes whose positions change, to refit them for the new positions instead
+ * of building new trees. Only trees containing all elements are kept, and a tree is only refit
+ * for a mesh with the same topology arrays.
+ */
+struct BVHRefitCache {
+  Mutex mutex;
+  BVHRefitTree verts;
+  BVHRefitTree edges;
+  BVHRefitTree corner_tris;
+};
+
+/**
+ * Refit caches of all meshes whose positions changed, keyed by the sharing info of their main
+ * topology array. A deforming mesh is copied from the same original mesh on every evaluation, so
+ * the copies don't share any runtime data, but they do share the topology arrays. Entries are
+ * removed once nothing uses their topology array anymore.
+ */
+struct BVHRefitCaches {
+  Mutex mutex;
+  Map<WeakImplicitSharingPtr, std::shared_ptr<BVHRefitCache>> caches;
+  bool exit_registered = false;
+};
+
+static BVHRefitCaches &bvh_refit_caches()
+{
+  static BVHRefitCaches caches;
+  return caches;
+}
+
+static void bvh_refit_caches_exit(void * /*user_data*/)
+{
+  BVHRefitCaches &caches = bvh_refit_caches();
+  std::scoped_lock lock(caches.mutex);
+  caches.caches.clear();
+}
+
+/**
+ * Get the refit cache for the topology of the mesh, creating it if necessary. Only meshes with
+ * changing positions use the cache, to avoid the memory cost for meshes that are never deformed.
+ */
+static std::shared_ptr<BVHRefitCache> bvh_refit_cache_ensure(const Mesh &mesh)
+{
+  if (!mesh.runtime->bvh_refit_positions_changed) {
+    return nullptr;
+  }
+  const ImplicitSharingInfo *key = attribute_sharing_info_get(mesh.corner_data, ".corner_vert");
+  if (!key) {
+    key = attribute_sharing_info_get(mesh.edge_data, ".edge_verts");
+  }
+  if (!key) {
+    return nullptr;
+  }
+  BVHRefitCaches &caches = bvh_refit_caches();
+  std::scoped_lock lock(caches.mutex);
+  if (!caches.exit_registered) {
+    BKE_blender_atexit_register(bvh_refit_caches_exit, nullptr);
+    caches.exit_registered = true;
+  }
+  if (const std::shared_ptr<BVHRefitCache> *cache = caches.caches.lookup_ptr_as(key)) {
+    return *cache;
+  }
+  /* Free the trees of meshes that don't exist anymore. */
+  caches.caches.remove_if([](const auto &item) { return item.key->is_expired(); });
+  std::shared_ptr<BVHRefitCache> cache = std::make_shared<BVHRefitCache>();
+  key->add_weak_user();
+  caches.caches.add_new(WeakImplicitSharingPtr(key), cache);
+  return cache;
+}
+
+static bool refit_topology_matches(const Span<TopologyArrayState> stored,
+                                   const Span<const ImplicitSharingInfo *> topology)
+{
+  for (const int i : topology.index_range()) {
+    if (!stored[i].matches(topology[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Refit a copy of the tree kept for previous positions of the mesh if possible. Otherwise build a
+ * new tree, and keep a copy of it when the positions of the mesh are changing. Trees are always
+ * refit from the first tree built for the current topology, so their quality only depends on how
+ * far the positions moved since then, not on the number of refits.
+ *
+ * \param topology: Sharing info of the topology arrays used by the tree, it is only refit for
+ * the same arrays.
+ * \param update_leaf: Update the bounds of the leaf with the given index, which is the same as
+ * its index in the tree because only trees containing all elements are refit.
+ */
+static std::unique_ptr<BVHTree, BVHTreeDeleter> refit_or_create_tree(
+    const Mesh &mesh,
+    BVHRefitTree BVHRefitCache::*stored_tree,
+    const int elems_num,
+    const Span<const ImplicitSharingInfo *> topology,
+    const FunctionRef<std::unique_ptr<BVHTree, BVHTreeDeleter>()> create_tree,
+    const FunctionRef<void(BVHTree &tree, int index)> update_leaf)
+{
+  const std::shared_ptr<BVHRefitCache> cache = bvh_refit_cache_ensure(mesh);
+  if (!cache) {
+    return create_tree();
+  }
+  std::unique_ptr<BVHTree, BVHTreeDeleter> tree;
+  {
+    std::scoped_lock lock(cache->mutex);
+    const BVHRefitTree &stored = (*cache).*stored_tree;
+    if (stored.tree && BLI_bvhtree_get_len(stored.tree.get()) == elems_num &&
+        refit_topology_matches(stored.topology, topology))
+    {
+      tree.reset(BLI_bvhtree_copy(stored.tree.get()));
+    }
+  }
+  if (tree) {
+    threading::parallel_for(IndexRange(elems_num), 4096, [&](const IndexRange range) {
+      for (const int i : range) {
+        update_leaf(*tree, i);
+      }
+    });
+    BLI_bvhtree_update_tree(tree.get());
+    return tree;
+  }
+
+  tree = create_tree();
+  if (tree) {
+    std::scoped_lock lock(cache->mutex);
+    BVHRefitTree &stored = (*cache).*stored_tree;
+    stored.tree.reset(BLI_bvhtree_copy(tree.get()));
+    for (const int i : topology.index_range()) {
+      stored.topology[i].set(topology[i]);
+    }
+  }
+  return tree;
+}
+
 static BitVector<> loose_verts_no_hidden_mask_get(const Mesh &mesh)
 {
   int count = mesh.verts_num;
@@ -674,7 +827,15 @@ blender::bke::BVHTreeFromMesh Mesh::bvh_verts() const
   using namespace blender::bke;
   const Span<float3> positions = this->vert_positions();
   this->runtime->bvh_cache_verts.ensure([&](std::unique_ptr<BVHTree, BVHTreeDeleter> &data) {
-    data = create_tree_from_verts(positions, positions.index_range());
+    data = refit_or_create_tree(
+        *this,
+        &BVHRefitCache::verts,
+        positions.size(),
+        {},
+        [&]() { return create_tree_from_verts(positions, positions.index_range()); },
+        [&](BVHTree &tree, const int vert) {
+          BLI_bvhtree_update_node(&tree, vert, positions[vert], nullptr, 1);
+        });
   });
   return create_verts_tree_data(this->runtime->bvh_cache_verts.data().get(), positions);
 }
@@ -718,7 +879,18 @@ blender::bke::BVHTreeFromMesh Mesh::bvh_edges() const
   const Span<float3> positions = this->vert_positions();
   const Span<int2> edges = this->edges();
   this->runtime->bvh_cache_edges.ensure([&](std::unique_ptr<BVHTree, BVHTreeDeleter> &data) {
-    data = create_tree_from_edges(positions, edges, edges.index_range());
+    data = refit_or_create_tree(
+        *this,
+        &BVHRefitCache::edges,
+        edges.size(),
+        {attribute_sharing_info_get(this->edge_data, ".edge_verts")},
+        [&]() { return create_tree_from_edges(positions, edges, edges.index_range()); },
+        [&](BVHTree &tree, const int edge) {
+          float co[2][3];
+          copy_v3_v3(co[0], positions[edges[edge][0]]);
+          copy_v3_v3(co[1], positions[edges[edge][1]]);
+          BLI_bvhtree_update_node(&tree, edge, co[0], nullptr, 2);
+        });
   });
   return create_edges_tree_data(this->runtime->bvh_cache_edges.data().get(), positions, edges);
 }
@@ -773,7 +945,20 @@ blender::bke::BVHTreeFromMesh Mesh::bvh_corner_tris() const
   const Span<int> corner_verts = this->corner_verts();
   const Span<int3> corner_tris = this->corner_tris();
   this->runtime->bvh_cache_corner_tris.ensure([&](std::unique_ptr<BVHTree, BVHTreeDeleter> &data) {
-    data = create_tree_from_tris(positions, corner_verts, corner_tris);
+    data = refit_or_create_tree(
+        *this,
+        &BVHRefitCache::corner_tris,
+        corner_tris.size(),
+        {this->runtime->face_offsets_sharing_info,
+         attribute_sharing_info_get(this->corner_data, ".corner_vert")},
+        [&]() { return create_tree_from_tris(positions, corner_verts, corner_tris); },
+        [&](BVHTree &tree, const int tri) {
+          float co[3][3];
+          copy_v3_v3(co[0], positions[corner_verts[corner_tris[tri][0]]]);
+          copy_v3_v3(co[1], positions[corner_verts[corner_tris[tri][1]]]);
+          copy_v3_v3(co[2], positions[corner_verts[corner_tris[tri][2]]]);
+          BLI_bvhtree_update_node(&tree, tri, co[0], nullptr, 3);
+        });
   });
   return create_tris_tree_data(
       this->runtime->bvh_cache_corner_tris.data().get(), positions, corner_verts, corner_tris);
@@ -5275,6 +5275,55 @@ static void blend_read_layer_data(BlendDataReader *reader, CustomDataLayer &laye
   }
 }
 
+/**
+ * Try to reference the data of generic attribute layers directly from the file instead of copying
+ * it, see #BLO_read_mapped_array.
+ */
+static const ImplicitSharingInfo *blend_read_layer_data_mapped(BlendDataReader *reader,
+                                                               CustomDataLayer &layer,
+                                                               const int count)
+{
+  const eCustomDataType type = eCustomDataType(layer.type);
+  if (!(CD_TYPE_AS_MASK(type) & (CD_MASK_PROP_ALL & ~CD_MASK_PROP_STRING))) {
+    return nullptr;
+  }
+  const LayerTypeInfo &type_info = *layerType_getInfo(type);
+  return BLO_read_mapped_array(
+      reader, int64_t(type_info.size) * count, type_info.alignment, &layer.data);
+}
+
+/**
+ * Try to defer reading the data of generic attribute layers of linked IDs until the ID is used,
+ * see #BLO_read_array_lazy.
+ */
+static bool blend_read_layer_data_lazy(BlendDataReader *reader,
+                                       CustomData *data,
+                                       CustomDataLayer &layer,
+                                       const int count)
+{
+  const eCustomDataType type = eCustomDataType(layer.type);
+  if (!(CD_TYPE_AS_MASK(type) & (CD_MASK_PROP_ALL & ~CD_MASK_PROP_STRING))) {
+    return false;
+  }
+  /* The layers array may be reallocated before the data is loaded, so the layer is looked up by
+   * its name again. */
+  return BLO_read_array_lazy(
+      reader,
+      int64_t(layerType_getInfo(type)->size) * count,
+      &layer.data,
+      [data, type, count, name = std::string(layer.name)](void *layer_data) {
+        const int index = CustomData_get_named_layer_index(data, type, name);
+        if (index == -1) {
+          MEM_freeN(layer_data);
+          return;
+        }
+        CustomDataLayer &layer = data->layers[index];
+        BLI_assert(layer.data == nullptr && layer.sharing_info == nullptr);
+        layer.data = layer_data;
+        layer.sharing_info = make_implicit_sharing_info_for_layer(type, layer_data, count);
+      });
+}
+
 void CustomData_blend_read(BlendDataReader *reader, CustomData *data, const int count)
 {
   BLO_read_struct_array(reader, CustomDataLayer, data->totlayer, &data->layers);
@@ -5305,8 +5354,17 @@ void CustomData_blend_read(BlendDataReader *reader, CustomData *data, const int
     layer->sharing_info = nullptr;
 
     if (CustomData_verify_versions(data, i)) {
+      if (blend_read_layer_data_lazy(reader, data, *layer, count)) {
+        i++;
+        continue;
+      }
       layer->sharing_info = BLO_read_shared(
           reader, &layer->data, [&]() -> const ImplicitSharingInfo * {
+            if (const ImplicitSharingInfo *mapped_sharing_info = blend_read_layer_data_mapped(
+                    reader, *layer, count))
+            {
+              return mapped_sharing_info;
+            }
             blend_read_layer_data(reader, *layer, count);
             if (layer->data == nullptr) {
               return nullptr;
@@ -68,6 +68,7 @@
 #include "RNA_access.hh"
 
 #include "BLO_read_write.hh"
+#include "BLO_readfile.hh"
 
 #include "atomic_ops.h"
 
@@ -215,6 +216,8 @@ void BKE_lib_id_clear_library_data(Main *bmain, ID *id, const int flags)
   }
 
   lib_id_library_local_paths(bmain, nullptr, id->lib, id);
+  /* The data can't be read from the library file anymore once the ID is local. */
+  BKE_libblock_lazy_data_ensure(*id);
 
   id_fake_user_clear(id);
 
@@ -694,6 +697,10 @@ ID *BKE_id_copy_in_lib(Main *bmain,
       return nullptr;
     }
 
+    /* This includes evaluated copies made by the depsgraph, so linked data is read from its
+     * library file once it is actually used. */
+    BKE_libblock_lazy_data_ensure(*const_cast<ID *>(id));
+
     BKE_libblock_copy_in_lib(bmain, owner_library, id, new_owner_id, &newid, flag);
 
     if (idtype_info->copy_data != nullptr) {
@@ -1307,6 +1314,13 @@ void BKE_libblock_runtime_ensure(ID &id)
   }
 }
 
+void BKE_libblock_lazy_data_ensure(ID &id)
+{
+  if (id.runtime && id.runtime->lazy_data) {
+    BLO_readfile_id_lazy_data_ensure(id);
+  }
+}
+
 size_t BKE_libblock_get_alloc_info(short type, const char **r_name)
 {
   const IDTypeInfo *id_type = BKE_idtype_get_info_from_idcode(type);
@@ -98,6 +98,7 @@ void BKE_libblock_free_runtime_data(ID *id)
      * replaced by assets are deleted. This means that the regular "delete this ID" flow (aka this
      * code here) also needs to free this data. */
     BLO_readfile_id_runtime_data_free(*id);
+    BLO_readfile_id_lazy_data_free(*id);
 
     MEM_SAFE_DELETE(id->runtime);
   }
@@ -222,6 +222,12 @@ void mesh_calc_edges(Mesh &mesh, bool keep_existing_edges, const bool select_new
   mesh.edges_num = edge_offsets.total_size();
   attributes.add<int2>(".edge_verts", AttrDomain::Edge, AttributeInitMoveArray(new_edges.data()));
 
+  /* The maps are built from the edges and corner edges, which were both replaced above. */
+  mesh.runtime->vert_to_edge_offset_cache.tag_dirty();
+  mesh.runtime->vert_to_edge_map_cache.tag_dirty();
+  mesh.runtime->edge_to_face_offset_cache.tag_dirty();
+  mesh.runtime->edge_to_face_map_cache.tag_dirty();
+
   if (select_new_edges) {
     MutableAttributeAccessor attributes = mesh.attributes_for_write();
     SpanAttributeWriter<bool> select_edge = attributes.lookup_or_add_for_write_span<bool>(
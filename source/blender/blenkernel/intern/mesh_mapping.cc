@@ -13,13 +13,12 @@
 
 #include "MEM_guardedalloc.h"
 
-#include "atomic_ops.h"
-
 #include "BLI_array.hh"
 #include "BLI_bitmap.h"
 #include "BLI_function_ref.hh"
 #include "BLI_math_geom.h"
 #include "BLI_math_vector.h"
+#include "BLI_sort.hh"
 #include "BLI_task.hh"
 #include "BLI_utildefines.h"
 
@@ -269,18 +268,6 @@ static Array<int> create_reverse_offsets(const Span<int> indices, const int item
   return offsets;
 }
 
-static void sort_small_groups(const OffsetIndices<int> groups,
-                              const int grain_size,
-                              MutableSpan<int> indices)
-{
-  threading::parallel_for(groups.index_range(), grain_size, [&](const IndexRange range) {
-    for (const int64_t index : range) {
-      MutableSpan<int> group = indices.slice(groups[index]);
-      std::sort(group.begin(), group.end());
-    }
-  });
-}
-
 static Array<int> reverse_indices_in_groups(const Span<int> group_indices,
                                             const OffsetIndices<int> offsets)
 {
@@ -290,21 +277,10 @@ static Array<int> reverse_indices_in_groups(const Span<int> group_indices,
   BLI_assert(*std::max_element(group_indices.begin(), group_indices.end()) < offsets.size());
   BLI_assert(*std::min_element(group_indices.begin(), group_indices.end()) >= 0);
 
-  /* `counts` keeps track of how many elements have been added to each group, and is incremented
-   * atomically by many threads in parallel. `calloc` can be measurably faster than a parallel fill
-   * of zero. Alternatively the offsets could be copied and incremented directly, but the cost of
-   * the copy is slightly higher than the cost of `calloc`. */
-  int *counts = MEM_calloc_arrayN<int>(size_t(offsets.size()), __func__);
-  BLI_SCOPED_DEFER([&]() { MEM_freeN(counts); })
+  /* A stable sort keeps the indices in each group sorted, which makes the result deterministic
+   * without atomic counters and sorting each group afterwards. */
   Array<int> results(group_indices.size());
-  threading::parallel_for(group_indices.index_range(), 1024, [&](const IndexRange range) {
-    for (const int64_t i : range) {
-      const int group_index = group_indices[i];
-      const int index_in_group = atomic_fetch_and_add_int32(&counts[group_index], 1);
-      results[offsets[group_index][index_in_group]] = int(i);
-    }
-  });
-  sort_small_groups(offsets, 1024, results);
+  parallel_counting_sort(group_indices, offsets, results);
   return results;
 }
 
@@ -314,17 +290,9 @@ static void reverse_group_indices_in_groups(const OffsetIndices<int> groups,
                                             const OffsetIndices<int> offsets,
                                             MutableSpan<int> results)
 {
-  int *counts = MEM_calloc_arrayN<int>(size_t(offsets.size()), __func__);
-  BLI_SCOPED_DEFER([&]() { MEM_freeN(counts); })
-  threading::parallel_for(groups.index_range(), 1024, [&](const IndexRange range) {
-    for (const int64_t face : range) {
-      for (const int elem : group_to_elem.slice(groups[face])) {
-        const int index_in_group = atomic_fetch_and_add_int32(&counts[elem], 1);
-        results[offsets[elem][index_in_group]] = int(face);
-      }
-    }
-  });
-  sort_small_groups(offsets, 1024, results);
+  Array<int> elem_to_group(group_to_elem.size());
+  offset_indices::build_reverse_map(groups, elem_to_group);
+  parallel_counting_sort(group_to_elem, offsets, elem_to_group, results);
 }
 
 static GroupedSpan<int> gather_groups(const Span<int> group_indices,
@@ -344,6 +312,19 @@ Array<int> build_corner_to_face_map(const OffsetIndices<int> faces)
   return map;
 }
 
+void build_vert_to_edge_indices(const Span<int2> edges,
+                                const OffsetIndices<int> offsets,
+                                MutableSpan<int> edge_indices)
+{
+  /* Sort the indices of the edge vertices, every edge stores two of them. */
+  parallel_counting_sort(edges.cast<int>(), offsets, edge_indices);
+  threading::parallel_for(edge_indices.index_range(), 4096, [&](const IndexRange range) {
+    for (int &edge : edge_indices.slice(range)) {
+      edge /= 2;
+    }
+  });
+}
+
 GroupedSpan<int> build_vert_to_edge_map(const Span<int2> edges,
                                         const int verts_num,
                                         Array<int> &r_offsets,
@@ -352,19 +333,7 @@ GroupedSpan<int> build_vert_to_edge_map(const Span<int2> edges,
   r_offsets = create_reverse_offsets(edges.cast<int>(), verts_num);
   const OffsetIndices<int> offsets(r_offsets);
   r_indices.reinitialize(offsets.total_size());
-
-  /* Version of #reverse_indices_in_groups that accounts for storing two indices for each edge. */
-  int *counts = MEM_calloc_arrayN<int>(size_t(offsets.size()), __func__);
-  BLI_SCOPED_DEFER([&]() { MEM_freeN(counts); })
-  threading::parallel_for(edges.index_range(), 1024, [&](const IndexRange range) {
-    for (const int64_t edge : range) {
-      for (const int vert : {edges[edge][0], edges[edge][1]}) {
-        const int index_in_group = atomic_fetch_and_add_int32(&counts[vert], 1);
-        r_indices[offsets[vert][index_in_group]] = int(edge);
-      }
-    }
-  });
-  sort_small_groups(offsets, 1024, r_indices);
+  build_vert_to_edge_indices(edges, offsets, r_indices);
   return {offsets, r_indices};
 }
 
@@ -410,6 +379,14 @@ GroupedSpan<int> build_edge_to_corner_map(const Span<int> corner_edges,
   return gather_groups(corner_edges, edges_num, r_offsets, r_indices);
 }
 
+void build_edge_to_face_indices(const OffsetIndices<int> faces,
+                                const Span<int> corner_edges,
+                                const OffsetIndices<int> offsets,
+                                MutableSpan<int> face_indices)
+{
+  reverse_group_indices_in_groups(faces, corner_edges, offsets, face_indices);
+}
+
 GroupedSpan<int> build_edge_to_face_map(const OffsetIndices<int> faces,
                                         const Span<int> corner_edges,
                                         const int edges_num,
@@ -418,7 +395,7 @@ GroupedSpan<int> build_edge_to_face_map(const OffsetIndices<int> faces,
 {
   r_offsets = create_reverse_offsets(corner_edges, edges_num);
   r_indices.reinitialize(r_offsets.last());
-  reverse_group_indices_in_groups(faces, corner_edges, OffsetIndices<int>(r_offsets), r_indices);
+  build_edge_to_face_indices(faces, corner_edges, OffsetIndices<int>(r_offsets), r_indices);
   return {OffsetIndices<int>(r_offsets), r_indices};
 }
 
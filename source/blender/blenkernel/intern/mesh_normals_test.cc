@@ -0,0 +1,112 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BLI_index_mask.hh"
+#include "BLI_math_vector_types.hh"
+
+#include "BKE_idtype.hh"
+#include "BKE_lib_id.hh"
+#include "BKE_mesh.h"
+#include "BKE_mesh.hh"
+#include "BKE_mesh_types.hh"
+
+#include "CLG_log.h"
+
+#include "DNA_mesh_types.h"
+
+#include "mesh_test_utils.hh"
+
+namespace blender::bke::tests {
+
+class MeshNormalsTest : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    CLG_init();
+    BKE_idtype_init();
+  }
+
+  static void TearDownTestSuite()
+  {
+    CLG_exit();
+  }
+};
+
+/** A grid of quads that is not flat, so that all faces have different normals. */
+static Mesh *create_bumpy_grid_mesh(const int size)
+{
+  return create_grid_mesh(
+      size, [](const int x, const int y) { return float((x * 7 + y * 3) % 5) * 0.2f; });
+}
+
+static void expect_normals_near(const Span<float3> a, const Span<float3> b)
+{
+  ASSERT_EQ(a.size(), b.size());
+  for (const int i : a.index_range()) {
+    EXPECT_V3_NEAR(a[i], b[i], 1e-6f);
+  }
+}
+
+TEST_F(MeshNormalsTest, PartialUpdateMatchesFullUpdate)
+{
+  Mesh *mesh = create_bumpy_grid_mesh(20);
+  mesh->face_normals_true();
+  mesh->vert_normals_true();
+  Mesh *mesh_full = BKE_mesh_copy_for_eval(*mesh);
+
+  /* Few enough vertices for a partial update, on corners, borders and inside the grid. */
+  const Array<int> moved_verts = {0, 20, 22, 200, 201, 440};
+  for (Mesh *m : {mesh, mesh_full}) {
+    MutableSpan<float3> positions = m->vert_positions_for_write();
+    for (const int vert : moved_verts) {
+      positions[vert] += float3(0.3f, -0.2f, 1.5f);
+    }
+  }
+  IndexMaskMemory memory;
+  mesh->tag_positions_changed(IndexMask::from_indices(moved_verts.as_span(), memory));
+  mesh_full->tag_positions_changed();
+
+  /* The normals have been updated in place instead of being tagged dirty. */
+  EXPECT_TRUE(mesh->runtime->face_normals_true_cache.is_cached());
+  EXPECT_TRUE(mesh->runtime->vert_normals_true_cache.is_cached());
+  EXPECT_FALSE(mesh_full->runtime->face_normals_true_cache.is_cached());
+
+  expect_normals_near(mesh->face_normals_true(), mesh_full->face_normals_true());
+  expect_normals_near(mesh->vert_normals_true(), mesh_full->vert_normals_true());
+  expect_normals_near(mesh->face_normals(), mesh_full->face_normals());
+  expect_normals_near(mesh->vert_normals(), mesh_full->vert_normals());
+  expect_normals_near(mesh->corner_normals(), mesh_full->corner_normals());
+
+  BKE_id_free(nullptr, mesh_full);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshNormalsTest, PartialUpdateFallsBackToFullUpdate)
+{
+  Mesh *mesh = create_bumpy_grid_mesh(4);
+  mesh->face_normals_true();
+  Mesh *mesh_full = BKE_mesh_copy_for_eval(*mesh);
+
+  /* Too many moved vertices for a partial update. */
+  const IndexRange moved_verts = IndexRange(mesh->verts_num / 2);
+  for (Mesh *m : {mesh, mesh_full}) {
+    MutableSpan<float3> positions = m->vert_positions_for_write();
+    for (const int vert : moved_verts) {
+      positions[vert].z += 1.0f;
+    }
+  }
+  mesh->tag_positions_changed(IndexMask(moved_verts));
+  mesh_full->tag_positions_changed();
+
+  EXPECT_FALSE(mesh->runtime->face_normals_true_cache.is_cached());
+  expect_normals_near(mesh->face_normals_true(), mesh_full->face_normals_true());
+  expect_normals_near(mesh->vert_normals(), mesh_full->vert_normals());
+
+  BKE_id_free(nullptr, mesh_full);
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::bke::tests
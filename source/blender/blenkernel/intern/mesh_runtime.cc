@@ -8,6 +8,7 @@
 
 #include "BLI_array_utils.hh"
 #include "BLI_math_geom.h"
+#include "BLI_sort.hh"
 
 #include "BKE_bake_data_block_id.hh"
 #include "BKE_bvhutils.hh"
@@ -163,6 +164,36 @@ blender::GroupedSpan<int> Mesh::vert_to_corner_map() const
   return {offsets, this->runtime->vert_to_corner_map_cache.data()};
 }
 
+blender::GroupedSpan<int> Mesh::vert_to_edge_map() const
+{
+  using namespace blender;
+  this->runtime->vert_to_edge_offset_cache.ensure([&](Array<int> &r_data) {
+    r_data = Array<int>(this->verts_num + 1, 0);
+    offset_indices::build_reverse_offsets(this->edges().cast<int>(), r_data);
+  });
+  const OffsetIndices<int> offsets(this->runtime->vert_to_edge_offset_cache.data());
+  this->runtime->vert_to_edge_map_cache.ensure([&](Array<int> &r_data) {
+    r_data.reinitialize(offsets.total_size());
+    bke::mesh::build_vert_to_edge_indices(this->edges(), offsets, r_data);
+  });
+  return {offsets, this->runtime->vert_to_edge_map_cache.data()};
+}
+
+blender::GroupedSpan<int> Mesh::edge_to_face_map() const
+{
+  using namespace blender;
+  this->runtime->edge_to_face_offset_cache.ensure([&](Array<int> &r_data) {
+    r_data = Array<int>(this->edges_num + 1, 0);
+    offset_indices::build_reverse_offsets(this->corner_edges(), r_data);
+  });
+  const OffsetIndices<int> offsets(this->runtime->edge_to_face_offset_cache.data());
+  this->runtime->edge_to_face_map_cache.ensure([&](Array<int> &r_data) {
+    r_data.reinitialize(offsets.total_size());
+    bke::mesh::build_edge_to_face_indices(this->faces(), this->corner_edges(), offsets, r_data);
+  });
+  return {offsets, this->runtime->edge_to_face_map_cache.data()};
+}
+
 const blender::bke::LooseVertCache &Mesh::loose_verts() const
 {
   using namespace blender::bke;
@@ -239,42 +270,100 @@ void TrianglesCache::unfreeze()
 {
   this->frozen = false;
   if (this->dirty_while_frozen) {
-    this->data.tag_dirty();
+    this->dirty_while_frozen = false;
+    this->tag_positions_changed();
   }
-  this->dirty_while_frozen = false;
 }
 
-void TrianglesCache::tag_dirty()
+void TrianglesCache::tag_positions_changed()
 {
   if (this->frozen) {
     this->dirty_while_frozen = true;
+    return;
   }
-  else {
-    this->data.tag_dirty();
+  if (this->data.is_cached() && this->data.is_shared()) {
+    /* Tagging shared data dirty creates new empty data, keep a reference to the previous one. */
+    this->previous_data = this->data;
   }
+  this->data.tag_dirty();
+}
+
+void TrianglesCache::tag_topology_changed()
+{
+  /* Release the previous triangles, which are never reused for different topology. */
+  this->data = {};
+  this->previous_data = {};
+}
+
+bool TopologyArrayState::matches(const ImplicitSharingInfo *info) const
+{
+  /* Arrays without sharing info can't be identified. */
+  return info != nullptr && this->sharing_info == info && this->version == info->version();
+}
+
+void TopologyArrayState::set(const ImplicitSharingInfo *info)
+{
+  if (info) {
+    info->add_weak_user();
+  }
+  this->sharing_info = WeakImplicitSharingPtr(info);
+  this->version = info ? info->version() : 0;
+}
+
+static std::array<const ImplicitSharingInfo *, 2> corner_tris_topology_get(const Mesh &mesh)
+{
+  const int corner_vert_index = CustomData_get_named_layer_index(
+      &mesh.corner_data, CD_PROP_INT32, ".corner_vert");
+  const ImplicitSharingInfo *corner_verts_sharing_info =
+      corner_vert_index == -1 ? nullptr : mesh.corner_data.layers[corner_vert_index].sharing_info;
+  return {mesh.runtime->face_offsets_sharing_info, corner_verts_sharing_info};
 }
 
 }  // namespace blender::bke
 
 blender::Span<blender::int3> Mesh::corner_tris() const
 {
-  this->runtime->corner_tris_cache.data.ensure([&](blender::Array<blender::int3> &r_data) {
+  using namespace blender::bke;
+  TrianglesCache &cache = this->runtime->corner_tris_cache;
+  cache.data.ensure([&](CornerTrisData &r_data) {
     const Span<float3> positions = this->vert_positions();
     const blender::OffsetIndices faces = this->faces();
     const Span<int> corner_verts = this->corner_verts();
+    const std::array<const blender::ImplicitSharingInfo *, 2> topology =
+        corner_tris_topology_get(*this);
 
-    r_data.reinitialize(poly_to_tri_count(faces.size(), corner_verts.size()));
+    const int tris_num = poly_to_tri_count(faces.size(), corner_verts.size());
+
+    if (cache.previous_data.is_cached()) {
+      r_data = cache.previous_data.data();
+      cache.previous_data = {};
+    }
+    if (r_data.tris.size() == tris_num && r_data.topology[0].matches(topology[0]) &&
+        r_data.topology[1].matches(topology[1]))
+    {
+      mesh::corner_tris_update(positions,
+                               faces,
+                               corner_verts,
+                               BKE_mesh_face_normals_are_dirty(this) ? Span<float3>() :
+                                                                       this->face_normals(),
+                               r_data.tris);
+      return;
+    }
+
+    r_data.tris.reinitialize(tris_num);
+    r_data.topology[0].set(topology[0]);
+    r_data.topology[1].set(topology[1]);
 
     if (BKE_mesh_face_normals_are_dirty(this)) {
-      blender::bke::mesh::corner_tris_calc(positions, faces, corner_verts, r_data);
+      mesh::corner_tris_calc(positions, faces, corner_verts, r_data.tris);
     }
     else {
-      blender::bke::mesh::corner_tris_calc_with_normals(
-          positions, faces, corner_verts, this->face_normals(), r_data);
+      mesh::corner_tris_calc_with_normals(
+          positions, faces, corner_verts, this->face_normals(), r_data.tris);
     }
   });
 
-  return this->runtime->corner_tris_cache.data.data();
+  return cache.data.data().tris;
 }
 
 blender::Span<int> Mesh::corner_tri_faces() const
@@ -320,6 +409,10 @@ void BKE_mesh_runtime_clear_geometry(Mesh *mesh)
   mesh->runtime->vert_to_face_map_cache.tag_dirty();
   mesh->runtime->vert_to_corner_map_cache.tag_dirty();
   mesh->runtime->corner_to_face_map_cache.tag_dirty();
+  mesh->runtime->vert_to_edge_offset_cache.tag_dirty();
+  mesh->runtime->vert_to_edge_map_cache.tag_dirty();
+  mesh->runtime->edge_to_face_offset_cache.tag_dirty();
+  mesh->runtime->edge_to_face_map_cache.tag_dirty();
   mesh->runtime->vert_normals_cache.tag_dirty();
   mesh->runtime->vert_normals_true_cache.tag_dirty();
   mesh->runtime->face_normals_cache.tag_dirty();
@@ -328,7 +421,7 @@ void BKE_mesh_runtime_clear_geometry(Mesh *mesh)
   mesh->runtime->loose_edges_cache.tag_dirty();
   mesh->runtime->loose_verts_cache.tag_dirty();
   mesh->runtime->verts_no_face_cache.tag_dirty();
-  mesh->runtime->corner_tris_cache.data.tag_dirty();
+  mesh->runtime->corner_tris_cache.tag_topology_changed();
   mesh->runtime->corner_tri_faces_cache.tag_dirty();
   mesh->runtime->shrinkwrap_boundary_cache.tag_dirty();
   mesh->runtime->max_material_index.tag_dirty();
@@ -348,6 +441,10 @@ void Mesh::tag_edges_split()
   this->runtime->vert_to_face_offset_cache.tag_dirty();
   this->runtime->vert_to_face_map_cache.tag_dirty();
   this->runtime->vert_to_corner_map_cache.tag_dirty();
+  this->runtime->vert_to_edge_offset_cache.tag_dirty();
+  this->runtime->vert_to_edge_map_cache.tag_dirty();
+  this->runtime->edge_to_face_offset_cache.tag_dirty();
+  this->runtime->edge_to_face_map_cache.tag_dirty();
   if (this->runtime->loose_edges_cache.is_cached() &&
       this->runtime->loose_edges_cache.data().count != 0)
   {
@@ -404,10 +501,89 @@ void Mesh::tag_positions_changed()
   this->tag_positions_changed_no_normals();
 }
 
+/**
+ * Updating the normals of a subset of the mesh requires building sorted lists of the affected
+ * elements, which is only worth it when a small part of the mesh changes.
+ */
+static constexpr int64_t partial_normals_update_max_factor = 8;
+
+/** Sort and remove duplicates, to create an #IndexMask from the indices. */
+static blender::IndexMask indices_to_mask(blender::Vector<int> &indices,
+                                          blender::IndexMaskMemory &memory)
+{
+  using namespace blender;
+  parallel_sort(indices.begin(), indices.end());
+  indices.resize(std::unique(indices.begin(), indices.end()) - indices.begin());
+  return IndexMask::from_indices<int>(indices, memory);
+}
+
+void Mesh::tag_positions_changed(const blender::IndexMask &changed_verts)
+{
+  using namespace blender;
+  using namespace blender::bke;
+  if (changed_verts.is_empty()) {
+    return;
+  }
+  MeshRuntime &runtime = *this->runtime;
+  if (!runtime.face_normals_true_cache.is_cached() ||
+      changed_verts.size() * partial_normals_update_max_factor > this->verts_num)
+  {
+    this->tag_positions_changed();
+    return;
+  }
+
+  const Span<float3> positions = this->vert_positions();
+  const OffsetIndices faces = this->faces();
+  const Span<int> corner_verts = this->corner_verts();
+  const GroupedSpan<int> vert_to_face_map = this->vert_to_face_map();
+
+  /* The normals of all faces using a changed vertex change. */
+  IndexMaskMemory memory;
+  Vector<int> face_indices;
+  changed_verts.foreach_index(
+      [&](const int vert) { face_indices.extend(vert_to_face_map[vert]); });
+  const IndexMask affected_faces = indices_to_mask(face_indices, memory);
+  runtime.face_normals_true_cache.update([&](Vector<float3> &r_data) {
+    mesh::normals_calc_faces(positions, faces, corner_verts, affected_faces, r_data);
+  });
+
+  if (runtime.vert_normals_true_cache.is_cached()) {
+    /* Vertex normals depend on the normals of all adjacent faces, and the angles of the face
+     * corners, so the normals of all vertices of the affected faces change. */
+    Vector<int> vert_indices;
+    changed_verts.foreach_index([&](const int vert) { vert_indices.append(vert); });
+    affected_faces.foreach_index(
+        [&](const int face) { vert_indices.extend(corner_verts.slice(faces[face])); });
+    const IndexMask affected_verts = indices_to_mask(vert_indices, memory);
+    const Span<float3> face_normals = runtime.face_normals_true_cache.data();
+    runtime.vert_normals_true_cache.update([&](Vector<float3> &r_data) {
+      mesh::normals_calc_verts(positions,
+                               faces,
+                               corner_verts,
+                               vert_to_face_map,
+                               face_normals,
+                               affected_verts,
+                               r_data);
+    });
+  }
+
+  /* Corner normals depend on the smooth fans around each vertex, which aren't worth finding for a
+   * partial update. The other caches only reference the true normals when there are no custom
+   * normals, which is cheap to check again. */
+  runtime.vert_normals_cache.tag_dirty();
+  runtime.face_normals_cache.tag_dirty();
+  runtime.corner_normals_cache.tag_dirty();
+  this->tag_positions_changed_no_normals();
+}
+
 void Mesh::tag_positions_changed_no_normals()
 {
+  this->runtime->bvh_refit_positions_changed = true;
   free_bvh_caches(*this->runtime);
-  this->runtime->corner_tris_cache.tag_dirty();
+  if (this->corners_num != this->faces_num * 3) {
+    /* The triangulation of a mesh with only triangles doesn't depend on positions. */
+    this->runtime->corner_tris_cache.tag_positions_changed();
+  }
   this->runtime->bounds_cache.tag_dirty();
   this->runtime->shrinkwrap_boundary_cache.tag_dirty();
 }
@@ -415,6 +591,7 @@ void Mesh::tag_positions_changed_no_normals()
 void Mesh::tag_positions_changed_uniformly()
 {
   /* The normals and triangulation didn't change, since all verts moved by the same amount. */
+  this->runtime->bvh_refit_positions_changed = true;
   free_bvh_caches(*this->runtime);
   this->runtime->bounds_cache.tag_dirty();
 }
@@ -161,10 +161,15 @@ struct LocalData {
   }
 };
 
+/**
+ * \param skip_triangles: Don't write the corner triangles of faces that are triangles already.
+ * They don't depend on the positions and are always the same for the same topology.
+ */
 static void corner_tris_calc_impl(const Span<float3> positions,
                                   const OffsetIndices<int> faces,
                                   const Span<int> corner_verts,
                                   const Span<float3> face_normals,
+                                  const bool skip_triangles,
                                   MutableSpan<int3> corner_tris)
 {
   threading::EnumerableThreadSpecific<LocalData> all_local_data;
@@ -174,6 +179,9 @@ static void corner_tris_calc_impl(const Span<float3> positions,
       for (const int64_t i : range) {
         const int face_start = int(faces[i].start());
         const int face_size = int(faces[i].size());
+        if (skip_triangles && face_size == 3) {
+          continue;
+        }
         const int tris_start = poly_to_tri_count(int(i), face_start);
         mesh_calc_tessellation_for_face(corner_verts,
                                         positions,
@@ -190,6 +198,9 @@ static void corner_tris_calc_impl(const Span<float3> positions,
       for (const int64_t i : range) {
         const int face_start = int(faces[i].start());
         const int face_size = int(faces[i].size());
+        if (skip_triangles && face_size == 3) {
+          continue;
+        }
         const int tris_start = poly_to_tri_count(int(i), face_start);
         mesh_calc_tessellation_for_face_with_normal(corner_verts,
                                                     positions,
@@ -208,7 +219,16 @@ void corner_tris_calc(const Span<float3> vert_positions,
                       const Span<int> corner_verts,
                       MutableSpan<int3> corner_tris)
 {
-  corner_tris_calc_impl(vert_positions, faces, corner_verts, {}, corner_tris);
+  corner_tris_calc_impl(vert_positions, faces, corner_verts, {}, false, corner_tris);
+}
+
+void corner_tris_update(const Span<float3> vert_positions,
+                        const OffsetIndices<int> faces,
+                        const Span<int> corner_verts,
+                        const Span<float3> face_normals,
+                        MutableSpan<int3> corner_tris)
+{
+  corner_tris_calc_impl(vert_positions, faces, corner_verts, face_normals, true, corner_tris);
 }
 
 void corner_tris_calc_face_indices(const OffsetIndices<int> faces, MutableSpan<int> tri_faces)
@@ -230,7 +250,7 @@ void corner_tris_calc_with_normals(const Span<float3> vert_positions,
                                    MutableSpan<int3> corner_tris)
 {
   BLI_assert(!face_normals.is_empty() || faces.is_empty());
-  corner_tris_calc_impl(vert_positions, faces, corner_verts, face_normals, corner_tris);
+  corner_tris_calc_impl(vert_positions, faces, corner_verts, face_normals, false, corner_tris);
 }
 
 /** \} */
@@ -0,0 +1,159 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_math_geom.h"
+#include "BLI_math_vector.hh"
+#include "BLI_math_vector_types.hh"
+
+#include "BKE_idtype.hh"
+#include "BKE_lib_id.hh"
+#include "BKE_mesh.h"
+#include "BKE_mesh.hh"
+
+#include "CLG_log.h"
+
+#include "DNA_mesh_types.h"
+
+namespace blender::bke::tests {
+
+class MeshTessellateTest : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    CLG_init();
+    BKE_idtype_init();
+  }
+
+  static void TearDownTestSuite()
+  {
+    CLG_exit();
+  }
+};
+
+/**
+ * A flat pentagon with a notch at the fourth vertex, which only has a single valid
+ * triangulation, followed by a quad.
+ */
+static Mesh *create_notched_ngon_mesh()
+{
+  Mesh *mesh = BKE_mesh_new_nomain(9, 0, 2, 9);
+  mesh->vert_positions_for_write().copy_from({float3(0, 0, 0),
+                                              float3(2, 0, 0),
+                                              float3(2, 2, 0),
+                                              float3(1, 0.5f, 0),
+                                              float3(0, 2, 0),
+                                              float3(3, 0, 0),
+                                              float3(4, 0, 0),
+                                              float3(4, 1, 0),
+                                              float3(3, 1, 0)});
+  mesh->face_offsets_for_write().copy_from({0, 5, 9});
+  mesh->corner_verts_for_write().copy_from({0, 1, 2, 3, 4, 5, 6, 7, 8});
+  mesh_calc_edges(*mesh, false, false);
+  return mesh;
+}
+
+static float tri_area_z(const Mesh &mesh, const int3 &tri)
+{
+  const Span<float3> positions = mesh.vert_positions();
+  const Span<int> corner_verts = mesh.corner_verts();
+  const float3 &co_a = positions[corner_verts[tri[0]]];
+  const float3 &co_b = positions[corner_verts[tri[1]]];
+  const float3 &co_c = positions[corner_verts[tri[2]]];
+  return math::cross(co_b - co_a, co_c - co_a).z;
+}
+
+static Array<int3> corner_tris_calc_from_scratch(const Mesh &mesh)
+{
+  Array<int3> tris(poly_to_tri_count(mesh.faces_num, mesh.corners_num));
+  mesh::corner_tris_calc(mesh.vert_positions(), mesh.faces(), mesh.corner_verts(), tris);
+  return tris;
+}
+
+TEST_F(MeshTessellateTest, PositionsChangeFlippingTriangles)
+{
+  Mesh *mesh = create_notched_ngon_mesh();
+  const Array<int3> old_tris(mesh->corner_tris());
+  const int3 *old_data = mesh->corner_tris().data();
+
+  /* Move the notch out of the face, which flips one of the previous triangles. */
+  mesh->vert_positions_for_write()[3] = float3(-0.5f, 3, 0);
+  mesh->tag_positions_changed();
+  bool any_flipped = false;
+  for (const int3 &tri : old_tris) {
+    any_flipped |= tri_area_z(*mesh, tri) <= 0.0f;
+  }
+  ASSERT_TRUE(any_flipped);
+
+  const Span<int3> tris = mesh->corner_tris();
+  /* The triangles are updated in place, without allocating another array. */
+  EXPECT_EQ(tris.data(), old_data);
+  for (const int3 &tri : tris) {
+    EXPECT_GT(tri_area_z(*mesh, tri), 0.0f);
+  }
+  EXPECT_EQ_SPAN(tris, corner_tris_calc_from_scratch(*mesh).as_span());
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshTessellateTest, PositionsChangeIndependentOfHistory)
+{
+  Mesh *mesh = create_notched_ngon_mesh();
+  const Array<int3> original_tris(mesh->corner_tris());
+
+  /* Move the notch out of the face and back again. The triangles are the same as before, as if
+   * they were never calculated for the intermediate positions. */
+  mesh->vert_positions_for_write()[3] = float3(-0.5f, 3, 0);
+  mesh->tag_positions_changed();
+  mesh->corner_tris();
+  mesh->vert_positions_for_write()[3] = float3(1, 0.5f, 0);
+  mesh->tag_positions_changed();
+  EXPECT_EQ_SPAN(mesh->corner_tris(), original_tris.as_span());
+
+  /* Moving it slightly without flipping any triangle also gives the same triangles as
+   * calculating them from scratch. */
+  mesh->vert_positions_for_write()[3] = float3(1.2f, 0.8f, 0);
+  mesh->tag_positions_changed();
+  EXPECT_EQ_SPAN(mesh->corner_tris(), corner_tris_calc_from_scratch(*mesh).as_span());
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshTessellateTest, PositionsChangeSharedCache)
+{
+  Mesh *mesh = create_notched_ngon_mesh();
+  const Array<int3> old_tris(mesh->corner_tris());
+  Mesh *mesh_copy = BKE_mesh_copy_for_eval(*mesh);
+
+  mesh_copy->vert_positions_for_write()[3] = float3(-0.5f, 3, 0);
+  mesh_copy->tag_positions_changed();
+
+  /* Updating the triangles of the copy doesn't affect the triangles of the original. */
+  EXPECT_EQ_SPAN(mesh_copy->corner_tris(), corner_tris_calc_from_scratch(*mesh_copy).as_span());
+  EXPECT_EQ_SPAN(mesh->corner_tris(), old_tris.as_span());
+
+  BKE_id_free(nullptr, mesh_copy);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(MeshTessellateTest, PositionsChangeDifferentTopology)
+{
+  Mesh *mesh = create_notched_ngon_mesh();
+  mesh->corner_tris();
+  Mesh *mesh_copy = BKE_mesh_copy_for_eval(*mesh);
+
+  /* Rotate the corners of the n-gon, which keeps the number of triangles. The previous
+   * triangles are not updated for the different corner vertices. */
+  mesh_copy->corner_verts_for_write().take_front(5).copy_from({1, 2, 3, 4, 0});
+  mesh_copy->tag_positions_changed();
+
+  EXPECT_EQ_SPAN(mesh_copy->corner_tris(), corner_tris_calc_from_scratch(*mesh_copy).as_span());
+
+  BKE_id_free(nullptr, mesh_copy);
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::bke::tests
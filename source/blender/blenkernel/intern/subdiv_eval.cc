@@ -8,9 +8,11 @@
 
 #include "BKE_subdiv_eval.hh"
 
+#include "BLI_array.hh"
 #include "BLI_math_vector.h"
 #include "BLI_math_vector.hh"
 #include "BLI_task.h"
+#include "BLI_task.hh"
 
 #include "BKE_customdata.hh"
 #include "BKE_mesh.hh"
@@ -331,6 +333,33 @@ void eval_limit_point_and_derivatives(Subdiv *subdiv,
 #endif
 }
 
+void eval_limit_points(Subdiv *subdiv,
+                       const Span<int> ptex_face_indices,
+                       const Span<float2> uvs,
+                       MutableSpan<float3> r_positions)
+{
+  BLI_assert(ptex_face_indices.size() == uvs.size());
+  BLI_assert(ptex_face_indices.size() == r_positions.size());
+#ifdef WITH_OPENSUBDIV
+  threading::parallel_for(r_positions.index_range(), 4096, [&](const IndexRange range) {
+    Array<OpenSubdiv_PatchCoord> patch_coords(range.size());
+    for (const int i : range.index_range()) {
+      const int point = range[i];
+      patch_coords[i] = {ptex_face_indices[point], uvs[point].x, uvs[point].y};
+    }
+    subdiv->evaluator->eval_output->evaluatePatchesLimit(
+        patch_coords.data(),
+        int(range.size()),
+        reinterpret_cast<float *>(r_positions.slice(range).data()),
+        nullptr,
+        nullptr);
+  });
+#else
+  UNUSED_VARS(subdiv, ptex_face_indices, uvs);
+  r_positions.fill(float3(0.0f));
+#endif
+}
+
 void eval_limit_point_and_normal(Subdiv *subdiv,
                                  const int ptex_face_index,
                                  const float u,
@@ -10,13 +10,18 @@
 #include "DNA_mesh_types.h"
 
 #include "BLI_array.hh"
+#include "BLI_implicit_sharing_ptr.hh"
+#include "BLI_listbase.h"
 #include "BLI_math_vector.h"
 #include "BLI_math_vector.hh"
 #include "BLI_math_vector_types.hh"
+#include "BLI_string.h"
+#include "BLI_vector.hh"
 
 #include "BKE_attribute_math.hh"
 #include "BKE_customdata.hh"
 #include "BKE_key.hh"
+#include "BKE_lib_id.hh"
 #include "BKE_mesh.hh"
 #include "BKE_mesh_mapping.hh"
 #include "BKE_subdiv.hh"
@@ -29,6 +34,139 @@
 
 namespace blender::bke::subdiv {
 
+/* -------------------------------------------------------------------- */
+/** \name Mesh Cache
+ * \{ */
+
+struct MeshCacheLayer {
+  eCustomDataType type;
+  std::string name;
+  const void *data;
+  /** Keeps the data alive and immutable while the cache exists. */
+  ImplicitSharingPtr<> sharing_info;
+};
+
+/**
+ * The result of a previous conversion, with the information necessary to detect whether it can be
+ * reused. Since the subdivision surface is only reused when the coarse topology is unchanged, the
+ * result can be reused as well, as long as the coarse attributes didn't change. In that case only
+ * the positions have to be evaluated again.
+ */
+struct MeshCache {
+  ToMeshSettings settings;
+
+  /** All coarse mesh layers except for positions. */
+  Vector<MeshCacheLayer> coarse_layers;
+  const int *coarse_face_offsets = nullptr;
+  ImplicitSharingPtr<> coarse_face_offsets_sharing_info;
+
+  /** The result mesh, without a position attribute. */
+  Mesh *mesh = nullptr;
+
+  /** The patch coordinates used to evaluate the position of every result vertex. */
+  Array<int> vert_ptex_faces;
+  Array<float2> vert_ptex_uvs;
+
+  ~MeshCache()
+  {
+    if (mesh != nullptr) {
+      BKE_id_free(nullptr, mesh);
+    }
+  }
+};
+
+static Vector<const CustomDataLayer *> mesh_cache_coarse_layers(const Mesh &coarse_mesh)
+{
+  Vector<const CustomDataLayer *> layers;
+  for (const CustomData *data : {&coarse_mesh.vert_data,
+                                 &coarse_mesh.edge_data,
+                                 &coarse_mesh.face_data,
+                                 &coarse_mesh.corner_data})
+  {
+    for (const CustomDataLayer &layer : Span(data->layers, data->totlayer)) {
+      if (data == &coarse_mesh.vert_data && STREQ(layer.name, "position")) {
+        continue;
+      }
+      layers.append(&layer);
+    }
+  }
+  return layers;
+}
+
+static bool mesh_cache_can_store(const Subdiv &subdiv, const Mesh &coarse_mesh)
+{
+  if (subdiv.displacement_evaluator != nullptr) {
+    return false;
+  }
+  if (coarse_mesh.faces_num == 0 || coarse_mesh.runtime->face_offsets_sharing_info == nullptr) {
+    return false;
+  }
+  /* Positions of vertices created for loose geometry are not evaluated from the limit surface. */
+  if (coarse_mesh.loose_edges().count > 0 || coarse_mesh.verts_no_face().count > 0) {
+    return false;
+  }
+  for (const CustomDataLayer *layer : mesh_cache_coarse_layers(coarse_mesh)) {
+    if (layer->sharing_info == nullptr) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void mesh_cache_store_coarse_key(MeshCache &cache, const Mesh &coarse_mesh)
+{
+  for (const CustomDataLayer *layer : mesh_cache_coarse_layers(coarse_mesh)) {
+    layer->sharing_info->add_user();
+    cache.coarse_layers.append({eCustomDataType(layer->type),
+                                layer->name,
+                                layer->data,
+                                ImplicitSharingPtr<>(layer->sharing_info)});
+  }
+  coarse_mesh.runtime->face_offsets_sharing_info->add_user();
+  cache.coarse_face_offsets = coarse_mesh.face_offset_indices;
+  cache.coarse_face_offsets_sharing_info = ImplicitSharingPtr<>(
+      coarse_mesh.runtime->face_offsets_sharing_info);
+}
+
+static bool mesh_cache_matches(const MeshCache &cache,
+                               const Subdiv &subdiv,
+                               const ToMeshSettings &settings,
+                               const Mesh &coarse_mesh)
+{
+  if (cache.settings.resolution != settings.resolution ||
+      cache.settings.use_optimal_display != settings.use_optimal_display)
+  {
+    return false;
+  }
+  if (subdiv.displacement_evaluator != nullptr) {
+    return false;
+  }
+  if (cache.coarse_face_offsets != coarse_mesh.face_offset_indices) {
+    return false;
+  }
+  const Vector<const CustomDataLayer *> layers = mesh_cache_coarse_layers(coarse_mesh);
+  if (layers.size() != cache.coarse_layers.size()) {
+    return false;
+  }
+  for (const int i : layers.index_range()) {
+    const MeshCacheLayer &cached_layer = cache.coarse_layers[i];
+    if (layers[i]->type != cached_layer.type || layers[i]->data != cached_layer.data ||
+        layers[i]->name != cached_layer.name)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+void mesh_cache_free(Subdiv *subdiv)
+{
+  MEM_delete(subdiv->mesh_cache);
+  subdiv->mesh_cache = nullptr;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Subdivision Context
  * \{ */
@@ -85,6 +223,9 @@ struct SubdivMeshContext {
   Array<int> vert_to_edge_offsets;
   Array<int> vert_to_edge_indices;
   GroupedSpan<int> vert_to_edge_map;
+
+  /* When not null, the patch coordinates of every vertex are stored for reusing the result. */
+  MeshCache *new_mesh_cache;
 };
 
 static void subdiv_mesh_ctx_cache_uv_layers(SubdivMeshContext *ctx)
@@ -564,6 +705,10 @@ static bool subdiv_mesh_topology_info(const ForeachContext *foreach_context,
   if (subdiv_context->settings->use_optimal_display) {
     subdiv_context->subdiv_display_edges = Array<bool>(num_edges, false);
   }
+  if (subdiv_context->new_mesh_cache) {
+    subdiv_context->new_mesh_cache->vert_ptex_faces.reinitialize(num_vertices);
+    subdiv_context->new_mesh_cache->vert_ptex_uvs.reinitialize(num_vertices);
+  }
   return true;
 }
 
@@ -603,6 +748,18 @@ static void subdiv_vertex_data_interpolate(const SubdivMeshContext *ctx,
   }
 }
 
+static void subdiv_vertex_patch_coord_store(const SubdivMeshContext *ctx,
+                                            const int ptex_face_index,
+                                            const float u,
+                                            const float v,
+                                            const int subdiv_vertex_index)
+{
+  if (ctx->new_mesh_cache) {
+    ctx->new_mesh_cache->vert_ptex_faces[subdiv_vertex_index] = ptex_face_index;
+    ctx->new_mesh_cache->vert_ptex_uvs[subdiv_vertex_index] = float2(u, v);
+  }
+}
+
 static void evaluate_vertex_and_apply_displacement_copy(const SubdivMeshContext *ctx,
                                                         const int ptex_face_index,
                                                         const float u,
@@ -622,6 +779,7 @@ static void evaluate_vertex_and_apply_displacement_copy(const SubdivMeshContext
   /* Copy custom data and evaluate position. */
   subdiv_vertex_data_copy(ctx, coarse_vertex_index, subdiv_vertex_index);
   subdiv_position = eval_limit_point(ctx->subdiv, ptex_face_index, u, v);
+  subdiv_vertex_patch_coord_store(ctx, ptex_face_index, u, v, subdiv_vertex_index);
   /* Apply displacement. */
   subdiv_position += D;
   /* Evaluate undeformed texture coordinate. */
@@ -650,6 +808,7 @@ static void evaluate_vertex_and_apply_displacement_interpolate(
   /* Interpolate custom data and evaluate position. */
   subdiv_vertex_data_interpolate(ctx, subdiv_vertex_index, vertex_interpolation, u, v);
   subdiv_position = eval_limit_point(ctx->subdiv, ptex_face_index, u, v);
+  subdiv_vertex_patch_coord_store(ctx, ptex_face_index, u, v, subdiv_vertex_index);
   /* Apply displacement. */
   add_v3_v3(subdiv_position, D);
   /* Evaluate undeformed texture coordinate. */
@@ -805,6 +964,7 @@ static void subdiv_mesh_vertex_inner(const ForeachContext *foreach_context,
   subdiv_mesh_ensure_vertex_interpolation(ctx, tls, coarse_face_index, coarse_corner);
   subdiv_vertex_data_interpolate(ctx, subdiv_vertex_index, &tls->vertex_interpolation, u, v);
   ctx->subdiv_positions[subdiv_vertex_index] = eval_final_point(subdiv, ptex_face_index, u, v);
+  subdiv_vertex_patch_coord_store(ctx, ptex_face_index, u, v, subdiv_vertex_index);
   subdiv_mesh_tag_center_vertex(coarse_face, subdiv_vertex_index, u, v, subdiv_mesh);
   subdiv_vertex_orco_evaluate(ctx, ptex_face_index, u, v, subdiv_vertex_index);
 }
@@ -1126,6 +1286,42 @@ static void setup_foreach_callbacks(const SubdivMeshContext *subdiv_context,
 /** \name Public entry point
  * \{ */
 
+static Mesh *subdiv_mesh_from_cache(Subdiv *subdiv, const Mesh &coarse_mesh)
+{
+  const MeshCache &cache = *subdiv->mesh_cache;
+  Mesh *result = BKE_mesh_copy_for_eval(*cache.mesh);
+  BLI_freelistN(&result->vertex_group_names);
+  BKE_mesh_copy_parameters_for_eval(result, &coarse_mesh);
+
+  float3 *positions = static_cast<float3 *>(CustomData_add_layer_named(
+      &result->vert_data, CD_PROP_FLOAT3, CD_CONSTRUCT, result->verts_num, "position"));
+  eval_limit_points(subdiv,
+                    cache.vert_ptex_faces,
+                    cache.vert_ptex_uvs,
+                    MutableSpan(positions, result->verts_num));
+  result->tag_positions_changed();
+
+  if (subdiv->settings.is_simple) {
+    result->runtime->bounds_cache = coarse_mesh.runtime->bounds_cache;
+  }
+  return result;
+}
+
+static void subdiv_mesh_cache_store(Subdiv *subdiv,
+                                    MeshCache *cache,
+                                    const ToMeshSettings &settings,
+                                    const Mesh &coarse_mesh,
+                                    const Mesh &result)
+{
+  cache->settings = settings;
+  mesh_cache_store_coarse_key(*cache, coarse_mesh);
+  /* The copy shares all arrays and topology caches with the result. Positions are evaluated
+   * again anyway, so they are not kept alive. */
+  cache->mesh = BKE_mesh_copy_for_eval(result);
+  CustomData_free_layer_named(&cache->mesh->vert_data, "position");
+  subdiv->mesh_cache = cache;
+}
+
 Mesh *subdiv_to_mesh(Subdiv *subdiv, const ToMeshSettings *settings, const Mesh *coarse_mesh)
 {
 
@@ -1142,9 +1338,24 @@ Mesh *subdiv_to_mesh(Subdiv *subdiv, const ToMeshSettings *settings, const Mesh
       return nullptr;
     }
   }
+  /* When only coarse positions changed since the last conversion, only evaluate new positions. */
+  if (subdiv->mesh_cache != nullptr &&
+      mesh_cache_matches(*subdiv->mesh_cache, *subdiv, *settings, *coarse_mesh))
+  {
+    Mesh *result = subdiv_mesh_from_cache(subdiv, *coarse_mesh);
+    subdiv->to_mesh_num++;
+    stats_end(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH);
+    return result;
+  }
+  mesh_cache_free(subdiv);
   /* Initialize subdivision mesh creation context. */
   SubdivMeshContext subdiv_context{};
   subdiv_context.settings = settings;
+  /* Only keep the result for the next conversion when the same subdivision surface is converted
+   * repeatedly, which is typically the case for deforming meshes. */
+  if (subdiv->to_mesh_num > 0 && mesh_cache_can_store(*subdiv, *coarse_mesh)) {
+    subdiv_context.new_mesh_cache = MEM_new<MeshCache>(__func__);
+  }
 
   subdiv_context.coarse_mesh = coarse_mesh;
   subdiv_context.coarse_positions = coarse_mesh->vert_positions();
@@ -1212,6 +1423,12 @@ Mesh *subdiv_to_mesh(Subdiv *subdiv, const ToMeshSettings *settings, const Mesh
     result->runtime->bounds_cache = coarse_mesh->runtime->bounds_cache;
   }
 
+  if (subdiv_context.new_mesh_cache) {
+    subdiv_mesh_cache_store(
+        subdiv, subdiv_context.new_mesh_cache, *settings, *coarse_mesh, *result);
+  }
+  subdiv->to_mesh_num++;
+
   // BKE_mesh_validate(result, true, true);
   stats_end(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH);
   subdiv_mesh_context_free(&subdiv_context);
@@ -0,0 +1,194 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include <cmath>
+
+#include "BLI_math_vector_types.hh"
+
+#include "BKE_attribute.hh"
+#include "BKE_idtype.hh"
+#include "BKE_lib_id.hh"
+#include "BKE_mesh.h"
+#include "BKE_mesh.hh"
+#include "BKE_subdiv.hh"
+#include "BKE_subdiv_mesh.hh"
+
+#include "CLG_log.h"
+
+#include "DNA_mesh_types.h"
+
+#include "mesh_test_utils.hh"
+
+#ifdef WITH_OPENSUBDIV
+
+namespace blender::bke::subdiv::tests {
+
+class SubdivMeshTest : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    CLG_init();
+    BKE_idtype_init();
+    subdiv::init();
+  }
+
+  static void TearDownTestSuite()
+  {
+    subdiv::exit();
+    CLG_exit();
+  }
+};
+
+/** A grid of quads with a generic point attribute. */
+static Mesh *create_grid_mesh_with_weights(const int size)
+{
+  Mesh *mesh = bke::tests::create_grid_mesh(size);
+  MutableAttributeAccessor attributes = mesh->attributes_for_write();
+  SpanAttributeWriter<float> weight = attributes.lookup_or_add_for_write_only_span<float>(
+      "weight", AttrDomain::Point);
+  for (const int i : weight.span.index_range()) {
+    weight.span[i] = float(i % 3);
+  }
+  weight.finish();
+  return mesh;
+}
+
+/** A copy of the mesh that shares all arrays except for the deformed positions. */
+static Mesh *deformed_copy(const Mesh &mesh, const float factor)
+{
+  Mesh *result = BKE_mesh_copy_for_eval(mesh);
+  MutableSpan<float3> positions = result->vert_positions_for_write();
+  for (const int i : positions.index_range()) {
+    positions[i].z += std::sin(float(i)) * factor;
+  }
+  result->tag_positions_changed();
+  return result;
+}
+
+static Settings subdiv_settings_get()
+{
+  Settings settings{};
+  settings.is_simple = false;
+  settings.is_adaptive = false;
+  settings.level = 2;
+  settings.use_creases = false;
+  settings.vtx_boundary_interpolation = vtx_boundary_interpolation_from_subsurf(0);
+  settings.fvar_linear_interpolation = fvar_interpolation_from_uv_smooth(0);
+  return settings;
+}
+
+static ToMeshSettings to_mesh_settings_get()
+{
+  ToMeshSettings settings;
+  settings.resolution = (1 << 2) + 1;
+  settings.use_optimal_display = false;
+  return settings;
+}
+
+/** Convert with a new subdivision surface, which never uses a result cached by a previous one. */
+static Mesh *subdiv_to_mesh_full(const Mesh &coarse_mesh)
+{
+  const Settings settings = subdiv_settings_get();
+  const ToMeshSettings to_mesh_settings = to_mesh_settings_get();
+  Subdiv *subdiv = new_from_mesh(&settings, &coarse_mesh);
+  Mesh *result = subdiv_to_mesh(subdiv, &to_mesh_settings, &coarse_mesh);
+  subdiv::free(subdiv);
+  return result;
+}
+
+static void expect_meshes_near(const Mesh &a, const Mesh &b)
+{
+  ASSERT_EQ(a.verts_num, b.verts_num);
+  ASSERT_EQ(a.edges_num, b.edges_num);
+  ASSERT_EQ(a.faces_num, b.faces_num);
+  EXPECT_EQ_SPAN(a.face_offsets(), b.face_offsets());
+  EXPECT_EQ_SPAN(a.corner_verts(), b.corner_verts());
+  EXPECT_EQ_SPAN(a.edges(), b.edges());
+  const Span<float3> positions_a = a.vert_positions();
+  const Span<float3> positions_b = b.vert_positions();
+  for (const int i : positions_a.index_range()) {
+    EXPECT_V3_NEAR(positions_a[i], positions_b[i], 1e-5f);
+  }
+  const VArraySpan weight_a = *a.attributes().lookup<float>("weight", AttrDomain::Point);
+  const VArraySpan weight_b = *b.attributes().lookup<float>("weight", AttrDomain::Point);
+  for (const int i : weight_a.index_range()) {
+    EXPECT_NEAR(weight_a[i], weight_b[i], 1e-5f);
+  }
+}
+
+TEST_F(SubdivMeshTest, DeformedCoarseMeshUsesCache)
+{
+  Mesh *coarse_mesh = create_grid_mesh_with_weights(3);
+  const Settings settings = subdiv_settings_get();
+  const ToMeshSettings to_mesh_settings = to_mesh_settings_get();
+  Subdiv *subdiv = new_from_mesh(&settings, coarse_mesh);
+  ASSERT_NE(subdiv, nullptr);
+
+  /* The result is only cached from the second conversion on. */
+  Mesh *first = subdiv_to_mesh(subdiv, &to_mesh_settings, coarse_mesh);
+  EXPECT_EQ(subdiv->mesh_cache, nullptr);
+  Mesh *second = subdiv_to_mesh(subdiv, &to_mesh_settings, coarse_mesh);
+  EXPECT_NE(subdiv->mesh_cache, nullptr);
+  expect_meshes_near(*first, *second);
+
+  /* Convert twice from the cache, for different deformations. */
+  for (const float factor : {0.5f, 1.5f}) {
+    Mesh *deformed_mesh = deformed_copy(*coarse_mesh, factor);
+    Mesh *result = subdiv_to_mesh(subdiv, &to_mesh_settings, deformed_mesh);
+    /* The topology is shared with the cached result. */
+    EXPECT_EQ(result->corner_verts().data(), second->corner_verts().data());
+
+    Mesh *expected = subdiv_to_mesh_full(*deformed_mesh);
+    expect_meshes_near(*result, *expected);
+
+    BKE_id_free(nullptr, expected);
+    BKE_id_free(nullptr, result);
+    BKE_id_free(nullptr, deformed_mesh);
+  }
+
+  subdiv::free(subdiv);
+  BKE_id_free(nullptr, second);
+  BKE_id_free(nullptr, first);
+  BKE_id_free(nullptr, coarse_mesh);
+}
+
+TEST_F(SubdivMeshTest, AttributeChangeBypassesCache)
+{
+  Mesh *coarse_mesh = create_grid_mesh_with_weights(3);
+  const Settings settings = subdiv_settings_get();
+  const ToMeshSettings to_mesh_settings = to_mesh_settings_get();
+  Subdiv *subdiv = new_from_mesh(&settings, coarse_mesh);
+  ASSERT_NE(subdiv, nullptr);
+
+  Mesh *first = subdiv_to_mesh(subdiv, &to_mesh_settings, coarse_mesh);
+  Mesh *second = subdiv_to_mesh(subdiv, &to_mesh_settings, coarse_mesh);
+  EXPECT_NE(subdiv->mesh_cache, nullptr);
+
+  /* Change an attribute other than positions, which can't be taken from the cached result. */
+  Mesh *changed_mesh = deformed_copy(*coarse_mesh, 1.0f);
+  SpanAttributeWriter<float> weight =
+      changed_mesh->attributes_for_write().lookup_for_write_span<float>("weight");
+  weight.span.fill(2.0f);
+  weight.span[0] = 0.0f;
+  weight.finish();
+
+  Mesh *result = subdiv_to_mesh(subdiv, &to_mesh_settings, changed_mesh);
+  EXPECT_NE(result->corner_verts().data(), second->corner_verts().data());
+  Mesh *expected = subdiv_to_mesh_full(*changed_mesh);
+  expect_meshes_near(*result, *expected);
+
+  BKE_id_free(nullptr, expected);
+  BKE_id_free(nullptr, result);
+  BKE_id_free(nullptr, changed_mesh);
+  subdiv::free(subdiv);
+  BKE_id_free(nullptr, second);
+  BKE_id_free(nullptr, first);
+  BKE_id_free(nullptr, coarse_mesh);
+}
+
+}  // namespace blender::bke::subdiv::tests
+
+#endif /* WITH_OPENSUBDIV */
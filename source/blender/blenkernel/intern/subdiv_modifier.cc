@@ -4,16 +4,26 @@
 
 #include "BKE_subdiv_modifier.hh"
 
+#include <cmath>
+
 #include "MEM_guardedalloc.h"
 
+#include "BLI_math_matrix.hh"
+#include "BLI_math_vector.hh"
+#include "BLI_task.hh"
+
 #include "DNA_mesh_types.h"
 #include "DNA_modifier_types.h"
 #include "DNA_object_types.h"
+#include "DNA_scene_types.h"
 #include "DNA_userdef_types.h"
 
 #include "BKE_attribute.hh"
+#include "BKE_camera.h"
+#include "BKE_idprop.hh"
 #include "BKE_mesh.hh"
 #include "BKE_modifier.hh"
+#include "BKE_scene.hh"
 #include "BKE_subdiv.hh"
 
 #include "GPU_capabilities.hh"
@@ -145,3 +155,158 @@ int BKE_subsurf_modifier_eval_required_mode(bool is_final_render, bool is_edit_m
 
   return eModifierMode_Realtime | (is_edit_mode ? int(eModifierMode_Editmode) : 0);
 }
+
+/** Cycles setting of the scene used for adaptive subdivision, or its default value. */
+static float cycles_scene_float_get(const Scene &scene,
+                                    const blender::StringRef name,
+                                    const float default_value)
+{
+  const IDProperty *idprop = scene.id.system_properties;
+  const IDProperty *cycles = idprop ? IDP_GetPropertyTypeFromGroup(idprop, "cycles", IDP_GROUP) :
+                                      nullptr;
+  const IDProperty *prop = cycles ? IDP_GetPropertyTypeFromGroup(cycles, name, IDP_FLOAT) :
+                                    nullptr;
+  return prop ? IDP_float_get(prop) : default_value;
+}
+
+static float coarse_edge_length_max(const Mesh &mesh)
+{
+  using namespace blender;
+  const Span<float3> positions = mesh.vert_positions();
+  const Span<int2> edges = mesh.edges();
+  return threading::parallel_reduce(
+      edges.index_range(),
+      4096,
+      0.0f,
+      [&](const IndexRange range, float max_length) {
+        for (const int2 edge : edges.slice(range)) {
+          max_length = std::max(max_length,
+                                math::distance(positions[edge[0]], positions[edge[1]]));
+        }
+        return max_length;
+      },
+      [](const float a, const float b) { return std::max(a, b); });
+}
+
+/**
+ * Size in pixels of the largest coarse edges seen from the scene camera, separately for edges in
+ * the camera view (x) and outside of it (y). Edges crossing the near clipping plane are clipped.
+ * Edges behind the camera are measured as if they were mirrored in front of it, so that their
+ * size still decreases with the distance to the camera.
+ */
+static blender::float2 coarse_edge_pixel_size_max(const Mesh &mesh,
+                                                  const Object &object,
+                                                  const Scene &scene)
+{
+  using namespace blender;
+  const Object &camera = *scene.camera;
+  int width;
+  int height;
+  BKE_render_resolution(&scene.r, false, &width, &height);
+
+  CameraParams params;
+  BKE_camera_params_init(&params);
+  BKE_camera_params_from_object(&params, &camera);
+  BKE_camera_params_compute_viewplane(&params, width, height, scene.r.xasp, scene.r.yasp);
+  BKE_camera_params_compute_matrix(&params);
+  const float4x4 object_to_clip = float4x4(params.winmat) * camera.world_to_object() *
+                                  object.object_to_world();
+  const float2 half_resolution = float2(width, height) * 0.5f;
+  /* Depth of the near clipping plane, to avoid dividing by zero behind the camera. */
+  const float min_w = params.is_ortho ? 1.0f : params.clip_start;
+
+  const Span<float3> positions = mesh.vert_positions();
+  Array<float4> clip_positions(positions.size());
+  threading::parallel_for(positions.index_range(), 4096, [&](const IndexRange range) {
+    for (const int vert : range) {
+      clip_positions[vert] = object_to_clip * float4(positions[vert], 1.0f);
+    }
+  });
+
+  const Span<int2> edges = mesh.edges();
+  return threading::parallel_reduce(
+      edges.index_range(),
+      4096,
+      float2(0.0f),
+      [&](const IndexRange range, float2 max_size) {
+        for (const int2 edge : edges.slice(range)) {
+          float4 a = clip_positions[edge[0]];
+          float4 b = clip_positions[edge[1]];
+          /* Signed distances to the near clipping plane. */
+          const float near_a = a.z + a.w;
+          const float near_b = b.z + b.w;
+          bool in_view = false;
+          if (near_a >= 0.0f || near_b >= 0.0f) {
+            if (near_a < 0.0f) {
+              a = math::interpolate(a, b, near_a / (near_a - near_b));
+            }
+            else if (near_b < 0.0f) {
+              b = math::interpolate(b, a, near_b / (near_b - near_a));
+            }
+            in_view = true;
+          }
+          const float2 a_ndc = a.xy() / std::max(std::abs(a.w), min_w);
+          const float2 b_ndc = b.xy() / std::max(std::abs(b.w), min_w);
+          const float2 min = math::min(a_ndc, b_ndc);
+          const float2 max = math::max(a_ndc, b_ndc);
+          if (min.x > 1.0f || min.y > 1.0f || max.x < -1.0f || max.y < -1.0f) {
+            in_view = false;
+          }
+          const float size = math::length((a_ndc - b_ndc) * half_resolution);
+          if (in_view) {
+            max_size.x = std::max(max_size.x, size);
+          }
+          else {
+            max_size.y = std::max(max_size.y, size);
+          }
+        }
+        return max_size;
+      },
+      [](const float2 a, const float2 b) { return math::max(a, b); });
+}
+
+/** Number of levels needed to subdivide an edge of the given size to the target size. */
+static int levels_for_edge_size(const float size, const float target_size)
+{
+  if (size <= target_size) {
+    return 0;
+  }
+  return int(std::ceil(std::log2(size / target_size)));
+}
+
+int BKE_subsurf_modifier_adaptive_levels_get(const SubsurfModifierData *smd,
+                                             const Scene *scene,
+                                             const Object *object,
+                                             const Mesh *mesh,
+                                             const bool use_render_params,
+                                             const int max_levels)
+{
+  if (!(smd->flags & eSubsurfModifierFlag_UseAdaptiveLevels) || max_levels == 0) {
+    return max_levels;
+  }
+  /* The size is scaled like for adaptive subdivision in Cycles. */
+  const float dicing_rate = use_render_params ?
+                                cycles_scene_float_get(*scene, "dicing_rate", 1.0f) :
+                                cycles_scene_float_get(*scene, "preview_dicing_rate", 8.0f);
+  int levels;
+  if (smd->adaptive_space == SUBSURF_ADAPTIVE_SPACE_OBJECT) {
+    const float target_size = smd->adaptive_object_edge_length * dicing_rate;
+    if (target_size <= 0.0f) {
+      return max_levels;
+    }
+    levels = levels_for_edge_size(coarse_edge_length_max(*mesh), target_size);
+  }
+  else {
+    if (scene->camera == nullptr) {
+      return max_levels;
+    }
+    const float target_size = std::max(smd->adaptive_pixel_size * dicing_rate, 0.1f);
+    /* Geometry outside of the view still gets subdivided for shadows and reflections, only
+     * less, like in Cycles. */
+    const float offscreen_scale = cycles_scene_float_get(*scene, "offscreen_dicing_scale", 4.0f);
+    const blender::float2 max_size = coarse_edge_pixel_size_max(*mesh, *object, *scene);
+    levels = std::max(levels_for_edge_size(max_size.x, target_size),
+                      levels_for_edge_size(max_size.y, target_size * offscreen_scale));
+  }
+  return std::min(levels, max_levels);
+}
@@ -0,0 +1,154 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BLI_math_matrix.hh"
+
+#include "BKE_idtype.hh"
+#include "BKE_lib_id.hh"
+#include "BKE_mesh.h"
+#include "BKE_mesh.hh"
+#include "BKE_object.hh"
+#include "BKE_object_types.hh"
+#include "BKE_subdiv_modifier.hh"
+
+#include "CLG_log.h"
+
+#include "DNA_camera_types.h"
+#include "DNA_defaults.h"
+#include "DNA_mesh_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "mesh_test_utils.hh"
+
+namespace blender::bke::tests {
+
+/**
+ * A camera looking down at the origin from a distance of 10, with the default lens and render
+ * resolution. Edges of length 1 at the origin are 266.7 pixels long.
+ */
+class SubdivModifierAdaptiveLevelsTest : public testing::Test {
+ public:
+  Scene scene;
+  Camera *camera_data = nullptr;
+  Object *camera = nullptr;
+  Object *object = nullptr;
+  SubsurfModifierData smd;
+
+  static void SetUpTestSuite()
+  {
+    CLG_init();
+    BKE_idtype_init();
+  }
+
+  static void TearDownTestSuite()
+  {
+    CLG_exit();
+  }
+
+  void SetUp() override
+  {
+    scene = *DNA_struct_default_get(Scene);
+    camera_data = BKE_id_new_nomain<Camera>("Camera");
+    camera = BKE_object_add_only_object(nullptr, OB_CAMERA, "Camera");
+    camera->data = camera_data;
+    this->object_location_set(*camera, float3(0.0f, 0.0f, 10.0f));
+    scene.camera = camera;
+    object = BKE_object_add_only_object(nullptr, OB_MESH, "Object");
+
+    smd = *DNA_struct_default_get(SubsurfModifierData);
+    smd.flags |= eSubsurfModifierFlag_UseAdaptiveLevels;
+  }
+
+  void TearDown() override
+  {
+    BKE_id_free(nullptr, object);
+    BKE_id_free(nullptr, camera);
+    BKE_id_free(nullptr, camera_data);
+  }
+
+  void object_location_set(Object &ob, const float3 &location)
+  {
+    ob.runtime->object_to_world = math::from_location<float4x4>(location);
+    ob.runtime->world_to_object = math::invert(ob.runtime->object_to_world);
+  }
+
+  int levels_get(const Mesh &mesh, const bool use_render_params, const int max_levels)
+  {
+    return BKE_subsurf_modifier_adaptive_levels_get(
+        &smd, &scene, object, &mesh, use_render_params, max_levels);
+  }
+};
+
+TEST_F(SubdivModifierAdaptiveLevelsTest, Disabled)
+{
+  Mesh *mesh = create_grid_mesh(2);
+  smd.flags &= ~eSubsurfModifierFlag_UseAdaptiveLevels;
+  /* Cycles adaptive subdivision doesn't change the levels. */
+  smd.flags |= eSubsurfModifierFlag_UseAdaptiveSubdivision;
+  smd.adaptive_pixel_size = 1000.0f;
+  EXPECT_EQ(levels_get(*mesh, true, 3), 3);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(SubdivModifierAdaptiveLevelsTest, PixelSpace)
+{
+  Mesh *mesh = create_grid_mesh(2);
+  smd.adaptive_pixel_size = 100.0f;
+  EXPECT_EQ(levels_get(*mesh, true, 6), 2);
+  EXPECT_EQ(levels_get(*mesh, true, 1), 1);
+  /* The default viewport dicing rate of 8 makes the target size larger than the edges. */
+  EXPECT_EQ(levels_get(*mesh, false, 6), 0);
+  smd.adaptive_pixel_size = 10.0f;
+  EXPECT_EQ(levels_get(*mesh, true, 6), 5);
+  EXPECT_EQ(levels_get(*mesh, false, 6), 2);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(SubdivModifierAdaptiveLevelsTest, ObjectSpace)
+{
+  Mesh *mesh = create_grid_mesh(2);
+  smd.adaptive_space = SUBSURF_ADAPTIVE_SPACE_OBJECT;
+  smd.adaptive_object_edge_length = 0.3f;
+  EXPECT_EQ(levels_get(*mesh, true, 6), 2);
+  /* The camera doesn't matter in object space. */
+  this->object_location_set(*object, float3(100.0f, 0.0f, 0.0f));
+  EXPECT_EQ(levels_get(*mesh, true, 6), 2);
+  scene.camera = nullptr;
+  EXPECT_EQ(levels_get(*mesh, true, 6), 2);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(SubdivModifierAdaptiveLevelsTest, OffScreen)
+{
+  Mesh *mesh = create_grid_mesh(2);
+  smd.adaptive_pixel_size = 10.0f;
+  EXPECT_EQ(levels_get(*mesh, true, 6), 5);
+  /* Objects outside of the view are subdivided less, with the default off-screen scale of 4,
+   * but not removed entirely. */
+  this->object_location_set(*object, float3(100.0f, 0.0f, 0.0f));
+  EXPECT_EQ(levels_get(*mesh, true, 6), 3);
+  /* Behind the camera at the same distance. */
+  this->object_location_set(*object, float3(0.0f, 0.0f, 20.0f));
+  EXPECT_EQ(levels_get(*mesh, true, 6), 3);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(SubdivModifierAdaptiveLevelsTest, EdgeCrossingNearPlane)
+{
+  /* A single edge from in front of the camera to behind it, which is long on screen once it is
+   * clipped at the near plane. */
+  Mesh *mesh = BKE_mesh_new_nomain(2, 1, 0, 0);
+  mesh->vert_positions_for_write().copy_from(
+      {float3(0.5f, 0.0f, 0.0f), float3(0.5f, 0.0f, 20.0f)});
+  mesh->edges_for_write()[0] = int2(0, 1);
+  smd.adaptive_pixel_size = 100.0f;
+  EXPECT_EQ(levels_get(*mesh, true, 6), 6);
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::bke::tests
@@ -792,6 +792,23 @@ bool BKE_undosys_step_load_data_ex(UndoStack *ustack,
              us_target->type->name,
              undo_dir);
 
+  /* Check that all steps can be decoded before changing anything. */
+  for (UndoStep *us_iter = undosys_step_iter_first(us_reference, undo_dir); us_iter != nullptr;
+       us_iter = (undo_dir == -1) ? us_iter->prev : us_iter->next)
+  {
+    if (us_iter->type->step_decode_prepare && !us_iter->type->step_decode_prepare(us_iter)) {
+      CLOG_ERROR(&LOG,
+                 "could not prepare step for decoding, addr=%p, name='%s', type='%s'",
+                 us_iter,
+                 us_iter->name,
+                 us_iter->type->name);
+      return false;
+    }
+    if (us_iter == us_target_active) {
+      break;
+    }
+  }
+
   /* Undo/Redo steps until we reach given target step (or beyond if it has to be skipped),
    * from given reference step. */
   bool is_processing_extra_skipped_steps = false;
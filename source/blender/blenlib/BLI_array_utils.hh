@@ -9,6 +9,7 @@
 #pragma once
 
 #include <numeric>
+#include <type_traits>
 
 #include "BLI_generic_span.hh"
 #include "BLI_generic_virtual_array.hh"
@@ -20,6 +21,48 @@
 
 namespace blender::array_utils {
 
+namespace detail {
+
+/**
+ * Types that are copied with the vectorized kernels in `array_utils.cc` instead of generic
+ * loops. These are trivially copyable types with the sizes of common attribute types, like
+ * `float`, `float2`, `float3` and `ColorGeometry4f`.
+ */
+template<typename T>
+inline constexpr bool use_trivial_kernel_v = std::is_trivially_copyable_v<T> &&
+                                              (sizeof(T) == 4 || sizeof(T) == 8 ||
+                                               sizeof(T) == 12 || sizeof(T) == 16);
+bool use_trivial_kernel(const CPPType &type);
+
+void gather_trivial(const void *src,
+                    int64_t src_size,
+                    const IndexMask &indices,
+                    void *dst,
+                    int64_t type_size,
+                    int64_t grain_size);
+void gather_trivial(const void *src,
+                    int64_t src_size,
+                    Span<int> indices,
+                    void *dst,
+                    int64_t type_size,
+                    int64_t grain_size);
+void scatter_trivial(
+    const void *src, const IndexMask &indices, void *dst, int64_t type_size, int64_t grain_size);
+/**
+ * Supports any trivially copyable type, the groups are copied as bytes.
+ * \param dst_by_position: Whether the destination groups are indexed by the position in the
+ * selection, like in #gather_group_to_group, or by the selected index.
+ */
+void copy_group_to_group_trivial(OffsetIndices<int> src_offsets,
+                                 OffsetIndices<int> dst_offsets,
+                                 const IndexMask &selection,
+                                 const void *src,
+                                 void *dst,
+                                 int64_t type_size,
+                                 bool dst_by_position);
+
+}  // namespace detail
+
 /**
  * Fill the destination span by copying all values from the `src` array. Threaded based on
  * grain-size.
@@ -119,6 +162,10 @@ inline void scatter(const Span<T> src,
 {
   BLI_assert(indices.size() == src.size());
   BLI_assert(indices.min_array_size() <= dst.size());
+  if constexpr (detail::use_trivial_kernel_v<T>) {
+    detail::scatter_trivial(src.data(), indices, dst.data(), sizeof(T), grain_size);
+    return;
+  }
   indices.foreach_index_optimized<int64_t>(
       GrainSize(grain_size),
       [&](const int64_t index, const int64_t pos) { dst[index] = src[pos]; });
@@ -162,6 +209,10 @@ inline void gather(const Span<T> src,
                    const int64_t grain_size = 4096)
 {
   BLI_assert(indices.size() == dst.size());
+  if constexpr (detail::use_trivial_kernel_v<T>) {
+    detail::gather_trivial(src.data(), src.size(), indices, dst.data(), sizeof(T), grain_size);
+    return;
+  }
   indices.foreach_segment(GrainSize(grain_size),
                           [&](const IndexMaskSegment segment, const int64_t segment_pos) {
                             for (const int64_t i : segment.index_range()) {
@@ -180,6 +231,10 @@ inline void gather(const Span<T> src,
                    const int64_t grain_size = 4096)
 {
   BLI_assert(indices.size() == dst.size());
+  if constexpr (detail::use_trivial_kernel_v<T> && std::is_same_v<IndexT, int>) {
+    detail::gather_trivial(src.data(), src.size(), indices, dst.data(), sizeof(T), grain_size);
+    return;
+  }
   threading::parallel_for(indices.index_range(), grain_size, [&](const IndexRange range) {
     for (const int64_t i : range) {
       dst[i] = src[indices[i]];
@@ -197,6 +252,12 @@ inline void gather(const VArray<T> &src,
                    const int64_t grain_size = 4096)
 {
   BLI_assert(indices.size() == dst.size());
+  if constexpr (detail::use_trivial_kernel_v<T>) {
+    if (src.is_span()) {
+      gather(src.get_internal_span(), indices, dst, grain_size);
+      return;
+    }
+  }
   devirtualize_varray(src, [&](const auto &src) {
     threading::parallel_for(indices.index_range(), grain_size, [&](const IndexRange range) {
       for (const int64_t i : range) {
@@ -213,6 +274,11 @@ inline void gather_group_to_group(const OffsetIndices<int> src_offsets,
                                   const Span<T> src,
                                   MutableSpan<T> dst)
 {
+  if constexpr (std::is_trivially_copyable_v<T>) {
+    detail::copy_group_to_group_trivial(
+        src_offsets, dst_offsets, selection, src.data(), dst.data(), sizeof(T), true);
+    return;
+  }
   selection.foreach_index(GrainSize(512), [&](const int64_t src_i, const int64_t dst_i) {
     dst.slice(dst_offsets[dst_i]).copy_from(src.slice(src_offsets[src_i]));
   });
@@ -9,7 +9,9 @@
  */
 
 #include "BLI_function_ref.hh"
+#include "BLI_index_mask_fwd.hh"
 #include "BLI_math_vector_types.hh"
+#include "BLI_span.hh"
 #include "BLI_sys_types.h"
 
 struct BVHTree;
@@ -78,6 +80,20 @@ enum {
    * pair once, rather than twice in different order as usual. */
   BVH_OVERLAP_SELF = (1 << 2),
 };
+enum {
+  /**
+   * Split nodes using the surface area heuristic instead of at the median. This makes ray-casts
+   * and nearest point queries faster, especially for unevenly distributed geometry, but is slower
+   * to build.
+   */
+  BVH_BALANCE_SAH = (1 << 0),
+  /**
+   * Also build a 4-wide layout of the tree that is used to test multiple nodes at once when
+   * ray-casting and finding the nearest point. Only supported for 6-DOP trees with up to 4
+   * children per node, ignored otherwise.
+   */
+  BVH_BALANCE_WIDE = (1 << 1),
+};
 enum {
   /* Use a priority queue to process nodes in the optimal order (for slow callbacks) */
   BVH_NEAREST_OPTIMAL_ORDER = (1 << 0),
@@ -139,12 +155,21 @@ class BVHTreeDeleter {
  * \note many callers don't check for `NULL` return.
  */
 BVHTree *BLI_bvhtree_new(int maxsize, float epsilon, char tree_type, char axis);
+/**
+ * Create an independent copy of a balanced tree, e.g. to refit it for new positions with
+ * #BLI_bvhtree_update_node while the original tree is still in use.
+ */
+BVHTree *BLI_bvhtree_copy(const BVHTree *tree);
 
 /**
  * Construct: first insert points, then call balance.
  */
 void BLI_bvhtree_insert(BVHTree *tree, int index, const float co[3], int numpoints);
 void BLI_bvhtree_balance(BVHTree *tree);
+/**
+ * \param flag: #BVH_BALANCE_SAH, #BVH_BALANCE_WIDE.
+ */
+void BLI_bvhtree_balance_ex(BVHTree *tree, int flag);
 
 /**
  * Update: first update points/nodes, then call update_tree to refit the bounding volumes.
@@ -351,4 +376,30 @@ inline void BLI_bvhtree_range_query_cpp(const BVHTree &tree,
       &fn);
 }
 
+/**
+ * Same as calling #BLI_bvhtree_ray_cast_ex for every index in \a mask, in parallel.
+ * \a hits must be initialized the same way.
+ */
+void BLI_bvhtree_ray_cast_batch(const BVHTree &tree,
+                                const IndexMask &mask,
+                                Span<float3> origins,
+                                Span<float3> directions,
+                                float radius,
+                                MutableSpan<BVHTreeRayHit> hits,
+                                BVHTree_RayCastCallback callback,
+                                void *userdata,
+                                int flag = BVH_RAYCAST_DEFAULT);
+
+/**
+ * Same as calling #BLI_bvhtree_find_nearest_ex for every index in \a mask, in parallel.
+ * \a nearest must be initialized the same way.
+ */
+void BLI_bvhtree_find_nearest_batch(const BVHTree &tree,
+                                    const IndexMask &mask,
+                                    Span<float3> positions,
+                                    MutableSpan<BVHTreeNearest> nearest,
+                                    BVHTree_NearestPointCallback callback,
+                                    void *userdata,
+                                    int flag = 0);
+
 }  // namespace blender
@@ -0,0 +1,354 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ * \brief A KD-tree for nearest neighbor search, for any number of dimensions.
+ *
+ * Unlike the C API in `BLI_kdtree.h`, the tree is built from all points at once and is immutable
+ * afterwards. The tree uses an implicit layout: the points are stored sorted so that the node of
+ * any range of points is its middle element, with the points on either side of the split plane
+ * before and after it. No child indices have to be stored, and nodes close in the tree are close
+ * in memory.
+ *
+ * Building the tree is multi-threaded, and the batch queries handle many query points in parallel.
+ * Batch queries also use the result of the previous query point as initial search bound, which
+ * skips most of the traversal when subsequent query points are close to each other, as is common
+ * for positions of geometry.
+ */
+
+#include <algorithm>
+#include <array>
+#include <limits>
+
+#include "BLI_array.hh"
+#include "BLI_index_mask.hh"
+#include "BLI_math_vector.hh"
+#include "BLI_task.hh"
+
+namespace blender::kdtree {
+
+template<int D> class KDTree {
+ public:
+  using VecT = VecBase<float, D>;
+
+ private:
+  struct Node {
+    VecT co;
+    int index;
+  };
+
+  struct StackItem {
+    int begin;
+    int end;
+    /** Squared distance of the query point to the split plane that separates this range. */
+    float plane_dist_sq;
+  };
+
+  /**
+   * The depth of the tree is at most `log2(size) + 1`, and traversal adds at most one item to the
+   * stack per level.
+   */
+  static constexpr int stack_size = 64;
+  using Stack = std::array<StackItem, stack_size>;
+
+  /** Ranges smaller than this are built on a single thread. */
+  static constexpr int parallel_build_threshold = 4096;
+
+  /** Points in tree order. */
+  Array<Node> nodes_;
+  /** Axis of the split plane of each node, only meaningful for nodes that have children. */
+  Array<uint8_t> axes_;
+
+ public:
+  KDTree() = default;
+
+  /**
+   * Build a tree of all positions. Indices returned by queries are indices into #positions.
+   */
+  explicit KDTree(const Span<VecT> positions) : KDTree(positions, positions.index_range()) {}
+
+  /**
+   * Build a tree of the positions in the mask. Indices returned by queries are indices into
+   * #positions, not into the mask.
+   */
+  KDTree(const Span<VecT> positions, const IndexMask &mask)
+      : nodes_(mask.size(), NoInitialization()), axes_(mask.size(), NoInitialization())
+  {
+    mask.foreach_index_optimized<int>(GrainSize(4096), [&](const int i, const int pos) {
+      new (&nodes_[pos]) Node{positions[i], i};
+    });
+    this->build(0, int(nodes_.size()));
+  }
+
+  int size() const
+  {
+    return int(nodes_.size());
+  }
+
+  bool is_empty() const
+  {
+    return nodes_.is_empty();
+  }
+
+  /**
+   * \return The index of the nearest point, or -1 when the tree is empty.
+   */
+  int find_nearest(const VecT &co, float *r_dist_sq = nullptr) const
+  {
+    return this->find_nearest(co, [](const int /*index*/) { return true; }, r_dist_sq);
+  }
+
+  /**
+   * Find the nearest point for which `filter(index)` returns true.
+   *
+   * \return The index of the nearest point, or -1 when no point passes the filter.
+   */
+  template<typename FilterFn>
+  int find_nearest(const VecT &co, const FilterFn &filter, float *r_dist_sq = nullptr) const
+  {
+    int nearest_node = -1;
+    float nearest_dist_sq = std::numeric_limits<float>::max();
+    this->find_nearest_impl(co, filter, nearest_node, nearest_dist_sq);
+    if (r_dist_sq) {
+      *r_dist_sq = nearest_dist_sq;
+    }
+    return nearest_node == -1 ? -1 : nodes_[nearest_node].index;
+  }
+
+  /**
+   * Call `fn(index, co, dist_sq)` for every point within #radius of #co, in no particular order.
+   */
+  template<typename Fn> void range_search(const VecT &co, const float radius, const Fn &fn) const
+  {
+    if (nodes_.is_empty()) {
+      return;
+    }
+    const float radius_sq = radius * radius;
+    Stack stack;
+    int stack_len = 0;
+    stack[stack_len++] = {0, int(nodes_.size()), 0.0f};
+    while (stack_len > 0) {
+      const StackItem item = stack[--stack_len];
+      const int mid = (item.begin + item.end) / 2;
+      const Node &node = nodes_[mid];
+      const float dist_sq = math::distance_squared(node.co, co);
+      if (dist_sq <= radius_sq) {
+        fn(node.index, node.co, dist_sq);
+      }
+      if (item.end - item.begin == 1) {
+        continue;
+      }
+      const int axis = axes_[mid];
+      const float plane_dist = co[axis] - node.co[axis];
+      if (plane_dist <= radius) {
+        if (item.begin < mid) {
+          stack[stack_len++] = {item.begin, mid, 0.0f};
+        }
+      }
+      if (plane_dist >= -radius) {
+        if (mid + 1 < item.end) {
+          stack[stack_len++] = {mid + 1, item.end, 0.0f};
+        }
+      }
+    }
+  }
+
+  /**
+   * Find the nearest point for every query position, in parallel.
+   *
+   * \param r_indices: The nearest point for every query, or -1 when the tree is empty.
+   * \param r_dists_sq: Optional squared distance to the nearest point for every query.
+   */
+  void find_nearest_batch(const Span<VecT> queries,
+                          MutableSpan<int> r_indices,
+                          MutableSpan<float> r_dists_sq = {}) const
+  {
+    BLI_assert(r_indices.size() == queries.size());
+    this->find_nearest_batch(
+        queries,
+        queries.index_range(),
+        [](const int /*query*/, const int /*index*/) { return true; },
+        r_indices,
+        r_dists_sq);
+  }
+
+  /**
+   * Find the nearest point for the query positions in the mask, in parallel. Only points for
+   * which `filter(query_index, index)` returns true are considered, e.g. to skip the query point
+   * itself.
+   *
+   * \param r_indices: Results for the indices in the mask, -1 when no point passes the filter.
+   */
+  template<typename FilterFn>
+  void find_nearest_batch(const Span<VecT> queries,
+                          const IndexMask &mask,
+                          const FilterFn &filter,
+                          MutableSpan<int> r_indices,
+                          MutableSpan<float> r_dists_sq = {}) const
+  {
+    /* Split the mask into contiguous chunks, so that the previous query of each query is usually
+     * close to it, and its result is a good initial bound for the search. */
+    mask.foreach_segment(GrainSize(512), [&](const IndexMaskSegment segment) {
+      /* Position of the previous result in #nodes_. */
+      int prev_node = -1;
+      for (const int64_t i : segment) {
+        const VecT &co = queries[i];
+        const auto query_filter = [&](const int index) { return filter(int(i), index); };
+
+        int nearest_node = -1;
+        float nearest_dist_sq = std::numeric_limits<float>::max();
+        if (prev_node != -1 && query_filter(nodes_[prev_node].index)) {
+          nearest_node = prev_node;
+          nearest_dist_sq = math::distance_squared(nodes_[prev_node].co, co);
+        }
+        this->find_nearest_impl(co, query_filter, nearest_node, nearest_dist_sq);
+        const int nearest = nearest_node == -1 ? -1 : nodes_[nearest_node].index;
+        r_indices[i] = nearest;
+        if (!r_dists_sq.is_empty()) {
+          r_dists_sq[i] = nearest_dist_sq;
+        }
+        prev_node = nearest_node;
+      }
+    });
+  }
+
+  /**
+   * Find points within #distance of each other, see #BLI_kdtree_3d_calc_duplicates_fast.
+   * Points are visited in index order, so the result does not depend on the layout of the tree.
+   * Every point within #distance of a visited point that hasn't been merged yet is merged into it,
+   * and points that other points were merged into reference themselves.
+   *
+   * \param r_duplicates: Filled with -1 by the caller, indexed by the indices of the points.
+   * \return The number of points that were merged into other points.
+   */
+  int calc_duplicates(const float distance, MutableSpan<int> r_duplicates) const
+  {
+    /* Position of every point in #nodes_, or -1 for indices that are not in the tree. */
+    Array<int> node_by_index(r_duplicates.size(), -1);
+    for (const int i : nodes_.index_range()) {
+      node_by_index[nodes_[i].index] = i;
+    }
+
+    int found = 0;
+    for (const int index : node_by_index.index_range()) {
+      const int node_i = node_by_index[index];
+      if (node_i == -1 || !ELEM(r_duplicates[index], -1, index)) {
+        continue;
+      }
+      const int found_prev = found;
+      this->range_search(
+          nodes_[node_i].co, distance, [&](const int other, const VecT & /*co*/, float) {
+            if (other != index && r_duplicates[other] == -1) {
+              r_duplicates[other] = index;
+              found++;
+            }
+          });
+      if (found != found_prev) {
+        /* Prevent chains of doubles. */
+        r_duplicates[index] = index;
+      }
+    }
+    return found;
+  }
+
+ private:
+  void build(const int begin, const int end)
+  {
+    const int size = end - begin;
+    if (size <= 1) {
+      if (size == 1) {
+        axes_[begin] = 0;
+      }
+      return;
+    }
+
+    /* Split along the axis with the largest extent. */
+    VecT min = nodes_[begin].co;
+    VecT max = min;
+    for (const int i : IndexRange(begin + 1, size - 1)) {
+      math::min_max(nodes_[i].co, min, max);
+    }
+    const VecT extent = max - min;
+    int axis = 0;
+    for (const int i : IndexRange(1, D - 1)) {
+      if (extent[i] > extent[axis]) {
+        axis = i;
+      }
+    }
+
+    const int mid = (begin + end) / 2;
+    std::nth_element(nodes_.begin() + begin,
+                     nodes_.begin() + mid,
+                     nodes_.begin() + end,
+                     [&](const Node &a, const Node &b) { return a.co[axis] < b.co[axis]; });
+    axes_[mid] = uint8_t(axis);
+
+    if (size >= parallel_build_threshold) {
+      threading::parallel_invoke([&]() { this->build(begin, mid); },
+                                 [&]() { this->build(mid + 1, end); });
+    }
+    else {
+      this->build(begin, mid);
+      this->build(mid + 1, end);
+    }
+  }
+
+  /**
+   * \param r_nearest_node: Position of the nearest point in #nodes_. Only points closer than
+   * #r_nearest_dist_sq are considered, so the initial values can be an already known candidate.
+   */
+  template<typename FilterFn>
+  void find_nearest_impl(const VecT &co,
+                         const FilterFn &filter,
+                         int &r_nearest_node,
+                         float &r_nearest_dist_sq) const
+  {
+    if (nodes_.is_empty()) {
+      return;
+    }
+    Stack stack;
+    int stack_len = 0;
+    stack[stack_len++] = {0, int(nodes_.size()), 0.0f};
+    while (stack_len > 0) {
+      const StackItem item = stack[--stack_len];
+      if (item.plane_dist_sq >= r_nearest_dist_sq) {
+        continue;
+      }
+      const int mid = (item.begin + item.end) / 2;
+      const Node &node = nodes_[mid];
+      const float dist_sq = math::distance_squared(node.co, co);
+      if (dist_sq < r_nearest_dist_sq && filter(node.index)) {
+        r_nearest_node = mid;
+        r_nearest_dist_sq = dist_sq;
+      }
+      if (item.end - item.begin == 1) {
+        continue;
+      }
+      const int axis = axes_[mid];
+      const float plane_dist = co[axis] - node.co[axis];
+      const float plane_dist_sq = plane_dist * plane_dist;
+      const StackItem left = {item.begin, mid, plane_dist < 0.0f ? 0.0f : plane_dist_sq};
+      const StackItem right = {mid + 1, item.end, plane_dist < 0.0f ? plane_dist_sq : 0.0f};
+      /* Push the far side first, so that the side containing the query point is visited first. */
+      const StackItem &near = plane_dist < 0.0f ? left : right;
+      const StackItem &far = plane_dist < 0.0f ? right : left;
+      if (far.begin < far.end && far.plane_dist_sq < r_nearest_dist_sq) {
+        stack[stack_len++] = far;
+      }
+      if (near.begin < near.end) {
+        stack[stack_len++] = near;
+      }
+    }
+  }
+};
+
+using KDTree1 = KDTree<1>;
+using KDTree2 = KDTree<2>;
+using KDTree3 = KDTree<3>;
+using KDTree4 = KDTree<4>;
+
+}  // namespace blender::kdtree
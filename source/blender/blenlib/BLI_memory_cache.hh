@@ -8,9 +8,13 @@
 
 #pragma once
 
+#include <concepts>
+#include <iosfwd>
+
 #include "BLI_function_ref.hh"
 #include "BLI_generic_key.hh"
 #include "BLI_memory_counter_fwd.hh"
+#include "BLI_string_ref.hh"
 
 namespace blender::memory_cache {
 
@@ -27,6 +31,31 @@ class CachedValue {
    * full.
    */
   virtual void count_memory(MemoryCounter &memory) const = 0;
+
+  /**
+   * Write the value to a stream, so that it can be moved to the disk cache instead of just being
+   * freed when the memory cache is full. It is read back by the deserialize function passed to
+   * #get_base, which is the static `T::deserialize(std::istream &)` method when using #get.
+   *
+   * \return False when the value can't be serialized, it is freed then.
+   */
+  virtual bool serialize(std::ostream & /*stream*/) const
+  {
+    return false;
+  }
+};
+
+/**
+ * Reads a value written by #CachedValue::serialize, returns null when that fails.
+ */
+using DeserializeFn = FunctionRef<std::unique_ptr<CachedValue>(std::istream &stream)>;
+
+/**
+ * Cached value types that can be read back from the disk cache.
+ */
+template<typename T>
+concept DeserializableCachedValue = requires(std::istream &stream) {
+  { T::deserialize(stream) } -> std::convertible_to<std::unique_ptr<CachedValue>>;
 };
 
 /**
@@ -40,9 +69,13 @@ std::shared_ptr<const T> get(const GenericKey &key, FunctionRef<std::unique_ptr<
 
 /**
  * A non-templated version of the main entry point above.
+ *
+ * \param deserialize_fn: Used to read the value from the disk cache if it has been moved there,
+ * before falling back to #compute_fn. May be null when the value type is not serializable.
  */
 std::shared_ptr<CachedValue> get_base(const GenericKey &key,
-                                      FunctionRef<std::unique_ptr<CachedValue>()> compute_fn);
+                                      FunctionRef<std::unique_ptr<CachedValue>()> compute_fn,
+                                      DeserializeFn deserialize_fn = nullptr);
 
 /**
  * Set how much memory the cache is allowed to use. This is only an approximation because counting
@@ -51,16 +84,32 @@ std::shared_ptr<CachedValue> get_base(const GenericKey &key,
 void set_approximate_size_limit(int64_t limit_in_bytes);
 
 /**
- * Remove all elements from the cache. Note that this does not guarantee that no elements are in
- * the cache after the function returned. This is because another thread may have added a new
- * element right after the clearing.
+ * Set the directory for the disk cache. Serializable values that don't fit into the memory cache
+ * anymore are written to files in this directory in the background, and are read from there when
+ * they are needed again, which is usually much faster than computing them again. An empty path
+ * disables the disk cache. Files in the previous directory are removed, after waiting for files
+ * that are still being written.
+ */
+void set_disk_cache_directory(StringRefNull dir_path);
+
+/**
+ * Set how much disk space the disk cache is allowed to use. Files that were used least recently
+ * are removed first. Zero disables the disk cache.
+ */
+void set_approximate_disk_size_limit(int64_t limit_in_bytes);
+
+/**
+ * Remove all elements from the cache, including the disk cache. Note that this does not guarantee
+ * that no elements are in the cache after the function returned. This is because another thread
+ * may have added a new element right after the clearing.
  */
 void clear();
 
 /**
- * Remove elements from the cache for which the predicate returns true. Note that this does not
- * guarantee that there are no elements for which the predicate is true after the function
- * returned. This is because another thread may have added a new element right after the removal.
+ * Remove elements from the memory and disk cache for which the predicate returns true. Note that
+ * this does not guarantee that there are no elements for which the predicate is true after the
+ * function returned. This is because another thread may have added a new element right after the
+ * removal.
  */
 void remove_if(FunctionRef<bool(const GenericKey &)> predicate);
 
@@ -72,7 +121,15 @@ template<typename T>
 inline std::shared_ptr<const T> get(const GenericKey &key,
                                     FunctionRef<std::unique_ptr<T>()> compute_fn)
 {
-  return std::dynamic_pointer_cast<const T>(get_base(key, compute_fn));
+  if constexpr (DeserializableCachedValue<T>) {
+    return std::dynamic_pointer_cast<const T>(
+        get_base(key, compute_fn, [](std::istream &stream) -> std::unique_ptr<CachedValue> {
+          return T::deserialize(stream);
+        }));
+  }
+  else {
+    return std::dynamic_pointer_cast<const T>(get_base(key, compute_fn));
+  }
 }
 
 /** \} */
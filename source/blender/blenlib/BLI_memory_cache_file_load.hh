@@ -21,14 +21,23 @@ std::shared_ptr<const T> get_loaded(const GenericKey &loader_key,
 
 std::shared_ptr<CachedValue> get_loaded_base(const GenericKey &loader_key,
                                              Span<StringRefNull> file_paths,
-                                             FunctionRef<std::unique_ptr<CachedValue>()> load_fn);
+                                             FunctionRef<std::unique_ptr<CachedValue>()> load_fn,
+                                             DeserializeFn deserialize_fn = nullptr);
 
 template<typename T>
 inline std::shared_ptr<const T> get_loaded(const GenericKey &loader_key,
                                            Span<StringRefNull> file_paths,
                                            FunctionRef<std::unique_ptr<T>()> load_fn)
 {
-  return std::dynamic_pointer_cast<const T>(get_loaded_base(loader_key, file_paths, load_fn));
+  if constexpr (DeserializableCachedValue<T>) {
+    return std::dynamic_pointer_cast<const T>(get_loaded_base(
+        loader_key, file_paths, load_fn, [](std::istream &stream) -> std::unique_ptr<CachedValue> {
+          return T::deserialize(stream);
+        }));
+  }
+  else {
+    return std::dynamic_pointer_cast<const T>(get_loaded_base(loader_key, file_paths, load_fn));
+  }
 }
 
 }  // namespace blender::memory_cache
@@ -21,6 +21,11 @@ typedef struct BLI_mmap_file BLI_mmap_file;
  * May return NULL if the operation fails.
  * Note that this seeks to the end of the file to determine its length. */
 BLI_mmap_file *BLI_mmap_open(int fd) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+/* Same as #BLI_mmap_open, but the mapped memory may also be written to. Modified pages are
+ * private copies of the original ones (copy-on-write), changes never reach the file itself.
+ * Pages that were not written to still reflect changes made to the file on disk afterwards, which
+ * can be detected with #BLI_mmap_file_changed. Not supported on Windows, returns NULL there. */
+BLI_mmap_file *BLI_mmap_open_copy_on_write(int fd) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
 
 /* Reads length bytes from file at the given offset into dest.
  * Returns whether the operation was successful (may fail when reading beyond the file
@@ -31,5 +36,10 @@ bool BLI_mmap_read(BLI_mmap_file *file, void *dest, size_t offset, size_t length
 void *BLI_mmap_get_pointer(BLI_mmap_file *file) ATTR_WARN_UNUSED_RESULT;
 size_t BLI_mmap_get_length(const BLI_mmap_file *file) ATTR_WARN_UNUSED_RESULT;
 bool BLI_mmap_any_io_error(const BLI_mmap_file *file) ATTR_WARN_UNUSED_RESULT;
+/* Whether the file of a copy-on-write mapping was modified or truncated on disk since it was
+ * mapped, or an IO error occurred while accessing it. The mapped memory may not contain the
+ * original file content anymore then. Replacing the file path (e.g. when saving over it) does
+ * not count as a change, the mapping keeps the original file alive. */
+bool BLI_mmap_file_changed(const BLI_mmap_file *file) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL(1);
 
 void BLI_mmap_free(BLI_mmap_file *file) ATTR_NONNULL(1);
@@ -10,6 +10,7 @@
 
 #include "BLI_math_matrix_types.hh"
 #include "BLI_math_vector_types.hh"
+#include "BLI_span.hh"
 
 namespace blender::noise {
 
@@ -137,6 +138,34 @@ float3 perlin_float3_fractal_distorted(float4 position,
                                        int type,
                                        bool normalize);
 
+/* Batched versions of the 3D noise functions above, with the same parameters for all positions.
+ * They give the same results as evaluating every position separately, but evaluate the noise of
+ * multiple positions at once using SIMD instructions where available. */
+
+void perlin_signed_batch(Span<float3> positions, MutableSpan<float> r_values);
+
+void perlin_fractal_distorted_batch(Span<float3> positions,
+                                    float detail,
+                                    float roughness,
+                                    float lacunarity,
+                                    float offset,
+                                    float gain,
+                                    float distortion,
+                                    int type,
+                                    bool normalize,
+                                    MutableSpan<float> r_values);
+
+void perlin_float3_fractal_distorted_batch(Span<float3> positions,
+                                           float detail,
+                                           float roughness,
+                                           float lacunarity,
+                                           float offset,
+                                           float gain,
+                                           float distortion,
+                                           int type,
+                                           bool normalize,
+                                           MutableSpan<float3> r_values);
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -223,6 +252,16 @@ VoronoiOutput fractal_voronoi_x_fx(const VoronoiParams &params,
 template<typename T>
 float fractal_voronoi_distance_to_edge(const VoronoiParams &params, const T coord);
 
+/**
+ * Batched #fractal_voronoi_x_fx for 3D coordinates, with the same parameters for all of them.
+ * The F1 feature is evaluated for multiple coordinates at once using SIMD instructions where
+ * available, other features are evaluated one by one.
+ */
+void fractal_voronoi_x_fx_batch(const VoronoiParams &params,
+                                Span<float3> coords,
+                                bool calc_color,
+                                MutableSpan<VoronoiOutput> r_outputs);
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
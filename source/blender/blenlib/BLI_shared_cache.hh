@@ -107,6 +107,15 @@ template<typename T> class SharedCache {
   {
     return cache_->mutex.is_cached();
   }
+
+  /**
+   * Return true if the cache is shared with other objects, in which case #tag_dirty() doesn't
+   * keep the previous data.
+   */
+  bool is_shared() const
+  {
+    return cache_.use_count() > 1;
+  }
 };
 
 }  // namespace blender
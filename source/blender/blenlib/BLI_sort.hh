@@ -14,6 +14,9 @@
 #  include <algorithm>
 #endif
 
+#include "BLI_offset_indices.hh"
+#include "BLI_span.hh"
+
 namespace blender {
 
 #ifdef WITH_TBB
@@ -31,4 +34,24 @@ void parallel_sort(RandomAccessIterator begin, RandomAccessIterator end, const C
 }
 #endif
 
+/**
+ * Group values by their bucket with a stable, parallel counting sort. The values in each bucket
+ * keep their original order. This is used to build reverse index maps, like the faces using each
+ * vertex.
+ *
+ * \param bucket_indices: The bucket of every value.
+ * \param bucket_offsets: The range of every bucket in \a r_values, typically built with
+ * #offset_indices::build_reverse_offsets.
+ */
+void parallel_counting_sort(Span<int> bucket_indices,
+                            OffsetIndices<int> bucket_offsets,
+                            Span<int> values,
+                            MutableSpan<int> r_values);
+/**
+ * Same as above, with the indices in \a bucket_indices as values.
+ */
+void parallel_counting_sort(Span<int> bucket_indices,
+                            OffsetIndices<int> bucket_offsets,
+                            MutableSpan<int> r_indices);
+
 }  // namespace blender
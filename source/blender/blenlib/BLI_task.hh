@@ -32,6 +32,9 @@
 #  endif
 #endif
 
+#include <atomic>
+#include <memory>
+
 #include "BLI_function_ref.hh"
 #include "BLI_index_range.hh"
 #include "BLI_lazy_threading.hh"
@@ -277,4 +280,66 @@ inline void memory_bandwidth_bound_task(const int64_t approximate_bytes_touched,
   detail::memory_bandwidth_bound_task_impl(function);
 }
 
+/**
+ * Classes of work that compete for the threads of the task scheduler. Work of each class runs in
+ * its own task arena. Idle threads prefer arenas of higher priority, and the number of threads in
+ * an arena can be limited, so that background work never starves work the user is waiting for.
+ */
+enum class TaskPriorityClass : int8_t {
+  /** Work the user is waiting for directly, like jobs that block other jobs. */
+  Interactive = 0,
+  /**
+   * Dependency graph evaluation. Other work that runs without a priority class shares its threads,
+   * unless the class is limited.
+   */
+  Evaluation = 1,
+  /** Work nobody is waiting for, like sequencer prefetching and preview rendering. */
+  Background = 2,
+};
+
+/**
+ * Run the function on the calling thread, in the task arena of the priority class. Parallel
+ * algorithms and task pools used by the function stay in that arena, so they use at most the
+ * number of threads of the class.
+ */
+void run_with_priority(TaskPriorityClass priority, FunctionRef<void()> function);
+
+/**
+ * Limit the number of threads that work of a priority class can use at the same time, zero
+ * removes the limit. By default, background work is limited to half of the threads.
+ */
+void priority_class_max_threads_set(TaskPriorityClass priority, int max_threads);
+int priority_class_max_threads_get(TaskPriorityClass priority);
+
+/**
+ * Cooperative cancellation of work that runs in other threads. Copies of a token share their
+ * state, so the token can be passed to the tasks doing the work, which check #is_canceled
+ * regularly and stop early.
+ */
+class CancellationToken {
+ private:
+  std::shared_ptr<std::atomic<bool>> canceled_ = std::make_shared<std::atomic<bool>>(false);
+
+ public:
+  void cancel() const
+  {
+    canceled_->store(true, std::memory_order_relaxed);
+  }
+
+  bool is_canceled() const
+  {
+    return canceled_->load(std::memory_order_relaxed);
+  }
+};
+
+#ifdef WITH_TBB
+namespace detail {
+/**
+ * Get the task arena of the priority class, or null when the class uses the default arena. The
+ * arena is shared, so that work still running in it can finish when the class gets a new arena.
+ */
+std::shared_ptr<tbb::task_arena> priority_class_arena_get(TaskPriorityClass priority);
+}  // namespace detail
+#endif
+
 }  // namespace blender::threading
@@ -0,0 +1,98 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bli
+ * \brief Recording of what all threads are doing over time.
+ *
+ * Events are recorded into a buffer per thread, whose lock is only contended while recording
+ * starts or stops, and written to a file in the Chrome trace event format when recording stops. The file can be opened with
+ * `chrome://tracing` or https://ui.perfetto.dev. Recording is enabled with the
+ * `--profile-trace` command line argument.
+ *
+ * When recording is disabled, an event costs a single relaxed atomic load.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+#include "BLI_string_ref.hh"
+#include "BLI_utility_mixins.hh"
+
+namespace blender::trace {
+
+namespace detail {
+extern std::atomic<bool> is_recording;
+
+using Clock = std::chrono::steady_clock;
+
+void record_event(const char *name, std::string detail, Clock::time_point start);
+}  // namespace detail
+
+/**
+ * Whether events are recorded currently.
+ */
+inline bool is_enabled()
+{
+  return detail::is_recording.load(std::memory_order_relaxed);
+}
+
+/**
+ * Start recording events, which are written to the given file by #stop.
+ */
+void start(StringRefNull filepath);
+
+/**
+ * Stop recording and write all recorded events to the file. Events of other threads that are
+ * still running are only written if they finished already.
+ */
+void stop();
+
+/**
+ * Records the time from its construction to its destruction as an event of the current thread.
+ * Events may be nested.
+ */
+class ScopedEvent : NonCopyable, NonMovable {
+ private:
+  const char *name_ = nullptr;
+  std::string detail_;
+  detail::Clock::time_point start_;
+
+ public:
+  /**
+   * \param name: Type of the event, e.g. the system that records it. Must be a static string.
+   */
+  explicit ScopedEvent(const char *name)
+  {
+    if (is_enabled()) {
+      name_ = name;
+      start_ = detail::Clock::now();
+    }
+  }
+
+  /**
+   * \param detail_fn: Returns a string that describes this specific event, e.g. the name of the
+   * data it processes. Only called while recording.
+   */
+  template<typename DetailFn> ScopedEvent(const char *name, const DetailFn &detail_fn)
+  {
+    if (is_enabled()) {
+      name_ = name;
+      detail_ = detail_fn();
+      start_ = detail::Clock::now();
+    }
+  }
+
+  ~ScopedEvent()
+  {
+    if (name_) {
+      detail::record_event(name_, std::move(detail_), start_);
+    }
+  }
+};
+
+}  // namespace blender::trace
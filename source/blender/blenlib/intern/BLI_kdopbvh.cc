@@ -21,9 +21,14 @@
  *   #BLI_bvhtree_overlap, #BVHOverlapData_Shared, #BVHOverlapData_Thread
  * - Range Query:
  *   #BLI_bvhtree_range_query
+ *
+ * Trees can optionally be built with the surface area heuristic (#BVH_BALANCE_SAH), and 6-DOP
+ * trees can store an additional 4-wide node layout (#BVH_BALANCE_WIDE, #BVHWideNode) that is used
+ * to test multiple children at once when ray-casting and finding the nearest point.
  */
 
 #include <algorithm>
+#include <atomic>
 
 #include "MEM_guardedalloc.h"
 
@@ -31,10 +36,14 @@
 #include "BLI_heap_simple.h"
 #include "BLI_kdopbvh.hh"
 #include "BLI_math_geom.h"
+#include "BLI_index_mask.hh"
 #include "BLI_math_vector_types.hh"
+#include "BLI_simd.hh"
 #include "BLI_stack.h"
 #include "BLI_task.h"
+#include "BLI_task.hh"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BLI_strict_flags.h" /* IWYU pragma: keep. Keep last. */
 
@@ -74,6 +83,24 @@ struct BVHNode {
   char main_axis; /* Axis used to split this node */
 };
 
+#define BVH_WIDE_WIDTH 4
+
+/**
+ * Node of the optional wide tree, see #BVH_BALANCE_WIDE. It collapses up to #BVH_WIDE_WIDTH
+ * descendants of a branch into a single node, with their bounds stored per axis so that all of
+ * them can be tested against a ray or point at once. Only used for 6-DOP trees, where the bounds
+ * are axis aligned boxes.
+ */
+struct BVHWideNode {
+  /** Bounds of the children, ordered like #BVHNode.bv (min x, max x, min y, ...). */
+  float bounds[6][BVH_WIDE_WIDTH];
+  /** The regular nodes the children correspond to, used to update the bounds. */
+  const BVHNode *nodes[BVH_WIDE_WIDTH];
+  /** Index of the child wide node, or -1 for leafs. */
+  int children[BVH_WIDE_WIDTH];
+  int children_num;
+};
+
 /* keep under 26 bytes for speed purposes */
 struct BVHTree {
   BVHNode **nodes;
@@ -86,11 +113,13 @@ struct BVHTree {
   axis_t start_axis, stop_axis; /* bvhtree_kdop_axes array indices according to axis */
   axis_t axis;                  /* KDOP type (6 => OBB, 7 => AABB, ...) */
   char tree_type;               /* type of tree (4 => quad-tree). */
+  BVHWideNode *wide_nodes;      /* Optional wide tree, root first, see #BVH_BALANCE_WIDE. */
+  int wide_node_num;
 };
 
 /* optimization, ensure we stay small */
-BLI_STATIC_ASSERT((sizeof(void *) == 8 && sizeof(BVHTree) <= 48) ||
-                      (sizeof(void *) == 4 && sizeof(BVHTree) <= 32),
+BLI_STATIC_ASSERT((sizeof(void *) == 8 && sizeof(BVHTree) <= 64) ||
+                      (sizeof(void *) == 4 && sizeof(BVHTree) <= 40),
                   "over sized")
 
 /* avoid duplicating vars in BVHOverlapData_Thread */
@@ -843,6 +872,406 @@ static void non_recursive_bvh_div_nodes(const BVHTree *tree,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name SAH Tree Build
+ *
+ * Alternative to the implicit tree build (see #BVH_BALANCE_SAH). Nodes are split where the sum
+ * of the surface areas of the children, weighted by their number of leafs, is smallest. Unlike
+ * median splits this adapts to unevenly distributed geometry, which makes ray-casts and nearest
+ * point queries faster, at the cost of a slower build. Candidate splits are found by sorting the
+ * leaf centroids into a fixed number of bins along each axis.
+ *
+ * Like the implicit tree build this only supports the x, y and z axes,
+ * see #get_largest_axis.
+ * \{ */
+
+#define BVH_SAH_BINS 16
+
+struct BVHSahBuildData {
+  BVHTree *tree;
+  /** Next unused branch in #BVHTree.nodearray, relative to the first branch. */
+  std::atomic<int> branch_next;
+};
+
+static void aabb_init(float bv[6])
+{
+  for (int axis = 0; axis < 3; axis++) {
+    bv[axis * 2] = FLT_MAX;
+    bv[axis * 2 + 1] = -FLT_MAX;
+  }
+}
+
+static void aabb_join(float bv[6], const float other[6])
+{
+  for (int axis = 0; axis < 3; axis++) {
+    bv[axis * 2] = std::min(bv[axis * 2], other[axis * 2]);
+    bv[axis * 2 + 1] = std::max(bv[axis * 2 + 1], other[axis * 2 + 1]);
+  }
+}
+
+/** Half the surface area of the box, the factor doesn't matter when comparing costs. */
+static float aabb_area(const float bv[6])
+{
+  const float x = std::max(bv[1] - bv[0], 0.0f);
+  const float y = std::max(bv[3] - bv[2], 0.0f);
+  const float z = std::max(bv[5] - bv[4], 0.0f);
+  return x * y + y * z + z * x;
+}
+
+static float bvh_node_centroid(const BVHNode *node, const int axis)
+{
+  return (node->bv[axis * 2] + node->bv[axis * 2 + 1]) * 0.5f;
+}
+
+static float bvh_sah_range_area(const BVHTree *tree, const int begin, const int end)
+{
+  float bv[6];
+  aabb_init(bv);
+  for (int i = begin; i < end; i++) {
+    aabb_join(bv, tree->nodes[i]->bv);
+  }
+  return aabb_area(bv);
+}
+
+/**
+ * Partition the leafs in the range at the split with the lowest cost.
+ * \return The index of the first leaf of the second partition.
+ */
+static int bvh_sah_split(const BVHTree *tree, const int begin, const int end, int *r_axis)
+{
+  BVHNode **leafs = tree->nodes;
+
+  float centroid_min[3] = {FLT_MAX, FLT_MAX, FLT_MAX};
+  float centroid_max[3] = {-FLT_MAX, -FLT_MAX, -FLT_MAX};
+  for (int i = begin; i < end; i++) {
+    for (int axis = 0; axis < 3; axis++) {
+      const float centroid = bvh_node_centroid(leafs[i], axis);
+      centroid_min[axis] = std::min(centroid_min[axis], centroid);
+      centroid_max[axis] = std::max(centroid_max[axis], centroid);
+    }
+  }
+
+  float best_cost = FLT_MAX;
+  int best_axis = -1;
+  int best_bin = 0;
+  for (int axis = 0; axis < 3; axis++) {
+    const float extent = centroid_max[axis] - centroid_min[axis];
+    if (!(extent > 0.0f)) {
+      continue;
+    }
+    const float bin_scale = float(BVH_SAH_BINS) / extent;
+
+    int bin_count[BVH_SAH_BINS] = {0};
+    float bin_bv[BVH_SAH_BINS][6];
+    for (int bin = 0; bin < BVH_SAH_BINS; bin++) {
+      aabb_init(bin_bv[bin]);
+    }
+    for (int i = begin; i < end; i++) {
+      const int bin = std::min(
+          int((bvh_node_centroid(leafs[i], axis) - centroid_min[axis]) * bin_scale),
+          BVH_SAH_BINS - 1);
+      bin_count[bin]++;
+      aabb_join(bin_bv[bin], leafs[i]->bv);
+    }
+
+    /* Sweep from the right to get the cost of the second partition for every split. */
+    float right_cost[BVH_SAH_BINS];
+    float right_bv[6];
+    aabb_init(right_bv);
+    int right_count = 0;
+    for (int bin = BVH_SAH_BINS - 1; bin > 0; bin--) {
+      aabb_join(right_bv, bin_bv[bin]);
+      right_count += bin_count[bin];
+      right_cost[bin] = float(right_count) * aabb_area(right_bv);
+    }
+
+    float left_bv[6];
+    aabb_init(left_bv);
+    int left_count = 0;
+    for (int bin = 0; bin < BVH_SAH_BINS - 1; bin++) {
+      aabb_join(left_bv, bin_bv[bin]);
+      left_count += bin_count[bin];
+      if (left_count == 0 || left_count == end - begin) {
+        continue;
+      }
+      const float cost = float(left_count) * aabb_area(left_bv) + right_cost[bin + 1];
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_axis = axis;
+        best_bin = bin;
+      }
+    }
+  }
+
+  if (best_axis != -1) {
+    const float bin_scale = float(BVH_SAH_BINS) /
+                            (centroid_max[best_axis] - centroid_min[best_axis]);
+    BVHNode **mid = std::partition(leafs + begin, leafs + end, [&](const BVHNode *node) {
+      const int bin = std::min(
+          int((bvh_node_centroid(node, best_axis) - centroid_min[best_axis]) * bin_scale),
+          BVH_SAH_BINS - 1);
+      return bin <= best_bin;
+    });
+    const int split = int(mid - leafs);
+    if (split > begin && split < end) {
+      *r_axis = best_axis;
+      return split;
+    }
+  }
+
+  /* All centroids are in the same place, split in the middle. */
+  float bv[6];
+  aabb_init(bv);
+  for (int i = begin; i < end; i++) {
+    aabb_join(bv, leafs[i]->bv);
+  }
+  const int axis = get_largest_axis(bv) / 2;
+  const int split = (begin + end) / 2;
+  partition_nth_element(leafs, begin, end, split, axis * 2);
+  *r_axis = axis;
+  return split;
+}
+
+static void bvh_sah_build_node(BVHSahBuildData &data,
+                               BVHNode *node,
+                               const int begin,
+                               const int end)
+{
+  const BVHTree *tree = data.tree;
+  BLI_assert(end - begin > 1);
+
+  refit_kdop_hull(tree, node, begin, end);
+
+  /* Split the leafs into ranges for every child. For trees with more than two children per node,
+   * the range with the largest area is split until all children are used. */
+  int ranges[MAX_TREETYPE][2] = {{begin, end}};
+  float range_areas[MAX_TREETYPE] = {0.0f};
+  int ranges_num = 1;
+  int split_index = 0;
+  while (true) {
+    int axis;
+    const int range_begin = ranges[split_index][0];
+    const int range_end = ranges[split_index][1];
+    const int split = bvh_sah_split(tree, range_begin, range_end, &axis);
+    if (ranges_num == 1) {
+      node->main_axis = char(axis);
+    }
+
+    /* Keep the ranges ordered, so that the children are ordered along the split axes. */
+    for (int i = ranges_num; i > split_index + 1; i--) {
+      ranges[i][0] = ranges[i - 1][0];
+      ranges[i][1] = ranges[i - 1][1];
+      range_areas[i] = range_areas[i - 1];
+    }
+    ranges[split_index][1] = split;
+    ranges[split_index + 1][0] = split;
+    ranges[split_index + 1][1] = range_end;
+    ranges_num++;
+    if (ranges_num == tree->tree_type) {
+      break;
+    }
+
+    range_areas[split_index] = bvh_sah_range_area(tree, range_begin, split);
+    range_areas[split_index + 1] = bvh_sah_range_area(tree, split, range_end);
+    split_index = -1;
+    float split_area = -1.0f;
+    for (int i = 0; i < ranges_num; i++) {
+      if (ranges[i][1] - ranges[i][0] > 1 && range_areas[i] > split_area) {
+        split_index = i;
+        split_area = range_areas[i];
+      }
+    }
+    if (split_index == -1) {
+      break;
+    }
+  }
+
+  for (int i = 0; i < ranges_num; i++) {
+    BVHNode *child;
+    if (ranges[i][1] - ranges[i][0] == 1) {
+      child = tree->nodes[ranges[i][0]];
+    }
+    else {
+      /* Branches are allocated after their parent, so that children always have a larger index,
+       * see #BLI_bvhtree_update_tree. */
+      child = &tree->nodearray[tree->leaf_num + data.branch_next++];
+    }
+    node->children[i] = child;
+    child->parent = node;
+  }
+  node->node_num = char(ranges_num);
+
+  auto build_child = [&](const int i) {
+    if (ranges[i][1] - ranges[i][0] == 1) {
+      return;
+    }
+    bvh_sah_build_node(data, node->children[i], ranges[i][0], ranges[i][1]);
+  };
+  if (end - begin > KDOPBVH_THREAD_LEAF_THRESHOLD) {
+    blender::threading::parallel_for(
+        blender::IndexRange(ranges_num), 1, [&](const blender::IndexRange range) {
+          for (const int64_t i : range) {
+            build_child(int(i));
+          }
+        });
+  }
+  else {
+    for (int i = 0; i < ranges_num; i++) {
+      build_child(i);
+    }
+  }
+}
+
+/**
+ * Make sure there is enough room for \a numnodes nodes. The SAH build can need more branches than
+ * the implicit tree build when nodes have more than two children.
+ */
+static void bvhtree_node_storage_ensure(BVHTree *tree, const int numnodes)
+{
+  const int numnodes_old = int(MEM_allocN_len(tree->nodearray) / sizeof(BVHNode));
+  if (numnodes <= numnodes_old) {
+    return;
+  }
+  const size_t axis = size_t(tree->axis);
+  const size_t tree_type = size_t(tree->tree_type);
+
+  BVHNode **nodes = MEM_calloc_arrayN<BVHNode *>(size_t(numnodes), "BVHNodes");
+  float *nodebv = MEM_calloc_arrayN<float>(axis * size_t(numnodes), "BVHNodeBV");
+  BVHNode **nodechild = MEM_calloc_arrayN<BVHNode *>(tree_type * size_t(numnodes), "BVHNodeBV");
+  BVHNode *nodearray = MEM_calloc_arrayN<BVHNode>(size_t(numnodes), "BVHNodeArray");
+
+  /* Only leafs exist before the tree is balanced, they don't have children yet. */
+  memcpy(nodebv, tree->nodebv, sizeof(float) * axis * size_t(numnodes_old));
+  for (int i = 0; i < numnodes; i++) {
+    if (i < tree->leaf_num) {
+      nodearray[i] = tree->nodearray[i];
+    }
+    nodearray[i].bv = &nodebv[size_t(i) * axis];
+    nodearray[i].children = &nodechild[size_t(i) * tree_type];
+  }
+  for (int i = 0; i < tree->leaf_num; i++) {
+    nodes[i] = &nodearray[tree->nodes[i] - tree->nodearray];
+  }
+
+  MEM_freeN(tree->nodes);
+  MEM_freeN(tree->nodebv);
+  MEM_freeN(tree->nodechild);
+  MEM_freeN(tree->nodearray);
+  tree->nodes = nodes;
+  tree->nodebv = nodebv;
+  tree->nodechild = nodechild;
+  tree->nodearray = nodearray;
+}
+
+static void bvhtree_balance_sah(BVHTree *tree)
+{
+  BLI_assert(tree->leaf_num > 1);
+  /* Every branch has at least two children. */
+  bvhtree_node_storage_ensure(tree, tree->leaf_num + (tree->leaf_num - 1) + tree->tree_type);
+
+  BVHSahBuildData data;
+  data.tree = tree;
+  data.branch_next = 1;
+
+  BVHNode *root = &tree->nodearray[tree->leaf_num];
+  root->parent = nullptr;
+  bvh_sah_build_node(data, root, 0, tree->leaf_num);
+
+  tree->branch_num = data.branch_next;
+  for (int i = 0; i < tree->branch_num; i++) {
+    tree->nodes[tree->leaf_num + i] = &tree->nodearray[tree->leaf_num + i];
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Wide Tree
+ * \{ */
+
+static void bvhtree_wide_node_update(BVHWideNode &wide_node)
+{
+  for (int i = 0; i < wide_node.children_num; i++) {
+    for (int j = 0; j < 6; j++) {
+      wide_node.bounds[j][i] = wide_node.nodes[i]->bv[j];
+    }
+  }
+  /* Unused children never intersect anything. */
+  for (int i = wide_node.children_num; i < BVH_WIDE_WIDTH; i++) {
+    for (int axis = 0; axis < 3; axis++) {
+      wide_node.bounds[axis * 2][i] = FLT_MAX;
+      wide_node.bounds[axis * 2 + 1][i] = -FLT_MAX;
+    }
+  }
+}
+
+static int bvhtree_wide_build_node(BVHTree *tree, const BVHNode *node)
+{
+  const int wide_index = tree->wide_node_num++;
+
+  /* Collapse the children with the largest area into their parent while there is room. */
+  const BVHNode *nodes[BVH_WIDE_WIDTH];
+  int nodes_num = 0;
+  for (int i = 0; i < node->node_num && nodes_num < BVH_WIDE_WIDTH; i++) {
+    nodes[nodes_num++] = node->children[i];
+  }
+  while (true) {
+    int expand_index = -1;
+    float expand_area = -1.0f;
+    for (int i = 0; i < nodes_num; i++) {
+      const int children_num = nodes[i]->node_num;
+      if (children_num > 0 && nodes_num - 1 + children_num <= BVH_WIDE_WIDTH) {
+        const float area = aabb_area(nodes[i]->bv);
+        if (area > expand_area) {
+          expand_index = i;
+          expand_area = area;
+        }
+      }
+    }
+    if (expand_index == -1) {
+      break;
+    }
+    const BVHNode *expand_node = nodes[expand_index];
+    nodes[expand_index] = expand_node->children[0];
+    for (int i = 1; i < expand_node->node_num; i++) {
+      nodes[nodes_num++] = expand_node->children[i];
+    }
+  }
+
+  int children[BVH_WIDE_WIDTH];
+  for (int i = 0; i < nodes_num; i++) {
+    children[i] = (nodes[i]->node_num == 0) ? -1 : bvhtree_wide_build_node(tree, nodes[i]);
+  }
+
+  BVHWideNode &wide_node = tree->wide_nodes[wide_index];
+  wide_node.children_num = nodes_num;
+  for (int i = 0; i < nodes_num; i++) {
+    wide_node.nodes[i] = nodes[i];
+    wide_node.children[i] = children[i];
+  }
+  bvhtree_wide_node_update(wide_node);
+  return wide_index;
+}
+
+static void bvhtree_wide_build(BVHTree *tree)
+{
+  BLI_assert(tree->axis == 6);
+  MEM_SAFE_FREE(tree->wide_nodes);
+  /* Every wide node corresponds to a different branch. */
+  tree->wide_nodes = MEM_malloc_arrayN<BVHWideNode>(size_t(tree->branch_num), __func__);
+  tree->wide_node_num = 0;
+  bvhtree_wide_build_node(tree, tree->nodes[tree->leaf_num]);
+}
+
+static void bvhtree_wide_update(BVHTree *tree)
+{
+  for (int i = 0; i < tree->wide_node_num; i++) {
+    bvhtree_wide_node_update(tree->wide_nodes[i]);
+  }
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree API
  * \{ */
@@ -918,6 +1347,45 @@ fail:
   return nullptr;
 }
 
+BVHTree *BLI_bvhtree_copy(const BVHTree *tree)
+{
+  BVHTree *tree_copy = static_cast<BVHTree *>(MEM_dupallocN(tree));
+
+  const int numnodes = int(MEM_allocN_len(tree->nodearray) / sizeof(BVHNode));
+  tree_copy->nodes = static_cast<BVHNode **>(MEM_dupallocN(tree->nodes));
+  tree_copy->nodearray = static_cast<BVHNode *>(MEM_dupallocN(tree->nodearray));
+  tree_copy->nodechild = static_cast<BVHNode **>(MEM_dupallocN(tree->nodechild));
+  tree_copy->nodebv = static_cast<float *>(MEM_dupallocN(tree->nodebv));
+
+  /* All node pointers point into the node array, relocate them to the copied array. */
+  const auto relocate = [&](const BVHNode *node) -> BVHNode * {
+    return node ? &tree_copy->nodearray[node - tree->nodearray] : nullptr;
+  };
+  for (int i = 0; i < numnodes; i++) {
+    BVHNode &node = tree_copy->nodearray[i];
+    node.bv = &tree_copy->nodebv[node.bv - tree->nodebv];
+    node.children = &tree_copy->nodechild[node.children - tree->nodechild];
+    node.parent = relocate(node.parent);
+  }
+  for (int i = 0; i < numnodes * tree->tree_type; i++) {
+    tree_copy->nodechild[i] = relocate(tree->nodechild[i]);
+  }
+  for (int i = 0; i < tree->leaf_num + tree->branch_num; i++) {
+    tree_copy->nodes[i] = relocate(tree->nodes[i]);
+  }
+
+  if (tree->wide_nodes) {
+    tree_copy->wide_nodes = static_cast<BVHWideNode *>(MEM_dupallocN(tree->wide_nodes));
+    for (int i = 0; i < tree->wide_node_num; i++) {
+      BVHWideNode &wide_node = tree_copy->wide_nodes[i];
+      for (int j = 0; j < wide_node.children_num; j++) {
+        wide_node.nodes[j] = relocate(wide_node.nodes[j]);
+      }
+    }
+  }
+  return tree_copy;
+}
+
 void BLI_bvhtree_free(BVHTree *tree)
 {
   if (tree) {
@@ -925,11 +1393,17 @@ void BLI_bvhtree_free(BVHTree *tree)
     MEM_SAFE_FREE(tree->nodearray);
     MEM_SAFE_FREE(tree->nodebv);
     MEM_SAFE_FREE(tree->nodechild);
+    MEM_SAFE_FREE(tree->wide_nodes);
     MEM_freeN(tree);
   }
 }
 
 void BLI_bvhtree_balance(BVHTree *tree)
+{
+  BLI_bvhtree_balance_ex(tree, 0);
+}
+
+void BLI_bvhtree_balance_ex(BVHTree *tree, const int flag)
 {
   BVHNode **leafs_array = tree->nodes;
 
@@ -937,15 +1411,26 @@ void BLI_bvhtree_balance(BVHTree *tree)
    * (some big bug goes here if its being called more than once per tree) */
   BLI_assert(tree->branch_num == 0);
 
-  /* Build the implicit tree */
-  non_recursive_bvh_div_nodes(
-      tree, tree->nodearray + (tree->leaf_num - 1), leafs_array, tree->leaf_num);
+  if ((flag & BVH_BALANCE_SAH) && tree->leaf_num > 1) {
+    bvhtree_balance_sah(tree);
+  }
+  else {
+    /* Build the implicit tree */
+    non_recursive_bvh_div_nodes(
+        tree, tree->nodearray + (tree->leaf_num - 1), leafs_array, tree->leaf_num);
 
-  /* current code expects the branches to be linked to the nodes array
-   * we perform that linkage here */
-  tree->branch_num = implicit_needed_branches(tree->tree_type, tree->leaf_num);
-  for (int i = 0; i < tree->branch_num; i++) {
-    tree->nodes[tree->leaf_num + i] = &tree->nodearray[tree->leaf_num + i];
+    /* current code expects the branches to be linked to the nodes array
+     * we perform that linkage here */
+    tree->branch_num = implicit_needed_branches(tree->tree_type, tree->leaf_num);
+    for (int i = 0; i < tree->branch_num; i++) {
+      tree->nodes[tree->leaf_num + i] = &tree->nodearray[tree->leaf_num + i];
+    }
+  }
+
+  if ((flag & BVH_BALANCE_WIDE) && tree->axis == 6 && tree->tree_type <= BVH_WIDE_WIDTH &&
+      tree->leaf_num > 1)
+  {
+    bvhtree_wide_build(tree);
   }
 
 #ifdef USE_SKIP_LINKS
@@ -1025,6 +1510,10 @@ void BLI_bvhtree_update_tree(BVHTree *tree)
   for (; index >= root; index--) {
     node_join(tree, *index);
   }
+
+  if (tree->wide_nodes) {
+    bvhtree_wide_update(tree);
+  }
 }
 int BLI_bvhtree_get_len(const BVHTree *tree)
 {
@@ -1517,13 +2006,49 @@ int *BLI_bvhtree_intersect_plane(const BVHTree *tree, float plane[4], uint *r_in
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Wide Tree Traversal Utilities
+ * \{ */
+
+/** Wide node to visit, with the distance to its bounds to skip it when a closer hit was found. */
+struct BVHWideStackItem {
+  int node;
+  float dist;
+};
+using BVHWideStack = blender::Vector<BVHWideStackItem, 64>;
+
+/**
+ * Get the children in \a hit_mask ordered by increasing distance.
+ * \return The number of children in \a r_order.
+ */
+static int wide_hits_sort(const float dist[BVH_WIDE_WIDTH],
+                          const int hit_mask,
+                          int r_order[BVH_WIDE_WIDTH])
+{
+  int hits_num = 0;
+  for (int i = 0; i < BVH_WIDE_WIDTH; i++) {
+    if (hit_mask & (1 << i)) {
+      int j = hits_num++;
+      for (; j > 0 && dist[r_order[j - 1]] > dist[i]; j--) {
+        r_order[j] = r_order[j - 1];
+      }
+      r_order[j] = i;
+    }
+  }
+  return hits_num;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree_find_nearest
  * \{ */
 
 /* Determines the nearest point of the given node BV.
  * Returns the squared distance to that point. */
-static float calc_nearest_point_squared(const float proj[3], BVHNode *node, float nearest[3])
+static float calc_nearest_point_squared(const float proj[3],
+                                        const BVHNode *node,
+                                        float nearest[3])
 {
   int i;
   const float *bv = node->bv;
@@ -1636,6 +2161,86 @@ static void heap_find_nearest_begin(BVHNearestData *data, BVHNode *root)
   }
 }
 
+/**
+ * Same as #calc_nearest_point_squared for all children of the wide node.
+ * \return A bit mask of the children that are closer than the current nearest point.
+ */
+static int wide_nearest_dist_sq(const BVHNearestData *data,
+                                const BVHWideNode &node,
+                                float r_dist_sq[BVH_WIDE_WIDTH])
+{
+#if BLI_HAVE_SSE2
+  __m128 dist_sq = _mm_setzero_ps();
+  for (int axis = 0; axis < 3; axis++) {
+    const __m128 proj = _mm_set1_ps(data->proj[axis]);
+    const __m128 nearest = _mm_min_ps(_mm_max_ps(proj, _mm_loadu_ps(node.bounds[axis * 2])),
+                                      _mm_loadu_ps(node.bounds[axis * 2 + 1]));
+    const __m128 delta = _mm_sub_ps(proj, nearest);
+    dist_sq = _mm_add_ps(dist_sq, _mm_mul_ps(delta, delta));
+  }
+  _mm_storeu_ps(r_dist_sq, dist_sq);
+  const int hit_mask = _mm_movemask_ps(
+      _mm_cmplt_ps(dist_sq, _mm_set1_ps(data->nearest.dist_sq)));
+#else
+  int hit_mask = 0;
+  for (int i = 0; i < BVH_WIDE_WIDTH; i++) {
+    float dist_sq = 0.0f;
+    for (int axis = 0; axis < 3; axis++) {
+      const float proj = data->proj[axis];
+      const float nearest = std::min(std::max(proj, node.bounds[axis * 2][i]),
+                                     node.bounds[axis * 2 + 1][i]);
+      dist_sq += (proj - nearest) * (proj - nearest);
+    }
+    r_dist_sq[i] = dist_sq;
+    if (dist_sq < data->nearest.dist_sq) {
+      hit_mask |= 1 << i;
+    }
+  }
+#endif
+  return hit_mask & ((1 << node.children_num) - 1);
+}
+
+/** Depth first search on the wide tree, visiting the closest children first. */
+static void wide_find_nearest(BVHNearestData *data)
+{
+  const BVHTree *tree = data->tree;
+  BVHWideStack stack;
+  stack.append({0, 0.0f});
+  while (!stack.is_empty()) {
+    const BVHWideStackItem item = stack.pop_last();
+    if (item.dist >= data->nearest.dist_sq) {
+      continue;
+    }
+    const BVHWideNode &node = tree->wide_nodes[item.node];
+    float dist_sq[BVH_WIDE_WIDTH];
+    int order[BVH_WIDE_WIDTH];
+    const int hit_mask = wide_nearest_dist_sq(data, node, dist_sq);
+    const int hits_num = wide_hits_sort(dist_sq, hit_mask, order);
+
+    for (int k = 0; k < hits_num; k++) {
+      const int i = order[k];
+      if (node.children[i] != -1 || dist_sq[i] >= data->nearest.dist_sq) {
+        continue;
+      }
+      const BVHNode *leaf = node.nodes[i];
+      if (data->callback) {
+        data->callback(data->userdata, leaf->index, data->co, &data->nearest);
+      }
+      else {
+        data->nearest.index = leaf->index;
+        data->nearest.dist_sq = calc_nearest_point_squared(data->proj, leaf, data->nearest.co);
+      }
+    }
+    /* Push the closest last, so that it is visited first. */
+    for (int k = hits_num - 1; k >= 0; k--) {
+      const int i = order[k];
+      if (node.children[i] != -1) {
+        stack.append({node.children[i], dist_sq[i]});
+      }
+    }
+  }
+}
+
 int BLI_bvhtree_find_nearest_ex(const BVHTree *tree,
                                 const float co[3],
                                 BVHTreeNearest *nearest,
@@ -1672,6 +2277,12 @@ int BLI_bvhtree_find_nearest_ex(const BVHTree *tree,
     if (flag & BVH_NEAREST_OPTIMAL_ORDER) {
       heap_find_nearest_begin(&data, root);
     }
+    else if (tree->wide_nodes) {
+      float root_nearest[3];
+      if (calc_nearest_point_squared(data.proj, root, root_nearest) < data.nearest.dist_sq) {
+        wide_find_nearest(&data);
+      }
+    }
     else {
       dfs_find_nearest_begin(&data, root);
     }
@@ -1694,6 +2305,23 @@ int BLI_bvhtree_find_nearest(const BVHTree *tree,
   return BLI_bvhtree_find_nearest_ex(tree, co, nearest, callback, userdata, 0);
 }
 
+namespace blender {
+
+void BLI_bvhtree_find_nearest_batch(const BVHTree &tree,
+                                    const IndexMask &mask,
+                                    const Span<float3> positions,
+                                    MutableSpan<BVHTreeNearest> nearest,
+                                    BVHTree_NearestPointCallback callback,
+                                    void *userdata,
+                                    const int flag)
+{
+  mask.foreach_index(GrainSize(256), [&](const int64_t i) {
+    BLI_bvhtree_find_nearest_ex(&tree, positions[i], &nearest[i], callback, userdata, flag);
+  });
+}
+
+}  // namespace blender
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -1926,6 +2554,109 @@ static void dfs_raycast_all(BVHRayCastData *data, BVHNode *node)
   }
 }
 
+/**
+ * Same as #fast_ray_nearest_hit (or #ray_nearest_hit when the ray has a radius) for all children
+ * of the wide node.
+ * \return A bit mask of the children that are hit closer than the current hit.
+ */
+static int wide_ray_nearest_hit(const BVHRayCastData *data,
+                                const BVHWideNode &node,
+                                float r_dist[BVH_WIDE_WIDTH])
+{
+  const float radius = data->ray.radius;
+#if BLI_HAVE_SSE2
+  __m128 t_min = _mm_set1_ps(-FLT_MAX);
+  __m128 t_max = _mm_set1_ps(FLT_MAX);
+  for (int axis = 0; axis < 3; axis++) {
+    /* The bounds the ray enters and exits through, see #bvhtree_ray_cast_data_precalc. */
+    const int enter = data->index[axis * 2];
+    const int exit = data->index[axis * 2 + 1];
+    const float enter_radius = (enter & 1) ? radius : -radius;
+    const __m128 origin = _mm_set1_ps(data->ray.origin[axis]);
+    const __m128 idot = _mm_set1_ps(data->idot_axis[axis]);
+    const __m128 t_enter = _mm_mul_ps(
+        _mm_sub_ps(_mm_add_ps(_mm_loadu_ps(node.bounds[enter]), _mm_set1_ps(enter_radius)),
+                   origin),
+        idot);
+    const __m128 t_exit = _mm_mul_ps(
+        _mm_sub_ps(_mm_sub_ps(_mm_loadu_ps(node.bounds[exit]), _mm_set1_ps(enter_radius)),
+                   origin),
+        idot);
+    t_min = _mm_max_ps(t_min, t_enter);
+    t_max = _mm_min_ps(t_max, t_exit);
+  }
+  const __m128 dist = (radius == 0.0f) ? t_min : _mm_max_ps(t_min, _mm_setzero_ps());
+  _mm_storeu_ps(r_dist, dist);
+  const __m128 is_hit = _mm_and_ps(
+      _mm_and_ps(_mm_cmple_ps(t_min, t_max), _mm_cmpge_ps(t_max, _mm_setzero_ps())),
+      _mm_cmplt_ps(dist, _mm_set1_ps(data->hit.dist)));
+  const int hit_mask = _mm_movemask_ps(is_hit);
+#else
+  int hit_mask = 0;
+  for (int i = 0; i < BVH_WIDE_WIDTH; i++) {
+    float t_min = -FLT_MAX;
+    float t_max = FLT_MAX;
+    for (int axis = 0; axis < 3; axis++) {
+      const int enter = data->index[axis * 2];
+      const int exit = data->index[axis * 2 + 1];
+      const float enter_radius = (enter & 1) ? radius : -radius;
+      const float origin = data->ray.origin[axis];
+      const float idot = data->idot_axis[axis];
+      t_min = std::max(t_min, (node.bounds[enter][i] + enter_radius - origin) * idot);
+      t_max = std::min(t_max, (node.bounds[exit][i] - enter_radius - origin) * idot);
+    }
+    const float dist = (radius == 0.0f) ? t_min : std::max(t_min, 0.0f);
+    r_dist[i] = dist;
+    if (t_min <= t_max && t_max >= 0.0f && dist < data->hit.dist) {
+      hit_mask |= 1 << i;
+    }
+  }
+#endif
+  return hit_mask & ((1 << node.children_num) - 1);
+}
+
+/** Depth first search on the wide tree, visiting the closest children first. */
+static void wide_raycast(BVHRayCastData *data)
+{
+  const BVHTree *tree = data->tree;
+  BVHWideStack stack;
+  stack.append({0, -FLT_MAX});
+  while (!stack.is_empty()) {
+    const BVHWideStackItem item = stack.pop_last();
+    if (item.dist >= data->hit.dist) {
+      continue;
+    }
+    const BVHWideNode &node = tree->wide_nodes[item.node];
+    float dist[BVH_WIDE_WIDTH];
+    int order[BVH_WIDE_WIDTH];
+    const int hit_mask = wide_ray_nearest_hit(data, node, dist);
+    const int hits_num = wide_hits_sort(dist, hit_mask, order);
+
+    for (int k = 0; k < hits_num; k++) {
+      const int i = order[k];
+      if (node.children[i] != -1 || dist[i] >= data->hit.dist) {
+        continue;
+      }
+      const int index = node.nodes[i]->index;
+      if (data->callback) {
+        data->callback(data->userdata, index, &data->ray, &data->hit);
+      }
+      else {
+        data->hit.index = index;
+        data->hit.dist = dist[i];
+        madd_v3_v3v3fl(data->hit.co, data->ray.origin, data->ray.direction, dist[i]);
+      }
+    }
+    /* Push the closest last, so that it is visited first. */
+    for (int k = hits_num - 1; k >= 0; k--) {
+      const int i = order[k];
+      if (node.children[i] != -1) {
+        stack.append({node.children[i], dist[i]});
+      }
+    }
+  }
+}
+
 static void bvhtree_ray_cast_data_precalc(BVHRayCastData *data, int flag)
 {
   int i;
@@ -1995,7 +2726,16 @@ int BLI_bvhtree_ray_cast_ex(const BVHTree *tree,
   }
 
   if (root) {
-    dfs_raycast(&data, root);
+    if (tree->wide_nodes) {
+      const float dist = (data.ray.radius == 0.0f) ? fast_ray_nearest_hit(&data, root) :
+                                                     ray_nearest_hit(&data, root->bv);
+      if (dist < data.hit.dist) {
+        wide_raycast(&data);
+      }
+    }
+    else {
+      dfs_raycast(&data, root);
+    }
     //      iterative_raycast(&data, root);
   }
 
@@ -2018,6 +2758,26 @@ int BLI_bvhtree_ray_cast(const BVHTree *tree,
       tree, co, dir, radius, hit, callback, userdata, BVH_RAYCAST_DEFAULT);
 }
 
+namespace blender {
+
+void BLI_bvhtree_ray_cast_batch(const BVHTree &tree,
+                                const IndexMask &mask,
+                                const Span<float3> origins,
+                                const Span<float3> directions,
+                                const float radius,
+                                MutableSpan<BVHTreeRayHit> hits,
+                                BVHTree_RayCastCallback callback,
+                                void *userdata,
+                                const int flag)
+{
+  mask.foreach_index(GrainSize(256), [&](const int64_t i) {
+    BLI_bvhtree_ray_cast_ex(
+        &tree, origins[i], directions[i], radius, &hits[i], callback, userdata, flag);
+  });
+}
+
+}  // namespace blender
+
 float BLI_bvhtree_bb_raycast(const float bv[6],
                              const float light_start[3],
                              const float light_end[3],
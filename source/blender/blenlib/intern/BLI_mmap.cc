@@ -16,6 +16,7 @@
 #ifndef WIN32
 #  include <csignal>
 #  include <cstdlib>
+#  include <mutex>
 #  include <sys/mman.h> /* For mmap. */
 #  include <unistd.h>   /* For read close. */
 #else
@@ -33,6 +34,19 @@ struct BLI_mmap_file {
   /* Platform-specific handle for the mapping. */
   void *handle;
 
+  /* Whether the mapped memory can be written to (with private copy-on-write pages). */
+  bool copy_on_write;
+
+  /* Duplicated file descriptor for copy-on-write mappings, -1 otherwise. It refers to the mapped
+   * file even when the file path is replaced, and is used to detect changes made to the file on
+   * disk while its memory is still referenced, see #BLI_mmap_file_changed. */
+  int fd;
+
+  /* The size and modification time of the file when it was mapped. */
+  int64_t file_size;
+  int64_t file_mtime_sec;
+  int64_t file_mtime_nsec;
+
   /* Flag to indicate IO errors. Needs to be volatile since it's being set from
    * within the signal handler, which is not part of the normal execution flow. */
   volatile bool io_error;
@@ -72,9 +86,14 @@ static void sigbus_handler(int sig, siginfo_t *siginfo, void *ptr)
     if (error_addr >= file->memory && error_addr < file->memory + file->length) {
       file->io_error = true;
 
-      /* Replace the mapped memory with zeroes. */
-      const void *mapped_memory = mmap(
-          file->memory, file->length, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+      /* Replace the mapped memory with zeroes. Copy-on-write mappings have to stay writable,
+       * the error is reported by #BLI_mmap_file_changed. */
+      const void *mapped_memory = mmap(file->memory,
+                                       file->length,
+                                       file->copy_on_write ? (PROT_READ | PROT_WRITE) : PROT_READ,
+                                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED,
+                                       -1,
+                                       0);
       if (mapped_memory == MAP_FAILED) {
         fprintf(stderr, "SIGBUS handler: Error replacing mapped file with zeros\n");
       }
@@ -115,22 +134,39 @@ static bool sigbus_handler_setup()
   return true;
 }
 
+/* Copy-on-write mappings may be freed from any thread once the data referenced from them is not
+ * used anymore, so changes to the list of files are serialized. */
+static std::mutex error_handler_mutex;
+
 /* Adds a file to the list that the error handler checks. */
 static void sigbus_handler_add(BLI_mmap_file *file)
 {
+  std::scoped_lock lock(error_handler_mutex);
   BLI_addtail(&error_handler.open_mmaps, BLI_genericNodeN(file));
 }
 
 /* Removes a file from the list that the error handler checks. */
 static void sigbus_handler_remove(BLI_mmap_file *file)
 {
+  std::scoped_lock lock(error_handler_mutex);
   LinkData *link = static_cast<LinkData *>(
       BLI_findptr(&error_handler.open_mmaps, file, offsetof(LinkData, data)));
   BLI_freelinkN(&error_handler.open_mmaps, link);
 }
+
+static void file_mtime_get(const BLI_stat_t &st, int64_t *r_sec, int64_t *r_nsec)
+{
+#  ifdef __APPLE__
+  *r_sec = int64_t(st.st_mtimespec.tv_sec);
+  *r_nsec = int64_t(st.st_mtimespec.tv_nsec);
+#  else
+  *r_sec = int64_t(st.st_mtim.tv_sec);
+  *r_nsec = int64_t(st.st_mtim.tv_nsec);
+#  endif
+}
 #endif
 
-BLI_mmap_file *BLI_mmap_open(int fd)
+static BLI_mmap_file *mmap_open_ex(int fd, const bool copy_on_write)
 {
   void *memory, *handle = nullptr;
   const size_t length = BLI_lseek(fd, 0, SEEK_END);
@@ -144,22 +180,49 @@ BLI_mmap_file *BLI_mmap_open(int fd)
     return nullptr;
   }
 
+  int file_fd = -1;
+  BLI_stat_t st = {0};
+  if (copy_on_write) {
+    file_fd = dup(fd);
+    if (file_fd == -1) {
+      return nullptr;
+    }
+    if (BLI_fstat(file_fd, &st) != 0) {
+      close(file_fd);
+      return nullptr;
+    }
+  }
+
   /* Map the given file to memory. */
-  memory = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  memory = mmap(nullptr,
+                length,
+                copy_on_write ? (PROT_READ | PROT_WRITE) : PROT_READ,
+                MAP_PRIVATE,
+                fd,
+                0);
   if (memory == MAP_FAILED) {
+    if (file_fd != -1) {
+      close(file_fd);
+    }
     return nullptr;
   }
 #else
+  if (copy_on_write) {
+    /* Not supported, see #BLI_mmap_open_copy_on_write. */
+    return nullptr;
+  }
+  const int file_fd = -1;
   /* Convert the POSIX-style file descriptor to a Windows handle. */
   void *file_handle = (void *)_get_osfhandle(fd);
   /* Memory mapping on Windows is a two-step process - first we create a mapping,
    * then we create a view into that mapping.
    * In our case, one view that spans the entire file is enough. */
-  handle = CreateFileMapping(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  handle = CreateFileMapping(
+      file_handle, nullptr, copy_on_write ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
   if (handle == nullptr) {
     return nullptr;
   }
-  memory = MapViewOfFile(handle, FILE_MAP_READ, 0, 0, 0);
+  memory = MapViewOfFile(handle, copy_on_write ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
   if (memory == nullptr) {
     CloseHandle(handle);
     return nullptr;
@@ -171,6 +234,14 @@ BLI_mmap_file *BLI_mmap_open(int fd)
   file->memory = static_cast<char *>(memory);
   file->handle = handle;
   file->length = length;
+  file->copy_on_write = copy_on_write;
+  file->fd = file_fd;
+#ifndef WIN32
+  if (copy_on_write) {
+    file->file_size = int64_t(st.st_size);
+    file_mtime_get(st, &file->file_mtime_sec, &file->file_mtime_nsec);
+  }
+#endif
 
 #ifndef WIN32
   /* Register the file with the error handler. */
@@ -180,6 +251,16 @@ BLI_mmap_file *BLI_mmap_open(int fd)
   return file;
 }
 
+BLI_mmap_file *BLI_mmap_open(int fd)
+{
+  return mmap_open_ex(fd, false);
+}
+
+BLI_mmap_file *BLI_mmap_open_copy_on_write(int fd)
+{
+  return mmap_open_ex(fd, true);
+}
+
 bool BLI_mmap_read(BLI_mmap_file *file, void *dest, size_t offset, size_t length)
 {
   /* If a previous read has already failed or we try to read past the end,
@@ -224,11 +305,36 @@ bool BLI_mmap_any_io_error(const BLI_mmap_file *file)
   return file->io_error;
 }
 
+bool BLI_mmap_file_changed(const BLI_mmap_file *file)
+{
+  if (file->io_error) {
+    return true;
+  }
+#ifndef WIN32
+  if (file->fd == -1) {
+    return false;
+  }
+  BLI_stat_t st;
+  if (BLI_fstat(file->fd, &st) != 0) {
+    return true;
+  }
+  int64_t mtime_sec, mtime_nsec;
+  file_mtime_get(st, &mtime_sec, &mtime_nsec);
+  return int64_t(st.st_size) != file->file_size || mtime_sec != file->file_mtime_sec ||
+         mtime_nsec != file->file_mtime_nsec;
+#else
+  return false;
+#endif
+}
+
 void BLI_mmap_free(BLI_mmap_file *file)
 {
 #ifndef WIN32
-  munmap((void *)file->memory, file->length);
   sigbus_handler_remove(file);
+  munmap((void *)file->memory, file->length);
+  if (file->fd != -1) {
+    close(file->fd);
+  }
 #else
   UnmapViewOfFile(file->memory);
   CloseHandle(file->handle);
@@ -6,15 +6,273 @@
  * \ingroup bli
  */
 
+#include <cstring>
 #include <functional>
 
 #include "BLI_array_utils.hh"
+#include "BLI_simd.hh"
 #include "BLI_threads.h"
 
 #include "atomic_ops.h"
 
 namespace blender::array_utils {
 
+namespace detail {
+
+/* -------------------------------------------------------------------- */
+/** \name Kernels for Trivially Copyable Types
+ *
+ * The elements are copied as bytes, so that one implementation per type size is enough for all
+ * types. Contiguous parts of index masks are copied with `memcpy`, and single elements with
+ * unaligned vector loads and stores. Elements of 12 bytes (e.g. `float3`) are copied with a
+ * single 16 byte load and store when possible, because the destination is written in order and
+ * the 4 bytes written past the element are overwritten by the next one.
+ *
+ * The kernels use the SIMD instruction set that Blender is compiled for, there is no dispatch
+ * at run-time.
+ * \{ */
+
+template<int Size> BLI_INLINE void copy_element(const char *src, char *dst)
+{
+#if BLI_HAVE_SSE2
+  if constexpr (Size == 16) {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst),
+                     _mm_loadu_si128(reinterpret_cast<const __m128i *>(src)));
+    return;
+  }
+  if constexpr (Size == 8) {
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(dst),
+                     _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src)));
+    return;
+  }
+#endif
+  memcpy(dst, src, Size);
+}
+
+/**
+ * Copy an element, possibly writing up to 16 bytes to #dst. Reading 16 bytes from #src is only
+ * allowed when #src_wide is true.
+ */
+template<int Size>
+BLI_INLINE void copy_element_wide(const char *src, char *dst, const bool src_wide)
+{
+#if BLI_HAVE_SSE2
+  if constexpr (Size == 12) {
+    if (src_wide) {
+      copy_element<16>(src, dst);
+      return;
+    }
+  }
+#endif
+  UNUSED_VARS(src_wide);
+  copy_element<Size>(src, dst);
+}
+
+/**
+ * Gather elements at `src + indices[i]`.
+ * \param src_size: Number of elements starting at #src, used to avoid reading past the end.
+ */
+template<int Size, typename IndexT>
+static void gather_elements(const char *src,
+                            const int64_t src_size,
+                            const Span<IndexT> indices,
+                            char *dst)
+{
+  if (indices.is_empty()) {
+    return;
+  }
+  const int64_t last = indices.size() - 1;
+  for (const int64_t i : IndexRange(last)) {
+    const int64_t index = indices[i];
+    copy_element_wide<Size>(src + index * Size, dst + i * Size, index < src_size - 1);
+  }
+  copy_element<Size>(src + int64_t(indices[last]) * Size, dst + last * Size);
+}
+
+template<int Size, typename IndexT>
+static void scatter_elements(const char *src, const Span<IndexT> indices, char *dst)
+{
+  /* Wide stores are not possible here, because the destination is not written in order. */
+  for (const int64_t i : indices.index_range()) {
+    copy_element<Size>(src + i * Size, dst + int64_t(indices[i]) * Size);
+  }
+}
+
+template<int Size>
+static void gather_trivial_impl(const char *src,
+                                const int64_t src_size,
+                                const IndexMask &indices,
+                                char *dst,
+                                const int64_t grain_size)
+{
+  indices.foreach_segment_optimized(
+      GrainSize(grain_size), [&](const auto segment, const int64_t segment_pos) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(segment)>, IndexRange>) {
+          memcpy(dst + segment_pos * Size, src + segment.start() * Size, segment.size() * Size);
+        }
+        else {
+          const int64_t offset = segment.offset();
+          gather_elements<Size>(src + offset * Size,
+                                src_size - offset,
+                                segment.base_span(),
+                                dst + segment_pos * Size);
+        }
+      });
+}
+
+template<int Size>
+static void gather_trivial_impl(const char *src,
+                                const int64_t src_size,
+                                const Span<int> indices,
+                                char *dst,
+                                const int64_t grain_size)
+{
+  threading::parallel_for(indices.index_range(), grain_size, [&](const IndexRange range) {
+    gather_elements<Size>(src, src_size, indices.slice(range), dst + range.start() * Size);
+  });
+}
+
+template<int Size>
+static void scatter_trivial_impl(const char *src,
+                                 const IndexMask &indices,
+                                 char *dst,
+                                 const int64_t grain_size)
+{
+  indices.foreach_segment_optimized(
+      GrainSize(grain_size), [&](const auto segment, const int64_t segment_pos) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(segment)>, IndexRange>) {
+          memcpy(dst + segment.start() * Size, src + segment_pos * Size, segment.size() * Size);
+        }
+        else {
+          scatter_elements<Size>(
+              src + segment_pos * Size, segment.base_span(), dst + segment.offset() * Size);
+        }
+      });
+}
+
+/** Call the function with the type size as compile-time constant. */
+template<typename Fn> static void dispatch_type_size(const int64_t type_size, const Fn &fn)
+{
+  switch (type_size) {
+    case 4:
+      fn(std::integral_constant<int, 4>());
+      break;
+    case 8:
+      fn(std::integral_constant<int, 8>());
+      break;
+    case 12:
+      fn(std::integral_constant<int, 12>());
+      break;
+    case 16:
+      fn(std::integral_constant<int, 16>());
+      break;
+    default:
+      BLI_assert_unreachable();
+      break;
+  }
+}
+
+bool use_trivial_kernel(const CPPType &type)
+{
+  return type.is_trivial && ELEM(type.size, 4, 8, 12, 16);
+}
+
+void gather_trivial(const void *src,
+                    const int64_t src_size,
+                    const IndexMask &indices,
+                    void *dst,
+                    const int64_t type_size,
+                    const int64_t grain_size)
+{
+  dispatch_type_size(type_size, [&](auto size) {
+    gather_trivial_impl<size.value>(static_cast<const char *>(src),
+                                    src_size,
+                                    indices,
+                                    static_cast<char *>(dst),
+                                    grain_size);
+  });
+}
+
+void gather_trivial(const void *src,
+                    const int64_t src_size,
+                    const Span<int> indices,
+                    void *dst,
+                    const int64_t type_size,
+                    const int64_t grain_size)
+{
+  dispatch_type_size(type_size, [&](auto size) {
+    gather_trivial_impl<size.value>(static_cast<const char *>(src),
+                                    src_size,
+                                    indices,
+                                    static_cast<char *>(dst),
+                                    grain_size);
+  });
+}
+
+void scatter_trivial(const void *src,
+                     const IndexMask &indices,
+                     void *dst,
+                     const int64_t type_size,
+                     const int64_t grain_size)
+{
+  dispatch_type_size(type_size, [&](auto size) {
+    scatter_trivial_impl<size.value>(
+        static_cast<const char *>(src), indices, static_cast<char *>(dst), grain_size);
+  });
+}
+
+/**
+ * Copy a small number of bytes without calling `memcpy`, which is relatively expensive for the
+ * typically small groups of e.g. face corners. The last 16 bytes may overlap the ones before.
+ */
+BLI_INLINE void copy_bytes(const char *src, char *dst, const int64_t size)
+{
+#if BLI_HAVE_SSE2
+  if (size >= 16 && size <= 64) {
+    for (int64_t i = 0; i < size - 16; i += 16) {
+      copy_element<16>(src + i, dst + i);
+    }
+    copy_element<16>(src + size - 16, dst + size - 16);
+    return;
+  }
+#endif
+  if (size >= 8 && size < 16) {
+    copy_element<8>(src, dst);
+    copy_element<8>(src + size - 8, dst + size - 8);
+    return;
+  }
+  if (size >= 4 && size < 8) {
+    copy_element<4>(src, dst);
+    copy_element<4>(src + size - 4, dst + size - 4);
+    return;
+  }
+  memcpy(dst, src, size);
+}
+
+void copy_group_to_group_trivial(const OffsetIndices<int> src_offsets,
+                                 const OffsetIndices<int> dst_offsets,
+                                 const IndexMask &selection,
+                                 const void *src,
+                                 void *dst,
+                                 const int64_t type_size,
+                                 const bool dst_by_position)
+{
+  const char *src_bytes = static_cast<const char *>(src);
+  char *dst_bytes = static_cast<char *>(dst);
+  selection.foreach_index(GrainSize(512), [&](const int64_t i, const int64_t pos) {
+    const IndexRange src_group = src_offsets[i];
+    const IndexRange dst_group = dst_offsets[dst_by_position ? pos : i];
+    BLI_assert(src_group.size() == dst_group.size());
+    copy_bytes(src_bytes + src_group.start() * type_size,
+               dst_bytes + dst_group.start() * type_size,
+               src_group.size() * type_size);
+  });
+}
+
+/** \} */
+
+}  // namespace detail
+
 void copy(const GVArray &src, GMutableSpan dst, const int64_t grain_size)
 {
   BLI_assert(src.type() == dst.type());
@@ -44,6 +302,12 @@ void gather(const GVArray &src,
 {
   BLI_assert(src.type() == dst.type());
   BLI_assert(indices.size() == dst.size());
+  if (src.is_span() && detail::use_trivial_kernel(src.type())) {
+    const GSpan src_span = src.get_internal_span();
+    detail::gather_trivial(
+        src_span.data(), src_span.size(), indices, dst.data(), src.type().size, grain_size);
+    return;
+  }
   threading::parallel_for(indices.index_range(), grain_size, [&](const IndexRange range) {
     src.materialize_compressed_to_uninitialized(indices.slice(range), dst.slice(range).data());
   });
@@ -60,6 +324,11 @@ void copy_group_to_group(const OffsetIndices<int> src_offsets,
                          const GSpan src,
                          GMutableSpan dst)
 {
+  if (src.type().is_trivial) {
+    detail::copy_group_to_group_trivial(
+        src_offsets, dst_offsets, selection, src.data(), dst.data(), src.type().size, false);
+    return;
+  }
   /* Each group might be large, so a threaded copy might make sense here too. */
   selection.foreach_index(GrainSize(512), [&](const int i) {
     dst.slice(dst_offsets[i]).copy_from(src.slice(src_offsets[i]));
@@ -21,6 +21,8 @@ struct MemoryReader {
 
   const char *data;
   BLI_mmap_file *mmap;
+  /** Whether the reader is responsible for freeing #mmap when it's closed. */
+  bool owns_mmap;
   size_t length;
 };
 
@@ -107,20 +109,18 @@ static int64_t memory_read_mmap(FileReader *reader, void *buffer, size_t size)
 static void memory_close_mmap(FileReader *reader)
 {
   MemoryReader *mem = (MemoryReader *)reader;
-  BLI_mmap_free(mem->mmap);
+  if (mem->owns_mmap) {
+    BLI_mmap_free(mem->mmap);
+  }
   MEM_freeN(mem);
 }
 
-FileReader *BLI_filereader_new_mmap(int filedes)
+static FileReader *filereader_new_mmap_ex(BLI_mmap_file *mmap, const bool owns_mmap)
 {
-  BLI_mmap_file *mmap = BLI_mmap_open(filedes);
-  if (mmap == nullptr) {
-    return nullptr;
-  }
-
   MemoryReader *mem = MEM_callocN<MemoryReader>(__func__);
 
   mem->mmap = mmap;
+  mem->owns_mmap = owns_mmap;
   mem->length = BLI_mmap_get_length(mmap);
 
   mem->reader.read = memory_read_mmap;
@@ -129,3 +129,18 @@ FileReader *BLI_filereader_new_mmap(int filedes)
 
   return (FileReader *)mem;
 }
+
+FileReader *BLI_filereader_new_mmap(int filedes)
+{
+  BLI_mmap_file *mmap = BLI_mmap_open(filedes);
+  if (mmap == nullptr) {
+    return nullptr;
+  }
+
+  return filereader_new_mmap_ex(mmap, true);
+}
+
+FileReader *BLI_filereader_new_mmap_file(BLI_mmap_file *mmap)
+{
+  return filereader_new_mmap_ex(mmap, false);
+}
@@ -7,14 +7,24 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <zstd.h>
 
 #include "BLI_fileops.hh"
 #include "BLI_filereader.h"
+#include "BLI_task.hh"
+#include "BLI_threads.h"
 
 #include "MEM_guardedalloc.h"
 
+/**
+ * Upper limit for the number of frames that are decompressed ahead of time (in parallel) when
+ * reading sequentially from a seekable file. With the default frame size used by the writer
+ * (~1 MB), this bounds the read-ahead buffer to ~32 MB.
+ */
+#define ZSTD_READAHEAD_FRAMES_MAX 32
+
 struct ZstdReader {
   FileReader reader;
 
@@ -29,8 +39,24 @@ struct ZstdReader {
     size_t *compressed_ofs;
     size_t *uncompressed_ofs;
 
+    /**
+     * Decompressed content of the frames in the `[cached_frame, cached_frame_end)` range, stored
+     * contiguously (the frames are adjacent in the uncompressed stream).
+     */
     char *cached_content;
     int cached_frame;
+    int cached_frame_end;
+
+    /** Maximum number of frames decompressed at once when reading sequentially. */
+    int readahead_frames;
+
+    /**
+     * End of the previous read in the uncompressed stream, and the number of reads in a row that
+     * started exactly there. Frames are only read ahead once the reads are known to be
+     * sequential, so that random reads landing right after the cached frames don't trigger it.
+     */
+    size_t last_read_end;
+    int sequential_reads;
   } seek;
 };
 
@@ -126,6 +152,11 @@ static bool zstd_read_seek_table(ZstdReader *zstd)
   }
 
   zstd->seek.cached_frame = -1;
+  zstd->seek.cached_frame_end = -1;
+  zstd->seek.readahead_frames = std::clamp(
+      BLI_system_thread_count(), 1, ZSTD_READAHEAD_FRAMES_MAX);
+  zstd->seek.last_read_end = SIZE_MAX;
+  zstd->seek.sequential_reads = 0;
 
   return true;
 }
@@ -153,19 +184,82 @@ static int zstd_frame_from_pos(ZstdReader *zstd, size_t pos)
   return low;
 }
 
-/* Ensure that the currently loaded frame is the correct one. */
+/* Decompress the frames in the `[first_frame, end_frame)` range into `dst`, in parallel when
+ * there is more than one frame. Returns false if any of the frames fails to decompress. */
+static bool zstd_decompress_frames(ZstdReader *zstd,
+                                   const int first_frame,
+                                   const int end_frame,
+                                   const char *compressed_data,
+                                   char *dst)
+{
+  const size_t compressed_base = zstd->seek.compressed_ofs[first_frame];
+  const size_t uncompressed_base = zstd->seek.uncompressed_ofs[first_frame];
+
+  auto decompress_frame = [&](ZSTD_DCtx *ctx, const int frame) {
+    const size_t compressed_size = zstd->seek.compressed_ofs[frame + 1] -
+                                   zstd->seek.compressed_ofs[frame];
+    const size_t uncompressed_size = zstd->seek.uncompressed_ofs[frame + 1] -
+                                     zstd->seek.uncompressed_ofs[frame];
+    const size_t res = ZSTD_decompressDCtx(
+        ctx,
+        dst + (zstd->seek.uncompressed_ofs[frame] - uncompressed_base),
+        uncompressed_size,
+        compressed_data + (zstd->seek.compressed_ofs[frame] - compressed_base),
+        compressed_size);
+    return !ZSTD_isError(res) && res == uncompressed_size;
+  };
+
+  if (end_frame - first_frame == 1) {
+    return decompress_frame(zstd->ctx, first_frame);
+  }
+
+  std::atomic<bool> success = true;
+  blender::threading::parallel_for(
+      blender::IndexRange::from_begin_end(first_frame, end_frame),
+      1,
+      [&](const blender::IndexRange range) {
+        /* Decompression contexts are not thread-safe, use one per task. */
+        ZSTD_DCtx *ctx = ZSTD_createDCtx();
+        for (const int64_t frame : range) {
+          if (!decompress_frame(ctx, int(frame))) {
+            success = false;
+            break;
+          }
+        }
+        ZSTD_freeDCtx(ctx);
+      });
+  return success;
+}
+
+/* Ensure that the given frame is part of the currently loaded frames.
+ * Returns a pointer to the decompressed content of that frame. */
 static const char *zstd_ensure_cache(ZstdReader *zstd, int frame)
 {
-  if (zstd->seek.cached_frame == frame) {
-    /* Cached frame matches, so just return it. */
-    return zstd->seek.cached_content;
+  if (frame >= zstd->seek.cached_frame && frame < zstd->seek.cached_frame_end) {
+    /* Cached frames contain the requested one, so just return it. */
+    return zstd->seek.cached_content +
+           (zstd->seek.uncompressed_ofs[frame] -
+            zstd->seek.uncompressed_ofs[zstd->seek.cached_frame]);
   }
 
-  /* Cached frame doesn't match, so discard it and cache the wanted one instead. */
+  /* When reading sequentially (i.e. at least the last two reads each continued where the previous
+   * one ended), decompress multiple frames ahead of time in parallel. Random access (e.g. reading
+   * #BHead data on demand) only decompresses the requested frame. */
+  const bool is_sequential = zstd->seek.sequential_reads >= 2;
+  const int end_frame = is_sequential ?
+                            std::min(frame + zstd->seek.readahead_frames,
+                                     zstd->seek.frames_num) :
+                            frame + 1;
+
+  /* Cached frames don't match, so discard them and cache the wanted ones instead. */
   MEM_SAFE_FREE(zstd->seek.cached_content);
+  zstd->seek.cached_frame = -1;
+  zstd->seek.cached_frame_end = -1;
 
-  size_t compressed_size = zstd->seek.compressed_ofs[frame + 1] - zstd->seek.compressed_ofs[frame];
-  size_t uncompressed_size = zstd->seek.uncompressed_ofs[frame + 1] -
+  /* All frames are stored back to back, so their compressed data can be read at once. */
+  size_t compressed_size = zstd->seek.compressed_ofs[end_frame] -
+                           zstd->seek.compressed_ofs[frame];
+  size_t uncompressed_size = zstd->seek.uncompressed_ofs[end_frame] -
                              zstd->seek.uncompressed_ofs[frame];
 
   char *uncompressed_data = MEM_malloc_arrayN<char>(uncompressed_size, __func__);
@@ -178,15 +272,16 @@ static const char *zstd_ensure_cache(ZstdReader *zstd, int frame)
     return nullptr;
   }
 
-  size_t res = ZSTD_decompressDCtx(
-      zstd->ctx, uncompressed_data, uncompressed_size, compressed_data, compressed_size);
+  const bool success = zstd_decompress_frames(
+      zstd, frame, end_frame, compressed_data, uncompressed_data);
   MEM_freeN(compressed_data);
-  if (ZSTD_isError(res) || res < uncompressed_size) {
+  if (!success) {
     MEM_freeN(uncompressed_data);
     return nullptr;
   }
 
   zstd->seek.cached_frame = frame;
+  zstd->seek.cached_frame_end = end_frame;
   zstd->seek.cached_content = uncompressed_data;
   return uncompressed_data;
 }
@@ -195,6 +290,14 @@ static int64_t zstd_read_seekable(FileReader *reader, void *buffer, size_t size)
 {
   ZstdReader *zstd = (ZstdReader *)reader;
 
+  if (zstd->reader.offset == zstd->seek.last_read_end) {
+    /* Only the first few reads matter, avoid overflowing for large files. */
+    zstd->seek.sequential_reads = std::min(zstd->seek.sequential_reads + 1, 2);
+  }
+  else {
+    zstd->seek.sequential_reads = 0;
+  }
+
   size_t end_offset = zstd->reader.offset + size, read_len = 0;
   while (zstd->reader.offset < end_offset) {
     int frame = zstd_frame_from_pos(zstd, zstd->reader.offset);
@@ -218,6 +321,7 @@ static int64_t zstd_read_seekable(FileReader *reader, void *buffer, size_t size)
     zstd->reader.offset = frame_end_offset;
   }
 
+  zstd->seek.last_read_end = zstd->reader.offset;
   return read_len;
 }
 
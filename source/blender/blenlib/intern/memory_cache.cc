@@ -8,11 +8,19 @@
 
 #include <atomic>
 #include <optional>
+#include <string>
 
 #include "BLI_concurrent_map.hh"
+#include "BLI_fileops.hh"
+#include "BLI_map.hh"
 #include "BLI_memory_cache.hh"
 #include "BLI_memory_counter.hh"
 #include "BLI_mutex.hh"
+#include "BLI_path_utils.hh"
+#include "BLI_string.h"
+#include "BLI_task.h"
+
+#include "MEM_guardedalloc.h"
 
 namespace blender::memory_cache {
 
@@ -59,7 +67,54 @@ static Cache &get_cache()
   return cache;
 }
 
+struct DiskEntry {
+  /** Shared with the #StoredValue the value was evicted from, referenced by the map key. */
+  std::shared_ptr<const GenericKey> key;
+  std::string filepath;
+  int64_t size_in_bytes = 0;
+  /** Logical time of the memory cache when the entry was last written or read. */
+  int64_t last_use_time = 0;
+};
+
+/**
+ * Second cache tier for values that have been evicted from the memory cache. The keys stay in
+ * memory, only the values are written to files, so the files are only valid during the current
+ * session.
+ */
+struct DiskCache {
+  Mutex mutex;
+  std::string dir_path;
+  int64_t approximate_limit = 0;
+  int64_t size_in_bytes = 0;
+  /** Used to give every file a unique name. */
+  int64_t file_counter = 0;
+  Map<std::reference_wrapper<const GenericKey>, DiskEntry> entries;
+  /**
+   * Values evicted from the memory cache that are waiting to be written to files. They are still
+   * returned from here until then.
+   */
+  Map<std::reference_wrapper<const GenericKey>, StoredValue> pending_values;
+  /** Writes the files in the background, so that evicting values does not wait for the disk. */
+  TaskPool *write_pool = nullptr;
+
+  /** Avoids locking the mutex when the disk cache is not used. */
+  std::atomic<bool> is_enabled = false;
+  /**
+   * Incremented by #remove_if while the global mutex of the memory cache is locked. Values that
+   * were evicted before a removal may be outdated, so they are not written to disk anymore.
+   */
+  std::atomic<int64_t> removal_generation = 0;
+};
+
+static DiskCache &get_disk_cache()
+{
+  static DiskCache disk_cache;
+  return disk_cache;
+}
+
 static void try_enforce_limit();
+static void disk_cache_add(Vector<StoredValue> values, int64_t removal_generation);
+static void disk_cache_remove_files(Span<std::string> filepaths);
 
 static void set_new_logical_time(const StoredValue &stored_value, const int64_t new_time)
 {
@@ -71,8 +126,62 @@ static void set_new_logical_time(const StoredValue &stored_value, const int64_t
   static_assert(sizeof(int64_t) == sizeof(std::atomic<int64_t>));
 }
 
+/**
+ * Read a value that has been moved to the disk cache before. The file is kept, so that it does
+ * not have to be written again when the value is evicted from memory again.
+ */
+static std::shared_ptr<CachedValue> disk_cache_load(const GenericKey &key,
+                                                    const DeserializeFn deserialize_fn,
+                                                    const int64_t new_time)
+{
+  DiskCache &disk_cache = get_disk_cache();
+  if (!disk_cache.is_enabled.load(std::memory_order_relaxed)) {
+    return {};
+  }
+  std::string filepath;
+  {
+    std::lock_guard lock{disk_cache.mutex};
+    if (const StoredValue *pending_value = disk_cache.pending_values.lookup_ptr(std::ref(key))) {
+      /* The value has not been written yet. */
+      return pending_value->value;
+    }
+    DiskEntry *entry = disk_cache.entries.lookup_ptr(std::ref(key));
+    if (!entry) {
+      return {};
+    }
+    entry->last_use_time = new_time;
+    filepath = entry->filepath;
+  }
+
+  std::shared_ptr<CachedValue> value;
+  {
+    fstream stream(filepath, std::ios::in | std::ios::binary);
+    if (stream.is_open()) {
+      value = deserialize_fn(stream);
+    }
+  }
+  if (value) {
+    return value;
+  }
+
+  /* The file has been removed or can't be read anymore, don't try it again. */
+  bool removed = false;
+  {
+    std::lock_guard lock{disk_cache.mutex};
+    if (const std::optional<DiskEntry> entry = disk_cache.entries.pop_try(std::ref(key))) {
+      disk_cache.size_in_bytes -= entry->size_in_bytes;
+      removed = true;
+    }
+  }
+  if (removed) {
+    disk_cache_remove_files({filepath});
+  }
+  return {};
+}
+
 std::shared_ptr<CachedValue> get_base(const GenericKey &key,
-                                      const FunctionRef<std::unique_ptr<CachedValue>()> compute_fn)
+                                      const FunctionRef<std::unique_ptr<CachedValue>()> compute_fn,
+                                      const DeserializeFn deserialize_fn)
 {
   Cache &cache = get_cache();
   /* "Touch" the cached value so that we know that it is still used. This makes it less likely that
@@ -90,7 +199,13 @@ std::shared_ptr<CachedValue> get_base(const GenericKey &key,
   /* Compute value while no locks are held to avoid potential for dead-locks. Not using a lock also
    * means that the value may be computed more than once, but that's still better than locking all
    * the time. It may be possible to implement something smarter in the future. */
-  std::shared_ptr<CachedValue> result = compute_fn();
+  std::shared_ptr<CachedValue> result;
+  if (deserialize_fn) {
+    result = disk_cache_load(key, deserialize_fn, new_time);
+  }
+  if (!result) {
+    result = compute_fn();
+  }
   /* Result should be valid. Use exception to propagate error if necessary. */
   BLI_assert(result);
 
@@ -136,6 +251,212 @@ void set_approximate_size_limit(const int64_t limit_in_bytes)
   try_enforce_limit();
 }
 
+/**
+ * Remove the oldest files until the disk cache is within its limit. Expects the disk cache mutex
+ * to be locked.
+ */
+static void disk_cache_enforce_limit(DiskCache &disk_cache, Vector<std::string> &r_removed_files)
+{
+  if (disk_cache.size_in_bytes <= disk_cache.approximate_limit) {
+    return;
+  }
+  Vector<std::pair<int64_t, const GenericKey *>> keys_with_time;
+  for (const DiskEntry &entry : disk_cache.entries.values()) {
+    keys_with_time.append({entry.last_use_time, entry.key.get()});
+  }
+  std::sort(keys_with_time.begin(), keys_with_time.end());
+  for (const auto &[time, key] : keys_with_time) {
+    if (disk_cache.size_in_bytes <= disk_cache.approximate_limit) {
+      break;
+    }
+    DiskEntry entry = disk_cache.entries.pop(std::ref(*key));
+    disk_cache.size_in_bytes -= entry.size_in_bytes;
+    r_removed_files.append(std::move(entry.filepath));
+  }
+}
+
+static void disk_cache_update_enabled(DiskCache &disk_cache)
+{
+  disk_cache.is_enabled = !disk_cache.dir_path.empty() && disk_cache.approximate_limit > 0;
+}
+
+static void disk_cache_remove_files(const Span<std::string> filepaths)
+{
+  for (const std::string &filepath : filepaths) {
+    BLI_delete(filepath.c_str(), false, false);
+  }
+}
+
+/**
+ * Write a value that has been evicted from the memory cache to a file. Runs in the write pool of
+ * the disk cache.
+ */
+static void disk_cache_write(const StoredValue &stored_value, const int64_t removal_generation)
+{
+  DiskCache &disk_cache = get_disk_cache();
+  Cache &cache = get_cache();
+  std::string dir_path;
+  std::string filepath;
+  {
+    std::lock_guard lock{disk_cache.mutex};
+    const StoredValue *pending_value = disk_cache.pending_values.lookup_ptr(
+        std::ref(*stored_value.key));
+    if (!pending_value || pending_value->value != stored_value.value) {
+      /* The value has been removed from the disk cache in the mean time. */
+      return;
+    }
+    if (!disk_cache.is_enabled) {
+      disk_cache.pending_values.remove_contained(std::ref(*stored_value.key));
+      return;
+    }
+    dir_path = disk_cache.dir_path;
+    char filename[64];
+    SNPRINTF(filename, "%lld.cache", (long long)disk_cache.file_counter++);
+    char filepath_buf[FILE_MAX];
+    BLI_path_join(filepath_buf, sizeof(filepath_buf), dir_path.c_str(), filename);
+    filepath = filepath_buf;
+  }
+
+  /* Write the file without holding the lock, because that can take a while. */
+  int64_t file_size = 0;
+  bool success = false;
+  if (BLI_dir_create_recursive(dir_path.c_str())) {
+    fstream stream(filepath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (stream.is_open()) {
+      success = stored_value.value->serialize(stream) && stream.good();
+      file_size = stream.tellp();
+    }
+  }
+
+  Vector<std::string> removed_files;
+  {
+    std::lock_guard lock{disk_cache.mutex};
+    const StoredValue *pending_value = disk_cache.pending_values.lookup_ptr(
+        std::ref(*stored_value.key));
+    const bool is_pending = pending_value && pending_value->value == stored_value.value;
+    const bool is_valid = success && is_pending && disk_cache.is_enabled &&
+                          disk_cache.dir_path == dir_path &&
+                          disk_cache.removal_generation == removal_generation &&
+                          !disk_cache.entries.contains(std::ref(*stored_value.key));
+    if (is_valid) {
+      DiskEntry entry;
+      entry.key = stored_value.key;
+      entry.filepath = filepath;
+      entry.size_in_bytes = file_size;
+      entry.last_use_time = cache.logical_time.load(std::memory_order_relaxed);
+      disk_cache.entries.add_new(std::ref(*entry.key), std::move(entry));
+      disk_cache.size_in_bytes += file_size;
+      disk_cache_enforce_limit(disk_cache, removed_files);
+    }
+    else {
+      removed_files.append(filepath);
+    }
+    if (is_pending) {
+      disk_cache.pending_values.remove_contained(std::ref(*stored_value.key));
+    }
+  }
+  disk_cache_remove_files(removed_files);
+}
+
+struct DiskCacheWriteTask {
+  Vector<StoredValue> values;
+  int64_t removal_generation;
+};
+
+/**
+ * Move values that have been evicted from the memory cache to the disk cache. The files are
+ * written in the background, values that can't be serialized are skipped.
+ */
+static void disk_cache_add(Vector<StoredValue> values, const int64_t removal_generation)
+{
+  DiskCache &disk_cache = get_disk_cache();
+  std::lock_guard lock{disk_cache.mutex};
+  if (!disk_cache.is_enabled) {
+    return;
+  }
+  values.remove_if([&](const StoredValue &stored_value) {
+    if (DiskEntry *entry = disk_cache.entries.lookup_ptr(std::ref(*stored_value.key))) {
+      /* The value has been loaded from disk before and did not change since. */
+      entry->last_use_time = stored_value.last_use_time;
+      return true;
+    }
+    return !disk_cache.pending_values.add(std::ref(*stored_value.key), stored_value);
+  });
+  if (values.is_empty()) {
+    return;
+  }
+  if (!disk_cache.write_pool) {
+    disk_cache.write_pool = BLI_task_pool_create_background_serial(nullptr, TASK_PRIORITY_LOW);
+  }
+  BLI_task_pool_push(
+      disk_cache.write_pool,
+      [](TaskPool *__restrict /*pool*/, void *taskdata) {
+        const DiskCacheWriteTask &task = *static_cast<DiskCacheWriteTask *>(taskdata);
+        for (const StoredValue &stored_value : task.values) {
+          disk_cache_write(stored_value, task.removal_generation);
+        }
+      },
+      MEM_new<DiskCacheWriteTask>(__func__, DiskCacheWriteTask{std::move(values),
+                                                               removal_generation}),
+      true,
+      [](TaskPool *__restrict /*pool*/, void *taskdata) {
+        MEM_delete(static_cast<DiskCacheWriteTask *>(taskdata));
+      });
+}
+
+/** Wait until all evicted values are written, and stop the background writing. */
+static void disk_cache_write_pool_free(DiskCache &disk_cache)
+{
+  TaskPool *write_pool;
+  {
+    std::lock_guard lock{disk_cache.mutex};
+    write_pool = disk_cache.write_pool;
+    disk_cache.write_pool = nullptr;
+  }
+  if (write_pool) {
+    BLI_task_pool_work_and_wait(write_pool);
+    BLI_task_pool_free(write_pool);
+  }
+}
+
+void set_disk_cache_directory(const StringRefNull dir_path)
+{
+  DiskCache &disk_cache = get_disk_cache();
+  Vector<std::string> removed_files;
+  {
+    std::lock_guard lock{disk_cache.mutex};
+    if (disk_cache.dir_path == dir_path) {
+      return;
+    }
+    for (DiskEntry &entry : disk_cache.entries.values()) {
+      removed_files.append(std::move(entry.filepath));
+    }
+    disk_cache.entries.clear();
+    disk_cache.pending_values.clear();
+    disk_cache.size_in_bytes = 0;
+    disk_cache.dir_path = dir_path;
+    disk_cache_update_enabled(disk_cache);
+  }
+  /* Writes that are still running skip values that are not pending anymore, but a file might be
+   * written to the previous directory already. Waiting also stops the background thread before
+   * exit, when the directory is reset. */
+  disk_cache_write_pool_free(disk_cache);
+  disk_cache_remove_files(removed_files);
+}
+
+void set_approximate_disk_size_limit(const int64_t limit_in_bytes)
+{
+  DiskCache &disk_cache = get_disk_cache();
+  Vector<std::string> removed_files;
+  {
+    std::lock_guard lock{disk_cache.mutex};
+    disk_cache.approximate_limit = limit_in_bytes;
+    disk_cache_update_enabled(disk_cache);
+    disk_cache_enforce_limit(disk_cache, removed_files);
+  }
+  disk_cache_remove_files(removed_files);
+}
+
 void clear()
 {
   memory_cache::remove_if([](const GenericKey &) { return true; });
@@ -179,6 +500,24 @@ void remove_if(const FunctionRef<bool(const GenericKey &)> predicate)
     return predicate_results[index];
   });
   cache.size_in_bytes = cache.memory.total_bytes;
+
+  /* Also remove values that have been moved to the disk cache. */
+  DiskCache &disk_cache = get_disk_cache();
+  disk_cache.removal_generation.fetch_add(1);
+  Vector<std::string> removed_files;
+  {
+    std::lock_guard disk_lock{disk_cache.mutex};
+    disk_cache.pending_values.remove_if([&](const auto item) { return predicate(item.key); });
+    disk_cache.entries.remove_if([&](const auto item) {
+      if (!predicate(item.key)) {
+        return false;
+      }
+      disk_cache.size_in_bytes -= item.value.size_in_bytes;
+      removed_files.append(item.value.filepath);
+      return true;
+    });
+  }
+  disk_cache_remove_files(removed_files);
 }
 
 static void try_enforce_limit()
@@ -191,7 +530,7 @@ static void try_enforce_limit()
     return;
   }
 
-  std::lock_guard lock{cache.global_mutex};
+  std::unique_lock lock{cache.global_mutex};
 
   /* Gather all the keys with their latest usage times. */
   Vector<std::pair<int64_t, const GenericKey *>> keys_with_time;
@@ -247,9 +586,19 @@ static void try_enforce_limit()
     need_memory_recount = true;
   }
 
-  /* Remove elements that don't fit anymore. */
+  /* Remove elements that don't fit anymore. Serializable values are moved to the disk cache
+   * below, so keep them alive until they are written. */
+  const bool use_disk_cache = get_disk_cache().is_enabled.load(std::memory_order_relaxed);
+  const int64_t removal_generation = get_disk_cache().removal_generation.load();
+  Vector<StoredValue> evicted_values;
   for (const int i : keys_with_time.index_range().drop_front(*first_bad_index)) {
     const GenericKey &key = *keys_with_time[i].second;
+    if (use_disk_cache) {
+      CacheMap::ConstAccessor accessor;
+      if (cache.map.lookup(accessor, key)) {
+        evicted_values.append(accessor->second);
+      }
+    }
     cache.map.remove(key);
   }
 
@@ -274,6 +623,12 @@ static void try_enforce_limit()
     }
   }
   cache.size_in_bytes = cache.memory.total_bytes;
+
+  if (!evicted_values.is_empty()) {
+    /* Writing files can take a while, don't block the memory cache in the mean time. */
+    lock.unlock();
+    disk_cache_add(std::move(evicted_values), removal_generation);
+  }
 }
 
 }  // namespace blender::memory_cache
@@ -133,11 +133,12 @@ static void invalidate_outdated_caches_if_necessary(const Span<StringRefNull> fi
 
 std::shared_ptr<CachedValue> get_loaded_base(const GenericKey &loader_key,
                                              Span<StringRefNull> file_paths,
-                                             FunctionRef<std::unique_ptr<CachedValue>()> load_fn)
+                                             FunctionRef<std::unique_ptr<CachedValue>()> load_fn,
+                                             DeserializeFn deserialize_fn)
 {
   invalidate_outdated_caches_if_necessary(file_paths);
   const LoadFileKey key{file_paths, loader_key.to_storable()};
-  return memory_cache::get_base(key, load_fn);
+  return memory_cache::get_base(key, load_fn, deserialize_fn);
 }
 
 }  // namespace blender::memory_cache
@@ -9,6 +9,7 @@
  */
 
 #include <algorithm>
+#include <array>
 #include <cfloat>
 #include <cmath>
 #include <cstdint>
@@ -19,6 +20,7 @@
 #include "BLI_math_numbers.hh"
 #include "BLI_math_vector.hh"
 #include "BLI_noise.hh"
+#include "BLI_simd.hh"
 #include "BLI_utildefines.h"
 
 /* Some noise functions integer overflow as part of expected operation. */
@@ -1122,6 +1124,336 @@ float3 perlin_float3_fractal_distorted(float4 position,
                                       normalize));
 }
 
+/* Batched Perlin noise.
+ *
+ * The SIMD versions below evaluate four positions at once and perform exactly the same
+ * floating point operations as the scalar functions, so that both give the same results. */
+
+/** Positions are processed in chunks of this size, to keep temporary buffers on the stack. */
+static constexpr int64_t noise_batch_chunk_size = 256;
+
+#if BLI_HAVE_SSE4
+
+template<int k> BLI_INLINE __m128i hash_bit_rotate_simd(const __m128i x)
+{
+  return _mm_or_si128(_mm_slli_epi32(x, k), _mm_srli_epi32(x, 32 - k));
+}
+
+/** See #hash_bit_final. */
+BLI_INLINE void hash_bit_final_simd(__m128i &a, __m128i &b, __m128i &c)
+{
+  c = _mm_xor_si128(c, b);
+  c = _mm_sub_epi32(c, hash_bit_rotate_simd<14>(b));
+  a = _mm_xor_si128(a, c);
+  a = _mm_sub_epi32(a, hash_bit_rotate_simd<11>(c));
+  b = _mm_xor_si128(b, a);
+  b = _mm_sub_epi32(b, hash_bit_rotate_simd<25>(a));
+  c = _mm_xor_si128(c, b);
+  c = _mm_sub_epi32(c, hash_bit_rotate_simd<16>(b));
+  a = _mm_xor_si128(a, c);
+  a = _mm_sub_epi32(a, hash_bit_rotate_simd<4>(c));
+  b = _mm_xor_si128(b, a);
+  b = _mm_sub_epi32(b, hash_bit_rotate_simd<14>(a));
+  c = _mm_xor_si128(c, b);
+  c = _mm_sub_epi32(c, hash_bit_rotate_simd<24>(b));
+}
+
+/** See #hash(uint32_t, uint32_t, uint32_t). */
+BLI_INLINE __m128i hash_simd(const __m128i kx, const __m128i ky, const __m128i kz)
+{
+  const __m128i init = _mm_set1_epi32(int(0xdeadbeef + (3 << 2) + 13));
+  __m128i a = _mm_add_epi32(init, kx);
+  __m128i b = _mm_add_epi32(init, ky);
+  __m128i c = _mm_add_epi32(init, kz);
+  hash_bit_final_simd(a, b, c);
+  return c;
+}
+
+/** See #fade, the polynomial is evaluated in double precision like in the scalar version. */
+BLI_INLINE __m128 fade_simd(const __m128 t)
+{
+  const __m128 t3 = _mm_mul_ps(_mm_mul_ps(t, t), t);
+  const auto polynomial = [](const __m128d t) {
+    return _mm_add_pd(
+        _mm_mul_pd(t, _mm_sub_pd(_mm_mul_pd(t, _mm_set1_pd(6.0)), _mm_set1_pd(15.0))),
+        _mm_set1_pd(10.0));
+  };
+  const __m128d lo = _mm_mul_pd(_mm_cvtps_pd(t3), polynomial(_mm_cvtps_pd(t)));
+  const __m128d hi = _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(t3, t3)),
+                                polynomial(_mm_cvtps_pd(_mm_movehl_ps(t, t))));
+  return _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi));
+}
+
+/** See #negate_if, with bit #bit of the hash as condition. */
+template<int bit> BLI_INLINE __m128 negate_if_simd(const __m128 value, const __m128i hash)
+{
+  const __m128i sign = _mm_slli_epi32(_mm_and_si128(hash, _mm_set1_epi32(1 << bit)), 31 - bit);
+  return _mm_xor_ps(value, _mm_castsi128_ps(sign));
+}
+
+/** See #noise_grad(uint32_t, float, float, float). */
+BLI_INLINE __m128 noise_grad_simd(const __m128i hash,
+                                  const __m128 x,
+                                  const __m128 y,
+                                  const __m128 z)
+{
+  const __m128i h = _mm_and_si128(hash, _mm_set1_epi32(15));
+  const __m128 u = _mm_blendv_ps(y, x, _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(8))));
+  const __m128i use_x = _mm_or_si128(_mm_cmpeq_epi32(h, _mm_set1_epi32(12)),
+                                     _mm_cmpeq_epi32(h, _mm_set1_epi32(14)));
+  const __m128 vt = _mm_blendv_ps(z, x, _mm_castsi128_ps(use_x));
+  const __m128 v = _mm_blendv_ps(vt, y, _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(4))));
+  return _mm_add_ps(negate_if_simd<0>(u, h), negate_if_simd<1>(v, h));
+}
+
+/** See #mix(float, float, float, float, float, float, float, float, float, float, float). */
+BLI_INLINE __m128 mix_simd(const __m128 v[8], const __m128 x, const __m128 y, const __m128 z)
+{
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 x1 = _mm_sub_ps(one, x);
+  const __m128 y1 = _mm_sub_ps(one, y);
+  const __m128 z1 = _mm_sub_ps(one, z);
+  const auto lerp_x = [&](const __m128 a, const __m128 b) {
+    return _mm_add_ps(_mm_mul_ps(a, x1), _mm_mul_ps(b, x));
+  };
+  const __m128 bottom = _mm_add_ps(_mm_mul_ps(y1, lerp_x(v[0], v[1])),
+                                   _mm_mul_ps(y, lerp_x(v[2], v[3])));
+  const __m128 top = _mm_add_ps(_mm_mul_ps(y1, lerp_x(v[4], v[5])),
+                                _mm_mul_ps(y, lerp_x(v[6], v[7])));
+  return _mm_add_ps(_mm_mul_ps(z1, bottom), _mm_mul_ps(z, top));
+}
+
+/** See #perlin_noise(float3). */
+BLI_INLINE __m128 perlin_noise_simd(const __m128 x, const __m128 y, const __m128 z)
+{
+  const __m128 x_floor = _mm_floor_ps(x);
+  const __m128 y_floor = _mm_floor_ps(y);
+  const __m128 z_floor = _mm_floor_ps(z);
+  const __m128i X = _mm_cvttps_epi32(x_floor);
+  const __m128i Y = _mm_cvttps_epi32(y_floor);
+  const __m128i Z = _mm_cvttps_epi32(z_floor);
+  const __m128 fx = _mm_sub_ps(x, x_floor);
+  const __m128 fy = _mm_sub_ps(y, y_floor);
+  const __m128 fz = _mm_sub_ps(z, z_floor);
+
+  const __m128i one_i = _mm_set1_epi32(1);
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128i X1 = _mm_add_epi32(X, one_i);
+  const __m128i Y1 = _mm_add_epi32(Y, one_i);
+  const __m128i Z1 = _mm_add_epi32(Z, one_i);
+  const __m128 fx1 = _mm_sub_ps(fx, one);
+  const __m128 fy1 = _mm_sub_ps(fy, one);
+  const __m128 fz1 = _mm_sub_ps(fz, one);
+
+  const __m128 v[8] = {
+      noise_grad_simd(hash_simd(X, Y, Z), fx, fy, fz),
+      noise_grad_simd(hash_simd(X1, Y, Z), fx1, fy, fz),
+      noise_grad_simd(hash_simd(X, Y1, Z), fx, fy1, fz),
+      noise_grad_simd(hash_simd(X1, Y1, Z), fx1, fy1, fz),
+      noise_grad_simd(hash_simd(X, Y, Z1), fx, fy, fz1),
+      noise_grad_simd(hash_simd(X1, Y, Z1), fx1, fy, fz1),
+      noise_grad_simd(hash_simd(X, Y1, Z1), fx, fy1, fz1),
+      noise_grad_simd(hash_simd(X1, Y1, Z1), fx1, fy1, fz1),
+  };
+  return mix_simd(v, fade_simd(fx), fade_simd(fy), fade_simd(fz));
+}
+
+#endif /* BLI_HAVE_SSE4 */
+
+void perlin_signed_batch(const Span<float3> positions, MutableSpan<float> r_values)
+{
+  BLI_assert(positions.size() == r_values.size());
+  int64_t i = 0;
+#if BLI_HAVE_SSE4
+  /* Larger coordinates are wrapped in #perlin_signed, which is left to the scalar version. */
+  const __m128 max_coordinate = _mm_set1_ps(100000.0f);
+  const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  for (; i + 4 <= positions.size(); i += 4) {
+    const float3 *p = &positions[i];
+    const __m128 x = _mm_setr_ps(p[0].x, p[1].x, p[2].x, p[3].x);
+    const __m128 y = _mm_setr_ps(p[0].y, p[1].y, p[2].y, p[3].y);
+    const __m128 z = _mm_setr_ps(p[0].z, p[1].z, p[2].z, p[3].z);
+    const __m128 max_abs = _mm_max_ps(
+        _mm_and_ps(x, abs_mask), _mm_max_ps(_mm_and_ps(y, abs_mask), _mm_and_ps(z, abs_mask)));
+    if (UNLIKELY(_mm_movemask_ps(_mm_cmplt_ps(max_abs, max_coordinate)) != 0xF)) {
+      for (const int j : IndexRange(4)) {
+        r_values[i + j] = perlin_signed(p[j]);
+      }
+      continue;
+    }
+    _mm_storeu_ps(&r_values[i], _mm_mul_ps(perlin_noise_simd(x, y, z), _mm_set1_ps(0.9820f)));
+  }
+#endif
+  for (; i < positions.size(); i++) {
+    r_values[i] = perlin_signed(positions[i]);
+  }
+}
+
+/** Batched #perlin_fbm, with the same arithmetic for every position. */
+static void perlin_fbm_batch(const Span<float3> positions,
+                             const float detail,
+                             const float roughness,
+                             const float lacunarity,
+                             const bool normalize,
+                             MutableSpan<float> r_values)
+{
+  std::array<float3, noise_batch_chunk_size> scaled_buffer;
+  std::array<float, noise_batch_chunk_size> noise_buffer;
+  MutableSpan<float> sums = r_values;
+  const MutableSpan<float3> scaled = MutableSpan(scaled_buffer).take_front(positions.size());
+  const MutableSpan<float> noise = MutableSpan(noise_buffer).take_front(positions.size());
+
+  float fscale = 1.0f;
+  float amp = 1.0f;
+  float maxamp = 0.0f;
+  sums.fill(0.0f);
+
+  for (int i = 0; i <= int(detail); i++) {
+    for (const int64_t j : positions.index_range()) {
+      scaled[j] = fscale * positions[j];
+    }
+    perlin_signed_batch(scaled, noise);
+    for (const int64_t j : positions.index_range()) {
+      sums[j] += noise[j] * amp;
+    }
+    maxamp += amp;
+    amp *= roughness;
+    fscale *= lacunarity;
+  }
+  float rmd = detail - std::floor(detail);
+  if (rmd != 0.0f) {
+    for (const int64_t j : positions.index_range()) {
+      scaled[j] = fscale * positions[j];
+    }
+    perlin_signed_batch(scaled, noise);
+    for (const int64_t j : positions.index_range()) {
+      const float sum = sums[j];
+      const float sum2 = sum + noise[j] * amp;
+      r_values[j] = normalize ? mix(0.5f * sum / maxamp + 0.5f,
+                                    0.5f * sum2 / (maxamp + amp) + 0.5f,
+                                    rmd) :
+                                mix(sum, sum2, rmd);
+    }
+    return;
+  }
+  if (normalize) {
+    for (const int64_t j : positions.index_range()) {
+      r_values[j] = 0.5f * sums[j] / maxamp + 0.5f;
+    }
+  }
+}
+
+static void perlin_select_batch(const Span<float3> positions,
+                                const float detail,
+                                const float roughness,
+                                const float lacunarity,
+                                const float offset,
+                                const float gain,
+                                const int type,
+                                const bool normalize,
+                                MutableSpan<float> r_values)
+{
+  if (type == NOISE_SHD_PERLIN_FBM) {
+    perlin_fbm_batch(positions, detail, roughness, lacunarity, normalize, r_values);
+    return;
+  }
+  for (const int64_t i : positions.index_range()) {
+    r_values[i] = perlin_select<float3>(
+        positions[i], detail, roughness, lacunarity, offset, gain, type, normalize);
+  }
+}
+
+/** Batched `position += perlin_distortion(position, distortion)`. */
+static void perlin_distortion_batch(MutableSpan<float3> positions, const float distortion)
+{
+  std::array<float3, noise_batch_chunk_size> offset_buffer;
+  std::array<float, noise_batch_chunk_size> noise_buffer[3];
+  const MutableSpan<float3> offset_positions = MutableSpan(offset_buffer)
+                                                   .take_front(positions.size());
+  for (const int axis : IndexRange(3)) {
+    const float3 offset = random_float3_offset(float(axis));
+    for (const int64_t i : positions.index_range()) {
+      offset_positions[i] = positions[i] + offset;
+    }
+    perlin_signed_batch(offset_positions,
+                        MutableSpan(noise_buffer[axis]).take_front(positions.size()));
+  }
+  for (const int64_t i : positions.index_range()) {
+    positions[i] += float3(noise_buffer[0][i] * distortion,
+                           noise_buffer[1][i] * distortion,
+                           noise_buffer[2][i] * distortion);
+  }
+}
+
+void perlin_fractal_distorted_batch(const Span<float3> positions,
+                                    const float detail,
+                                    const float roughness,
+                                    const float lacunarity,
+                                    const float offset,
+                                    const float gain,
+                                    const float distortion,
+                                    const int type,
+                                    const bool normalize,
+                                    MutableSpan<float> r_values)
+{
+  BLI_assert(positions.size() == r_values.size());
+  std::array<float3, noise_batch_chunk_size> distorted_buffer;
+  for (int64_t start = 0; start < positions.size(); start += noise_batch_chunk_size) {
+    const IndexRange chunk(start, std::min(noise_batch_chunk_size, positions.size() - start));
+    const MutableSpan<float3> distorted = MutableSpan(distorted_buffer).take_front(chunk.size());
+    distorted.copy_from(positions.slice(chunk));
+    perlin_distortion_batch(distorted, distortion);
+    perlin_select_batch(distorted,
+                        detail,
+                        roughness,
+                        lacunarity,
+                        offset,
+                        gain,
+                        type,
+                        normalize,
+                        r_values.slice(chunk));
+  }
+}
+
+void perlin_float3_fractal_distorted_batch(const Span<float3> positions,
+                                           const float detail,
+                                           const float roughness,
+                                           const float lacunarity,
+                                           const float offset,
+                                           const float gain,
+                                           const float distortion,
+                                           const int type,
+                                           const bool normalize,
+                                           MutableSpan<float3> r_values)
+{
+  BLI_assert(positions.size() == r_values.size());
+  std::array<float3, noise_batch_chunk_size> distorted_buffer;
+  std::array<float3, noise_batch_chunk_size> offset_buffer;
+  std::array<float, noise_batch_chunk_size> values_buffer;
+  for (int64_t start = 0; start < positions.size(); start += noise_batch_chunk_size) {
+    const IndexRange chunk(start, std::min(noise_batch_chunk_size, positions.size() - start));
+    const MutableSpan<float3> distorted = MutableSpan(distorted_buffer).take_front(chunk.size());
+    const MutableSpan<float3> offset_positions = MutableSpan(offset_buffer)
+                                                     .take_front(chunk.size());
+    const MutableSpan<float> values = MutableSpan(values_buffer).take_front(chunk.size());
+    distorted.copy_from(positions.slice(chunk));
+    perlin_distortion_batch(distorted, distortion);
+    for (const int component : IndexRange(3)) {
+      /* The same seeds as in #perlin_float3_fractal_distorted. */
+      const float3 seed_offset = component == 0 ? float3(0.0f) :
+                                                  random_float3_offset(float(component + 2));
+      for (const int64_t i : chunk.index_range()) {
+        offset_positions[i] = component == 0 ? distorted[i] : distorted[i] + seed_offset;
+      }
+      perlin_select_batch(
+          offset_positions, detail, roughness, lacunarity, offset, gain, type, normalize, values);
+      for (const int64_t i : chunk.index_range()) {
+        r_values[chunk[i]][component] = values[i];
+      }
+    }
+  }
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -2198,6 +2530,246 @@ template float fractal_voronoi_distance_to_edge<float3>(const VoronoiParams &par
                                                         const float3 coord);
 template float fractal_voronoi_distance_to_edge<float4>(const VoronoiParams &params,
                                                         const float4 coord);
+
+/* Batched Voronoi noise. */
+
+#if BLI_HAVE_SSE4
+
+/** See #hash_pcg3d_i. */
+BLI_INLINE void hash_pcg3d_simd(__m128i &x, __m128i &y, __m128i &z)
+{
+  const __m128i mul = _mm_set1_epi32(1664525);
+  const __m128i add = _mm_set1_epi32(1013904223);
+  x = _mm_add_epi32(_mm_mullo_epi32(x, mul), add);
+  y = _mm_add_epi32(_mm_mullo_epi32(y, mul), add);
+  z = _mm_add_epi32(_mm_mullo_epi32(z, mul), add);
+  x = _mm_add_epi32(x, _mm_mullo_epi32(y, z));
+  y = _mm_add_epi32(y, _mm_mullo_epi32(z, x));
+  z = _mm_add_epi32(z, _mm_mullo_epi32(x, y));
+  x = _mm_xor_si128(x, _mm_srai_epi32(x, 16));
+  y = _mm_xor_si128(y, _mm_srai_epi32(y, 16));
+  z = _mm_xor_si128(z, _mm_srai_epi32(z, 16));
+  x = _mm_add_epi32(x, _mm_mullo_epi32(y, z));
+  y = _mm_add_epi32(y, _mm_mullo_epi32(z, x));
+  z = _mm_add_epi32(z, _mm_mullo_epi32(x, y));
+}
+
+/** See #int_to_float_01. */
+BLI_INLINE __m128 int_to_float_01_simd(const __m128i k)
+{
+  return _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(k, _mm_set1_epi32(0x7fffffff))),
+                    _mm_set1_ps(1.0f / float(0x7fffffff)));
+}
+
+/** See #voronoi_distance and #voronoi_distance_bound, for all metrics except Minkowski. */
+BLI_INLINE __m128 voronoi_distance_simd(const __m128 dx,
+                                        const __m128 dy,
+                                        const __m128 dz,
+                                        const int metric,
+                                        const bool bound)
+{
+  const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  switch (metric) {
+    case NOISE_SHD_VORONOI_MANHATTAN:
+      return _mm_add_ps(_mm_add_ps(_mm_and_ps(dx, abs_mask), _mm_and_ps(dy, abs_mask)),
+                        _mm_and_ps(dz, abs_mask));
+    case NOISE_SHD_VORONOI_CHEBYCHEV:
+      return _mm_max_ps(_mm_max_ps(_mm_and_ps(dx, abs_mask), _mm_and_ps(dy, abs_mask)),
+                        _mm_and_ps(dz, abs_mask));
+    default: {
+      const __m128 length_squared = _mm_add_ps(
+          _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+      return bound ? length_squared : _mm_sqrt_ps(length_squared);
+    }
+  }
+}
+
+/** See #voronoi_f1(const VoronoiParams &, const float3), for four coordinates at once. */
+static void voronoi_f1_simd(const VoronoiParams &params, const float3 *coords, VoronoiOutput *r)
+{
+  const __m128 x = _mm_setr_ps(coords[0].x, coords[1].x, coords[2].x, coords[3].x);
+  const __m128 y = _mm_setr_ps(coords[0].y, coords[1].y, coords[2].y, coords[3].y);
+  const __m128 z = _mm_setr_ps(coords[0].z, coords[1].z, coords[2].z, coords[3].z);
+  const __m128 cell_x_f = _mm_floor_ps(x);
+  const __m128 cell_y_f = _mm_floor_ps(y);
+  const __m128 cell_z_f = _mm_floor_ps(z);
+  const __m128 local_x = _mm_sub_ps(x, cell_x_f);
+  const __m128 local_y = _mm_sub_ps(y, cell_y_f);
+  const __m128 local_z = _mm_sub_ps(z, cell_z_f);
+  const __m128i cell_x = _mm_cvttps_epi32(cell_x_f);
+  const __m128i cell_y = _mm_cvttps_epi32(cell_y_f);
+  const __m128i cell_z = _mm_cvttps_epi32(cell_z_f);
+  const __m128 randomness = _mm_set1_ps(params.randomness);
+
+  __m128 min_distance = _mm_set1_ps(FLT_MAX);
+  __m128i target_offset_x = _mm_setzero_si128();
+  __m128i target_offset_y = _mm_setzero_si128();
+  __m128i target_offset_z = _mm_setzero_si128();
+  __m128 target_x = _mm_setzero_ps();
+  __m128 target_y = _mm_setzero_ps();
+  __m128 target_z = _mm_setzero_ps();
+  for (int k = -1; k <= 1; k++) {
+    for (int j = -1; j <= 1; j++) {
+      for (int i = -1; i <= 1; i++) {
+        const __m128i offset_x = _mm_set1_epi32(i);
+        const __m128i offset_y = _mm_set1_epi32(j);
+        const __m128i offset_z = _mm_set1_epi32(k);
+        __m128i hash_x = _mm_add_epi32(cell_x, offset_x);
+        __m128i hash_y = _mm_add_epi32(cell_y, offset_y);
+        __m128i hash_z = _mm_add_epi32(cell_z, offset_z);
+        hash_pcg3d_simd(hash_x, hash_y, hash_z);
+        const __m128 point_x = _mm_add_ps(
+            _mm_set1_ps(float(i)), _mm_mul_ps(int_to_float_01_simd(hash_x), randomness));
+        const __m128 point_y = _mm_add_ps(
+            _mm_set1_ps(float(j)), _mm_mul_ps(int_to_float_01_simd(hash_y), randomness));
+        const __m128 point_z = _mm_add_ps(
+            _mm_set1_ps(float(k)), _mm_mul_ps(int_to_float_01_simd(hash_z), randomness));
+        const __m128 distance = voronoi_distance_simd(_mm_sub_ps(point_x, local_x),
+                                                      _mm_sub_ps(point_y, local_y),
+                                                      _mm_sub_ps(point_z, local_z),
+                                                      params.metric,
+                                                      true);
+        const __m128 closer = _mm_cmplt_ps(distance, min_distance);
+        const __m128i closer_i = _mm_castps_si128(closer);
+        min_distance = _mm_blendv_ps(min_distance, distance, closer);
+        target_offset_x = _mm_blendv_epi8(target_offset_x, offset_x, closer_i);
+        target_offset_y = _mm_blendv_epi8(target_offset_y, offset_y, closer_i);
+        target_offset_z = _mm_blendv_epi8(target_offset_z, offset_z, closer_i);
+        target_x = _mm_blendv_ps(target_x, point_x, closer);
+        target_y = _mm_blendv_ps(target_y, point_y, closer);
+        target_z = _mm_blendv_ps(target_z, point_z, closer);
+      }
+    }
+  }
+
+  float distance[4];
+  _mm_storeu_ps(distance,
+                voronoi_distance_simd(_mm_sub_ps(target_x, local_x),
+                                      _mm_sub_ps(target_y, local_y),
+                                      _mm_sub_ps(target_z, local_z),
+                                      params.metric,
+                                      false));
+  __m128i color_x = _mm_add_epi32(cell_x, target_offset_x);
+  __m128i color_y = _mm_add_epi32(cell_y, target_offset_y);
+  __m128i color_z = _mm_add_epi32(cell_z, target_offset_z);
+  hash_pcg3d_simd(color_x, color_y, color_z);
+  float color[3][4];
+  _mm_storeu_ps(color[0], int_to_float_01_simd(color_x));
+  _mm_storeu_ps(color[1], int_to_float_01_simd(color_y));
+  _mm_storeu_ps(color[2], int_to_float_01_simd(color_z));
+  float position[3][4];
+  _mm_storeu_ps(position[0], _mm_add_ps(target_x, cell_x_f));
+  _mm_storeu_ps(position[1], _mm_add_ps(target_y, cell_y_f));
+  _mm_storeu_ps(position[2], _mm_add_ps(target_z, cell_z_f));
+  for (const int lane : IndexRange(4)) {
+    r[lane].distance = distance[lane];
+    r[lane].color = float3(color[0][lane], color[1][lane], color[2][lane]);
+    r[lane].position = float4(position[0][lane], position[1][lane], position[2][lane], 0.0f);
+  }
+}
+
+#endif /* BLI_HAVE_SSE4 */
+
+/** Batched #voronoi_f1, for all positions of a chunk. */
+static void voronoi_f1_batch(const VoronoiParams &params,
+                             const Span<float3> coords,
+                             MutableSpan<VoronoiOutput> r_outputs)
+{
+  int64_t i = 0;
+#if BLI_HAVE_SSE4
+  if (params.metric != NOISE_SHD_VORONOI_MINKOWSKI) {
+    for (; i + 4 <= coords.size(); i += 4) {
+      voronoi_f1_simd(params, &coords[i], &r_outputs[i]);
+    }
+  }
+#endif
+  for (; i < coords.size(); i++) {
+    r_outputs[i] = voronoi_f1(params, coords[i]);
+  }
+}
+
+void fractal_voronoi_x_fx_batch(const VoronoiParams &params,
+                                const Span<float3> coords,
+                                const bool calc_color,
+                                MutableSpan<VoronoiOutput> r_outputs)
+{
+  BLI_assert(coords.size() == r_outputs.size());
+  const bool use_f1 = params.feature == NOISE_SHD_VORONOI_F1 ||
+                      (params.feature == NOISE_SHD_VORONOI_SMOOTH_F1 &&
+                       params.smoothness == 0.0f);
+  if (!use_f1) {
+    for (const int64_t i : coords.index_range()) {
+      r_outputs[i] = fractal_voronoi_x_fx<float3>(params, coords[i], calc_color);
+    }
+    return;
+  }
+
+  /* Same as #fractal_voronoi_x_fx, but every octave is computed for a whole chunk at once. */
+  std::array<float3, noise_batch_chunk_size> scaled_buffer;
+  std::array<VoronoiOutput, noise_batch_chunk_size> octave_buffer;
+  const bool zero_input = params.detail == 0.0f || params.roughness == 0.0f;
+  for (int64_t start = 0; start < coords.size(); start += noise_batch_chunk_size) {
+    const IndexRange chunk(start, std::min(noise_batch_chunk_size, coords.size() - start));
+    const MutableSpan<float3> scaled = MutableSpan(scaled_buffer).take_front(chunk.size());
+    const MutableSpan<VoronoiOutput> octaves = MutableSpan(octave_buffer)
+                                                   .take_front(chunk.size());
+    const MutableSpan<VoronoiOutput> outputs = r_outputs.slice(chunk);
+    outputs.fill(VoronoiOutput());
+
+    float amplitude = 1.0f;
+    float max_amplitude = 0.0f;
+    float scale = 1.0f;
+    for (int i = 0; i <= ceilf(params.detail); ++i) {
+      for (const int64_t j : chunk.index_range()) {
+        scaled[j] = coords[chunk[j]] * scale;
+      }
+      voronoi_f1_batch(params, scaled, octaves);
+
+      if (zero_input) {
+        max_amplitude = 1.0f;
+        outputs.copy_from(octaves);
+        break;
+      }
+      if (i <= params.detail) {
+        max_amplitude += amplitude;
+        for (const int64_t j : chunk.index_range()) {
+          VoronoiOutput &output = outputs[j];
+          output.distance += octaves[j].distance * amplitude;
+          output.color += octaves[j].color * amplitude;
+          output.position = mix(output.position, octaves[j].position / scale, amplitude);
+        }
+        scale *= params.lacunarity;
+        amplitude *= params.roughness;
+      }
+      else {
+        float remainder = params.detail - floorf(params.detail);
+        if (remainder != 0.0f) {
+          max_amplitude = mix(max_amplitude, max_amplitude + amplitude, remainder);
+          for (const int64_t j : chunk.index_range()) {
+            VoronoiOutput &output = outputs[j];
+            output.distance = mix(
+                output.distance, output.distance + octaves[j].distance * amplitude, remainder);
+            output.color = mix(
+                output.color, output.color + octaves[j].color * amplitude, remainder);
+            output.position = mix(output.position,
+                                  mix(output.position, octaves[j].position / scale, amplitude),
+                                  remainder);
+          }
+        }
+      }
+    }
+
+    for (VoronoiOutput &output : outputs) {
+      if (params.normalize) {
+        output.distance /= max_amplitude * params.max_distance;
+        output.color /= max_amplitude;
+      }
+      output.position = (params.scale != 0.0f) ? output.position / params.scale :
+                                                 float4{0.0f, 0.0f, 0.0f, 0.0f};
+    }
+  }
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
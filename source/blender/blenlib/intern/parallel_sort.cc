@@ -0,0 +1,116 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bli
+ */
+
+#include <algorithm>
+
+#include "BLI_array.hh"
+#include "BLI_math_base.h"
+#include "BLI_sort.hh"
+#include "BLI_task.hh"
+#include "BLI_threads.h"
+
+namespace blender {
+
+/* -------------------------------------------------------------------- */
+/** \name Counting Sort
+ * \{ */
+
+/** Chunks should be large enough that the overhead of computing their offsets is small. */
+static constexpr int64_t counting_sort_chunk_size_min = 8192;
+
+template<typename GetValueFn>
+static void counting_sort_impl(const Span<int> bucket_indices,
+                               const OffsetIndices<int> bucket_offsets,
+                               const GetValueFn &get_value,
+                               MutableSpan<int> r_values)
+{
+  BLI_assert(bucket_indices.size() == r_values.size());
+  BLI_assert(bucket_offsets.total_size() == r_values.size());
+  const int64_t size = bucket_indices.size();
+  const int64_t buckets_num = bucket_offsets.size();
+  if (size == 0) {
+    return;
+  }
+
+  /* Every thread counts its own chunk of the input, large inputs are split into as many chunks as
+   * there are threads. */
+  const int64_t chunks_num = std::clamp<int64_t>(
+      size / counting_sort_chunk_size_min, 1, BLI_system_thread_count());
+
+  if (chunks_num == 1) {
+    /* Counting per chunk and computing the offsets of every chunk is not worth it. */
+    Array<int> offsets(buckets_num, NoInitialization());
+    for (const int64_t bucket : IndexRange(buckets_num)) {
+      offsets[bucket] = bucket_offsets[bucket].start();
+    }
+    for (const int64_t i : IndexRange(size)) {
+      r_values[offsets[bucket_indices[i]]++] = get_value(i);
+    }
+    return;
+  }
+
+  const int64_t chunk_size = divide_ceil_ul(size, chunks_num);
+  Array<int> chunk_offsets(chunks_num * buckets_num);
+  threading::parallel_for(IndexRange(chunks_num), 1, [&](const IndexRange range) {
+    for (const int64_t chunk : range) {
+      MutableSpan<int> counts = chunk_offsets.as_mutable_span().slice(chunk * buckets_num,
+                                                                       buckets_num);
+      counts.fill(0);
+      for (const int bucket : bucket_indices.slice_safe(chunk * chunk_size, chunk_size)) {
+        counts[bucket]++;
+      }
+    }
+  });
+
+  /* Turn the counts into the destination of the first value of each chunk in every bucket. */
+  threading::parallel_for(IndexRange(buckets_num), 4096, [&](const IndexRange range) {
+    for (const int64_t bucket : range) {
+      int offset = bucket_offsets[bucket].start();
+      for (const int64_t chunk : IndexRange(chunks_num)) {
+        int &chunk_offset = chunk_offsets[chunk * buckets_num + bucket];
+        const int count = chunk_offset;
+        chunk_offset = offset;
+        offset += count;
+      }
+      BLI_assert(offset == bucket_offsets[bucket].one_after_last());
+    }
+  });
+
+  threading::parallel_for(IndexRange(chunks_num), 1, [&](const IndexRange range) {
+    for (const int64_t chunk : range) {
+      int *offsets = &chunk_offsets[chunk * buckets_num];
+      const int64_t start = chunk * chunk_size;
+      for (const int64_t i : IndexRange::from_begin_end(start, std::min(start + chunk_size, size)))
+      {
+        r_values[offsets[bucket_indices[i]]++] = get_value(i);
+      }
+    }
+  });
+}
+
+void parallel_counting_sort(const Span<int> bucket_indices,
+                            const OffsetIndices<int> bucket_offsets,
+                            const Span<int> values,
+                            MutableSpan<int> r_values)
+{
+  BLI_assert(values.size() == bucket_indices.size());
+  counting_sort_impl(
+      bucket_indices, bucket_offsets, [&](const int64_t i) { return values[i]; }, r_values);
+}
+
+void parallel_counting_sort(const Span<int> bucket_indices,
+                            const OffsetIndices<int> bucket_offsets,
+                            MutableSpan<int> r_indices)
+{
+  counting_sort_impl(
+      bucket_indices, bucket_offsets, [](const int64_t i) { return int(i); }, r_indices);
+}
+
+/** \} */
+
+}  // namespace blender
@@ -20,7 +20,9 @@
 #include "BLI_assert.h"
 #include "BLI_mempool.h"
 #include "BLI_task.h"
+#include "BLI_task.hh"
 #include "BLI_threads.h"
+#include "BLI_trace.hh"
 #include "BLI_vector.hh"
 
 #ifdef WITH_TBB
@@ -113,6 +115,7 @@ class Task {
 /* Execute task. */
 void Task::operator()() const
 {
+  blender::trace::ScopedEvent event("task_pool");
   run(pool, taskdata);
 }
 
@@ -126,9 +129,8 @@ class TBBTaskGroup : public tbb::task_group {
   TBBTaskGroup(eTaskPriority priority)
   {
 #  if TBB_INTERFACE_VERSION_MAJOR >= 12
-    /* TODO: support priorities in TBB 2021, where they are only available as
-     * part of task arenas, no longer for task groups. Or remove support for
-     * task priorities if they are no longer useful. */
+    /* Priorities are only available as part of task arenas in TBB 2021, see
+     * #TaskPool::tbb_arena. */
     UNUSED_VARS(priority);
 #  else
     switch (priority) {
@@ -163,6 +165,12 @@ struct TaskPool {
 #ifdef WITH_TBB
   /* TBB task pool. */
   std::unique_ptr<TBBTaskGroup> tbb_group;
+  /**
+   * Tasks of low priority pools run in the background task arena, so that they don't take
+   * threads away from evaluation. The tasks of a group must be waited for in the arena they run
+   * in, so the pool keeps using the same arena. Null for the default arena.
+   */
+  std::shared_ptr<tbb::task_arena> tbb_arena;
 #endif
   volatile bool is_suspended = false;
   blender::Vector<Task> suspended_tasks;
@@ -197,6 +205,10 @@ struct TaskPool {
 #ifdef WITH_TBB
         if (use_threads) {
           this->tbb_group = std::make_unique<TBBTaskGroup>(priority);
+          if (priority == TASK_PRIORITY_LOW) {
+            this->tbb_arena = blender::threading::detail::priority_class_arena_get(
+                blender::threading::TaskPriorityClass::Background);
+          }
         }
 #endif
         break;
@@ -326,6 +338,7 @@ struct TaskPool {
    * Tasks may be suspended until in all are created, to make it possible to
    * initialize data structures and create tasks in a single pass. */
   void tbb_task_pool_run(Task &&task);
+  void tbb_task_pool_wait();
   void tbb_task_pool_work_and_wait();
   void tbb_task_pool_cancel();
   bool tbb_task_pool_canceled();
@@ -363,7 +376,17 @@ void TaskPool::tbb_task_pool_run(Task &&task)
 #ifdef WITH_TBB
   else if (this->use_threads) {
     /* Execute in TBB task group. */
-    this->tbb_group->run(std::move(task));
+    if (this->tbb_arena) {
+#  if TBB_INTERFACE_VERSION >= 12080
+      /* Push the task into the arena without the calling thread joining it. */
+      this->tbb_arena->enqueue(this->tbb_group->defer(std::move(task)));
+#  else
+      this->tbb_arena->execute([&]() { this->tbb_group->run(std::move(task)); });
+#  endif
+    }
+    else {
+      this->tbb_group->run(std::move(task));
+    }
   }
 #endif
   else {
@@ -372,6 +395,25 @@ void TaskPool::tbb_task_pool_run(Task &&task)
   }
 }
 
+void TaskPool::tbb_task_pool_wait()
+{
+#ifdef WITH_TBB
+  /* This is called wait(), but internally it can actually do work. This
+   * matters because we don't want recursive usage of task pools to run
+   * out of threads and get stuck. */
+  if (this->tbb_arena) {
+    /* Make sure the lazy threading hints are send now, because they shouldn't be send out of an
+     * isolated region. */
+    blender::lazy_threading::send_hint();
+    blender::lazy_threading::ReceiverIsolation isolation;
+    this->tbb_arena->execute([&]() { this->tbb_group->wait(); });
+  }
+  else {
+    this->tbb_group->wait();
+  }
+#endif
+}
+
 void TaskPool::tbb_task_pool_work_and_wait()
 {
   BLI_assert(ELEM(this->type, TASK_POOL_TBB, TASK_POOL_TBB_SUSPENDED, TASK_POOL_NO_THREADS));
@@ -388,10 +430,7 @@ void TaskPool::tbb_task_pool_work_and_wait()
 
 #ifdef WITH_TBB
   if (this->use_threads) {
-    /* This is called wait(), but internally it can actually do work. This
-     * matters because we don't want recursive usage of task pools to run
-     * out of threads and get stuck. */
-    this->tbb_group->wait();
+    this->tbb_task_pool_wait();
   }
 #endif
 }
@@ -402,7 +441,7 @@ void TaskPool::tbb_task_pool_cancel()
 #ifdef WITH_TBB
   if (this->use_threads) {
     this->tbb_group->cancel();
-    this->tbb_group->wait();
+    this->tbb_task_pool_wait();
   }
 #endif
 }
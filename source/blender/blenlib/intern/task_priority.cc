@@ -0,0 +1,151 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bli
+ *
+ * Task arenas for the different priority classes of work.
+ */
+
+#include <algorithm>
+#include <array>
+
+#include "BLI_mutex.hh"
+#include "BLI_task.h"
+#include "BLI_task.hh"
+
+namespace blender::threading {
+
+#ifdef WITH_TBB
+
+struct PriorityClassArena {
+  Mutex mutex;
+  /**
+   * Created when it's used first, and recreated when the number of threads changes. Shared, so
+   * that work still running in an old arena can finish.
+   */
+  std::shared_ptr<tbb::task_arena> arena;
+  /** Number of threads the arena was created with. */
+  int arena_max_threads = 0;
+  /** Zero means the number of threads is not limited. */
+  int max_threads = 0;
+  bool max_threads_initialized = false;
+};
+
+static PriorityClassArena &get_class_arena(const TaskPriorityClass priority)
+{
+  static std::array<PriorityClassArena, 3> arenas;
+  return arenas[int(priority)];
+}
+
+static int default_max_threads(const TaskPriorityClass priority)
+{
+  switch (priority) {
+    case TaskPriorityClass::Interactive:
+    case TaskPriorityClass::Evaluation:
+      return 0;
+    case TaskPriorityClass::Background:
+      return std::max(1, BLI_task_scheduler_num_threads() / 2);
+  }
+  return 0;
+}
+
+std::shared_ptr<tbb::task_arena> detail::priority_class_arena_get(const TaskPriorityClass priority)
+{
+  PriorityClassArena &class_arena = get_class_arena(priority);
+  std::lock_guard lock{class_arena.mutex};
+  if (!class_arena.max_threads_initialized) {
+    class_arena.max_threads = default_max_threads(priority);
+    class_arena.max_threads_initialized = true;
+  }
+  const int num_threads = BLI_task_scheduler_num_threads();
+  const int max_threads = class_arena.max_threads == 0 ?
+                              num_threads :
+                              std::min(class_arena.max_threads, num_threads);
+  if (priority != TaskPriorityClass::Background && max_threads == num_threads) {
+    /* Interactive work and evaluation run in the default arena when they are not limited. */
+    return {};
+  }
+  if (class_arena.arena && class_arena.arena_max_threads != max_threads) {
+    /* The number of threads of the task scheduler changed. */
+    class_arena.arena.reset();
+  }
+  if (!class_arena.arena) {
+    /* No slots are reserved for external threads, so that tasks pushed into the arena always
+     * have worker threads processing them, even when nobody waits for them. */
+#  if TBB_INTERFACE_VERSION_MAJOR >= 12
+    tbb::task_arena::priority arena_priority = tbb::task_arena::priority::normal;
+    switch (priority) {
+      case TaskPriorityClass::Interactive:
+        arena_priority = tbb::task_arena::priority::high;
+        break;
+      case TaskPriorityClass::Evaluation:
+        arena_priority = tbb::task_arena::priority::normal;
+        break;
+      case TaskPriorityClass::Background:
+        arena_priority = tbb::task_arena::priority::low;
+        break;
+    }
+    class_arena.arena = std::make_shared<tbb::task_arena>(max_threads, 0, arena_priority);
+#  else
+    class_arena.arena = std::make_shared<tbb::task_arena>(max_threads, 0);
+#  endif
+    class_arena.arena_max_threads = max_threads;
+  }
+  return class_arena.arena;
+}
+
+#endif
+
+void run_with_priority(const TaskPriorityClass priority, const FunctionRef<void()> function)
+{
+#ifdef WITH_TBB
+  const std::shared_ptr<tbb::task_arena> arena = detail::priority_class_arena_get(priority);
+  if (!arena) {
+    function();
+    return;
+  }
+  /* Make sure the lazy threading hints are send now, because they shouldn't be send out of an
+   * isolated region. */
+  lazy_threading::send_hint();
+  lazy_threading::ReceiverIsolation isolation;
+
+  arena->execute(function);
+#else
+  UNUSED_VARS(priority);
+  function();
+#endif
+}
+
+void priority_class_max_threads_set(const TaskPriorityClass priority, const int max_threads)
+{
+#ifdef WITH_TBB
+  PriorityClassArena &class_arena = get_class_arena(priority);
+  std::lock_guard lock{class_arena.mutex};
+  if (class_arena.max_threads_initialized && class_arena.max_threads == max_threads) {
+    return;
+  }
+  class_arena.max_threads = std::max(max_threads, 0);
+  class_arena.max_threads_initialized = true;
+  /* The next use creates a new arena with the new number of threads. */
+  class_arena.arena.reset();
+#else
+  UNUSED_VARS(priority, max_threads);
+#endif
+}
+
+int priority_class_max_threads_get(const TaskPriorityClass priority)
+{
+#ifdef WITH_TBB
+  PriorityClassArena &class_arena = get_class_arena(priority);
+  std::lock_guard lock{class_arena.mutex};
+  return class_arena.max_threads_initialized ? class_arena.max_threads :
+                                               default_max_threads(priority);
+#else
+  UNUSED_VARS(priority);
+  return 0;
+#endif
+}
+
+}  // namespace blender::threading
@@ -18,6 +18,7 @@
 #include "BLI_task.h"
 #include "BLI_task.hh"
 #include "BLI_threads.h"
+#include "BLI_trace.hh"
 #include "BLI_vector.hh"
 
 #include "atomic_ops.h"
@@ -161,6 +162,14 @@ int BLI_task_parallel_thread_id(const TaskParallelTLS * /*tls*/)
 
 namespace blender::threading::detail {
 
+/** Run a part of a parallel loop, recording it when tracing. */
+static void parallel_for_run_task(const FunctionRef<void(IndexRange)> function,
+                                  const IndexRange range)
+{
+  trace::ScopedEvent event("parallel_for");
+  function(range);
+}
+
 #ifdef WITH_TBB
 static void parallel_for_impl_static_size(const IndexRange range,
                                           const int64_t grain_size,
@@ -168,7 +177,8 @@ static void parallel_for_impl_static_size(const IndexRange range,
 {
   tbb::parallel_for(tbb::blocked_range<int64_t>(range.first(), range.one_after_last(), grain_size),
                     [function](const tbb::blocked_range<int64_t> &subrange) {
-                      function(IndexRange(subrange.begin(), subrange.size()));
+                      parallel_for_run_task(function,
+                                            IndexRange(subrange.begin(), subrange.size()));
                     });
 }
 #endif /* WITH_TBB */
@@ -226,12 +236,12 @@ static void parallel_for_impl_accumulated_size_lookup(
   BLI_assert(!range.is_empty());
   if (range.size() == 1) {
     /* Can't subdivide further. */
-    function(range);
+    parallel_for_run_task(function, range);
     return;
   }
   const int64_t total_size = size_hints.lookup_accumulated_size(range);
   if (total_size <= grain_size) {
-    function(range);
+    parallel_for_run_task(function, range);
     return;
   }
   const int64_t middle = range.size() / 2;
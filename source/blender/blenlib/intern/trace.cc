@@ -0,0 +1,185 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bli
+ */
+
+#include <fmt/format.h>
+
+#include "CLG_log.h"
+
+#include "BLI_fileops.hh"
+#include "BLI_mutex.hh"
+#include "BLI_threads.h"
+#include "BLI_trace.hh"
+#include "BLI_vector.hh"
+
+static CLG_LogRef LOG = {"system.trace"};
+
+namespace blender::trace {
+
+namespace detail {
+std::atomic<bool> is_recording = false;
+}
+
+struct Event {
+  const char *name;
+  std::string detail;
+  detail::Clock::time_point start;
+  detail::Clock::duration duration;
+};
+
+/**
+ * Events of a single thread. Only that thread adds events, so the mutex is only contended when
+ * #start or #stop access the events of all threads.
+ */
+struct ThreadEvents {
+  int thread_id;
+  bool is_main;
+  Mutex mutex;
+  Vector<Event> events;
+};
+
+struct Recorder {
+  /** Protects the thread list, the file path and the start time. */
+  Mutex mutex;
+  std::string filepath;
+  detail::Clock::time_point start_time;
+  /** Kept after the threads exited, so that their events are written too. */
+  Vector<std::unique_ptr<ThreadEvents>> threads;
+};
+
+static Recorder &get_recorder()
+{
+  static Recorder recorder;
+  return recorder;
+}
+
+static ThreadEvents &get_thread_events()
+{
+  thread_local ThreadEvents *thread_events = nullptr;
+  if (!thread_events) {
+    /* Only locks the first time a thread records an event. */
+    Recorder &recorder = get_recorder();
+    std::lock_guard lock{recorder.mutex};
+    auto new_thread_events = std::make_unique<ThreadEvents>();
+    new_thread_events->thread_id = int(recorder.threads.size());
+    new_thread_events->is_main = BLI_thread_is_main();
+    thread_events = new_thread_events.get();
+    recorder.threads.append(std::move(new_thread_events));
+  }
+  return *thread_events;
+}
+
+void detail::record_event(const char *name, std::string detail, const Clock::time_point start)
+{
+  const Clock::time_point end = Clock::now();
+  ThreadEvents &thread_events = get_thread_events();
+  std::lock_guard lock{thread_events.mutex};
+  thread_events.events.append({name, std::move(detail), start, end - start});
+}
+
+static std::string json_escape(const StringRef str)
+{
+  std::string result;
+  result.reserve(str.size());
+  for (const char c : str) {
+    switch (c) {
+      case '"':
+        result += "\\\"";
+        break;
+      case '\\':
+        result += "\\\\";
+        break;
+      default:
+        if (uint8_t(c) < 0x20) {
+          result += fmt::format("\\u{:04x}", int(c));
+        }
+        else {
+          result += c;
+        }
+        break;
+    }
+  }
+  return result;
+}
+
+/**
+ * Write the events in the Chrome trace event format. The file is written directly instead of
+ * building a #io::serialize::Value first, because traces can contain millions of events.
+ */
+static void write_trace(const Recorder &recorder)
+{
+  fstream stream(recorder.filepath, std::ios::out);
+  if (!stream.is_open()) {
+    CLOG_ERROR(&LOG, "Failed to write trace to '%s'", recorder.filepath.c_str());
+    return;
+  }
+  /* Timestamps are in microseconds. */
+  const auto to_us = [](const detail::Clock::duration duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+  };
+  stream << "{\"traceEvents\":[\n";
+  bool is_first = true;
+  for (const std::unique_ptr<ThreadEvents> &thread : recorder.threads) {
+    std::lock_guard thread_lock{thread->mutex};
+    stream << (is_first ? "" : ",\n");
+    is_first = false;
+    const std::string thread_name = thread->is_main ?
+                                        "Main" :
+                                        fmt::format("Thread {}", thread->thread_id);
+    stream << fmt::format(
+        R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":"{}"}}}})",
+        thread->thread_id,
+        thread_name);
+    for (const Event &event : thread->events) {
+      if (event.start < recorder.start_time) {
+        /* Started before recording did, but only finished afterwards. */
+        continue;
+      }
+      stream << fmt::format(R"(,
+{{"name":"{}","cat":"{}","ph":"X","pid":1,"tid":{},"ts":{:.3f},"dur":{:.3f}}})",
+                            json_escape(event.detail.empty() ? event.name : event.detail),
+                            event.name,
+                            thread->thread_id,
+                            to_us(event.start - recorder.start_time),
+                            to_us(event.duration));
+    }
+  }
+  stream << "\n]}\n";
+  CLOG_INFO(&LOG, "Trace written to '%s'", recorder.filepath.c_str());
+}
+
+void start(const StringRefNull filepath)
+{
+  Recorder &recorder = get_recorder();
+  {
+    std::lock_guard lock{recorder.mutex};
+    recorder.filepath = filepath;
+    recorder.start_time = detail::Clock::now();
+    for (std::unique_ptr<ThreadEvents> &thread : recorder.threads) {
+      std::lock_guard thread_lock{thread->mutex};
+      thread->events.clear();
+    }
+  }
+  detail::is_recording = true;
+}
+
+void stop()
+{
+  if (!is_enabled()) {
+    return;
+  }
+  detail::is_recording = false;
+  Recorder &recorder = get_recorder();
+  std::lock_guard lock{recorder.mutex};
+  write_trace(recorder);
+  for (std::unique_ptr<ThreadEvents> &thread : recorder.threads) {
+    std::lock_guard thread_lock{thread->mutex};
+    thread->events.clear_and_shrink();
+  }
+}
+
+}  // namespace blender::trace
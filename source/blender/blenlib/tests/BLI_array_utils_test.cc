@@ -6,6 +6,7 @@
 
 #include "BLI_array_utils.h"
 #include "BLI_array_utils.hh"
+#include "BLI_math_vector_types.hh"
 #include "BLI_utildefines.h"
 #include "BLI_utildefines_stack.h"
 
@@ -291,3 +292,119 @@ TEST(array_utils, FindAllRanges5)
   const std::array data_cmp = {IndexRange(0, 1), IndexRange(3, 2), IndexRange(6, 1)};
   find_all_ranges_test(data, data_cmp);
 }
+
+namespace blender::array_utils::tests {
+
+/** Mask with both contiguous ranges and scattered indices, so that all code paths are used. */
+static IndexMask mixed_index_mask(const int64_t size, IndexMaskMemory &memory)
+{
+  return IndexMask::from_predicate(
+      IndexRange(size), GrainSize(1024), memory, [](const int64_t i) {
+        return (i / 1000) % 2 == 0 || i % 3 == 0;
+      });
+}
+
+template<typename T> static Array<T> test_values(const int64_t size)
+{
+  Array<T> values(size);
+  for (const int64_t i : values.index_range()) {
+    T value;
+    float *components = reinterpret_cast<float *>(&value);
+    for (const int64_t j : IndexRange(sizeof(T) / sizeof(float))) {
+      components[j] = float(i * 4 + j);
+    }
+    values[i] = value;
+  }
+  return values;
+}
+
+template<typename T> static void test_gather_scatter()
+{
+  const int64_t size = 20000;
+  const Array<T> src = test_values<T>(size);
+  IndexMaskMemory memory;
+  const IndexMask mask = mixed_index_mask(size, memory);
+
+  Array<T> gathered(mask.size());
+  gather(src.as_span(), mask, gathered.as_mutable_span());
+  mask.foreach_index([&](const int64_t i, const int64_t pos) {
+    EXPECT_EQ(gathered[pos], src[i]);
+  });
+
+  Array<T> gathered_generic(mask.size());
+  gather(GSpan(src.as_span()), mask, GMutableSpan(gathered_generic.as_mutable_span()));
+  EXPECT_EQ_SPAN<T>(gathered, gathered_generic);
+
+  Array<int> indices(mask.size());
+  mask.to_indices<int>(indices);
+  /* Reverse the indices, so that the last source element is read before others. */
+  std::reverse(indices.begin(), indices.end());
+  Array<T> gathered_indices(indices.size());
+  gather(src.as_span(), indices.as_span(), gathered_indices.as_mutable_span());
+  for (const int64_t i : indices.index_range()) {
+    EXPECT_EQ(gathered_indices[i], src[indices[i]]);
+  }
+
+  Array<T> scattered = test_values<T>(size);
+  const T zero = {};
+  scattered.fill(zero);
+  scatter(gathered.as_span(), mask, scattered.as_mutable_span());
+  for (const int64_t i : IndexRange(size)) {
+    EXPECT_EQ(scattered[i], mask.contains(i) ? src[i] : zero);
+  }
+}
+
+TEST(array_utils, GatherScatterFloat)
+{
+  test_gather_scatter<float>();
+}
+
+TEST(array_utils, GatherScatterFloat2)
+{
+  test_gather_scatter<float2>();
+}
+
+TEST(array_utils, GatherScatterFloat3)
+{
+  test_gather_scatter<float3>();
+}
+
+TEST(array_utils, GatherScatterFloat4)
+{
+  test_gather_scatter<float4>();
+}
+
+TEST(array_utils, CopyGroupToGroup)
+{
+  /* Group sizes that use every branch of the small copies. */
+  Array<int> offset_data(101);
+  for (const int i : IndexRange(100)) {
+    offset_data[i] = i % 25;
+  }
+  const OffsetIndices<int> offsets = offset_indices::accumulate_counts_to_offsets(offset_data);
+  const Array<float3> src = test_values<float3>(offsets.total_size());
+  IndexMaskMemory memory;
+  const IndexMask selection = IndexMask::from_predicate(
+      offsets.index_range(), GrainSize(1), memory, [](const int64_t i) { return i % 7 != 0; });
+
+  Array<float3> dst(src.size(), float3(-1.0f));
+  copy_group_to_group(offsets, offsets, selection, src.as_span(), dst.as_mutable_span());
+  for (const int64_t group : offsets.index_range()) {
+    for (const int64_t i : offsets[group]) {
+      EXPECT_EQ(dst[i], selection.contains(group) ? src[i] : float3(-1.0f));
+    }
+  }
+
+  Array<int> dst_offset_data(selection.size() + 1);
+  const OffsetIndices<int> dst_offsets = offset_indices::gather_selected_offsets(
+      offsets, selection, dst_offset_data);
+  Array<float3> dst_compressed(dst_offsets.total_size());
+  gather_group_to_group(
+      offsets, dst_offsets, selection, src.as_span(), dst_compressed.as_mutable_span());
+  selection.foreach_index([&](const int64_t group, const int64_t pos) {
+    EXPECT_EQ_SPAN<float3>(src.as_span().slice(offsets[group]),
+                           dst_compressed.as_span().slice(dst_offsets[pos]));
+  });
+}
+
+}  // namespace blender::array_utils::tests
@@ -0,0 +1,125 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include <algorithm>
+#include <zstd.h>
+
+#include "BLI_filereader.h"
+#include "BLI_vector.hh"
+
+namespace blender::tests {
+
+static Vector<char> filereader_test_data(const int64_t size)
+{
+  Vector<char> data(size);
+  for (const int64_t i : data.index_range()) {
+    /* Compressible, but not trivially. */
+    data[i] = char((i * 7) ^ (i >> 5));
+  }
+  return data;
+}
+
+static void append_u32(Vector<char> &dst, const uint32_t value)
+{
+  dst.extend(Span(reinterpret_cast<const char *>(&value), sizeof(uint32_t)));
+}
+
+/** Compress the data into independent frames followed by a seek table, like the file writer. */
+static Vector<char> zstd_compress_seekable(const Span<char> data, const int64_t frame_size)
+{
+  Vector<char> result;
+  Vector<std::pair<uint32_t, uint32_t>> frame_sizes;
+  for (int64_t start = 0; start < data.size(); start += frame_size) {
+    const Span<char> frame = data.slice(start, std::min(frame_size, data.size() - start));
+    Vector<char> compressed(ZSTD_compressBound(frame.size()));
+    const size_t compressed_size = ZSTD_compress(
+        compressed.data(), compressed.size(), frame.data(), frame.size(), 3);
+    EXPECT_FALSE(ZSTD_isError(compressed_size));
+    result.extend(compressed.as_span().take_front(compressed_size));
+    frame_sizes.append({uint32_t(compressed_size), uint32_t(frame.size())});
+  }
+
+  /* Seek table in a skippable frame. */
+  append_u32(result, 0x184D2A5E);
+  append_u32(result, uint32_t(frame_sizes.size() * 8 + 9));
+  for (const auto [compressed_size, uncompressed_size] : frame_sizes) {
+    append_u32(result, compressed_size);
+    append_u32(result, uncompressed_size);
+  }
+  append_u32(result, uint32_t(frame_sizes.size()));
+  result.append(0);
+  append_u32(result, 0x8F92EAB1);
+  return result;
+}
+
+TEST(filereader_zstd, SeekableSequentialRead)
+{
+  /* Use more frames than are read ahead at once. */
+  const Vector<char> data = filereader_test_data(1000003);
+  const Vector<char> compressed = zstd_compress_seekable(data, 4096);
+
+  FileReader *reader = BLI_filereader_new_zstd(
+      BLI_filereader_new_memory(compressed.data(), compressed.size()));
+  ASSERT_NE(reader, nullptr);
+  EXPECT_NE(reader->seek, nullptr);
+
+  Vector<char> result(data.size());
+  int64_t offset = 0;
+  while (offset < result.size()) {
+    /* Reads that are not aligned to the frames. */
+    const int64_t size = std::min<int64_t>(1000, result.size() - offset);
+    ASSERT_EQ(reader->read(reader, result.data() + offset, size), size);
+    offset += size;
+  }
+  char extra;
+  EXPECT_EQ(reader->read(reader, &extra, 1), 0);
+  reader->close(reader);
+
+  EXPECT_EQ(result.as_span(), data.as_span());
+}
+
+TEST(filereader_zstd, SeekableRandomRead)
+{
+  const Vector<char> data = filereader_test_data(300001);
+  const Vector<char> compressed = zstd_compress_seekable(data, 1024);
+
+  FileReader *reader = BLI_filereader_new_zstd(
+      BLI_filereader_new_memory(compressed.data(), compressed.size()));
+  ASSERT_NE(reader, nullptr);
+  ASSERT_NE(reader->seek, nullptr);
+
+  /* Jump back and forth, within frames and across frame boundaries. */
+  for (const int64_t start : {200000, 10, 1020, 299990, 0, 150000, 1024, 5000}) {
+    const int64_t size = std::min<int64_t>(3000, data.size() - start);
+    Vector<char> result(size);
+    ASSERT_EQ(reader->seek(reader, start, SEEK_SET), start);
+    ASSERT_EQ(reader->read(reader, result.data(), size), size);
+    EXPECT_EQ(result.as_span(), data.as_span().slice(start, size));
+  }
+  reader->close(reader);
+}
+
+TEST(filereader_zstd, NonSeekableRead)
+{
+  const Vector<char> data = filereader_test_data(100000);
+  Vector<char> compressed(ZSTD_compressBound(data.size()));
+  const size_t compressed_size = ZSTD_compress(
+      compressed.data(), compressed.size(), data.data(), data.size(), 3);
+  ASSERT_FALSE(ZSTD_isError(compressed_size));
+
+  FileReader *reader = BLI_filereader_new_zstd(
+      BLI_filereader_new_memory(compressed.data(), compressed_size));
+  ASSERT_NE(reader, nullptr);
+  EXPECT_EQ(reader->seek, nullptr);
+
+  Vector<char> result(data.size());
+  ASSERT_EQ(reader->read(reader, result.data(), result.size()), result.size());
+  reader->close(reader);
+
+  EXPECT_EQ(result.as_span(), data.as_span());
+}
+
+}  // namespace blender::tests
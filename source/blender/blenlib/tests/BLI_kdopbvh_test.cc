@@ -8,7 +8,9 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_array.hh"
 #include "BLI_compiler_attrs.h"
+#include "BLI_index_mask.hh"
 #include "BLI_kdopbvh.hh"
 #include "BLI_math_vector.h"
 #include "BLI_rand.h"
@@ -68,11 +70,17 @@ static void optimal_check_callback(void *userdata,
  * Note that a small epsilon is added to the BVH nodes bounds, even if we pass in zero.
  * Use rounding to ensure very close nodes don't cause the wrong node to be found as nearest.
  */
-static void find_nearest_points_test(
-    int points_len, float scale, int round, int random_seed, bool optimal = false)
+static void find_nearest_points_test(int points_len,
+                                     float scale,
+                                     int round,
+                                     int random_seed,
+                                     bool optimal = false,
+                                     char tree_type = 8,
+                                     char axis = 8,
+                                     int balance_flag = 0)
 {
   RNG *rng = BLI_rng_new(random_seed);
-  BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, 8, 8);
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, tree_type, axis);
 
   void *mem = MEM_malloc_arrayN<float[3]>(size_t(points_len), __func__);
   float (*points)[3] = (float (*)[3])mem;
@@ -81,7 +89,7 @@ static void find_nearest_points_test(
     rng_v3_round(points[i], 3, rng, round, scale);
     BLI_bvhtree_insert(tree, i, points[i], 1);
   }
-  BLI_bvhtree_balance(tree);
+  BLI_bvhtree_balance_ex(tree, balance_flag);
 
   /* first find each point */
   BVHTree_NearestPointCallback callback = optimal ? optimal_check_callback : nullptr;
@@ -134,3 +142,139 @@ TEST(kdopbvh, OptimalFindNearest_500)
 {
   find_nearest_points_test(500, 1.0, 1000, 12, true);
 }
+
+TEST(kdopbvh, FindNearestSAH_500)
+{
+  find_nearest_points_test(500, 1.0, 1000, 12, false, 4, 8, BVH_BALANCE_SAH);
+}
+TEST(kdopbvh, FindNearestWide_500)
+{
+  find_nearest_points_test(500, 1.0, 1000, 12, false, 2, 6, BVH_BALANCE_SAH | BVH_BALANCE_WIDE);
+  find_nearest_points_test(500, 1.0, 1000, 12, false, 4, 6, BVH_BALANCE_WIDE);
+}
+TEST(kdopbvh, OptimalFindNearestWide_500)
+{
+  find_nearest_points_test(500, 1.0, 1000, 12, true, 2, 6, BVH_BALANCE_SAH | BVH_BALANCE_WIDE);
+}
+
+/** Refit a copy of a tree for new positions, after freeing the original tree. */
+static void copy_refit_test(int points_len, int random_seed, int balance_flag)
+{
+  RNG *rng = BLI_rng_new(random_seed);
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, 2, 6);
+  blender::Array<blender::float3> points(points_len);
+  for (int i = 0; i < points_len; i++) {
+    rng_v3_round(points[i], 3, rng, 1000, 1.0f);
+    BLI_bvhtree_insert(tree, i, points[i], 1);
+  }
+  BLI_bvhtree_balance_ex(tree, balance_flag);
+
+  BVHTree *tree_copy = BLI_bvhtree_copy(tree);
+  BLI_bvhtree_free(tree);
+  EXPECT_EQ(BLI_bvhtree_get_len(tree_copy), points_len);
+
+  for (int i = 0; i < points_len; i++) {
+    rng_v3_round(points[i], 3, rng, 1000, 10.0f);
+    BLI_bvhtree_update_node(tree_copy, i, points[i], nullptr, 1);
+  }
+  BLI_bvhtree_update_tree(tree_copy);
+
+  for (int i = 0; i < points_len; i++) {
+    const int j = BLI_bvhtree_find_nearest(tree_copy, points[i], nullptr, nullptr, nullptr);
+    EXPECT_GE(j, 0);
+    EXPECT_LT(j, points_len);
+    EXPECT_EQ_ARRAY(points[i], points[j], 3);
+  }
+  BLI_bvhtree_free(tree_copy);
+  BLI_rng_free(rng);
+}
+
+TEST(kdopbvh, CopyRefit_500)
+{
+  copy_refit_test(500, 1234, 0);
+}
+
+TEST(kdopbvh, CopyRefitWide_500)
+{
+  copy_refit_test(500, 1234, BVH_BALANCE_SAH | BVH_BALANCE_WIDE);
+}
+
+static BVHTree *raycast_boxes_tree(const float (*boxes)[2][3],
+                                   int boxes_len,
+                                   char tree_type,
+                                   int balance_flag)
+{
+  BVHTree *tree = BLI_bvhtree_new(boxes_len, 0.0, tree_type, 6);
+  for (int i = 0; i < boxes_len; i++) {
+    BLI_bvhtree_insert(tree, i, boxes[i][0], 2);
+  }
+  BLI_bvhtree_balance_ex(tree, balance_flag);
+  return tree;
+}
+
+/**
+ * Compare ray-casts on trees built with the given flags against the default tree. Without a
+ * callback the distance to the hit bounding box is returned, which doesn't depend on the tree.
+ */
+static void raycast_boxes_test(int boxes_len, int rays_len, int random_seed, float radius)
+{
+  using namespace blender;
+  RNG *rng = BLI_rng_new(random_seed);
+
+  Array<float[2][3]> boxes(boxes_len);
+  for (int i = 0; i < boxes_len; i++) {
+    rng_v3_round(boxes[i][0], 3, rng, 1000, 10.0f);
+    for (int axis = 0; axis < 3; axis++) {
+      boxes[i][1][axis] = boxes[i][0][axis] + BLI_rng_get_float(rng);
+    }
+  }
+  Array<float3> origins(rays_len);
+  Array<float3> directions(rays_len);
+  for (int i = 0; i < rays_len; i++) {
+    rng_v3_round(origins[i], 3, rng, 1000, 12.0f);
+    do {
+      rng_v3_round(directions[i], 3, rng, 1000, 1.0f);
+    } while (normalize_v3(directions[i]) == 0.0f);
+  }
+  /* Include axis aligned rays. */
+  directions[0] = float3(1.0f, 0.0f, 0.0f);
+  directions[1] = float3(0.0f, -1.0f, 0.0f);
+
+  BVHTree *tree_ref = raycast_boxes_tree(boxes.data(), boxes_len, 2, 0);
+  Array<BVHTreeRayHit> hits_ref(rays_len);
+  for (int i = 0; i < rays_len; i++) {
+    hits_ref[i].index = -1;
+    hits_ref[i].dist = BVH_RAYCAST_DIST_MAX;
+    BLI_bvhtree_ray_cast(
+        tree_ref, origins[i], directions[i], radius, &hits_ref[i], nullptr, nullptr);
+  }
+  BLI_bvhtree_free(tree_ref);
+
+  for (const char tree_type : {2, 4}) {
+    BVHTree *tree = raycast_boxes_tree(
+        boxes.data(), boxes_len, tree_type, BVH_BALANCE_SAH | BVH_BALANCE_WIDE);
+    Array<BVHTreeRayHit> hits(rays_len);
+    for (BVHTreeRayHit &hit : hits) {
+      hit.index = -1;
+      hit.dist = BVH_RAYCAST_DIST_MAX;
+    }
+    BLI_bvhtree_ray_cast_batch(
+        *tree, IndexMask(rays_len), origins, directions, radius, hits, nullptr, nullptr);
+    for (int i = 0; i < rays_len; i++) {
+      EXPECT_EQ(hits[i].index == -1, hits_ref[i].index == -1);
+      EXPECT_FLOAT_EQ(hits[i].dist, hits_ref[i].dist);
+    }
+    BLI_bvhtree_free(tree);
+  }
+
+  BLI_rng_free(rng);
+}
+
+TEST(kdopbvh, RayCastWide_1000)
+{
+  raycast_boxes_test(1000, 1000, 12, 0.0f);
+}
+TEST(kdopbvh, RayCastWideRadius_1000)
+{
+  raycast_boxes_test(1000, 1000, 123, 0.1f);
+}
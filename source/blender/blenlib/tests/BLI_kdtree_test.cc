@@ -5,6 +5,8 @@
 #include "testing/testing.h"
 
 #include "BLI_kdtree.h"
+#include "BLI_kdtree.hh"
+#include "BLI_rand.hh"
 
 #include <cmath>
 
@@ -63,3 +65,143 @@ TEST(kdtree, Deduplicate)
 {
   deduplicate_test();
 }
+
+/* -------------------------------------------------------------------- */
+/* C++ KD-tree Tests */
+
+namespace blender::kdtree::tests {
+
+static Array<float3> random_positions(const int size, const int seed)
+{
+  RandomNumberGenerator rng(seed);
+  Array<float3> positions(size);
+  for (float3 &position : positions) {
+    position = rng.get_unit_float3() * rng.get_float();
+  }
+  return positions;
+}
+
+static int find_nearest_brute_force(const Span<float3> positions,
+                                    const float3 &co,
+                                    const int skip_index = -1)
+{
+  int nearest = -1;
+  float nearest_dist_sq = std::numeric_limits<float>::max();
+  for (const int i : positions.index_range()) {
+    const float dist_sq = math::distance_squared(positions[i], co);
+    if (i != skip_index && dist_sq < nearest_dist_sq) {
+      nearest = i;
+      nearest_dist_sq = dist_sq;
+    }
+  }
+  return nearest;
+}
+
+TEST(kdtree_cpp, Empty)
+{
+  const KDTree3 tree;
+  EXPECT_EQ(tree.find_nearest(float3(0.0f)), -1);
+  Array<int> indices(2);
+  tree.find_nearest_batch(Span<float3>{float3(0.0f), float3(1.0f)}, indices);
+  EXPECT_EQ(indices[0], -1);
+  EXPECT_EQ(indices[1], -1);
+}
+
+TEST(kdtree_cpp, FindNearest)
+{
+  for (const int size : {1, 2, 3, 10, 1000, 10000}) {
+    const Array<float3> positions = random_positions(size, size);
+    const KDTree3 tree(positions);
+    EXPECT_EQ(tree.size(), size);
+    const Array<float3> queries = random_positions(500, size + 1);
+    for (const float3 &co : queries) {
+      float dist_sq;
+      const int nearest = tree.find_nearest(co, &dist_sq);
+      EXPECT_EQ(nearest, find_nearest_brute_force(positions, co));
+      EXPECT_FLOAT_EQ(dist_sq, math::distance_squared(positions[nearest], co));
+    }
+  }
+}
+
+TEST(kdtree_cpp, FindNearestBatch)
+{
+  const Array<float3> positions = random_positions(10000, 0);
+  const KDTree3 tree(positions);
+  const Array<float3> queries = random_positions(5000, 1);
+  Array<int> indices(queries.size());
+  Array<float> dists_sq(queries.size());
+  tree.find_nearest_batch(queries, indices, dists_sq);
+  for (const int i : queries.index_range()) {
+    EXPECT_EQ(indices[i], find_nearest_brute_force(positions, queries[i]));
+    EXPECT_FLOAT_EQ(dists_sq[i], math::distance_squared(positions[indices[i]], queries[i]));
+  }
+}
+
+TEST(kdtree_cpp, FindNearestBatchNonSelf)
+{
+  const Array<float3> positions = random_positions(5000, 2);
+  IndexMaskMemory memory;
+  const IndexMask mask = IndexMask::from_predicate(
+      positions.index_range(), GrainSize(1024), memory, [](const int i) { return i % 3 != 0; });
+  const KDTree3 tree(positions, mask);
+  EXPECT_EQ(tree.size(), mask.size());
+
+  Array<int> indices(positions.size(), -2);
+  tree.find_nearest_batch(
+      positions,
+      mask,
+      [](const int query, const int index) { return query != index; },
+      indices);
+  mask.foreach_index([&](const int i) {
+    int expected = -1;
+    float expected_dist_sq = std::numeric_limits<float>::max();
+    mask.foreach_index([&](const int j) {
+      const float dist_sq = math::distance_squared(positions[i], positions[j]);
+      if (i != j && dist_sq < expected_dist_sq) {
+        expected = j;
+        expected_dist_sq = dist_sq;
+      }
+    });
+    EXPECT_EQ(indices[i], expected);
+  });
+  EXPECT_EQ(indices[0], -2);
+}
+
+TEST(kdtree_cpp, RangeSearch)
+{
+  const Array<float3> positions = random_positions(5000, 3);
+  const KDTree3 tree(positions);
+  const float radius = 0.1f;
+  for (const float3 &co : random_positions(100, 4)) {
+    Vector<int> found;
+    tree.range_search(co, radius, [&](const int index, const float3 & /*co*/, float /*dist_sq*/) {
+      found.append(index);
+    });
+    Vector<int> expected;
+    for (const int i : positions.index_range()) {
+      if (math::distance_squared(positions[i], co) <= radius * radius) {
+        expected.append(i);
+      }
+    }
+    std::sort(found.begin(), found.end());
+    EXPECT_EQ(found.as_span(), expected.as_span());
+  }
+}
+
+TEST(kdtree_cpp, CalcDuplicates)
+{
+  Array<float2> positions(100);
+  for (const int i : positions.index_range()) {
+    positions[i] = float2(float(i % 10), 0.0f);
+  }
+  const KDTree2 tree(positions);
+  Array<int> duplicates(positions.size(), -1);
+  EXPECT_EQ(tree.calc_duplicates(0.01f, duplicates), 90);
+  /* Points are visited in index order, so they are merged into the first point at the same
+   * position. */
+  for (const int i : positions.index_range()) {
+    EXPECT_EQ(duplicates[i], i % 10);
+  }
+}
+
+}  // namespace blender::kdtree::tests
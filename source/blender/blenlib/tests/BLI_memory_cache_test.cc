@@ -2,9 +2,15 @@
  *
  * SPDX-License-Identifier: Apache-2.0 */
 
+#include <istream>
+#include <ostream>
+
+#include "BLI_fileops.h"
 #include "BLI_hash.hh"
 #include "BLI_memory_cache.hh"
 #include "BLI_memory_counter.hh"
+#include "BLI_path_utils.hh"
+#include "BLI_tempfile.h"
 
 #include "testing/testing.h"
 
@@ -56,6 +62,26 @@ class CachedInt : public memory_cache::CachedValue {
   }
 };
 
+class SerializableCachedInt : public CachedInt {
+ public:
+  using CachedInt::CachedInt;
+
+  bool serialize(std::ostream &stream) const override
+  {
+    stream.write(reinterpret_cast<const char *>(&this->value), sizeof(int));
+    return true;
+  }
+
+  static std::unique_ptr<SerializableCachedInt> deserialize(std::istream &stream)
+  {
+    int value;
+    if (!stream.read(reinterpret_cast<char *>(&value), sizeof(int))) {
+      return {};
+    }
+    return std::make_unique<SerializableCachedInt>(value);
+  }
+};
+
 TEST(memory_cache, Simple)
 {
   memory_cache::clear();
@@ -105,4 +131,46 @@ TEST(memory_cache, RemoveIf)
                })->value);
 }
 
+TEST(memory_cache, DiskCache)
+{
+  memory_cache::clear();
+
+  char temp_dir[FILE_MAX];
+  BLI_temp_directory_path_get(temp_dir, sizeof(temp_dir));
+  char cache_dir[FILE_MAX];
+  BLI_path_join(cache_dir, sizeof(cache_dir), temp_dir, "blender_memory_cache_test");
+  memory_cache::set_disk_cache_directory(cache_dir);
+  memory_cache::set_approximate_disk_size_limit(1024 * 1024);
+  /* Only leave space for two values in memory. */
+  memory_cache::set_approximate_size_limit(2 * sizeof(int) + 2);
+
+  for (const int i : {0, 1, 2}) {
+    memory_cache::get<SerializableCachedInt>(
+        GenericIntKey(i), [&]() { return std::make_unique<SerializableCachedInt>(i); });
+  }
+
+  /* The oldest value has been evicted from memory, but is still available from the disk cache,
+   * either from its file or because it is still being written. */
+  bool newly_computed = false;
+  EXPECT_EQ(0, memory_cache::get<SerializableCachedInt>(GenericIntKey(0), [&]() {
+                 newly_computed = true;
+                 return std::make_unique<SerializableCachedInt>(10);
+               })->value);
+  EXPECT_FALSE(newly_computed);
+
+  /* Removed values are removed from the disk cache too. */
+  memory_cache::clear();
+  EXPECT_EQ(10, memory_cache::get<SerializableCachedInt>(GenericIntKey(0), [&]() {
+                  newly_computed = true;
+                  return std::make_unique<SerializableCachedInt>(10);
+                })->value);
+  EXPECT_TRUE(newly_computed);
+
+  memory_cache::set_disk_cache_directory("");
+  memory_cache::set_approximate_disk_size_limit(0);
+  memory_cache::set_approximate_size_limit(1024 * 1024 * 1024);
+  memory_cache::clear();
+  BLI_delete(cache_dir, true, true);
+}
+
 }  // namespace blender::memory_cache::tests
@@ -0,0 +1,88 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_noise.hh"
+#include "BLI_rand.hh"
+
+namespace blender::noise::tests {
+
+static Array<float3> random_positions(const int size, const float range)
+{
+  RandomNumberGenerator rng(0);
+  Array<float3> positions(size);
+  for (float3 &position : positions) {
+    position = (float3(rng.get_float(), rng.get_float(), rng.get_float()) * 2.0f - 1.0f) * range;
+  }
+  /* Test the wrapping of large coordinates. */
+  positions[5].y = 250000.0f;
+  return positions;
+}
+
+TEST(noise, PerlinBatch)
+{
+  /* Not a multiple of the SIMD width and larger than a chunk. */
+  const Array<float3> positions = random_positions(1003, 50.0f);
+  Array<float> values(positions.size());
+  perlin_signed_batch(positions, values);
+  for (const int i : positions.index_range()) {
+    EXPECT_FLOAT_EQ(values[i], perlin_signed(positions[i]));
+  }
+
+  for (const int type : {0, 1, 3}) {
+    for (const float detail : {0.0f, 2.5f}) {
+      perlin_fractal_distorted_batch(
+          positions, detail, 0.5f, 2.0f, 1.0f, 1.0f, 0.3f, type, true, values);
+      for (const int i : positions.index_range()) {
+        EXPECT_FLOAT_EQ(values[i],
+                        perlin_fractal_distorted(
+                            positions[i], detail, 0.5f, 2.0f, 1.0f, 1.0f, 0.3f, type, true));
+      }
+    }
+  }
+
+  Array<float3> colors(positions.size());
+  perlin_float3_fractal_distorted_batch(
+      positions, 3.0f, 0.5f, 2.0f, 0.0f, 0.0f, 0.0f, 1, false, colors);
+  for (const int i : positions.index_range()) {
+    const float3 expected = perlin_float3_fractal_distorted(
+        positions[i], 3.0f, 0.5f, 2.0f, 0.0f, 0.0f, 0.0f, 1, false);
+    EXPECT_FLOAT_EQ(colors[i].x, expected.x);
+    EXPECT_FLOAT_EQ(colors[i].y, expected.y);
+    EXPECT_FLOAT_EQ(colors[i].z, expected.z);
+  }
+}
+
+TEST(noise, VoronoiBatch)
+{
+  const Array<float3> positions = random_positions(1003, 20.0f);
+  Array<VoronoiOutput> outputs(positions.size());
+  for (const int metric : {0, 1, 2}) {
+    for (const float detail : {0.0f, 1.5f}) {
+      VoronoiParams params{};
+      params.scale = 2.0f;
+      params.detail = detail;
+      params.roughness = 0.5f;
+      params.lacunarity = 2.0f;
+      params.randomness = 0.8f;
+      params.max_distance = 1.0f;
+      params.normalize = true;
+      params.feature = 0;
+      params.metric = metric;
+      fractal_voronoi_x_fx_batch(params, positions, true, outputs);
+      for (const int i : positions.index_range()) {
+        const VoronoiOutput expected = fractal_voronoi_x_fx<float3>(params, positions[i], true);
+        EXPECT_FLOAT_EQ(outputs[i].distance, expected.distance);
+        EXPECT_FLOAT_EQ(outputs[i].color.x, expected.color.x);
+        EXPECT_FLOAT_EQ(outputs[i].color.z, expected.color.z);
+        EXPECT_FLOAT_EQ(outputs[i].position.x, expected.position.x);
+        EXPECT_FLOAT_EQ(outputs[i].position.y, expected.position.y);
+      }
+    }
+  }
+}
+
+}  // namespace blender::noise::tests
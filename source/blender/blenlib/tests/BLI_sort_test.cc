@@ -0,0 +1,51 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include <algorithm>
+
+#include "BLI_array.hh"
+#include "BLI_rand.hh"
+#include "BLI_sort.hh"
+
+#include "BLI_strict_flags.h" /* IWYU pragma: keep. Keep last. */
+
+namespace blender::tests {
+
+TEST(sort, CountingSort)
+{
+  RandomNumberGenerator rng(0);
+  for (const int buckets_num : {1, 10, 1000, 100000}) {
+    Array<int> bucket_indices(100000);
+    for (int &bucket : bucket_indices) {
+      bucket = rng.get_int32(buckets_num);
+    }
+    Array<int> offset_data(buckets_num + 1, 0);
+    offset_indices::build_reverse_offsets(bucket_indices, offset_data);
+    const OffsetIndices<int> offsets(offset_data);
+
+    Array<int> indices(bucket_indices.size());
+    parallel_counting_sort(bucket_indices, offsets, indices);
+    for (const int64_t bucket : offsets.index_range()) {
+      const Span<int> bucket_values = indices.as_span().slice(offsets[bucket]);
+      EXPECT_TRUE(std::is_sorted(bucket_values.begin(), bucket_values.end()));
+      for (const int index : bucket_values) {
+        EXPECT_EQ(bucket_indices[index], bucket);
+      }
+    }
+
+    Array<int> values(bucket_indices.size());
+    for (const int64_t i : values.index_range()) {
+      values[i] = -int(i);
+    }
+    Array<int> sorted_values(values.size());
+    parallel_counting_sort(bucket_indices, offsets, values, sorted_values);
+    for (const int64_t i : indices.index_range()) {
+      EXPECT_EQ(sorted_values[i], -indices[i]);
+    }
+  }
+}
+
+}  // namespace blender::tests
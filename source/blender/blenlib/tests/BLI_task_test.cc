@@ -243,3 +243,50 @@ TEST(task, ParallelInvoke)
                                       [&]() { counter++; });
   EXPECT_EQ(counter, 6);
 }
+
+TEST(task, RunWithPriority)
+{
+  using namespace blender::threading;
+  const int old_max_threads = priority_class_max_threads_get(TaskPriorityClass::Background);
+  priority_class_max_threads_set(TaskPriorityClass::Background, 2);
+
+  std::atomic<int> counter = 0;
+  std::atomic<int> running = 0;
+  std::atomic<int> max_running = 0;
+  run_with_priority(TaskPriorityClass::Background, [&]() {
+    parallel_for(blender::IndexRange(ITEMS_NUM), 1, [&](const blender::IndexRange range) {
+      const int running_num = ++running;
+      int prev_max = max_running;
+      while (prev_max < running_num && !max_running.compare_exchange_weak(prev_max, running_num))
+      {
+      }
+      counter += int(range.size());
+      running--;
+    });
+  });
+  EXPECT_EQ(counter, ITEMS_NUM);
+  /* The work has been limited to the threads of the background class. */
+  EXPECT_LE(max_running, 2);
+
+  priority_class_max_threads_set(TaskPriorityClass::Background, old_max_threads);
+}
+
+TEST(task, CancellationToken)
+{
+  blender::threading::CancellationToken token;
+  const blender::threading::CancellationToken token_copy = token;
+  std::atomic<int> counter = 0;
+  blender::threading::parallel_for(
+      blender::IndexRange(ITEMS_NUM), 1, [&](const blender::IndexRange range) {
+        for ([[maybe_unused]] const int64_t i : range) {
+          if (token_copy.is_canceled()) {
+            return;
+          }
+          if (++counter == ITEMS_NUM / 2) {
+            token_copy.cancel();
+          }
+        }
+      });
+  EXPECT_TRUE(token.is_canceled());
+  EXPECT_LT(counter, ITEMS_NUM);
+}
@@ -0,0 +1,154 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include <atomic>
+#include <fstream>
+#include <thread>
+
+#include "BLI_fileops.h"
+#include "BLI_index_range.hh"
+#include "BLI_path_utils.hh"
+#include "BLI_serialize.hh"
+#include "BLI_tempfile.h"
+#include "BLI_trace.hh"
+#include "BLI_vector.hh"
+
+namespace blender::trace::tests {
+
+using namespace io::serialize;
+
+/** Duration events of the trace, with the thread metadata events skipped. */
+static Vector<const DictionaryValue *> trace_duration_events(const ArrayValue &events)
+{
+  Vector<const DictionaryValue *> result;
+  for (const std::shared_ptr<Value> &value : events.elements()) {
+    const DictionaryValue *event = value->as_dictionary_value();
+    EXPECT_NE(event, nullptr);
+    if (event && event->lookup_str("ph") == "X") {
+      result.append(event);
+    }
+  }
+  return result;
+}
+
+TEST(trace, ChromeTraceJson)
+{
+  char temp_dir[FILE_MAX];
+  BLI_temp_directory_path_get(temp_dir, sizeof(temp_dir));
+  char filepath[FILE_MAX];
+  BLI_path_join(filepath, sizeof(filepath), temp_dir, "blender_trace_test.json");
+
+  EXPECT_FALSE(is_enabled());
+  start(filepath);
+  EXPECT_TRUE(is_enabled());
+  {
+    ScopedEvent outer("test_outer");
+    {
+      /* Detail strings are escaped. */
+      ScopedEvent inner("test_inner", []() { return std::string("Detail \"quoted\"\n"); });
+    }
+  }
+  std::thread thread([]() { ScopedEvent event("test_thread"); });
+  thread.join();
+  stop();
+  EXPECT_FALSE(is_enabled());
+
+  /* Events recorded after stopping are ignored. */
+  {
+    ScopedEvent ignored("test_ignored");
+  }
+
+  std::ifstream stream(filepath);
+  ASSERT_TRUE(stream.is_open());
+  JsonFormatter json;
+  const std::shared_ptr<Value> root = json.deserialize(stream);
+  stream.close();
+  BLI_delete(filepath, false, false);
+
+  ASSERT_NE(root, nullptr);
+  ASSERT_NE(root->as_dictionary_value(), nullptr);
+  const ArrayValue *events = root->as_dictionary_value()->lookup_array("traceEvents");
+  ASSERT_NE(events, nullptr);
+
+  const Vector<const DictionaryValue *> duration_events = trace_duration_events(*events);
+  ASSERT_EQ(duration_events.size(), 3);
+  const DictionaryValue *outer = nullptr;
+  const DictionaryValue *inner = nullptr;
+  const DictionaryValue *thread_event = nullptr;
+  for (const DictionaryValue *event : duration_events) {
+    const std::optional<StringRefNull> category = event->lookup_str("cat");
+    ASSERT_TRUE(category.has_value());
+    if (*category == "test_outer") {
+      outer = event;
+    }
+    else if (*category == "test_inner") {
+      inner = event;
+    }
+    else if (*category == "test_thread") {
+      thread_event = event;
+    }
+  }
+  ASSERT_NE(outer, nullptr);
+  ASSERT_NE(inner, nullptr);
+  ASSERT_NE(thread_event, nullptr);
+
+  /* Events without detail are named after their type. */
+  EXPECT_EQ(outer->lookup_str("name"), "test_outer");
+  EXPECT_EQ(inner->lookup_str("name"), "Detail \"quoted\"\n");
+
+  /* The nested event lies within the outer one, on the same thread. */
+  EXPECT_EQ(outer->lookup_int("tid"), inner->lookup_int("tid"));
+  EXPECT_NE(outer->lookup_int("tid"), thread_event->lookup_int("tid"));
+  const double outer_start = *outer->lookup_double("ts");
+  const double outer_end = outer_start + *outer->lookup_double("dur");
+  const double inner_start = *inner->lookup_double("ts");
+  const double inner_end = inner_start + *inner->lookup_double("dur");
+  EXPECT_GE(inner_start, outer_start);
+  EXPECT_LE(inner_end, outer_end);
+  EXPECT_GE(*thread_event->lookup_double("ts"), outer_end);
+}
+
+TEST(trace, RestartWhileThreadRecords)
+{
+  char temp_dir[FILE_MAX];
+  BLI_temp_directory_path_get(temp_dir, sizeof(temp_dir));
+  char filepath[FILE_MAX];
+  BLI_path_join(filepath, sizeof(filepath), temp_dir, "blender_trace_restart_test.json");
+
+  /* Starting and stopping accesses the events of a thread that keeps recording. */
+  std::atomic<bool> finished = false;
+  std::thread thread([&]() {
+    while (!finished) {
+      ScopedEvent event("test_loop");
+    }
+  });
+  for ([[maybe_unused]] const int i : IndexRange(3)) {
+    start(filepath);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    stop();
+  }
+  finished = true;
+  thread.join();
+
+  std::ifstream stream(filepath);
+  ASSERT_TRUE(stream.is_open());
+  JsonFormatter json;
+  const std::shared_ptr<Value> root = json.deserialize(stream);
+  stream.close();
+  BLI_delete(filepath, false, false);
+
+  ASSERT_NE(root, nullptr);
+  ASSERT_NE(root->as_dictionary_value(), nullptr);
+  const ArrayValue *events = root->as_dictionary_value()->lookup_array("traceEvents");
+  ASSERT_NE(events, nullptr);
+
+  /* Events that started before the last recording are not included. */
+  for (const DictionaryValue *event : trace_duration_events(*events)) {
+    EXPECT_GE(*event->lookup_double("ts"), 0.0);
+  }
+}
+
+}  // namespace blender::trace::tests
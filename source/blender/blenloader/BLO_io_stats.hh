@@ -0,0 +1,85 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup blenloader
+ * \brief Statistics about reading and writing blend-files.
+ *
+ * Gathers the time spent in the different phases of loading and saving a file, and the time and
+ * bytes per ID type and per block code. This helps finding out which part of a file is expensive
+ * to load or save. Only gathered when enabled with the `--debug-io-stats` command line argument.
+ */
+
+#include <cstddef>
+
+#include "BLI_utility_mixins.hh"
+
+/** Phases of reading or writing a blend-file that are timed separately. */
+enum eBLOIOStatsPhase {
+  /** Reading blocks from the file, including decompression. */
+  BLO_IO_STATS_PHASE_READ_BLOCKS = 0,
+  /** Linking the data of read IDs (`blend_read_data`), summed over all threads. */
+  BLO_IO_STATS_PHASE_DIRECT_LINK,
+  /** Running versioning code, including the versioning after linking and after setup. */
+  BLO_IO_STATS_PHASE_VERSIONING,
+  /** Linking pointers between IDs. */
+  BLO_IO_STATS_PHASE_LIB_LINK,
+  /** Building and evaluating the dependency graph after loading a file. */
+  BLO_IO_STATS_PHASE_DEPSGRAPH,
+  /** Serializing IDs into blocks, summed over all threads. */
+  BLO_IO_STATS_PHASE_WRITE_IDS,
+  /** Writing blocks to the file, including compression. */
+  BLO_IO_STATS_PHASE_WRITE_BLOCKS,
+};
+#define BLO_IO_STATS_PHASE_NUM (BLO_IO_STATS_PHASE_WRITE_BLOCKS + 1)
+
+bool BLO_io_stats_is_enabled();
+/**
+ * Clear all gathered statistics, typically before reading or writing a new file.
+ */
+void BLO_io_stats_reset();
+
+/* All functions below are thread-safe. */
+
+void BLO_io_stats_phase_add(eBLOIOStatsPhase phase, double duration);
+/**
+ * \param code: The #BHead code of the block.
+ * \param size: Size of the block, including its header.
+ */
+void BLO_io_stats_block_add(bool is_write, int code, size_t size);
+/**
+ * \param count: Number of IDs to add, zero when only adding more time for already counted IDs.
+ */
+void BLO_io_stats_id_add(bool is_write, short idcode, int count, double duration, size_t size);
+
+/**
+ * Print the gathered statistics, and write them to the JSON file if one has been set.
+ *
+ * \param filepath: The file that has been read or written.
+ */
+void BLO_io_stats_report(const char *filepath);
+/**
+ * Set the file the statistics are written to by #BLO_io_stats_report, in JSON format.
+ */
+void BLO_io_stats_json_filepath_set(const char *filepath);
+
+/**
+ * Adds the time until it goes out of scope to a phase, when statistics are enabled. Time spent in
+ * nested phases on the same thread (e.g. blocks read on demand while linking data) is only added
+ * to the innermost phase.
+ */
+class BLOIOStatsScopedPhase : blender::NonCopyable, blender::NonMovable {
+ private:
+  eBLOIOStatsPhase phase_;
+  double start_time_;
+  /** Time spent in nested phases, excluded from this phase. */
+  double nested_time_ = 0.0;
+  BLOIOStatsScopedPhase *parent_ = nullptr;
+
+ public:
+  BLOIOStatsScopedPhase(eBLOIOStatsPhase phase, bool use_io_stats);
+  ~BLOIOStatsScopedPhase();
+};
@@ -30,6 +30,8 @@
 
 #pragma once
 
+#include <functional>
+
 #include "DNA_sdna_type_ids.hh"
 
 #include "BLI_function_ref.hh"
@@ -370,6 +372,37 @@ const blender::ImplicitSharingInfo *BLO_read_shared(
   return shared_data.sharing_info;
 }
 
+/**
+ * Reference an array of trivial data directly from the memory-mapped blend-file instead of
+ * copying it, when the "Zero-Copy Blend File Reading" experimental option is enabled. This only
+ * works for large arrays that don't need any conversion, and is meant to be used in the read
+ * callback of #BLO_read_shared.
+ *
+ * \return The sharing-info owning the referenced data, or null if the data can't be referenced
+ * from the file. Then the data has to be read with the regular `BLO_read_*_array` functions.
+ */
+const blender::ImplicitSharingInfo *BLO_read_mapped_array(BlendDataReader *reader,
+                                                          int64_t size_in_bytes,
+                                                          int64_t alignment,
+                                                          void **ptr_p);
+
+/**
+ * Defer reading a large array of trivial data of a linked ID until the ID is first needed, when
+ * the "Lazy Library Data" experimental option is enabled. Only the offset of the array in the
+ * library file is stored, see #BKE_libblock_lazy_data_ensure.
+ *
+ * \param assign: Called with the read array (allocated with the guarded allocator) once it is
+ * loaded, to give ownership of it to the ID. It must not depend on any pointer that may change
+ * before then, except for pointers into the ID itself.
+ *
+ * \return True if reading the array was deferred, `*ptr_p` is null then. Otherwise the data has
+ * to be read with the regular `BLO_read_*_array` functions.
+ */
+bool BLO_read_array_lazy(BlendDataReader *reader,
+                         int64_t size_in_bytes,
+                         void **ptr_p,
+                         std::function<void(void *data)> assign);
+
 int BLO_read_fileversion_get(BlendDataReader *reader);
 bool BLO_read_data_is_undo(BlendDataReader *reader);
 void BLO_read_data_globmap_add(BlendDataReader *reader, void *oldaddr, void *newaddr);
@@ -262,6 +262,13 @@ void BLO_datablock_info_linklist_free(LinkNode * /*BLODataBlockInfo*/ datablock_
  * \return A handle on success, or NULL on failure.
  */
 BlendHandle *BLO_blendhandle_from_file(const char *filepath, BlendFileReadReport *reports);
+/**
+ * Same as #BLO_blendhandle_from_file, for handles used to link or append data from the file.
+ * The file is then read as a library, e.g. with lazily loaded array data when the "Lazy Library
+ * Data" experimental option is enabled.
+ */
+BlendHandle *BLO_blendhandle_from_file_for_link(const char *filepath,
+                                                BlendFileReadReport *reports);
 /**
  * Open a blendhandle from memory.
  *
@@ -613,4 +620,24 @@ void BLO_readfile_id_runtime_data_free_all(Main &bmain);
  */
 void BLO_readfile_id_runtime_data_free(ID &id);
 
+/**
+ * Read the arrays of a linked ID that were deferred by #BLO_read_array_lazy from its library
+ * file. The arrays are zero-filled when the file was changed or removed since it was read.
+ * Use #BKE_libblock_lazy_data_ensure instead.
+ */
+void BLO_readfile_id_lazy_data_ensure(ID &id);
+/**
+ * Free the deferred data of an ID that was never loaded.
+ */
+void BLO_readfile_id_lazy_data_free(ID &id);
+
+/**
+ * Check whether any of the files that data is still referenced from without copying (see the
+ * "Zero-Copy Blend File Reading" option) was modified on disk since it was read, in which case
+ * that data may be invalid. Reports an error for every such file.
+ *
+ * \return False if any of the files changed.
+ */
+bool BLO_read_mapped_files_check(ReportList *reports);
+
 #define BLEN_THUMB_MEMSIZE_FILE(_x, _y) (sizeof(int) * (2 + (size_t)(_x) * (size_t)(_y)))
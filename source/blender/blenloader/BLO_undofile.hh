@@ -13,8 +13,10 @@
 #include "BLI_implicit_sharing.hh"
 #include "BLI_listbase.h"
 #include "BLI_map.hh"
+#include "BLI_span.hh"
 
 struct Main;
+struct MemFileArchive;
 struct Scene;
 
 struct MemFileSharedStorage {
@@ -26,13 +28,38 @@ struct MemFileSharedStorage {
   ~MemFileSharedStorage();
 };
 
+/**
+ * Information about a written ID that allows reusing its chunks in the next undo step without
+ * serializing it again, when the ID did not change.
+ */
+struct MemFileIDInfo {
+  /** Hash of the ID struct itself, to detect changes that are not tagged for depsgraph updates. */
+  uint64_t id_struct_hash;
+  /**
+   * Runtime pointers and the address ids they were stored as while writing the ID. Those have to
+   * be used again when its chunks are reused, for the data to stay consistent.
+   */
+  blender::Map<const void *, uint64_t> address_ids;
+};
+
+struct MemFileIDStorage {
+  /** Maps ID session uids to information about the written ID. */
+  blender::Map<uint, MemFileIDInfo> info_by_session_uid;
+};
+
 struct MemFileChunk {
   void *next, *prev;
   const char *buf;
   /** Size in bytes. */
   size_t size;
-  /** When true, this chunk doesn't own the memory, it's shared with a previous #MemFileChunk */
+  /** When true, this chunk is identical to the matching one of the previous step. */
   bool is_identical;
+  /**
+   * When true, this chunk owns #buf. Otherwise the memory is shared with a previous
+   * #MemFileChunk. Identical chunks usually share the memory, but chunks of memfiles restored
+   * from the undo archive own their buffers, see #BLO_memfile_archive_restore.
+   */
+  bool owns_buf;
   /** When true, this chunk is also identical to the one in the next step (used by undo code to
    * detect unchanged IDs).
    * Defined when writing the next step (i.e. last undo step has those always false). */
@@ -50,6 +77,13 @@ struct MemFile {
    * without making a copy. This is faster and requires less memory.
    */
   MemFileSharedStorage *shared_storage;
+  /** Only set when incremental undo is enabled, see #MemFileIDInfo. */
+  MemFileIDStorage *id_storage;
+  /**
+   * Only set when the memfile has been archived, see #BLO_memfile_archive. While archived (and
+   * not restored), the chunks keep their flags and sizes, but have no buffers.
+   */
+  MemFileArchive *archive;
 };
 
 struct MemFileWriteData {
@@ -61,6 +95,9 @@ struct MemFileWriteData {
 
   /** Maps an ID session uid to its first reference MemFileChunk, if existing. */
   blender::Map<uint, MemFileChunk *> id_session_uid_mapping;
+
+  /** When set, the address ids used while writing the current ID are gathered here. */
+  blender::Map<const void *, uint64_t> *current_id_address_ids;
 };
 
 struct MemFileUndoData {
@@ -87,6 +124,11 @@ void BLO_memfile_write_init(MemFileWriteData *mem_data,
 void BLO_memfile_write_finalize(MemFileWriteData *mem_data);
 
 void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t size);
+/**
+ * Add the chunks of the reference memfile written for the given ID (starting at
+ * #MemFileWriteData.reference_current_chunk) as identical chunks, instead of writing the ID again.
+ */
+void BLO_memfile_chunks_reuse_for_id(MemFileWriteData *mem_data, uint id_session_uid);
 
 /* exports */
 
@@ -106,6 +148,32 @@ void BLO_memfile_merge(MemFile *first, MemFile *second);
  */
 void BLO_memfile_clear_future(MemFile *memfile);
 
+/**
+ * Move the chunk data of an older undo step into the undo archive, which de-duplicates it against
+ * the previously archived step. Buffers that are shared with later memfiles are handed over to the
+ * first of them that uses it.
+ *
+ * \param later_memfiles: All memfiles of steps after this one, in order.
+ */
+void BLO_memfile_archive(MemFile *memfile, blender::Span<MemFile *> later_memfiles);
+/**
+ * Give the chunks of an archived memfile their own buffers again, so it can be read or used as
+ * reference for writing. Does nothing for memfiles that are not archived.
+ *
+ * \return False if the archived data could not be read (e.g. the file it was evicted to was
+ * removed), the memfile can't be used then.
+ */
+[[nodiscard]] bool BLO_memfile_archive_restore(MemFile *memfile);
+/**
+ * Move the oldest archived memfiles to compressed files on disk, until the memory used by the
+ * archive is below the given limit.
+ */
+void BLO_memfile_archive_evict(size_t memory_limit);
+/**
+ * Memory used by the memfile, taking archiving into account.
+ */
+size_t BLO_memfile_memory_size(const MemFile *memfile);
+
 /* Utilities. */
 
 Main *BLO_memfile_main_get(MemFile *memfile, Main *bmain, Scene **r_scene);
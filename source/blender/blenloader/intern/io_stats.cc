@@ -0,0 +1,291 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup blenloader
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "BLI_fileops.hh"
+#include "BLI_index_range.hh"
+#include "BLI_map.hh"
+#include "BLI_mutex.hh"
+#include "BLI_serialize.hh"
+#include "BLI_time.h"
+#include "BLI_vector.hh"
+
+#include "BKE_global.hh"
+#include "BKE_idtype.hh"
+
+#include "BLO_io_stats.hh"
+
+namespace blender::blo::io_stats {
+
+struct Item {
+  int64_t count = 0;
+  double duration = 0.0;
+  size_t size = 0;
+};
+
+/** Statistics for either reading or writing. */
+struct Direction {
+  Map<short, Item> ids;
+  Map<int, Item> blocks;
+
+  bool is_empty() const
+  {
+    return ids.is_empty() && blocks.is_empty();
+  }
+};
+
+struct Stats {
+  Mutex mutex;
+  double phases[BLO_IO_STATS_PHASE_NUM] = {};
+  Direction read;
+  Direction write;
+  std::string json_filepath;
+};
+
+static Stats &stats_get()
+{
+  static Stats stats;
+  return stats;
+}
+
+static const char *phase_name(const eBLOIOStatsPhase phase)
+{
+  switch (phase) {
+    case BLO_IO_STATS_PHASE_READ_BLOCKS:
+      return "read_blocks";
+    case BLO_IO_STATS_PHASE_DIRECT_LINK:
+      return "direct_link";
+    case BLO_IO_STATS_PHASE_VERSIONING:
+      return "versioning";
+    case BLO_IO_STATS_PHASE_LIB_LINK:
+      return "lib_link";
+    case BLO_IO_STATS_PHASE_DEPSGRAPH:
+      return "depsgraph";
+    case BLO_IO_STATS_PHASE_WRITE_IDS:
+      return "write_ids";
+    case BLO_IO_STATS_PHASE_WRITE_BLOCKS:
+      return "write_blocks";
+  }
+  return "";
+}
+
+/** Block codes are made of up to four characters, see #BLEND_MAKE_ID. */
+static std::string block_code_name(const int code)
+{
+  char name[sizeof(code) + 1] = {};
+  memcpy(name, &code, sizeof(code));
+  for (const int i : IndexRange(sizeof(code))) {
+    if (name[i] == '\0') {
+      break;
+    }
+    if (name[i] < ' ' || name[i] > '~') {
+      return std::to_string(code);
+    }
+  }
+  return name;
+}
+
+/** Blocks that are not actual IDs, such as link placeholders, are named by their block code. */
+static std::string idcode_name(const short idcode)
+{
+  if (const IDTypeInfo *info = BKE_idtype_get_info_from_idcode(idcode)) {
+    return info->name;
+  }
+  return block_code_name(int(uint16_t(idcode)));
+}
+
+/** Items sorted by decreasing time and size, so the most expensive ones are listed first. */
+template<typename Key> static Vector<std::pair<Key, Item>> items_sorted(const Map<Key, Item> &map)
+{
+  Vector<std::pair<Key, Item>> items;
+  for (const auto item : map.items()) {
+    items.append({item.key, item.value});
+  }
+  std::sort(items.begin(), items.end(), [](const auto &a, const auto &b) {
+    if (a.second.duration != b.second.duration) {
+      return a.second.duration > b.second.duration;
+    }
+    return a.second.size > b.second.size;
+  });
+  return items;
+}
+
+static void direction_print(const Direction &direction, const char *name)
+{
+  if (direction.is_empty()) {
+    return;
+  }
+  printf("  %s IDs:\n", name);
+  for (const auto &[idcode, item] : items_sorted(direction.ids)) {
+    printf("    %-20s %8lld  %10.3f ms  %12zu bytes\n",
+           idcode_name(idcode).c_str(),
+           (long long)item.count,
+           item.duration * 1000.0,
+           item.size);
+  }
+  printf("  %s blocks:\n", name);
+  for (const auto &[code, item] : items_sorted(direction.blocks)) {
+    printf("    %-20s %8lld  %12zu bytes\n",
+           block_code_name(code).c_str(),
+           (long long)item.count,
+           item.size);
+  }
+}
+
+static void direction_serialize(const Direction &direction, io::serialize::DictionaryValue &dict)
+{
+  using namespace io::serialize;
+  ArrayValue &ids = *dict.append_array("ids");
+  for (const auto &[idcode, item] : items_sorted(direction.ids)) {
+    DictionaryValue &id_dict = *ids.append_dict();
+    id_dict.append_str("type", idcode_name(idcode));
+    id_dict.append_int("count", item.count);
+    id_dict.append_double("time", item.duration);
+    id_dict.append_int("bytes", int64_t(item.size));
+  }
+  ArrayValue &blocks = *dict.append_array("blocks");
+  for (const auto &[code, item] : items_sorted(direction.blocks)) {
+    DictionaryValue &block_dict = *blocks.append_dict();
+    block_dict.append_str("code", block_code_name(code));
+    block_dict.append_int("count", item.count);
+    block_dict.append_int("bytes", int64_t(item.size));
+  }
+}
+
+static void stats_write_json(const Stats &stats, const char *filepath)
+{
+  using namespace io::serialize;
+  DictionaryValue root;
+  root.append_str("filepath", filepath);
+  DictionaryValue &phases = *root.append_dict("phases");
+  for (const int phase : IndexRange(BLO_IO_STATS_PHASE_NUM)) {
+    phases.append_double(phase_name(eBLOIOStatsPhase(phase)), stats.phases[phase]);
+  }
+  if (!stats.read.is_empty()) {
+    direction_serialize(stats.read, *root.append_dict("read"));
+  }
+  if (!stats.write.is_empty()) {
+    direction_serialize(stats.write, *root.append_dict("write"));
+  }
+
+  fstream stream(stats.json_filepath, std::ios::out);
+  if (!stream.is_open()) {
+    printf("Failed to write I/O statistics to '%s'\n", stats.json_filepath.c_str());
+    return;
+  }
+  JsonFormatter formatter;
+  formatter.indentation_len = 2;
+  formatter.serialize(stream, root);
+}
+
+}  // namespace blender::blo::io_stats
+
+using namespace blender::blo::io_stats;
+
+bool BLO_io_stats_is_enabled()
+{
+  return (G.debug & G_DEBUG_IO_STATS) != 0;
+}
+
+void BLO_io_stats_reset()
+{
+  Stats &stats = stats_get();
+  std::scoped_lock lock(stats.mutex);
+  std::fill_n(stats.phases, BLO_IO_STATS_PHASE_NUM, 0.0);
+  stats.read = {};
+  stats.write = {};
+}
+
+void BLO_io_stats_phase_add(const eBLOIOStatsPhase phase, const double duration)
+{
+  Stats &stats = stats_get();
+  std::scoped_lock lock(stats.mutex);
+  stats.phases[phase] += duration;
+}
+
+void BLO_io_stats_block_add(const bool is_write, const int code, const size_t size)
+{
+  Stats &stats = stats_get();
+  std::scoped_lock lock(stats.mutex);
+  Item &item = (is_write ? stats.write : stats.read).blocks.lookup_or_add_default(code);
+  item.count++;
+  item.size += size;
+}
+
+void BLO_io_stats_id_add(const bool is_write,
+                         const short idcode,
+                         const int count,
+                         const double duration,
+                         const size_t size)
+{
+  Stats &stats = stats_get();
+  std::scoped_lock lock(stats.mutex);
+  Item &item = (is_write ? stats.write : stats.read).ids.lookup_or_add_default(idcode);
+  item.count += count;
+  item.duration += duration;
+  item.size += size;
+}
+
+void BLO_io_stats_report(const char *filepath)
+{
+  Stats &stats = stats_get();
+  std::scoped_lock lock(stats.mutex);
+
+  printf("I/O statistics for '%s':\n", filepath);
+  printf("  Phases:\n");
+  for (const int phase : blender::IndexRange(BLO_IO_STATS_PHASE_NUM)) {
+    if (stats.phases[phase] > 0.0) {
+      printf("    %-20s %10.3f ms\n",
+             phase_name(eBLOIOStatsPhase(phase)),
+             stats.phases[phase] * 1000.0);
+    }
+  }
+  direction_print(stats.read, "Read");
+  direction_print(stats.write, "Write");
+
+  if (!stats.json_filepath.empty()) {
+    stats_write_json(stats, filepath);
+  }
+}
+
+void BLO_io_stats_json_filepath_set(const char *filepath)
+{
+  Stats &stats = stats_get();
+  std::scoped_lock lock(stats.mutex);
+  stats.json_filepath = filepath ? filepath : "";
+}
+
+/** Innermost phase of the current thread. */
+static thread_local BLOIOStatsScopedPhase *active_scoped_phase = nullptr;
+
+BLOIOStatsScopedPhase::BLOIOStatsScopedPhase(const eBLOIOStatsPhase phase,
+                                             const bool use_io_stats)
+    : phase_(phase), start_time_(use_io_stats ? BLI_time_now_seconds() : -1.0)
+{
+  if (use_io_stats) {
+    parent_ = active_scoped_phase;
+    active_scoped_phase = this;
+  }
+}
+
+BLOIOStatsScopedPhase::~BLOIOStatsScopedPhase()
+{
+  if (start_time_ < 0.0) {
+    return;
+  }
+  const double duration = BLI_time_now_seconds() - start_time_;
+  BLO_io_stats_phase_add(phase_, duration - nested_time_);
+  if (parent_) {
+    parent_->nested_time_ += duration;
+  }
+  active_scoped_phase = parent_;
+}
@@ -26,6 +26,7 @@
 #include "BKE_main.hh"
 #include "BKE_preview_image.hh"
 
+#include "BLO_io_stats.hh"
 #include "BLO_readfile.hh"
 
 #include "readfile.hh"
@@ -59,7 +60,17 @@ BlendHandle *BLO_blendhandle_from_file(const char *filepath, BlendFileReadReport
 {
   BlendHandle *bh;
 
-  bh = (BlendHandle *)blo_filedata_from_file(filepath, reports);
+  bh = (BlendHandle *)blo_filedata_from_file(filepath, reports, false);
+
+  return bh;
+}
+
+BlendHandle *BLO_blendhandle_from_file_for_link(const char *filepath,
+                                                BlendFileReadReport *reports)
+{
+  BlendHandle *bh;
+
+  bh = (BlendHandle *)blo_filedata_from_file(filepath, reports, true);
 
   return bh;
 }
@@ -187,7 +198,7 @@ LinkNode *BLO_blendhandle_get_datablock_info(BlendHandle *bh,
 
       bool has_preview = false;
       /* See if we can find a preview in the data of this ID. */
-      for (BHead *data_bhead = blo_bhead_next(fd, id_bhead); data_bhead->code == BLO_CODE_DATA;
+      for (BHead *data_bhead = blo_bhead_next(fd, id_bhead); blo_bhead_is_data(data_bhead);
            data_bhead = blo_bhead_next(fd, data_bhead))
       {
         if (data_bhead->SDNAnr == sdna_nr_preview_image) {
@@ -230,10 +241,13 @@ static BHead *blo_blendhandle_read_preview_rects(FileData *fd,
         preview_from_file->h[preview_index])
     {
       bhead = blo_bhead_next(fd, bhead);
-      BLI_assert((preview_from_file->w[preview_index] * preview_from_file->h[preview_index] *
-                  sizeof(uint)) == bhead->len);
-      result->rect[preview_index] = static_cast<uint *>(
-          BLO_library_read_struct(fd, bhead, "PreviewImage Icon Rect"));
+      BHead *data_bhead = blo_bhead_data_resolve(fd, bhead);
+      BLI_assert(data_bhead == nullptr ||
+                 (preview_from_file->w[preview_index] * preview_from_file->h[preview_index] *
+                  sizeof(uint)) == data_bhead->len);
+      result->rect[preview_index] = data_bhead ? static_cast<uint *>(BLO_library_read_struct(
+                                                     fd, data_bhead, "PreviewImage Icon Rect")) :
+                                                 nullptr;
     }
     else {
       /* This should not be needed, but can happen in 'broken' .blend files,
@@ -259,8 +273,8 @@ PreviewImage *BLO_blendhandle_get_preview_for_id(BlendHandle *bh,
   const int sdna_preview_image = DNA_struct_find_with_alias(fd->filesdna, "PreviewImage");
 
   for (BHead *bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
-    if (bhead->code == BLO_CODE_DATA) {
-      if (looking && bhead->SDNAnr == sdna_preview_image) {
+    if (blo_bhead_is_data(bhead)) {
+      if (looking && bhead->code == BLO_CODE_DATA && bhead->SDNAnr == sdna_preview_image) {
         PreviewImage *preview_from_file = static_cast<PreviewImage *>(
             BLO_library_read_struct(fd, bhead, "PreviewImage"));
 
@@ -344,11 +358,13 @@ BlendFileData *BLO_read_from_file(const char *filepath,
   BlendFileData *bfd = nullptr;
   FileData *fd;
 
-  fd = blo_filedata_from_file(filepath, reports);
+  fd = blo_filedata_from_file(filepath, reports, false);
   if (fd) {
     fd->skip_flags = skip_flags;
     bfd = blo_read_file_internal(fd, filepath);
     blo_filedata_free(fd);
+    /* Create versioned copies of the libraries requested while reading. */
+    blo_versioning_cache_update();
   }
 
   return bfd;
@@ -446,5 +462,7 @@ void BLO_read_do_version_after_setup(Main *new_bmain,
                                      BlendfileLinkAppendContext *lapp_context,
                                      BlendFileReadReport *reports)
 {
+  const BLOIOStatsScopedPhase stats_phase(BLO_IO_STATS_PHASE_VERSIONING,
+                                          BLO_io_stats_is_enabled());
   do_versions_after_setup(new_bmain, lapp_context, reports);
 }
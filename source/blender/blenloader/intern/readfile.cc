@@ -8,6 +8,7 @@
 
 #include "fmt/core.h"
 
+#include <atomic>
 #include <cerrno>
 #include <cstdarg> /* for va_start/end. */
 #include <cstddef> /* for offsetof. */
@@ -15,7 +16,10 @@
 #include <cstring>
 #include <ctime>   /* for gmtime. */
 #include <fcntl.h> /* for open flags (O_BINARY, O_RDONLY). */
+#include <functional>
+#include <mutex>
 #include <queue>
+#include <string>
 
 #ifndef WIN32
 #  include <unistd.h> /* for read close */
@@ -54,11 +58,14 @@
 #include "BLI_ghash.h"
 #include "BLI_map.hh"
 #include "BLI_memarena.h"
+#include "BLI_mmap.h"
+#include "BLI_mutex.hh"
 #include "BLI_set.hh"
 #include "BLI_string.h"
 #include "BLI_string_ref.hh"
 #include "BLI_string_utf8.h"
 #include "BLI_string_utils.hh"
+#include "BLI_task.hh"
 #include "BLI_threads.h"
 #include "BLI_time.h"
 #include "BLI_utildefines.h"
@@ -103,6 +110,7 @@
 #include "DEG_depsgraph.hh"
 
 #include "BLO_blend_validate.hh"
+#include "BLO_io_stats.hh"
 #include "BLO_read_write.hh"
 #include "BLO_readfile.hh"
 #include "BLO_undofile.hh"
@@ -338,6 +346,279 @@ static void oldnewmap_free(OldNewMap *onm)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Memory-Mapped Data Blocks
+ *
+ * With the "Zero-Copy Blend File Reading" (or "Lazy Library Data" for linked libraries) option,
+ * uncompressed blend-files are mapped into memory and large arrays that need no conversion are
+ * referenced directly from the mapping, instead of being copied into newly allocated memory (see
+ * #BLO_read_mapped_array).
+ * Such data blocks are not read into the #FileData.datamap up-front. They are only copied there
+ * when they are accessed in any other way.
+ * \{ */
+
+/** Smaller data blocks are always copied, referencing them from the mapping is not worth it. */
+#define MAPPED_DATA_BLOCK_MIN_SIZE (1 << 16)
+
+struct BlendFileMapping;
+
+/**
+ * All mappings that are still alive, to check whether their files were changed on disk while the
+ * data referenced from them is still in use, see #BLO_read_mapped_files_check.
+ */
+static blender::Set<const BlendFileMapping *> &live_mappings()
+{
+  static blender::Set<const BlendFileMapping *> mappings;
+  return mappings;
+}
+static std::mutex live_mappings_mutex;
+
+/** Keeps the memory-mapped file alive as long as any data referenced from it is in use. */
+struct BlendFileMapping : public blender::ImplicitSharingInfo {
+  BLI_mmap_file *mmap;
+  std::string filepath;
+
+  BlendFileMapping(BLI_mmap_file *mmap, const char *filepath) : mmap(mmap), filepath(filepath)
+  {
+    std::scoped_lock lock(live_mappings_mutex);
+    live_mappings().add_new(this);
+  }
+
+ private:
+  void delete_self_with_data() override
+  {
+    {
+      std::scoped_lock lock(live_mappings_mutex);
+      live_mappings().remove(this);
+    }
+    BLI_mmap_free(mmap);
+    MEM_delete(this);
+  }
+};
+
+bool BLO_read_mapped_files_check(ReportList *reports)
+{
+  bool all_unchanged = true;
+  std::scoped_lock lock(live_mappings_mutex);
+  for (const BlendFileMapping *mapping : live_mappings()) {
+    if (BLI_mmap_file_changed(mapping->mmap)) {
+      BKE_reportf(reports,
+                  RPT_ERROR,
+                  "File '%s' was modified on disk while data read from it is still in use, "
+                  "reload it to avoid using invalid data",
+                  mapping->filepath.c_str());
+      all_unchanged = false;
+    }
+  }
+  return all_unchanged;
+}
+
+/**
+ * Sharing-info for a single array referenced from a #BlendFileMapping. Every array gets its own
+ * sharing-info (instead of all of them sharing the one of the mapping), so that they behave just
+ * like regularly allocated arrays. Modifying the array in place is fine, since the file is mapped
+ * with copy-on-write pages.
+ */
+class MappedArraySharingInfo : public blender::ImplicitSharingInfo {
+ private:
+  const BlendFileMapping *mapping_;
+
+ public:
+  MappedArraySharingInfo(const BlendFileMapping *mapping) : mapping_(mapping)
+  {
+    mapping_->add_user();
+  }
+
+ private:
+  void delete_self_with_data() override
+  {
+    mapping_->remove_user_and_delete_if_last();
+    MEM_delete(this);
+  }
+};
+
+/**
+ * Whether reading the data block can be deferred, because it may be referenced from the mapped
+ * file, or read lazily when the ID is first needed (see #BLO_read_array_lazy).
+ */
+static bool blo_bhead_is_mappable(const FileData *fd, const BHead *bhead)
+{
+#ifdef USE_BHEAD_READ_ON_DEMAND
+  if (fd->mapping == nullptr && fd->lazy_file == nullptr) {
+    return false;
+  }
+  if (bhead->len < MAPPED_DATA_BLOCK_MIN_SIZE) {
+    return false;
+  }
+  if (fd->flags & FD_FLAGS_SWITCH_ENDIAN) {
+    return false;
+  }
+  if (BHEADN_FROM_BHEAD(bhead)->has_data) {
+    return false;
+  }
+  return fd->compflags[bhead->SDNAnr] == SDNA_CMP_EQUAL;
+#else
+  UNUSED_VARS(fd, bhead);
+  return false;
+#endif
+}
+
+/**
+ * Read a data block that could have been referenced from the mapped file into the datamap, because
+ * it is accessed as regular data.
+ *
+ * \param data_blocks: The data blocks of the ID, when they are not the ones in \a fd.
+ */
+static void mapped_data_block_read_into_datamap(FileData *fd,
+                                                IDDataBlocks *data_blocks,
+                                                const void *adr)
+{
+  const std::optional<MappedDataBlock> block =
+      (data_blocks ? data_blocks->mapped_data_blocks : fd->mapped_data_blocks).pop_try(adr);
+  if (!block) {
+    return;
+  }
+  void *data;
+  {
+    /* The data of other IDs may be linked in parallel. */
+    std::scoped_lock lock(fd->file_read_mutex);
+    data = read_struct(fd, block->bhead, block->allocname, block->id_type_index);
+  }
+  if (data) {
+    oldnewmap_insert(data_blocks ? data_blocks->datamap : fd->datamap, adr, data, 0);
+  }
+}
+
+static void datamap_clear(FileData *fd)
+{
+  oldnewmap_clear(fd->datamap);
+  fd->mapped_data_blocks.clear();
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Lazy Library Data
+ *
+ * With the "Lazy Library Data" experimental option, large arrays of IDs linked from uncompressed
+ * library files are not read together with the rest of the ID (see #BLO_read_array_lazy). Only
+ * their offset in the file is stored, and they are read from the library file when the ID is
+ * first needed, see #BKE_libblock_lazy_data_ensure. The arrays of IDs that are linked but never
+ * used (e.g. in collections excluded from the view layer) are then never read.
+ * \{ */
+
+/** A library file that arrays are read from lazily, shared by all IDs linked from it. */
+struct LazyLibraryFile {
+  std::string filepath;
+  /** The state of the file when the IDs were read from it, to detect changes made since then. */
+  BLI_stat_t stat;
+};
+
+/** An array that is read from #LazyLibraryFile when its ID is first needed. */
+struct LazyArray {
+  off64_t file_offset;
+  int64_t size;
+  /** Gives ownership of the read array to the ID. */
+  std::function<void(void *data)> assign;
+};
+
+struct ID_LazyData {
+  std::shared_ptr<LazyLibraryFile> file;
+  blender::Vector<LazyArray> arrays;
+  /** The ID may be needed by multiple threads at once, e.g. during depsgraph evaluation. */
+  blender::Mutex mutex;
+  std::atomic<bool> is_loaded = false;
+};
+
+static void blo_filedata_lazy_file_init(FileData *fd, const char *filepath)
+{
+  if (!(fd->flags & FD_FLAGS_IS_UNCOMPRESSED_FILE) || (fd->flags & FD_FLAGS_SWITCH_ENDIAN)) {
+    return;
+  }
+  /* The arrays are used as they are stored in the file, there must not be any versioning that
+   * could modify them. */
+  if (fd->fileversion != BLENDER_FILE_VERSION || fd->filesubversion != BLENDER_FILE_SUBVERSION) {
+    return;
+  }
+  if (!fd->file_stat) {
+    return;
+  }
+  fd->lazy_file = std::make_shared<LazyLibraryFile>();
+  fd->lazy_file->filepath = filepath;
+  fd->lazy_file->stat = *fd->file_stat;
+}
+
+static bool lazy_file_is_unchanged(const LazyLibraryFile &file, const int filedes)
+{
+  BLI_stat_t stat;
+  if (BLI_fstat(filedes, &stat) != 0) {
+    return false;
+  }
+  /* The inode changes when the file is replaced, e.g. by saving over it. */
+  return stat.st_size == file.stat.st_size && stat.st_mtime == file.stat.st_mtime &&
+         stat.st_ino == file.stat.st_ino;
+}
+
+static bool lazy_array_read(const int filedes, const LazyArray &array, void *dst)
+{
+  if (BLI_lseek(filedes, array.file_offset, SEEK_SET) != array.file_offset) {
+    return false;
+  }
+  return BLI_read(filedes, dst, size_t(array.size)) == array.size;
+}
+
+void BLO_readfile_id_lazy_data_ensure(ID &id)
+{
+  ID_LazyData *lazy_data = id.runtime->lazy_data;
+  if (lazy_data == nullptr || lazy_data->is_loaded) {
+    return;
+  }
+  std::scoped_lock lock(lazy_data->mutex);
+  if (lazy_data->is_loaded) {
+    return;
+  }
+
+  const LazyLibraryFile &file = *lazy_data->file;
+  /* Every load uses its own file descriptor, so that IDs can be loaded in parallel. */
+  int filedes = BLI_open(file.filepath.c_str(), O_BINARY | O_RDONLY, 0);
+  if (filedes != -1 && !lazy_file_is_unchanged(file, filedes)) {
+    close(filedes);
+    filedes = -1;
+  }
+
+  bool success = filedes != -1;
+  for (LazyArray &array : lazy_data->arrays) {
+    void *data = MEM_malloc_arrayN<char>(size_t(array.size), __func__);
+    if (!success || !lazy_array_read(filedes, array, data)) {
+      /* The ID has to stay valid, its data is only known to be missing at this point. */
+      memset(data, 0, size_t(array.size));
+      success = false;
+    }
+    array.assign(data);
+  }
+  if (filedes != -1) {
+    close(filedes);
+  }
+  if (!success) {
+    CLOG_ERROR(&LOG,
+               "Unable to read data of '%s' from library file '%s', it was changed or removed "
+               "since it was linked. The missing data is replaced by zeros, reload the library "
+               "to fix it",
+               id.name,
+               file.filepath.c_str());
+  }
+
+  lazy_data->arrays.clear_and_shrink();
+  lazy_data->is_loaded = true;
+}
+
+void BLO_readfile_id_lazy_data_free(ID &id)
+{
+  MEM_SAFE_DELETE(id.runtime->lazy_data);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Helper Functions
  * \{ */
@@ -516,6 +797,11 @@ static bool blo_bhead_is_id(const BHead *bhead)
   return bhead->code <= 0xFFFF;
 }
 
+bool blo_bhead_is_data(const BHead *bhead)
+{
+  return ELEM(bhead->code, BLO_CODE_DATA, BLO_CODE_DATA_REFERENCE);
+}
+
 static bool blo_bhead_is_id_valid_type(const BHead *bhead)
 {
   if (!blo_bhead_is_id(bhead)) {
@@ -577,6 +863,15 @@ void blo_readfile_invalidate(FileData *fd, Main *bmain, const char *message)
 struct BlendDataReader {
   FileData *fd;
 
+  /** The ID whose data is being read, embedded IDs are part of it. */
+  ID *id = nullptr;
+
+  /**
+   * Data blocks of the ID being read, when its data is linked in parallel with other IDs (see
+   * #DeferredIDRead). Otherwise null, and the data blocks in #fd are used.
+   */
+  IDDataBlocks *data_blocks = nullptr;
+
   /**
    * The key is the old address id referencing shared data that's written to a file, typically an
    * array. The corresponding value is the shared data at run-time.
@@ -594,6 +889,7 @@ static BHeadN *get_bhead(FileData *fd)
   BHeadN *new_bhead = nullptr;
 
   if (fd) {
+    const BLOIOStatsScopedPhase stats_phase(BLO_IO_STATS_PHASE_READ_BLOCKS, fd->use_io_stats);
     if (!fd->is_eof) {
       std::optional<BHead> bhead_opt = BLO_readfile_read_bhead(fd->file,
                                                                fd->blender_header.bhead_type());
@@ -677,6 +973,10 @@ static BHeadN *get_bhead(FileData *fd)
    */
   if (new_bhead) {
     BLI_addtail(&fd->bhead_list, new_bhead);
+    if (fd->use_io_stats) {
+      BLO_io_stats_block_add(
+          false, new_bhead->bhead.code, sizeof(BHead) + size_t(new_bhead->bhead.len));
+    }
   }
 
   return new_bhead;
@@ -739,6 +1039,7 @@ BHead *blo_bhead_next(FileData *fd, BHead *thisblock)
 #ifdef USE_BHEAD_READ_ON_DEMAND
 static bool blo_bhead_read_data(FileData *fd, BHead *thisblock, void *buf)
 {
+  const BLOIOStatsScopedPhase stats_phase(BLO_IO_STATS_PHASE_READ_BLOCKS, fd->use_io_stats);
   bool success = true;
   BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
   BLI_assert(new_bhead->has_data == false && new_bhead->file_offset != 0);
@@ -1231,9 +1532,19 @@ static FileData *blo_decode_and_check(FileData *fd, ReportList *reports)
   return fd;
 }
 
+/**
+ * Whether large arrays may be referenced directly from the memory-mapped file, see
+ * #BLO_read_mapped_array.
+ */
+static bool blo_filedata_use_mapped_data()
+{
+  return USER_DEVELOPER_TOOL_TEST(&U, use_blend_file_zero_copy);
+}
+
 static FileData *blo_filedata_from_file_descriptor(const char *filepath,
                                                    BlendFileReadReport *reports,
-                                                   const int filedes)
+                                                   const int filedes,
+                                                   const bool use_mapped_data)
 {
   char header[7];
   FileReader *rawfile = BLI_filereader_new_file(filedes);
@@ -1259,10 +1570,28 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
   /* Rewind the file after reading the header. */
   rawfile->seek(rawfile, 0, SEEK_SET);
 
+  BlendFileMapping *mapping = nullptr;
+  bool is_uncompressed = false;
+
   /* Check if we have a regular file. */
   if (memcmp(header, "BLENDER", sizeof(header)) == 0) {
-    /* Try opening the file with memory-mapped IO. */
-    file = BLI_filereader_new_mmap(filedes);
+    is_uncompressed = true;
+#ifndef WIN32
+    /* Not supported on Windows, where a mapped file can't be replaced (e.g. when saving over
+     * it) as long as the mapping exists. */
+    if (use_mapped_data) {
+      /* Use copy-on-write pages, so that arrays referenced from the mapping can still be modified
+       * in place like regularly allocated arrays. */
+      if (BLI_mmap_file *mmap = BLI_mmap_open_copy_on_write(filedes)) {
+        mapping = MEM_new<BlendFileMapping>(__func__, mmap, filepath);
+        file = BLI_filereader_new_mmap_file(mmap);
+      }
+    }
+#endif
+    if (file == nullptr) {
+      /* Try opening the file with memory-mapped IO. */
+      file = BLI_filereader_new_mmap(filedes);
+    }
     if (file == nullptr) {
       /* `mmap` failed, so just keep using `rawfile`. */
       file = rawfile;
@@ -1293,6 +1622,10 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
 
   FileData *fd = filedata_new(reports);
   fd->file = file;
+  fd->mapping = mapping;
+  if (is_uncompressed) {
+    fd->flags |= FD_FLAGS_IS_UNCOMPRESSED_FILE;
+  }
 
   BLI_stat_t stat;
   if (BLI_stat(filepath, &stat) != -1) {
@@ -1302,7 +1635,9 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
   return fd;
 }
 
-static FileData *blo_filedata_from_file_open(const char *filepath, BlendFileReadReport *reports)
+static FileData *blo_filedata_from_file_open(const char *filepath,
+                                             BlendFileReadReport *reports,
+                                             const bool use_mapped_data)
 {
   errno = 0;
   const int file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
@@ -1314,17 +1649,24 @@ static FileData *blo_filedata_from_file_open(const char *filepath, BlendFileRead
                 errno ? strerror(errno) : RPT_("unknown error reading file"));
     return nullptr;
   }
-  return blo_filedata_from_file_descriptor(filepath, reports, file);
+  return blo_filedata_from_file_descriptor(filepath, reports, file, use_mapped_data);
 }
 
-FileData *blo_filedata_from_file(const char *filepath, BlendFileReadReport *reports)
+FileData *blo_filedata_from_file(const char *filepath,
+                                 BlendFileReadReport *reports,
+                                 const bool is_library)
 {
-  FileData *fd = blo_filedata_from_file_open(filepath, reports);
+  FileData *fd = blo_filedata_from_file_open(filepath, reports, blo_filedata_use_mapped_data());
   if (fd != nullptr) {
     /* needed for library_append and read_libraries */
     STRNCPY(fd->relabase, filepath);
+    fd->use_io_stats = BLO_io_stats_is_enabled();
 
-    return blo_decode_and_check(fd, reports->reports);
+    fd = blo_decode_and_check(fd, reports->reports);
+    if (fd != nullptr && is_library && USER_DEVELOPER_TOOL_TEST(&U, use_lazy_library_data)) {
+      blo_filedata_lazy_file_init(fd, filepath);
+    }
+    return fd;
   }
   return nullptr;
 }
@@ -1336,7 +1678,7 @@ FileData *blo_filedata_from_file(const char *filepath, BlendFileReadReport *repo
 static FileData *blo_filedata_from_file_minimal(const char *filepath)
 {
   BlendFileReadReport read_report{};
-  FileData *fd = blo_filedata_from_file_open(filepath, &read_report);
+  FileData *fd = blo_filedata_from_file_open(filepath, &read_report, false);
   if (fd != nullptr) {
     read_blender_header(fd);
     if (fd->flags & FD_FLAGS_FILE_OK) {
@@ -1388,8 +1730,14 @@ FileData *blo_filedata_from_memfile(MemFile *memfile,
     return nullptr;
   }
 
+  FileReader *file = BLO_memfile_new_filereader(memfile, params->undo_direction);
+  if (file == nullptr) {
+    BKE_report(reports->reports, RPT_ERROR, "Unable to restore archived undo step");
+    return nullptr;
+  }
+
   FileData *fd = filedata_new(reports);
-  fd->file = BLO_memfile_new_filereader(memfile, params->undo_direction);
+  fd->file = file;
   fd->undo_direction = params->undo_direction;
   fd->flags |= FD_FLAGS_IS_MEMFILE;
 
@@ -1413,6 +1761,10 @@ void blo_filedata_free(FileData *fd)
   }
 #endif
   fd->file->close(fd->file);
+  if (fd->mapping) {
+    /* Arrays referenced from the mapping keep it alive for as long as they are used. */
+    fd->mapping->remove_user_and_delete_if_last();
+  }
 
   if (fd->filesdna) {
     DNA_sdna_free(fd->filesdna);
@@ -1497,16 +1849,29 @@ short BLO_version_from_file(const char *filepath)
 /** \name Old/New Pointer Map
  * \{ */
 
+static void *datamap_lookup_and_inc(BlendDataReader *reader,
+                                    const void *adr,
+                                    const bool increase_users)
+{
+  FileData *fd = reader->fd;
+  IDDataBlocks *data_blocks = reader->data_blocks;
+  if (!(data_blocks ? data_blocks->mapped_data_blocks : fd->mapped_data_blocks).is_empty()) {
+    mapped_data_block_read_into_datamap(fd, data_blocks, adr);
+  }
+  return oldnewmap_lookup_and_inc(
+      data_blocks ? data_blocks->datamap : fd->datamap, adr, increase_users);
+}
+
 /* Only direct data-blocks. */
-static void *newdataadr(FileData *fd, const void *adr)
+static void *newdataadr(BlendDataReader *reader, const void *adr)
 {
-  return oldnewmap_lookup_and_inc(fd->datamap, adr, true);
+  return datamap_lookup_and_inc(reader, adr, true);
 }
 
 /* Only direct data-blocks. */
-static void *newdataadr_no_us(FileData *fd, const void *adr)
+static void *newdataadr_no_us(BlendDataReader *reader, const void *adr)
 {
-  return oldnewmap_lookup_and_inc(fd->datamap, adr, false);
+  return datamap_lookup_and_inc(reader, adr, false);
 }
 
 void *blo_read_get_new_globaldata_address(FileData *fd, const void *adr)
@@ -1954,15 +2319,16 @@ static const void *peek_struct_undo(FileData *fd, BHead *bhead)
   return (bhead->len) ? (const void *)(bhead + 1) : nullptr;
 }
 
-static void link_glob_list(FileData *fd, ListBase *lb) /* for glob data */
+static void link_glob_list(BlendDataReader *reader, ListBase *lb) /* for glob data */
 {
+  FileData *fd = reader->fd;
   Link *ln, *prev;
   void *poin;
 
   if (BLI_listbase_is_empty(lb)) {
     return;
   }
-  poin = newdataadr(fd, lb->first);
+  poin = newdataadr(reader, lb->first);
   if (lb->first) {
     oldnewmap_insert(fd->globmap, lb->first, poin, 0);
   }
@@ -1971,7 +2337,7 @@ static void link_glob_list(FileData *fd, ListBase *lb) /* for glob data */
   ln = static_cast<Link *>(lb->first);
   prev = nullptr;
   while (ln) {
-    poin = newdataadr(fd, ln->next);
+    poin = newdataadr(reader, ln->next);
     if (ln->next) {
       oldnewmap_insert(fd->globmap, ln->next, poin, 0);
     }
@@ -2617,9 +2983,14 @@ static bool direct_link_id(FileData *fd,
                            const int tag,
                            const ID_Readfile_Data::Tags id_read_tags,
                            ID *id,
-                           ID *id_old)
+                           ID *id_old,
+                           IDDataBlocks *data_blocks = nullptr)
 {
+  const BLOIOStatsScopedPhase stats_phase(BLO_IO_STATS_PHASE_DIRECT_LINK, fd->use_io_stats);
+
   BlendDataReader reader = {fd};
+  reader.id = id;
+  reader.data_blocks = data_blocks;
   /* Sharing is only allowed within individual data-blocks currently. The clearing is done
    * explicitly here, in case the `reader` is used by multiple IDs in the future. */
   reader.shared_data_by_stored_address.clear();
@@ -2663,18 +3034,81 @@ static bool direct_link_id(FileData *fd,
   return success;
 }
 
-/* Read all data associated with a datablock into datamap. */
+BHead *blo_bhead_data_resolve(FileData *fd, BHead *reference_bhead)
+{
+  if (reference_bhead->code != BLO_CODE_DATA_REFERENCE) {
+    return reference_bhead;
+  }
+  uint64_t target_address_id;
+  if (reference_bhead->len != sizeof(target_address_id)) {
+    CLOG_ERROR(&LOG, "Blendfile corruption: Invalid data reference block.");
+    return nullptr;
+  }
+  memcpy(&target_address_id, reference_bhead + 1, sizeof(target_address_id));
+  const void *target_old = reinterpret_cast<const void *>(target_address_id);
+
+  if (BHead *target = fd->data_bhead_by_old_address.lookup_default(target_old, nullptr)) {
+    return target;
+  }
+  /* Referenced blocks are always written before the reference, so the index only has to be
+   * extended up to it. The first block wins, because the same old address may be reused for
+   * different data by later IDs. */
+  BHead *bhead = fd->data_bhead_index_end ? blo_bhead_next(fd, fd->data_bhead_index_end) :
+                                            blo_bhead_first(fd);
+  for (; bhead && bhead != reference_bhead; bhead = blo_bhead_next(fd, bhead)) {
+    if (bhead->code == BLO_CODE_DATA) {
+      fd->data_bhead_by_old_address.add(bhead->old, bhead);
+    }
+    fd->data_bhead_index_end = bhead;
+  }
+  BHead *target = fd->data_bhead_by_old_address.lookup_default(target_old, nullptr);
+  if (target == nullptr) {
+    CLOG_ERROR(&LOG, "Blendfile corruption: Referenced data block (%p) not found.", target_old);
+  }
+  return target;
+}
+
+/**
+ * Read all data associated with a datablock into datamap.
+ *
+ * \param data_blocks: Read into these instead of the data blocks of \a fd, when set.
+ */
 static BHead *read_data_into_datamap(FileData *fd,
                                      BHead *bhead,
                                      const char *allocname,
-                                     const int id_type_index)
+                                     const int id_type_index,
+                                     IDDataBlocks *data_blocks = nullptr)
 {
+  OldNewMap *datamap = data_blocks ? data_blocks->datamap : fd->datamap;
+  blender::Map<const void *, MappedDataBlock> &mapped_data_blocks =
+      data_blocks ? data_blocks->mapped_data_blocks : fd->mapped_data_blocks;
+
   bhead = blo_bhead_next(fd, bhead);
 
-  while (bhead && bhead->code == BLO_CODE_DATA) {
-    void *data = read_struct(fd, bhead, allocname, id_type_index);
+  while (bhead && blo_bhead_is_data(bhead)) {
+    /* References to identical data elsewhere in the file are read like a copy of that data, under
+     * their own old address. */
+    BHead *data_bhead = blo_bhead_data_resolve(fd, bhead);
+    if (data_bhead == nullptr) {
+      bhead = blo_bhead_next(fd, bhead);
+      continue;
+    }
+
+    if (blo_bhead_is_mappable(fd, data_bhead)) {
+      /* Defer reading, the data may be referenced from the mapped file instead. */
+      if (!mapped_data_blocks.add(bhead->old, {data_bhead, allocname, id_type_index})) {
+        CLOG_ERROR(&LOG,
+                   "Blendfile corruption: Invalid, or multiple `bhead` with same old address "
+                   "value (%p) for a given ID.",
+                   bhead->old);
+      }
+      bhead = blo_bhead_next(fd, bhead);
+      continue;
+    }
+
+    void *data = read_struct(fd, data_bhead, allocname, id_type_index);
     if (data) {
-      const bool is_new = oldnewmap_insert(fd->datamap, bhead->old, data, 0);
+      const bool is_new = oldnewmap_insert(datamap, bhead->old, data, 0);
       if (!is_new) {
         CLOG_ERROR(&LOG,
                    "Blendfile corruption: Invalid, or multiple `bhead` with same old address "
@@ -2776,7 +3210,7 @@ static bool read_libblock_is_identical(FileData *fd, BHead *bhead)
   /* Test any other data that is part of ID (logic must match read_data_into_datamap). */
   bhead = blo_bhead_next(fd, bhead);
 
-  while (bhead && bhead->code == BLO_CODE_DATA) {
+  while (bhead && blo_bhead_is_data(bhead)) {
     if (bhead->len && !BHEADN_FROM_BHEAD(bhead)->is_memchunk_identical) {
       return false;
     }
@@ -3175,13 +3609,55 @@ static bool read_libblock_undo_restore(
  * When reading for undo, libraries, linked datablocks and unchanged datablocks
  * will be restored from the old database. Only new or changed datablocks will
  * actually be read. */
-static BHead *read_libblock(FileData *fd,
-                            Main *main,
-                            BHead *bhead,
-                            int id_tag,
-                            ID_Readfile_Data::Tags id_read_tags,
-                            const bool placeholder_set_indirect_extern,
-                            ID **r_id)
+/**
+ * Whether the data of an ID of that type can be linked in parallel with other IDs, i.e. its
+ * `blend_read_data` callback only accesses data of the ID itself.
+ */
+static bool read_libblock_can_defer(const Main *main, const short idcode)
+{
+  if (main->curlib != nullptr) {
+    return false;
+  }
+  return ELEM(idcode,
+              ID_ME,
+              ID_CV,
+              ID_PT,
+              ID_MA,
+              ID_TE,
+              ID_IM,
+              ID_NT,
+              ID_AC,
+              ID_KE,
+              ID_LA,
+              ID_CA);
+}
+
+/** Add a newly read ID to the lookup maps, once its data has been linked. */
+static void read_libblock_register(FileData *fd, Main *main, ID *id, ID *id_target)
+{
+  if (fd->new_idmap_uid != nullptr) {
+    BKE_main_idmap_insert_id(fd->new_idmap_uid, id_target);
+  }
+  if (main->id_map != nullptr) {
+    BKE_main_idmap_insert_id(main->id_map, id_target);
+  }
+  if (ID_IS_PACKED(id)) {
+    BLI_assert(id->deep_hash != IDHash::get_null());
+    fd->id_by_deep_hash->add_new(id->deep_hash, id);
+    BLI_assert(main->curlib);
+  }
+  if (fd->file_stat) {
+    id->runtime->src_blend_modifification_time = fd->file_stat->st_mtime;
+  }
+}
+
+static BHead *read_libblock_ex(FileData *fd,
+                               Main *main,
+                               BHead *bhead,
+                               int id_tag,
+                               ID_Readfile_Data::Tags id_read_tags,
+                               const bool placeholder_set_indirect_extern,
+                               ID **r_id)
 {
   const bool do_partial_undo = (fd->skip_flags & BLO_READ_SKIP_UNDO_OLD_MAIN) == 0;
 
@@ -3273,11 +3749,20 @@ static BHead *read_libblock(FileData *fd,
     return blo_bhead_next(fd, bhead);
   }
 
+  if (fd->deferred_id_reads && read_libblock_can_defer(main, idcode)) {
+    /* Only read the data blocks now, the data is linked later in parallel with other IDs. */
+    DeferredIDRead deferred_read{main, id, id_tag, id_read_tags, {oldnewmap_new(), {}}};
+    bhead = read_data_into_datamap(
+        fd, bhead, blockname, id_type_index, &deferred_read.data_blocks);
+    fd->deferred_id_reads->append(std::move(deferred_read));
+    return bhead;
+  }
+
   /* Read datablock contents.
    * Use convenient malloc name for debugging and better memory link prints. */
   bhead = read_data_into_datamap(fd, bhead, blockname, id_type_index);
   const bool success = direct_link_id(fd, main, id_tag, id_read_tags, id, id_old);
-  oldnewmap_clear(fd->datamap);
+  datamap_clear(fd);
 
   if (!success) {
     /* XXX This is probably working OK currently given the very limited scope of that flag.
@@ -3294,25 +3779,86 @@ static BHead *read_libblock(FileData *fd,
       /* For undo, store contents read into id at id_old. */
       read_libblock_undo_restore_at_old_address(fd, main, id, id_old);
     }
-    if (fd->new_idmap_uid != nullptr) {
-      BKE_main_idmap_insert_id(fd->new_idmap_uid, id_target);
-    }
-    if (main->id_map != nullptr) {
-      BKE_main_idmap_insert_id(main->id_map, id_target);
-    }
-    if (ID_IS_PACKED(id)) {
-      BLI_assert(id->deep_hash != IDHash::get_null());
-      fd->id_by_deep_hash->add_new(id->deep_hash, id);
-      BLI_assert(main->curlib);
-    }
-    if (fd->file_stat) {
-      id->runtime->src_blend_modifification_time = fd->file_stat->st_mtime;
-    }
+    read_libblock_register(fd, main, id, id_target);
   }
 
   return bhead;
 }
 
+static BHead *read_libblock(FileData *fd,
+                            Main *main,
+                            BHead *bhead,
+                            const int id_tag,
+                            const ID_Readfile_Data::Tags id_read_tags,
+                            const bool placeholder_set_indirect_extern,
+                            ID **r_id)
+{
+  if (!fd->use_io_stats) {
+    return read_libblock_ex(
+        fd, main, bhead, id_tag, id_read_tags, placeholder_set_indirect_extern, r_id);
+  }
+
+  const double start_time = BLI_time_now_seconds();
+  const short idcode = short(bhead->code);
+  BHead *bhead_next = read_libblock_ex(
+      fd, main, bhead, id_tag, id_read_tags, placeholder_set_indirect_extern, r_id);
+  const double duration = BLI_time_now_seconds() - start_time;
+
+  /* All blocks of the ID have been read already, up to the next one. */
+  size_t size = 0;
+  for (BHead *bhead_iter = bhead; bhead_iter && bhead_iter != bhead_next;
+       bhead_iter = blo_bhead_next(fd, bhead_iter))
+  {
+    size += sizeof(BHead) + size_t(bhead_iter->len);
+  }
+  BLO_io_stats_id_add(false, idcode, 1, duration, size);
+  return bhead_next;
+}
+
+/**
+ * Link the data of all IDs deferred by #read_libblock, in parallel. This only accesses the data
+ * blocks of each ID, which have been read from the file already.
+ */
+static void read_libblock_deferred_finish(FileData *fd)
+{
+  if (!fd->deferred_id_reads) {
+    return;
+  }
+  blender::MutableSpan<DeferredIDRead> deferred_reads = *fd->deferred_id_reads;
+
+  blender::threading::parallel_for(
+      deferred_reads.index_range(), 1, [&](const blender::IndexRange range) {
+        for (DeferredIDRead &deferred_read : deferred_reads.slice(range)) {
+          const double start_time = fd->use_io_stats ? BLI_time_now_seconds() : 0.0;
+          const bool success = direct_link_id(fd,
+                                              deferred_read.main,
+                                              deferred_read.id_tag,
+                                              deferred_read.id_read_tags,
+                                              deferred_read.id,
+                                              nullptr,
+                                              &deferred_read.data_blocks);
+          /* Only screens and libraries can fail, which are never deferred. */
+          BLI_assert(success);
+          UNUSED_VARS_NDEBUG(success);
+          oldnewmap_clear(deferred_read.data_blocks.datamap);
+          oldnewmap_free(deferred_read.data_blocks.datamap);
+          if (fd->use_io_stats) {
+            /* The ID itself has been counted when its blocks were read. */
+            BLO_io_stats_id_add(false,
+                                GS(deferred_read.id->name),
+                                0,
+                                BLI_time_now_seconds() - start_time,
+                                0);
+          }
+        }
+      });
+
+  for (DeferredIDRead &deferred_read : deferred_reads) {
+    read_libblock_register(fd, deferred_read.main, deferred_read.id, deferred_read.id);
+  }
+  fd->deferred_id_reads.reset();
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -3329,7 +3875,7 @@ BHead *blo_read_asset_data_block(FileData *fd, BHead *bhead, AssetMetaData **r_a
   BLO_read_struct(&reader, AssetMetaData, r_asset_data);
   BKE_asset_metadata_read(&reader, *r_asset_data);
 
-  oldnewmap_clear(fd->datamap);
+  datamap_clear(fd);
 
   return bhead;
 }
@@ -3432,6 +3978,8 @@ static void do_versions_userdef(FileData * /*fd*/, BlendFileData *bfd)
 
 static void do_versions(FileData *fd, Library *lib, Main *main)
 {
+  const BLOIOStatsScopedPhase stats_phase(BLO_IO_STATS_PHASE_VERSIONING, fd->use_io_stats);
+
   /* WATCH IT!!!: pointers from libdata have not been converted */
 
   /* Don't allow versioning to create new data-blocks. */
@@ -3525,6 +4073,7 @@ static void do_versions(FileData *fd, Library *lib, Main *main)
 static void do_versions_after_linking(FileData *fd, Main *main)
 {
   BLI_assert(fd != nullptr);
+  const BLOIOStatsScopedPhase stats_phase(BLO_IO_STATS_PHASE_VERSIONING, fd->use_io_stats);
 
   CLOG_DEBUG(&LOG,
              "Processing %s (%s), %d.%d",
@@ -3615,6 +4164,7 @@ static int lib_link_cb(LibraryIDLinkCallbackData *cb_data)
 
 static void lib_link_all(FileData *fd, Main *bmain)
 {
+  const BLOIOStatsScopedPhase stats_phase(BLO_IO_STATS_PHASE_LIB_LINK, fd->use_io_stats);
   BlendLibReader reader = {fd, bmain};
 
   ID *id;
@@ -3821,7 +4371,7 @@ static BHead *read_userdef(BlendFileData *bfd, FileData *fd, BHead *bhead)
   user->edit_studio_light = 0;
 
   /* free fd->datamap again */
-  oldnewmap_clear(fd->datamap);
+  datamap_clear(fd);
 
   return bhead;
 }
@@ -3956,6 +4506,10 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     read_undo_reuse_noundo_local_ids(fd);
   }
 
+  if (!is_undo && USER_DEVELOPER_TOOL_TEST(&U, use_parallel_blend_file_read)) {
+    fd->deferred_id_reads.emplace();
+  }
+
   while (bhead) {
     /* If not-null after the `switch`, the BHead is an ID one and needs to be read. */
     Main *bmain_to_read_into = nullptr;
@@ -3963,6 +4517,7 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 
     switch (bhead->code) {
       case BLO_CODE_DATA:
+      case BLO_CODE_DATA_REFERENCE:
       case BLO_CODE_DNA1:
       case BLO_CODE_TEST: /* used as preview since 2.5x */
       case BLO_CODE_REND:
@@ -4041,10 +4596,14 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     }
 
     if (bfd->main->is_read_invalid) {
+      /* Deferred IDs still need valid data to be freed. */
+      read_libblock_deferred_finish(fd);
       return bfd;
     }
   }
 
+  read_libblock_deferred_finish(fd);
+
   if (is_undo) {
     /* Move the remaining Library IDs and their linked data to the new main.
      *
@@ -5224,6 +5783,9 @@ void BLO_library_link_end(Main *mainl,
     library_filedata_release(lib);
   }
 
+  /* Linking is done, so libraries can be read again to create their versioned copies. */
+  blo_versioning_cache_update();
+
   *bh = reinterpret_cast<BlendHandle *>(fd);
 }
 
@@ -5436,7 +5998,28 @@ static FileData *read_library_file_data(FileData *basefd, Main *bmain, Main *lib
                      lib_bmain->curlib->runtime->filepath_abs,
                      lib_bmain->curlib->filepath,
                      library_parent_filepath(lib_bmain->curlib));
-    fd = blo_filedata_from_file(lib_bmain->curlib->runtime->filepath_abs, basefd->reports);
+    fd = blo_filedata_from_file(
+        lib_bmain->curlib->runtime->filepath_abs, basefd->reports, true);
+
+    /* Read a versioned copy of libraries saved by older versions instead, when available. Only
+     * the file version from the header is checked, versioning of files with an older subversion
+     * is usually cheap. */
+    if (fd && fd->fileversion < BLENDER_FILE_VERSION &&
+        USER_DEVELOPER_TOOL_TEST(&U, use_versioning_cache))
+    {
+      const std::string cache_filepath = blo_versioning_cache_filepath_find(
+          lib_bmain->curlib->runtime->filepath_abs);
+      if (!cache_filepath.empty()) {
+        if (FileData *cache_fd = blo_filedata_from_file(
+                cache_filepath.c_str(), basefd->reports, true))
+        {
+          blo_filedata_free(fd);
+          fd = cache_fd;
+          /* Relative paths are still resolved from the original library location. */
+          STRNCPY(fd->relabase, lib_bmain->curlib->runtime->filepath_abs);
+        }
+      }
+    }
   }
 
   if (fd) {
@@ -5612,14 +6195,14 @@ static void *blo_verify_data_address(FileData *fd,
 
 void *BLO_read_get_new_data_address(BlendDataReader *reader, const void *old_address)
 {
-  return newdataadr(reader->fd, old_address);
+  return newdataadr(reader, old_address);
 }
 
 void *BLO_read_get_new_data_address_no_us(BlendDataReader *reader,
                                           const void *old_address,
                                           const size_t expected_size)
 {
-  void *new_address = newdataadr_no_us(reader->fd, old_address);
+  void *new_address = newdataadr_no_us(reader, old_address);
   return blo_verify_data_address(reader->fd, new_address, old_address, expected_size);
 }
 
@@ -5627,7 +6210,7 @@ void *BLO_read_struct_array_with_size(BlendDataReader *reader,
                                       const void *old_address,
                                       const size_t expected_size)
 {
-  void *new_address = newdataadr(reader->fd, old_address);
+  void *new_address = newdataadr(reader, old_address);
   return blo_verify_data_address(reader->fd, new_address, old_address, expected_size);
 }
 
@@ -5796,7 +6379,7 @@ void BLO_read_pointer_array(BlendDataReader *reader, const int64_t array_size, v
 {
   FileData *fd = reader->fd;
 
-  void *orig_array = newdataadr(fd, *ptr_p);
+  void *orig_array = newdataadr(reader, *ptr_p);
   if (orig_array == nullptr) {
     *ptr_p = nullptr;
     return;
@@ -5832,6 +6415,78 @@ void BLO_read_pointer_array(BlendDataReader *reader, const int64_t array_size, v
   *ptr_p = final_array;
 }
 
+const blender::ImplicitSharingInfo *BLO_read_mapped_array(BlendDataReader *reader,
+                                                          const int64_t size_in_bytes,
+                                                          const int64_t alignment,
+                                                          void **ptr_p)
+{
+  FileData *fd = reader->fd;
+  if (fd->mapping == nullptr || *ptr_p == nullptr) {
+    return nullptr;
+  }
+  blender::Map<const void *, MappedDataBlock> &mapped_data_blocks =
+      reader->data_blocks ? reader->data_blocks->mapped_data_blocks : fd->mapped_data_blocks;
+  const MappedDataBlock *block = mapped_data_blocks.lookup_ptr(*ptr_p);
+  if (block == nullptr || block->bhead->len < size_in_bytes) {
+    /* Invalid sizes are reported when reading the data the regular way. */
+    return nullptr;
+  }
+  if (BLI_mmap_file_changed(fd->mapping->mmap)) {
+    if (!fd->mapping_changed_reported) {
+      BLO_reportf_wrap(fd->reports,
+                       RPT_ERROR,
+                       RPT_("File '%s' was modified on disk while reading it"),
+                       fd->mapping->filepath.c_str());
+      fd->mapping_changed_reported = true;
+    }
+    return nullptr;
+  }
+  char *data = static_cast<char *>(BLI_mmap_get_pointer(fd->mapping->mmap)) +
+               BHEADN_FROM_BHEAD(block->bhead)->file_offset;
+  if (uintptr_t(data) % uintptr_t(alignment) != 0) {
+    return nullptr;
+  }
+
+  mapped_data_blocks.remove(*ptr_p);
+  *ptr_p = data;
+  return MEM_new<MappedArraySharingInfo>(__func__, fd->mapping);
+}
+
+bool BLO_read_array_lazy(BlendDataReader *reader,
+                         const int64_t size_in_bytes,
+                         void **ptr_p,
+                         std::function<void(void *data)> assign)
+{
+  FileData *fd = reader->fd;
+  if (fd->lazy_file == nullptr || reader->id == nullptr || *ptr_p == nullptr) {
+    return false;
+  }
+  /* Only meshes are supported currently, other geometry types may move their layers to another
+   * storage while reading them. */
+  if (GS(reader->id->name) != ID_ME) {
+    return false;
+  }
+  blender::Map<const void *, MappedDataBlock> &mapped_data_blocks =
+      reader->data_blocks ? reader->data_blocks->mapped_data_blocks : fd->mapped_data_blocks;
+  const MappedDataBlock *block = mapped_data_blocks.lookup_ptr(*ptr_p);
+  if (block == nullptr || block->bhead->len != size_in_bytes) {
+    /* Invalid sizes are reported when reading the data the regular way. */
+    return false;
+  }
+
+  ID &id = *reader->id;
+  if (id.runtime->lazy_data == nullptr) {
+    id.runtime->lazy_data = MEM_new<ID_LazyData>(__func__);
+    id.runtime->lazy_data->file = fd->lazy_file;
+  }
+  id.runtime->lazy_data->arrays.append(
+      {BHEADN_FROM_BHEAD(block->bhead)->file_offset, size_in_bytes, std::move(assign)});
+
+  mapped_data_blocks.remove(*ptr_p);
+  *ptr_p = nullptr;
+  return true;
+}
+
 blender::ImplicitSharingInfoAndData blo_read_shared_impl(
     BlendDataReader *reader,
     const void **ptr_p,
@@ -5887,7 +6542,7 @@ void BLO_read_data_globmap_add(BlendDataReader *reader, void *oldaddr, void *new
 
 void BLO_read_glob_list(BlendDataReader *reader, ListBase *list)
 {
-  link_glob_list(reader->fd, list);
+  link_glob_list(reader, list);
 }
 
 BlendFileReadReport *BLO_read_data_reports(BlendDataReader *reader)
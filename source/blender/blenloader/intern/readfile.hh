@@ -10,7 +10,9 @@
 #pragma once
 
 #include <cstdio> /* IWYU pragma: keep. Include header using off_t before poisoning it below. */
+#include <memory>
 #include <optional>
+#include <string>
 
 #ifdef WIN32
 #  include "BLI_winstuff.h"
@@ -19,6 +21,8 @@
 #include "BLI_fileops.h"
 #include "BLI_filereader.h"
 #include "BLI_map.hh"
+#include "BLI_mutex.hh"
+#include "BLI_vector.hh"
 
 #include "DNA_sdna_types.h"
 #include "DNA_space_types.h"
@@ -33,6 +37,8 @@ struct BlendFileReadParams;
 struct BlendFileReadReport;
 struct BLOCacheStorage;
 struct BHeadSort;
+struct BlendFileMapping;
+struct LazyLibraryFile;
 struct DNA_ReconstructInfo;
 struct IDNameLib_Map;
 struct Key;
@@ -61,6 +67,11 @@ enum eFileDataFlag {
    * corrupted). I.e. their names have no null char in their first 66 bytes.
    */
   FD_FLAGS_HAS_INVALID_ID_NAMES = 1 << 6,
+  /**
+   * The blend-file is read from an uncompressed file on disk, so the data of blocks can also be
+   * read directly from their offset in the file later, see #FileData.lazy_file.
+   */
+  FD_FLAGS_IS_UNCOMPRESSED_FILE = 1 << 7,
 };
 ENUM_OPERATORS(eFileDataFlag, FD_FLAGS_IS_MEMFILE)
 
@@ -69,6 +80,37 @@ ENUM_OPERATORS(eFileDataFlag, FD_FLAGS_IS_MEMFILE)
 #  pragma GCC poison off_t
 #endif
 
+/**
+ * A data block that has not been read yet, because it may be referenced directly from the
+ * memory-mapped file instead, see #FileData.mapping.
+ */
+struct MappedDataBlock {
+  BHead *bhead;
+  const char *allocname;
+  int id_type_index;
+};
+
+/**
+ * Data blocks of a single ID, used instead of #FileData.datamap and #FileData.mapped_data_blocks
+ * for IDs whose data is linked in parallel, see #DeferredIDRead.
+ */
+struct IDDataBlocks {
+  OldNewMap *datamap = nullptr;
+  blender::Map<const void *, MappedDataBlock> mapped_data_blocks;
+};
+
+/**
+ * An ID that has been read with all its data blocks, but whose data has not been linked yet. This
+ * allows linking the data of many independent IDs in parallel once the whole file has been read.
+ */
+struct DeferredIDRead {
+  Main *main;
+  ID *id;
+  int id_tag;
+  ID_Readfile_Data::Tags id_read_tags;
+  IDDataBlocks data_blocks;
+};
+
 /**
  * General data used during a blend-file reading.
  *
@@ -80,6 +122,8 @@ struct FileData {
   ListBase bhead_list = {};
   enum eFileDataFlag flags = eFileDataFlag(0);
   bool is_eof = false;
+  /** Gather statistics about reading the file, see #BLO_io_stats_is_enabled. */
+  bool use_io_stats = false;
   BlenderHeader blender_header = {};
 
   FileReader *file = nullptr;
@@ -139,6 +183,45 @@ struct FileData {
 
   OldNewMap *datamap = nullptr;
   OldNewMap *globmap = nullptr;
+
+  /**
+   * Memory-mapped file that large arrays can be referenced from without copying them, see
+   * #BLO_read_mapped_array. Only set for uncompressed files when the "Zero-Copy Blend File
+   * Reading" experimental option is enabled.
+   */
+  BlendFileMapping *mapping = nullptr;
+  /** The file of #mapping changed on disk while reading it, which was reported already. */
+  bool mapping_changed_reported = false;
+  /**
+   * Library file that large arrays are read from when the IDs using them are first needed,
+   * instead of reading them with the rest of the ID, see #BLO_read_array_lazy. Only set for
+   * uncompressed library files that don't need versioning, when the "Lazy Library Data"
+   * experimental option is enabled.
+   */
+  std::shared_ptr<LazyLibraryFile> lazy_file;
+  /**
+   * Data blocks of the ID currently being read that are not in #datamap yet, because they may be
+   * referenced from #mapping or read from #lazy_file later instead. They are read into #datamap
+   * when accessed otherwise.
+   */
+  blender::Map<const void *, MappedDataBlock> mapped_data_blocks;
+
+  /**
+   * IDs whose data is linked in parallel once all blocks of the file have been read. Only set
+   * when reading a whole file with the "Parallel Blend File Reading" experimental option enabled.
+   */
+  std::optional<blender::Vector<DeferredIDRead>> deferred_id_reads;
+  /** Serializes reading blocks from #file while the data of deferred IDs is linked. */
+  blender::Mutex file_read_mutex;
+
+  /**
+   * #BLO_CODE_DATA blocks by their old address, used to resolve #BLO_CODE_DATA_REFERENCE blocks.
+   * Only built up to #data_bhead_index_end when references are read, since referenced blocks
+   * always come first in the file.
+   */
+  blender::Map<const void *, BHead *> data_bhead_by_old_address;
+  BHead *data_bhead_index_end = nullptr;
+
   /** Used to keep track of already loaded packed IDs to avoid loading them multiple times. */
   std::shared_ptr<blender::Map<IDHash, ID *>> id_by_deep_hash;
 
@@ -218,13 +301,31 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath) ATTR_N
  * On each new library added, it now checks for the current #FileData and expands relativeness
  *
  * cannot be called with relative paths anymore!
+ *
+ * \param is_library: The file is read to link or append data from it, rather than being opened
+ * as the main file.
  */
-FileData *blo_filedata_from_file(const char *filepath, BlendFileReadReport *reports);
+FileData *blo_filedata_from_file(const char *filepath,
+                                 BlendFileReadReport *reports,
+                                 bool is_library);
 FileData *blo_filedata_from_memory(const void *mem, int memsize, BlendFileReadReport *reports);
 FileData *blo_filedata_from_memfile(MemFile *memfile,
                                     const BlendFileReadParams *params,
                                     BlendFileReadReport *reports);
 
+/**
+ * Get the path of a copy of the library at \a filepath that was read and saved again by the
+ * current Blender version, stored in the user cache directory. Reading that copy does not require
+ * any versioning. Returns an empty string when there is no copy yet, its creation is then
+ * requested for the next #blo_versioning_cache_update.
+ */
+std::string blo_versioning_cache_filepath_find(const char *filepath);
+/**
+ * Start creating the versioned copies of libraries requested by
+ * #blo_versioning_cache_filepath_find on a background thread, if it is not running yet.
+ */
+void blo_versioning_cache_update();
+
 /**
  * Build a #GSet of old main (we only care about local data here,
  * so we can do that after #blo_split_main() call.
@@ -244,6 +345,17 @@ BHead *blo_bhead_first(FileData *fd) ATTR_NONNULL(1);
 BHead *blo_bhead_next(FileData *fd, BHead *thisblock) ATTR_NONNULL(1);
 BHead *blo_bhead_prev(FileData *fd, BHead *thisblock) ATTR_NONNULL(1, 2);
 
+/**
+ * Whether the block is part of the data of the preceding ID, i.e. #BLO_CODE_DATA or
+ * #BLO_CODE_DATA_REFERENCE.
+ */
+bool blo_bhead_is_data(const BHead *bhead);
+/**
+ * Get the block containing the data of \a bhead, which is the block itself unless it is a
+ * #BLO_CODE_DATA_REFERENCE. Returns null if the referenced block can't be found.
+ */
+BHead *blo_bhead_data_resolve(FileData *fd, BHead *bhead) ATTR_NONNULL(1, 2);
+
 /**
  * Warning! Caller's responsibility to ensure given bhead **is** an ID one!
  *
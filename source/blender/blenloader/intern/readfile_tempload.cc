@@ -28,7 +28,8 @@ TempLibraryContext *BLO_library_temp_load_id(Main *real_main,
   /* Copy the file path so any path remapping is performed properly. */
   STRNCPY(temp_lib_ctx->bmain_base->filepath, real_main->filepath);
 
-  BlendHandle *blendhandle = BLO_blendhandle_from_file(blend_file_path, &temp_lib_ctx->bf_reports);
+  BlendHandle *blendhandle = BLO_blendhandle_from_file_for_link(blend_file_path,
+                                                                &temp_lib_ctx->bf_reports);
 
   LibraryLink_Params lib_link_params;
   BLO_library_link_params_init(&lib_link_params, temp_lib_ctx->bmain_base, 0, ID_TAG_TEMP_MAIN);
@@ -18,33 +18,53 @@
 #  include <io.h>
 #endif
 
+#include <zstd.h>
+
+#include "CLG_log.h"
+
 #include "MEM_guardedalloc.h"
 
 #include "DNA_listBase.h"
 
+#include "BLI_array_store.h"
+#include "BLI_fileops.h"
 #include "BLI_implicit_sharing.hh"
+#include "BLI_path_utils.hh"
+#include "BLI_string.h"
+#include "BLI_vector.hh"
 
 #include "BLO_readfile.hh"
 #include "BLO_undofile.hh"
 
+#include "BKE_appdir.hh"
 #include "BKE_lib_id.hh"
 #include "BKE_main.hh"
 #include "BKE_undo_system.hh"
 
 #include "BLI_strict_flags.h" /* IWYU pragma: keep. Keep last. */
 
+static CLG_LogRef LOG = {"undo"};
+
 /* **************** support for memory-write, for undo buffers *************** */
 
+static void memfile_archive_free(MemFileArchive *archive);
+
 void BLO_memfile_free(MemFile *memfile)
 {
   while (MemFileChunk *chunk = static_cast<MemFileChunk *>(BLI_pophead(&memfile->chunks))) {
-    if (chunk->is_identical == false) {
+    if (chunk->owns_buf) {
       MEM_freeN(chunk->buf);
     }
     MEM_freeN(chunk);
   }
   MEM_delete(memfile->shared_storage);
   memfile->shared_storage = nullptr;
+  MEM_delete(memfile->id_storage);
+  memfile->id_storage = nullptr;
+  if (memfile->archive) {
+    memfile_archive_free(memfile->archive);
+    memfile->archive = nullptr;
+  }
   memfile->size = 0;
 }
 
@@ -64,7 +84,7 @@ void BLO_memfile_merge(MemFile *first, MemFile *second)
 
   /* First, detect all memchunks in second memfile that are not owned by it. */
   LISTBASE_FOREACH (MemFileChunk *, sc, &second->chunks) {
-    if (sc->is_identical) {
+    if (!sc->owns_buf) {
       buffer_to_second_memchunk.add(sc->buf, sc);
     }
   }
@@ -72,11 +92,12 @@ void BLO_memfile_merge(MemFile *first, MemFile *second)
   /* Now, check all chunks from first memfile (the one we are removing), and if a memchunk owned by
    * it is also used by the second memfile, transfer the ownership. */
   LISTBASE_FOREACH (MemFileChunk *, fc, &first->chunks) {
-    if (!fc->is_identical) {
+    if (fc->owns_buf) {
       if (MemFileChunk *sc = buffer_to_second_memchunk.lookup_default(fc->buf, nullptr)) {
-        BLI_assert(sc->is_identical);
+        BLI_assert(!sc->owns_buf);
         sc->is_identical = false;
-        fc->is_identical = true;
+        sc->owns_buf = true;
+        fc->owns_buf = false;
       }
       /* Note that if the second memfile does not use that chunk, we assume that the first one
        * fully owns it without sharing it with any other memfile, and hence it should be freed with
@@ -98,6 +119,11 @@ void BLO_memfile_write_init(MemFileWriteData *mem_data,
                             MemFile *written_memfile,
                             MemFile *reference_memfile)
 {
+  if (reference_memfile && !BLO_memfile_archive_restore(reference_memfile)) {
+    /* Write all data again instead of comparing against the lost data. */
+    reference_memfile = nullptr;
+  }
+
   mem_data->written_memfile = written_memfile;
   mem_data->reference_memfile = reference_memfile;
   mem_data->reference_current_chunk = reference_memfile ? static_cast<MemFileChunk *>(
@@ -134,6 +160,7 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
   curchunk->size = size;
   curchunk->buf = nullptr;
   curchunk->is_identical = false;
+  curchunk->owns_buf = false;
   /* This is unsafe in the sense that an app handler or other code that does not
    * perform an undo push may make changes after the last undo push that
    * will then not be undo. Though it's not entirely clear that is wrong behavior. */
@@ -159,10 +186,278 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
     char *buf_new = MEM_malloc_arrayN<char>(size, "Chunk buffer");
     memcpy(buf_new, buf, size);
     curchunk->buf = buf_new;
+    curchunk->owns_buf = true;
     memfile->size += size;
   }
 }
 
+void BLO_memfile_chunks_reuse_for_id(MemFileWriteData *mem_data, const uint id_session_uid)
+{
+  MemFile *memfile = mem_data->written_memfile;
+  MemFileChunk *compchunk = mem_data->reference_current_chunk;
+
+  while (compchunk != nullptr && compchunk->id_session_uid == id_session_uid) {
+    MemFileChunk *curchunk = MEM_mallocN<MemFileChunk>("MemFileChunk");
+    curchunk->size = compchunk->size;
+    curchunk->buf = compchunk->buf;
+    curchunk->is_identical = true;
+    curchunk->owns_buf = false;
+    curchunk->is_identical_future = true;
+    curchunk->id_session_uid = id_session_uid;
+    BLI_addtail(&memfile->chunks, curchunk);
+
+    compchunk->is_identical_future = true;
+    compchunk = static_cast<MemFileChunk *>(compchunk->next);
+  }
+  mem_data->reference_current_chunk = compchunk;
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Undo Archive
+ *
+ * Older undo steps are neither read nor used as reference for writing in the common case, so
+ * their data is stored more compactly. The data of all archived memfiles is kept in a single
+ * #BArrayStore, where each memfile is de-duplicated against the previously archived one. When the
+ * store grows beyond the memory limit, the oldest memfiles are moved to compressed files in the
+ * session temporary directory.
+ * \{ */
+
+/** Chunk size of the array store, in bytes. */
+#define MEMFILE_ARCHIVE_CHUNK_SIZE 4096
+/** Use the fastest compression level, undo pushes should stay interactive. */
+#define MEMFILE_ARCHIVE_ZSTD_LEVEL 1
+
+struct MemFileArchive {
+  /** Size of the data of all chunks. */
+  size_t data_size = 0;
+  /** Memory added to the store when this memfile was archived. */
+  size_t memory_size = 0;
+  /** Set while the data is kept in the array store. */
+  BArrayState *state = nullptr;
+  /** Set once the data has been evicted to disk. */
+  std::string filepath;
+  /** When true, the chunks have their own buffers again, see #BLO_memfile_archive_restore. */
+  bool is_restored = false;
+};
+
+static struct {
+  BArrayStore *store;
+  /** Archives with data in the store, oldest first. */
+  blender::Vector<MemFileArchive *> archives_in_store;
+  /** Used to generate unique file names for evicted archives. */
+  uint file_counter;
+} g_memfile_archive = {};
+
+static void memfile_archive_free(MemFileArchive *archive)
+{
+  if (archive->state) {
+    g_memfile_archive.archives_in_store.remove(
+        g_memfile_archive.archives_in_store.first_index_of(archive));
+    BLI_array_store_state_remove(g_memfile_archive.store, archive->state);
+    if (g_memfile_archive.archives_in_store.is_empty()) {
+      BLI_array_store_destroy(g_memfile_archive.store);
+      g_memfile_archive.store = nullptr;
+    }
+  }
+  if (!archive->filepath.empty()) {
+    BLI_delete(archive->filepath.c_str(), false, false);
+  }
+  MEM_delete(archive);
+}
+
+/**
+ * Hand over buffers owned by the memfile to the first later memfile using them, free the others.
+ */
+static void memfile_archive_release_chunks(MemFile *memfile,
+                                           const blender::Span<MemFile *> later_memfiles)
+{
+  blender::Map<const char *, MemFileChunk *> later_chunk_by_buffer;
+  for (MemFile *later_memfile : later_memfiles) {
+    LISTBASE_FOREACH (MemFileChunk *, chunk, &later_memfile->chunks) {
+      if (!chunk->owns_buf && chunk->buf != nullptr) {
+        later_chunk_by_buffer.add(chunk->buf, chunk);
+      }
+    }
+  }
+
+  /* Only the ownership changes, #MemFileChunk.is_identical still describes the undo steps. */
+  LISTBASE_FOREACH (MemFileChunk *, chunk, &memfile->chunks) {
+    if (chunk->owns_buf) {
+      if (MemFileChunk *later_chunk = later_chunk_by_buffer.lookup_default(chunk->buf, nullptr)) {
+        later_chunk->owns_buf = true;
+      }
+      else {
+        MEM_freeN(chunk->buf);
+      }
+    }
+    chunk->buf = nullptr;
+    chunk->owns_buf = false;
+  }
+  memfile->size = 0;
+}
+
+void BLO_memfile_archive(MemFile *memfile, const blender::Span<MemFile *> later_memfiles)
+{
+  MemFileArchive *archive = memfile->archive;
+  if (archive != nullptr && !archive->is_restored) {
+    return;
+  }
+
+  if (archive == nullptr) {
+    /* The archived data of a restored memfile is still valid, only add new memfiles. */
+    archive = MEM_new<MemFileArchive>(__func__);
+    LISTBASE_FOREACH (const MemFileChunk *, chunk, &memfile->chunks) {
+      archive->data_size += chunk->size;
+    }
+
+    char *data = MEM_malloc_arrayN<char>(archive->data_size, __func__);
+    size_t offset = 0;
+    LISTBASE_FOREACH (const MemFileChunk *, chunk, &memfile->chunks) {
+      memcpy(data + offset, chunk->buf, chunk->size);
+      offset += chunk->size;
+    }
+
+    if (g_memfile_archive.store == nullptr) {
+      g_memfile_archive.store = BLI_array_store_create(1, MEMFILE_ARCHIVE_CHUNK_SIZE);
+    }
+    const BArrayState *state_reference = g_memfile_archive.archives_in_store.is_empty() ?
+                                             nullptr :
+                                             g_memfile_archive.archives_in_store.last()->state;
+    const size_t size_prev = BLI_array_store_calc_size_compacted_get(g_memfile_archive.store);
+    archive->state = BLI_array_store_state_add(
+        g_memfile_archive.store, data, archive->data_size, state_reference);
+    archive->memory_size = BLI_array_store_calc_size_compacted_get(g_memfile_archive.store) -
+                           size_prev;
+    g_memfile_archive.archives_in_store.append(archive);
+    MEM_freeN(data);
+
+    memfile->archive = archive;
+  }
+
+  memfile_archive_release_chunks(memfile, later_memfiles);
+  archive->is_restored = false;
+}
+
+static char *memfile_archive_read_from_disk(const MemFileArchive &archive)
+{
+  size_t compressed_size = 0;
+  void *compressed_data = BLI_file_read_binary_as_mem(
+      archive.filepath.c_str(), 0, &compressed_size);
+  if (compressed_data == nullptr) {
+    return nullptr;
+  }
+  char *data = MEM_malloc_arrayN<char>(archive.data_size, __func__);
+  const size_t data_size = ZSTD_decompress(
+      data, archive.data_size, compressed_data, compressed_size);
+  MEM_freeN(compressed_data);
+  if (ZSTD_isError(data_size) || data_size != archive.data_size) {
+    MEM_freeN(data);
+    return nullptr;
+  }
+  return data;
+}
+
+bool BLO_memfile_archive_restore(MemFile *memfile)
+{
+  MemFileArchive *archive = memfile->archive;
+  if (archive == nullptr || archive->is_restored) {
+    return true;
+  }
+
+  char *data = nullptr;
+  if (archive->state) {
+    size_t data_size = 0;
+    data = static_cast<char *>(BLI_array_store_state_data_get_alloc(archive->state, &data_size));
+    BLI_assert(data_size == archive->data_size);
+  }
+  else {
+    data = memfile_archive_read_from_disk(*archive);
+  }
+  if (data == nullptr) {
+    /* The chunks stay without buffers, the archive may still be restored later. */
+    CLOG_ERROR(&LOG, "Unable to restore archived undo step from '%s'", archive->filepath.c_str());
+    return false;
+  }
+
+  /* Restored chunks own their buffers, so the regular sharing with later memfiles applies. */
+  size_t offset = 0;
+  LISTBASE_FOREACH (MemFileChunk *, chunk, &memfile->chunks) {
+    char *buf = MEM_malloc_arrayN<char>(chunk->size, "Chunk buffer");
+    memcpy(buf, data + offset, chunk->size);
+    chunk->buf = buf;
+    chunk->owns_buf = true;
+    offset += chunk->size;
+  }
+  MEM_freeN(data);
+
+  memfile->size = archive->data_size;
+  archive->is_restored = true;
+  return true;
+}
+
+static bool memfile_archive_write_to_disk(MemFileArchive &archive)
+{
+  size_t data_size = 0;
+  void *data = BLI_array_store_state_data_get_alloc(archive.state, &data_size);
+
+  const size_t compressed_size_max = ZSTD_compressBound(data_size);
+  void *compressed_data = MEM_mallocN(compressed_size_max, __func__);
+  const size_t compressed_size = ZSTD_compress(
+      compressed_data, compressed_size_max, data, data_size, MEMFILE_ARCHIVE_ZSTD_LEVEL);
+  MEM_freeN(data);
+
+  bool success = false;
+  if (!ZSTD_isError(compressed_size)) {
+    char filename[64];
+    SNPRINTF(filename, "undo_archive_%u.zst", g_memfile_archive.file_counter++);
+    char filepath[FILE_MAX];
+    BLI_path_join(filepath, sizeof(filepath), BKE_tempdir_session(), filename);
+
+    if (FILE *file = BLI_fopen(filepath, "wb")) {
+      success = fwrite(compressed_data, 1, compressed_size, file) == compressed_size;
+      fclose(file);
+      if (success) {
+        archive.filepath = filepath;
+      }
+      else {
+        BLI_delete(filepath, false, false);
+      }
+    }
+  }
+  MEM_freeN(compressed_data);
+  return success;
+}
+
+void BLO_memfile_archive_evict(const size_t memory_limit)
+{
+  while (g_memfile_archive.store &&
+         BLI_array_store_calc_size_compacted_get(g_memfile_archive.store) > memory_limit)
+  {
+    MemFileArchive *archive = g_memfile_archive.archives_in_store.first();
+    if (!memfile_archive_write_to_disk(*archive)) {
+      break;
+    }
+    g_memfile_archive.archives_in_store.remove(0);
+    BLI_array_store_state_remove(g_memfile_archive.store, archive->state);
+    archive->state = nullptr;
+    archive->memory_size = 0;
+    if (g_memfile_archive.archives_in_store.is_empty()) {
+      BLI_array_store_destroy(g_memfile_archive.store);
+      g_memfile_archive.store = nullptr;
+    }
+  }
+}
+
+size_t BLO_memfile_memory_size(const MemFile *memfile)
+{
+  if (memfile->archive == nullptr || memfile->archive->is_restored) {
+    return memfile->size;
+  }
+  return memfile->archive->memory_size;
+}
+
+/** \} */
+
 Main *BLO_memfile_main_get(MemFile *memfile, Main *bmain, Scene **r_scene)
 {
   Main *bmain_undo = nullptr;
@@ -264,6 +559,10 @@ static void undo_close(FileReader *reader)
 
 FileReader *BLO_memfile_new_filereader(MemFile *memfile, int undo_direction)
 {
+  if (!BLO_memfile_archive_restore(memfile)) {
+    return nullptr;
+  }
+
   UndoReader *undo = MEM_callocN<UndoReader>(__func__);
 
   undo->memfile = memfile;
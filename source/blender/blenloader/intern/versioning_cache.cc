@@ -0,0 +1,365 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup blenloader
+ *
+ * Cache of versioned library files.
+ *
+ * Linking from a library saved by an older Blender version runs all versioning code on the linked
+ * data, every time the library is read. Libraries such as asset libraries rarely change, so a
+ * copy of them that has been read and saved by the current version is kept in the user cache
+ * directory. That copy is read instead of the original file, without any versioning.
+ *
+ * Cached files are identified by the path, size, modification time and content hash of the
+ * original file and the current file version, so modified libraries and newer Blender versions
+ * never use outdated copies. Hashing the library content is much cheaper than versioning it.
+ *
+ * Creating a copy requires reading the whole library, so it is done by a background thread once
+ * the file that links it has been read (see #blo_versioning_cache_update). The cache is limited
+ * in size, the copies that were used least recently are removed first.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <thread>
+
+#ifndef WIN32
+#  include <unistd.h>
+#else
+#  include <io.h>
+#endif
+
+#include <xxhash.h>
+
+#include "CLG_log.h"
+
+#include "BLI_array.hh"
+#include "BLI_fileops.h"
+#include "BLI_fileops_types.h"
+#include "BLI_mutex.hh"
+#include "BLI_path_utils.hh"
+#include "BLI_string.h"
+#include "BLI_vector.hh"
+#include "BLI_vector_set.hh"
+
+#include "BKE_appdir.hh"
+#include "BKE_blender.hh"
+#include "BKE_blender_version.h"
+#include "BKE_main.hh"
+
+#include "BLO_readfile.hh"
+#include "BLO_writefile.hh"
+
+#include "readfile.hh"
+
+static CLG_LogRef LOG = {"blend.readfile.versioning_cache"};
+
+namespace blender::blo {
+
+/** Total size of the cached copies, above which the least recently used ones are removed. */
+static constexpr int64_t VERSIONING_CACHE_SIZE_MAX = int64_t(4) * 1024 * 1024 * 1024;
+
+/** Libraries that have no versioned copy yet, and the background thread creating them. */
+struct VersioningCacheRequests {
+  Mutex mutex;
+  VectorSet<std::string> filepaths;
+  std::thread worker;
+  bool worker_running = false;
+  bool exit_registered = false;
+  /** Set when Blender exits, copies that are not created yet are skipped then. */
+  std::atomic<bool> cancel = false;
+};
+
+static VersioningCacheRequests &versioning_cache_requests()
+{
+  static VersioningCacheRequests requests;
+  return requests;
+}
+
+/** Identifies the current state and content of the file. */
+struct VersioningCacheKey {
+  int64_t size;
+  int64_t mtime_nsec;
+  XXH128_hash_t content_hash;
+
+  bool operator==(const VersioningCacheKey &other) const
+  {
+    return size == other.size && mtime_nsec == other.mtime_nsec &&
+           XXH128_isEqual(content_hash, other.content_hash);
+  }
+};
+
+static int64_t file_mtime_nsec_get(const BLI_stat_t &st)
+{
+#ifdef WIN32
+  return int64_t(st.st_mtime) * 1000000000;
+#elif defined(__APPLE__)
+  return int64_t(st.st_mtimespec.tv_sec) * 1000000000 + int64_t(st.st_mtimespec.tv_nsec);
+#else
+  return int64_t(st.st_mtim.tv_sec) * 1000000000 + int64_t(st.st_mtim.tv_nsec);
+#endif
+}
+
+static bool file_content_hash(const char *filepath, XXH128_hash_t &r_hash)
+{
+  const int file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+  if (file == -1) {
+    return false;
+  }
+  XXH3_state_t *state = XXH3_createState();
+  XXH3_128bits_reset(state);
+  Array<char> buffer(1024 * 1024, NoInitialization());
+  bool success = true;
+  while (true) {
+    const int64_t read_size = BLI_read(file, buffer.data(), size_t(buffer.size()));
+    if (read_size <= 0) {
+      success = read_size == 0;
+      break;
+    }
+    XXH3_128bits_update(state, buffer.data(), size_t(read_size));
+  }
+  r_hash = XXH3_128bits_digest(state);
+  XXH3_freeState(state);
+  close(file);
+  return success;
+}
+
+static bool versioning_cache_key_get(const char *filepath, VersioningCacheKey &r_key)
+{
+  BLI_stat_t st;
+  if (BLI_stat(filepath, &st) != 0) {
+    return false;
+  }
+  r_key.size = int64_t(st.st_size);
+  r_key.mtime_nsec = file_mtime_nsec_get(st);
+  return file_content_hash(filepath, r_key.content_hash);
+}
+
+static bool versioning_cache_dirpath_get(char r_cache_dirpath[FILE_MAX])
+{
+  if (!BKE_appdir_folder_caches(r_cache_dirpath, FILE_MAX)) {
+    return false;
+  }
+  BLI_path_append_dir(r_cache_dirpath, FILE_MAX, "versioning");
+  return true;
+}
+
+/**
+ * The prefix of the names of all cached copies of the library, used to remove outdated copies.
+ */
+static std::string versioning_cache_filename_prefix(const char *filepath)
+{
+  char prefix[32];
+  SNPRINTF(prefix, "%016llx_", (unsigned long long)XXH3_64bits(filepath, strlen(filepath)));
+  return prefix;
+}
+
+static bool versioning_cache_filepath_get(const char *filepath,
+                                          const VersioningCacheKey &key,
+                                          char r_cache_filepath[FILE_MAX])
+{
+  char cache_dirpath[FILE_MAX];
+  if (!versioning_cache_dirpath_get(cache_dirpath)) {
+    return false;
+  }
+
+  XXH3_state_t *state = XXH3_createState();
+  XXH3_128bits_reset(state);
+  XXH3_128bits_update(state, &key.size, sizeof(key.size));
+  XXH3_128bits_update(state, &key.mtime_nsec, sizeof(key.mtime_nsec));
+  XXH3_128bits_update(state, &key.content_hash, sizeof(key.content_hash));
+  const XXH128_hash_t hash = XXH3_128bits_digest(state);
+  XXH3_freeState(state);
+
+  char cache_filename[FILE_MAXFILE];
+  SNPRINTF(cache_filename,
+           "%s%016llx%016llx_%d_%d.blend",
+           versioning_cache_filename_prefix(filepath).c_str(),
+           (unsigned long long)hash.high64,
+           (unsigned long long)hash.low64,
+           BLENDER_FILE_VERSION,
+           BLENDER_FILE_SUBVERSION);
+  BLI_path_join(r_cache_filepath, FILE_MAX, cache_dirpath, cache_filename);
+  return true;
+}
+
+static bool versioning_cache_file_create(const char *filepath, const char *cache_filepath)
+{
+  /* Read the whole library, as any of its data-blocks may be linked later. */
+  BlendFileReadReport bf_reports{};
+  BlendFileData *bfd = BLO_read_from_file(filepath, BLO_READ_SKIP_USERDEF, &bf_reports);
+  if (bfd == nullptr) {
+    return false;
+  }
+  BLO_read_do_version_after_setup(bfd->main, nullptr, &bf_reports);
+
+  /* Paths in the cached file must not depend on its location. */
+  BlendFileWriteParams params{};
+  params.remap_mode = BLO_WRITE_PATH_REMAP_ABSOLUTE;
+  params.use_save_as_copy = true;
+  const bool success = BLO_write_file(bfd->main, cache_filepath, bfd->fileflags, &params, nullptr);
+
+  BLO_blendfiledata_free(bfd);
+  return success;
+}
+
+/**
+ * Remove other copies of the same library, which are outdated, and the least recently used
+ * copies while the cache is larger than #VERSIONING_CACHE_SIZE_MAX.
+ */
+static void versioning_cache_evict(const char *filepath, const char *cache_filepath)
+{
+  char cache_dirpath[FILE_MAX];
+  BLI_path_split_dir_part(cache_filepath, cache_dirpath, sizeof(cache_dirpath));
+  const std::string prefix = versioning_cache_filename_prefix(filepath);
+
+  direntry *entries;
+  const uint entries_num = BLI_filelist_dir_contents(cache_dirpath, &entries);
+  Vector<const direntry *> copies;
+  int64_t size = 0;
+  for (const direntry &entry : Span(entries, entries_num)) {
+    if (!S_ISREG(entry.type) || !BLI_path_extension_check(entry.relname, ".blend")) {
+      continue;
+    }
+    if (BLI_path_cmp(entry.path, cache_filepath) != 0 && STRPREFIX(entry.relname, prefix.c_str()))
+    {
+      BLI_delete(entry.path, false, false);
+      continue;
+    }
+    copies.append(&entry);
+    size += int64_t(entry.s.st_size);
+  }
+
+  std::sort(copies.begin(), copies.end(), [](const direntry *a, const direntry *b) {
+    return a->s.st_mtime < b->s.st_mtime;
+  });
+  for (const direntry *entry : copies) {
+    if (size <= VERSIONING_CACHE_SIZE_MAX) {
+      break;
+    }
+    if (BLI_path_cmp(entry->path, cache_filepath) == 0) {
+      continue;
+    }
+    if (BLI_delete(entry->path, false, false) == 0) {
+      size -= int64_t(entry->s.st_size);
+    }
+  }
+
+  BLI_filelist_free(entries, entries_num);
+}
+
+static void versioning_cache_file_ensure(const char *filepath)
+{
+  VersioningCacheKey key;
+  char cache_filepath[FILE_MAX];
+  if (!versioning_cache_key_get(filepath, key) ||
+      !versioning_cache_filepath_get(filepath, key, cache_filepath))
+  {
+    return;
+  }
+  if (BLI_exists(cache_filepath)) {
+    return;
+  }
+
+  char cache_dirpath[FILE_MAX];
+  BLI_path_split_dir_part(cache_filepath, cache_dirpath, sizeof(cache_dirpath));
+  if (!BLI_dir_create_recursive(cache_dirpath)) {
+    return;
+  }
+  if (!versioning_cache_file_create(filepath, cache_filepath)) {
+    CLOG_WARN(&LOG, "Failed to create versioned copy of library '%s'", filepath);
+    return;
+  }
+
+  /* The library may have been modified while it was read, the copy would then be stored under
+   * the key of the older file. */
+  VersioningCacheKey key_after;
+  if (!versioning_cache_key_get(filepath, key_after) || !(key_after == key)) {
+    BLI_delete(cache_filepath, false, false);
+    return;
+  }
+  CLOG_INFO(&LOG, "Created versioned copy of library '%s' at '%s'", filepath, cache_filepath);
+
+  versioning_cache_evict(filepath, cache_filepath);
+}
+
+static void versioning_cache_worker()
+{
+  VersioningCacheRequests &requests = versioning_cache_requests();
+  while (!requests.cancel) {
+    std::string filepath;
+    {
+      std::scoped_lock lock(requests.mutex);
+      if (requests.filepaths.is_empty()) {
+        requests.worker_running = false;
+        return;
+      }
+      filepath = requests.filepaths.pop();
+    }
+    /* Reading the library can request copies of its own libraries, these are handled by this
+     * loop as well. */
+    versioning_cache_file_ensure(filepath.c_str());
+  }
+  std::scoped_lock lock(requests.mutex);
+  requests.worker_running = false;
+}
+
+static void versioning_cache_exit(void * /*user_data*/)
+{
+  VersioningCacheRequests &requests = versioning_cache_requests();
+  requests.cancel = true;
+  /* Wait for the copy that is being created, so that no file is left half-written. */
+  if (requests.worker.joinable()) {
+    requests.worker.join();
+  }
+}
+
+}  // namespace blender::blo
+
+using namespace blender::blo;
+
+std::string blo_versioning_cache_filepath_find(const char *filepath)
+{
+  VersioningCacheKey key;
+  char cache_filepath[FILE_MAX];
+  if (!versioning_cache_key_get(filepath, key) ||
+      !versioning_cache_filepath_get(filepath, key, cache_filepath))
+  {
+    return {};
+  }
+  if (BLI_exists(cache_filepath)) {
+    /* Mark the copy as recently used, see #versioning_cache_evict. */
+    BLI_file_touch(cache_filepath);
+    return cache_filepath;
+  }
+
+  VersioningCacheRequests &requests = versioning_cache_requests();
+  std::scoped_lock lock(requests.mutex);
+  requests.filepaths.add(filepath);
+  return {};
+}
+
+void blo_versioning_cache_update()
+{
+  VersioningCacheRequests &requests = versioning_cache_requests();
+  std::scoped_lock lock(requests.mutex);
+  if (requests.worker_running || requests.filepaths.is_empty() || requests.cancel) {
+    return;
+  }
+  if (requests.worker.joinable()) {
+    /* The previous worker has finished already. */
+    requests.worker.join();
+  }
+  if (!requests.exit_registered) {
+    BKE_blender_atexit_register(versioning_cache_exit, nullptr);
+    requests.exit_registered = true;
+  }
+  requests.worker_running = true;
+  requests.worker = std::thread(versioning_cache_worker);
+}
@@ -59,6 +59,7 @@
  *   - #BLENDER_USERPREF_FILE (on UNIX `~/.config/blender/X.X/config/userpref.blend`).
  */
 
+#include <atomic>
 #include <cerrno>
 #include <climits>
 #include <cstdio>
@@ -86,6 +87,7 @@
 /* Allow writefile to use deprecated functionality (for forward compatibility code). */
 #define DNA_DEPRECATED_ALLOW
 
+#include "DNA_collection_types.h"
 #include "DNA_fileglobal_types.h"
 #include "DNA_genfile.h"
 #include "DNA_key_types.h"
@@ -98,13 +100,16 @@
 #include "BLI_endian_defines.h"
 #include "BLI_fileops.hh"
 #include "BLI_implicit_sharing.hh"
+#include "BLI_linear_allocator.hh"
 #include "BLI_math_base.h"
 #include "BLI_math_matrix.h"
 #include "BLI_multi_value_map.hh"
 #include "BLI_path_utils.hh"
 #include "BLI_set.hh"
 #include "BLI_string.h"
+#include "BLI_task.hh"
 #include "BLI_threads.h"
+#include "BLI_time.h"
 
 #include "MEM_guardedalloc.h" /* MEM_freeN */
 
@@ -130,6 +135,7 @@
 #include "DRW_engine.hh"
 
 #include "BLO_blend_validate.hh"
+#include "BLO_io_stats.hh"
 #include "BLO_read_write.hh"
 #include "BLO_readfile.hh"
 #include "BLO_undofile.hh"
@@ -160,6 +166,9 @@
 
 #define ZSTD_COMPRESSION_LEVEL 3
 
+/** Raw data blocks smaller than this are never replaced by references to identical data. */
+#define DEDUPLICATE_DATA_MIN_SIZE 1024
+
 static CLG_LogRef LOG = {"blend.writefile"};
 
 /** Use if we want to store how many bytes have been written to the file. */
@@ -411,6 +420,72 @@ bool ZstdWriteWrap::write(const void *buf, const size_t buf_len)
 /** \name Write Data Type & Functions
  * \{ */
 
+/**
+ * Blocks written for a single ID, collected without touching any state shared with other IDs, so
+ * that independent IDs can be serialized in parallel. Pointers are kept as runtime addresses and
+ * only replaced by their stable address ids when the recording is written to the actual
+ * #WriteData, in the same order as when the ID is written directly. This keeps the output
+ * identical to the single-threaded writer.
+ */
+struct WriteRecording {
+  enum class BlockType : int8_t {
+    /** A DNA struct array, whose pointer members still have to be remapped. */
+    Struct,
+    /** Raw data that is written as is. */
+    Raw,
+    /**
+     * An array of pointers that is remapped in place. It is only written when #write_block is
+     * set, the address ids are generated in any case.
+     */
+    PointerArray,
+    /** Only generates the address id of #address (e.g. for shared data). */
+    Address,
+  };
+
+  struct Block {
+    BlockType type;
+    bool write_block;
+    int filecode;
+    int struct_nr;
+    int64_t nr;
+    const void *address;
+    /** Copy of the data, owned by #WriteRecording.allocator. */
+    void *data;
+    int64_t len;
+  };
+
+  blender::Vector<Block> blocks;
+  blender::LinearAllocator<> allocator;
+  /** Size of all the data copied into #allocator. */
+  int64_t data_size = 0;
+  /** Time spent recording the blocks, only measured when gathering I/O statistics. */
+  double duration = 0.0;
+
+  void *copy_data(const void *data, const int64_t len)
+  {
+    void *copy = this->allocator.allocate(len, 64);
+    memcpy(copy, data, size_t(len));
+    this->data_size += len;
+    return copy;
+  }
+};
+
+/** Key to find identical raw data blocks. */
+struct WriteDataHash {
+  XXH128_hash_t content_hash;
+  size_t len;
+
+  uint64_t hash() const
+  {
+    return this->content_hash.low64;
+  }
+
+  friend bool operator==(const WriteDataHash &a, const WriteDataHash &b)
+  {
+    return a.len == b.len && XXH128_isEqual(a.content_hash, b.content_hash);
+  }
+};
+
 struct WriteData {
   const SDNA *sdna;
   std::ostream *debug_dst = nullptr;
@@ -495,6 +570,18 @@ struct WriteData {
    */
   blender::Set<const void *> per_id_written_shared_addresses;
 
+  /** Storing identical raw data blocks only once, see #writedata_deduplicate. */
+  struct {
+    bool enabled;
+    /** Address ids of raw data blocks that identical blocks can refer to, by content hash. */
+    blender::Map<WriteDataHash, uint64_t> address_id_by_hash;
+    /**
+     * Address ids of all written #BLO_CODE_DATA blocks. Only the first block with a given address
+     * id can be referred to, because it is the one found when reading.
+     */
+    blender::Set<uint64_t> written_address_ids;
+  } deduplicate;
+
   /** #MemFile writing (used for undo). */
   MemFileWriteData mem;
   /** When true, write to #WriteData.current, could also call 'is_undo'. */
@@ -506,6 +593,17 @@ struct WriteData {
    * Will be nullptr for UNDO.
    */
   WriteWrap *ww;
+
+  /**
+   * When set, blocks are added to this recording instead of being written, see
+   * #write_ids_parallel.
+   */
+  WriteRecording *recording = nullptr;
+
+  /** Gather statistics about writing the file, see #BLO_io_stats_is_enabled. */
+  bool use_io_stats = false;
+  /** Bytes written for the current ID, only counted when #use_io_stats is set. */
+  size_t io_stats_id_size = 0;
 };
 
 struct BlendWriter {
@@ -557,6 +655,7 @@ static void writedata_do_write(WriteData *wd, const void *mem, const size_t meml
     BLO_memfile_chunk_add(&wd->mem, static_cast<const char *>(mem), memlen);
   }
   else {
+    const BLOIOStatsScopedPhase stats_phase(BLO_IO_STATS_PHASE_WRITE_BLOCKS, wd->use_io_stats);
     if (!wd->ww->write(mem, memlen)) {
       wd->validation_data.critical_error = true;
     }
@@ -790,6 +889,12 @@ static bool write_at_address_validate(WriteData *wd, const int filecode, const v
 
 static void write_bhead(WriteData *wd, const BHead &bhead)
 {
+  if (wd->use_io_stats) {
+    const size_t size = sizeof(BHead) + size_t(bhead.len);
+    BLO_io_stats_block_add(true, bhead.code, size);
+    wd->io_stats_id_size += size;
+  }
+
   if constexpr (sizeof(void *) == 4) {
     /* Always write #BHead4 in 32 bit builds. */
     BHead4 bh;
@@ -858,8 +963,12 @@ static uint64_t get_address_id_int(WriteData &wd, const void *address)
     return 0;
   }
   /* Either reuse an existing identifier or create a new one. */
-  return wd.stable_address_ids.pointer_map.lookup_or_add_cb(
+  const uint64_t address_id = wd.stable_address_ids.pointer_map.lookup_or_add_cb(
       address, [&]() { return get_next_stable_address_id(wd); });
+  if (wd.mem.current_id_address_ids) {
+    wd.mem.current_id_address_ids->add(address, address_id);
+  }
+  return address_id;
 }
 
 static const void *get_address_id(WriteData &wd, const void *address)
@@ -867,33 +976,21 @@ static const void *get_address_id(WriteData &wd, const void *address)
   return reinterpret_cast<const void *>(get_address_id_int(wd, address));
 }
 
-static void writestruct_at_address_nr(WriteData *wd,
-                                      const int filecode,
-                                      const int struct_nr,
-                                      const int64_t nr,
-                                      const void *adr,
-                                      const void *data)
+/**
+ * Write a struct block that passed validation.
+ *
+ * \param data_is_mutable: The pointers in \a data can be remapped in place, instead of in a
+ * temporary copy.
+ */
+static void writestruct_block(WriteData *wd,
+                              const int filecode,
+                              const int struct_nr,
+                              const int64_t nr,
+                              const void *adr,
+                              const void *data,
+                              const int64_t len_in_bytes,
+                              const bool data_is_mutable)
 {
-  BLI_assert(struct_nr > 0 && struct_nr <= blender::dna::sdna_struct_id_get_max());
-
-  if (adr == nullptr || data == nullptr || nr == 0) {
-    return;
-  }
-
-  if (!write_at_address_validate(wd, filecode, adr)) {
-    return;
-  }
-
-  const int64_t len_in_bytes = nr * DNA_struct_size(wd->sdna, struct_nr);
-  if (!SYSTEM_SUPPORTS_WRITING_FILE_VERSION_1 ||
-      USER_DEVELOPER_TOOL_TEST(&U, write_legacy_blend_file_format))
-  {
-    if (len_in_bytes > INT32_MAX) {
-      CLOG_ERROR(&LOG, "Cannot write chunks bigger than INT_MAX.");
-      return;
-    }
-  }
-
   /* Get the address identifier that will be written to the file.*/
   const void *address_id = get_address_id(*wd, adr);
 
@@ -901,16 +998,18 @@ static void writestruct_at_address_nr(WriteData *wd,
       wd->stable_address_ids.sdna_pointers->get_for_struct(struct_nr);
   const bool can_write_raw_runtime_data = struct_info.pointers.is_empty();
 
-  blender::DynamicStackBuffer<16 * 1024> buffer_owner(len_in_bytes, 64);
+  blender::DynamicStackBuffer<16 * 1024> buffer_owner(data_is_mutable ? 0 : len_in_bytes, 64);
   const void *data_to_write;
   if (can_write_raw_runtime_data) {
     /* The passed in data contains no pointers, so it can be written without an additional copy. */
     data_to_write = data;
   }
   else {
-    void *buffer = buffer_owner.buffer();
+    void *buffer = data_is_mutable ? const_cast<void *>(data) : buffer_owner.buffer();
     data_to_write = buffer;
-    memcpy(buffer, data, len_in_bytes);
+    if (!data_is_mutable) {
+      memcpy(buffer, data, len_in_bytes);
+    }
 
     /* Overwrite pointers with their corresponding address identifiers. */
     for (const int i : blender::IndexRange(nr)) {
@@ -939,10 +1038,56 @@ static void writestruct_at_address_nr(WriteData *wd,
         *wd->sdna, struct_nr, data_to_write, address_id, nr, *wd->debug_dst);
   }
 
+  if (wd->deduplicate.enabled && filecode == BLO_CODE_DATA) {
+    wd->deduplicate.written_address_ids.add(uint64_t(address_id));
+  }
+
   write_bhead(wd, bh);
   mywrite(wd, data_to_write, size_t(bh.len));
 }
 
+static void writestruct_at_address_nr(WriteData *wd,
+                                      const int filecode,
+                                      const int struct_nr,
+                                      const int64_t nr,
+                                      const void *adr,
+                                      const void *data)
+{
+  BLI_assert(struct_nr > 0 && struct_nr <= blender::dna::sdna_struct_id_get_max());
+
+  if (adr == nullptr || data == nullptr || nr == 0) {
+    return;
+  }
+
+  if (!write_at_address_validate(wd, filecode, adr)) {
+    return;
+  }
+
+  const int64_t len_in_bytes = nr * DNA_struct_size(wd->sdna, struct_nr);
+  if (!SYSTEM_SUPPORTS_WRITING_FILE_VERSION_1 ||
+      USER_DEVELOPER_TOOL_TEST(&U, write_legacy_blend_file_format))
+  {
+    if (len_in_bytes > INT32_MAX) {
+      CLOG_ERROR(&LOG, "Cannot write chunks bigger than INT_MAX.");
+      return;
+    }
+  }
+
+  if (WriteRecording *recording = wd->recording) {
+    recording->blocks.append({WriteRecording::BlockType::Struct,
+                              true,
+                              filecode,
+                              struct_nr,
+                              nr,
+                              adr,
+                              recording->copy_data(data, len_in_bytes),
+                              len_in_bytes});
+    return;
+  }
+
+  writestruct_block(wd, filecode, struct_nr, nr, adr, data, len_in_bytes, false);
+}
+
 static void writestruct_nr(
     WriteData *wd, const int filecode, const int struct_nr, const int64_t nr, const void *adr)
 {
@@ -979,17 +1124,15 @@ static void write_raw_data_in_debug_file(WriteData *wd,
 }
 
 /**
- * \warning Do not use for structs.
+ * \return False if the raw data block should not be written.
  */
-static void writedata(
-    WriteData *wd, const int filecode, const void *data, const size_t len, const void *adr)
+static bool writedata_validate(WriteData *wd,
+                               const int filecode,
+                               const size_t len,
+                               const void *adr)
 {
-  if (data == nullptr || len == 0) {
-    return;
-  }
-
   if (!write_at_address_validate(wd, filecode, adr)) {
-    return;
+    return false;
   }
 
   if ((!SYSTEM_SUPPORTS_WRITING_FILE_VERSION_1 ||
@@ -997,9 +1140,50 @@ static void writedata(
       len > INT_MAX)
   {
     BLI_assert_msg(0, "Cannot write chunks bigger than INT_MAX.");
-    return;
+    return false;
   }
+  return true;
+}
+
+/**
+ * Write a reference to an identical raw data block that has been written before, instead of the
+ * data itself.
+ *
+ * \return True if a reference was written.
+ */
+static bool writedata_deduplicate(WriteData *wd,
+                                  const void *address_id,
+                                  const void *data,
+                                  const size_t len)
+{
+  std::optional<WriteDataHash> key;
+  if (len >= DEDUPLICATE_DATA_MIN_SIZE) {
+    key = WriteDataHash{XXH3_128bits(data, len), len};
+    if (const uint64_t *target_address_id = wd->deduplicate.address_id_by_hash.lookup_ptr(*key)) {
+      BHead bh;
+      bh.code = BLO_CODE_DATA_REFERENCE;
+      bh.old = address_id;
+      bh.nr = 1;
+      bh.SDNAnr = SDNA_RAW_DATA_STRUCT_INDEX;
+      bh.len = sizeof(*target_address_id);
+
+      write_bhead(wd, bh);
+      mywrite(wd, target_address_id, sizeof(*target_address_id));
+      return true;
+    }
+  }
+  if (wd->deduplicate.written_address_ids.add(uint64_t(address_id)) && key) {
+    wd->deduplicate.address_id_by_hash.add_new(*key, uint64_t(address_id));
+  }
+  return false;
+}
 
+/**
+ * Write a raw data block that passed validation.
+ */
+static void writedata_block(
+    WriteData *wd, const int filecode, const void *data, const size_t len, const void *adr)
+{
   const void *address_id = get_address_id(*wd, adr);
 
   BHead bh;
@@ -1014,10 +1198,45 @@ static void writedata(
     write_raw_data_in_debug_file(wd, len, address_id, adr);
   }
 
+  if (wd->deduplicate.enabled && filecode == BLO_CODE_DATA) {
+    if (writedata_deduplicate(wd, address_id, data, len)) {
+      return;
+    }
+  }
+
   write_bhead(wd, bh);
   mywrite(wd, data, len);
 }
 
+/**
+ * \warning Do not use for structs.
+ */
+static void writedata(
+    WriteData *wd, const int filecode, const void *data, const size_t len, const void *adr)
+{
+  if (data == nullptr || len == 0) {
+    return;
+  }
+
+  if (!writedata_validate(wd, filecode, len, adr)) {
+    return;
+  }
+
+  if (WriteRecording *recording = wd->recording) {
+    recording->blocks.append({WriteRecording::BlockType::Raw,
+                              true,
+                              filecode,
+                              SDNA_RAW_DATA_STRUCT_INDEX,
+                              1,
+                              adr,
+                              recording->copy_data(data, int64_t(len)),
+                              int64_t(len)});
+    return;
+  }
+
+  writedata_block(wd, filecode, data, len, adr);
+}
+
 static void writedata(WriteData *wd, const int filecode, const size_t len, const void *adr)
 {
   writedata(wd, filecode, adr, len, adr);
@@ -1256,6 +1475,12 @@ static void write_userdef(BlendWriter *writer, const UserDef *userdef)
  */
 static void write_id(WriteData *wd, ID *id)
 {
+  const double start_time = wd->use_io_stats ? BLI_time_now_seconds() : 0.0;
+  wd->io_stats_id_size = 0;
+
+  /* Packed linked data may not be read from its library file yet. */
+  BKE_libblock_lazy_data_ensure(*id);
+
   const IDTypeInfo *id_type = BKE_idtype_get_info_from_id(id);
   mywrite_id_begin(wd, id);
   if (id_type->blend_write != nullptr) {
@@ -1264,6 +1489,340 @@ static void write_id(WriteData *wd, ID *id)
     id_type->blend_write(&writer, id_buffer.get(), id);
   }
   mywrite_id_end(wd, id);
+
+  if (wd->use_io_stats) {
+    const double duration = BLI_time_now_seconds() - start_time;
+    BLO_io_stats_phase_add(BLO_IO_STATS_PHASE_WRITE_IDS, duration);
+    BLO_io_stats_id_add(true, GS(id->name), 1, duration, wd->io_stats_id_size);
+  }
+}
+
+/**
+ * Only ID types whose writing code has been checked to be thread-safe are recorded on other
+ * threads, all other IDs are written directly.
+ */
+static bool write_id_supports_recording(const ID &id)
+{
+  const IDTypeInfo *id_type = BKE_idtype_get_info_from_id(&id);
+  return id_type->flags & IDTYPE_FLAGS_THREADSAFE_BLEND_WRITE;
+}
+
+/**
+ * Serialize the ID into a recording without modifying \a wd, can be called from any thread.
+ */
+static void write_id_record(const WriteData &wd, ID *id, WriteRecording &recording)
+{
+  const double start_time = wd.use_io_stats ? BLI_time_now_seconds() : 0.0;
+  WriteData record_wd{};
+  record_wd.sdna = wd.sdna;
+  record_wd.recording = &recording;
+  write_id(&record_wd, id);
+  if (wd.use_io_stats) {
+    recording.duration = BLI_time_now_seconds() - start_time;
+  }
+}
+
+/**
+ * Write the blocks recorded by #write_id_record, generating the address ids in the same order as
+ * #write_id would.
+ */
+static void write_id_recording(WriteData *wd, ID *id, WriteRecording &recording)
+{
+  const double start_time = wd->use_io_stats ? BLI_time_now_seconds() : 0.0;
+  wd->io_stats_id_size = 0;
+
+  mywrite_id_begin(wd, id);
+  for (WriteRecording::Block &block : recording.blocks) {
+    switch (block.type) {
+      case WriteRecording::BlockType::Struct:
+        writestruct_block(wd,
+                          block.filecode,
+                          block.struct_nr,
+                          block.nr,
+                          block.address,
+                          block.data,
+                          block.len,
+                          true);
+        break;
+      case WriteRecording::BlockType::Raw:
+        writedata_block(wd, block.filecode, block.data, size_t(block.len), block.address);
+        break;
+      case WriteRecording::BlockType::PointerArray: {
+        const void **pointers = static_cast<const void **>(block.data);
+        for (const int64_t i : blender::IndexRange(block.nr)) {
+          pointers[i] = get_address_id(*wd, pointers[i]);
+        }
+        if (block.write_block) {
+          writedata_block(wd, block.filecode, block.data, size_t(block.len), block.address);
+        }
+        break;
+      }
+      case WriteRecording::BlockType::Address:
+        get_address_id(*wd, block.address);
+        break;
+    }
+  }
+  mywrite_id_end(wd, id);
+
+  if (wd->use_io_stats) {
+    const double duration = recording.duration + (BLI_time_now_seconds() - start_time);
+    BLO_io_stats_phase_add(BLO_IO_STATS_PHASE_WRITE_IDS, duration);
+    BLO_io_stats_id_add(true, GS(id->name), 1, duration, wd->io_stats_id_size);
+  }
+}
+
+/**
+ * Memory limit for the recordings of a batch of IDs in #write_ids_parallel. Larger recordings are
+ * still possible, since the first ID of a batch is always recorded.
+ */
+static constexpr int64_t WRITE_RECORDING_BATCH_SIZE_MAX = 256 * 1024 * 1024;
+
+/**
+ * Multi-threaded version of calling #write_id for all \a ids.
+ *
+ * The IDs are serialized into recordings in parallel, which are then written in order on the
+ * calling thread. IDs are processed in batches, which also end when the recordings use more than
+ * #WRITE_RECORDING_BATCH_SIZE_MAX bytes of memory.
+ */
+static void write_ids_parallel(WriteData *wd, const blender::Span<ID *> ids)
+{
+  using namespace blender;
+  const int64_t batch_ids_num = std::max(BLI_system_thread_count() * 4, 16);
+  Array<std::unique_ptr<WriteRecording>> recordings(ids.size());
+
+  int64_t batch_start = 0;
+  while (batch_start < ids.size()) {
+    const IndexRange batch(batch_start, std::min(batch_ids_num, ids.size() - batch_start));
+
+    /* Recordings that were not written in the previous batch are kept. */
+    std::atomic<int64_t> batch_size = 0;
+    for (const int64_t i : batch) {
+      if (recordings[i]) {
+        batch_size += recordings[i]->data_size;
+      }
+    }
+
+    threading::parallel_for(batch, 1, [&](const IndexRange range) {
+      for (const int64_t i : range) {
+        if (recordings[i] || !write_id_supports_recording(*ids[i])) {
+          continue;
+        }
+        if (i != batch.first() &&
+            batch_size.load(std::memory_order_relaxed) >= WRITE_RECORDING_BATCH_SIZE_MAX)
+        {
+          continue;
+        }
+        std::unique_ptr<WriteRecording> recording = std::make_unique<WriteRecording>();
+        write_id_record(*wd, ids[i], *recording);
+        batch_size += recording->data_size;
+        recordings[i] = std::move(recording);
+      }
+    });
+
+    /* Write in order, up to the first ID that could not be recorded within the memory limit.
+     * The next batch starts there. */
+    int64_t i = batch.first();
+    for (; i < batch.one_after_last(); i++) {
+      if (recordings[i]) {
+        write_id_recording(wd, ids[i], *recordings[i]);
+        recordings[i].reset();
+      }
+      else if (!write_id_supports_recording(*ids[i])) {
+        write_id(wd, ids[i]);
+      }
+      else {
+        break;
+      }
+    }
+    batch_start = i;
+  }
+}
+
+/**
+ * Changes of the ID (and its embedded IDs) since the last undo push, and the ones stored in the
+ * last undo step, as tagged in the depsgraph. The latter have to be written again to be cleared.
+ */
+static uint write_id_undo_recalc(ID &id)
+{
+  uint recalc = id.recalc_up_to_undo_push | id.recalc_after_undo_push;
+  if (const bNodeTree *nodetree = blender::bke::node_tree_from_id(&id)) {
+    recalc |= nodetree->id.recalc_up_to_undo_push | nodetree->id.recalc_after_undo_push;
+  }
+  if (GS(id.name) == ID_SCE) {
+    const Scene *scene = reinterpret_cast<const Scene *>(&id);
+    if (const Collection *collection = scene->master_collection) {
+      recalc |= collection->id.recalc_up_to_undo_push | collection->id.recalc_after_undo_push;
+    }
+  }
+  return recalc;
+}
+
+/**
+ * Find the information stored for an unchanged ID in the reference undo step, if its chunks can
+ * be reused instead of writing it.
+ *
+ * \return Null if the chunks can't be reused, the ID has to be written then.
+ */
+static const MemFileIDInfo *write_id_undo_reuse_info(WriteData *wd,
+                                                     const ID &id,
+                                                     const uint64_t id_struct_hash)
+{
+  const MemFile *reference_memfile = wd->mem.reference_memfile;
+  if (reference_memfile == nullptr || reference_memfile->id_storage == nullptr) {
+    return nullptr;
+  }
+  /* Set by #mywrite_id_begin to the first chunk of the ID, if it exists. */
+  const MemFileChunk *chunk = wd->mem.reference_current_chunk;
+  if (chunk == nullptr || chunk->id_session_uid != id.session_uid) {
+    return nullptr;
+  }
+  const MemFileIDInfo *info = reference_memfile->id_storage->info_by_session_uid.lookup_ptr(
+      id.session_uid);
+  if (info == nullptr || info->id_struct_hash != id_struct_hash) {
+    return nullptr;
+  }
+
+  /* The reused chunks refer to data by the address ids used in the reference step. Those have to
+   * map to the same pointers in this step, which is not the case when other IDs written before
+   * already use them differently. */
+  const auto &stable_address_ids = wd->stable_address_ids;
+  for (const auto [address, address_id] : info->address_ids.items()) {
+    if (const uint64_t *existing_id = stable_address_ids.pointer_map.lookup_ptr(address)) {
+      if (*existing_id != address_id) {
+        return nullptr;
+      }
+    }
+    else if (stable_address_ids.used_ids.contains(address_id)) {
+      return nullptr;
+    }
+  }
+  return info;
+}
+
+/** Use the same address ids as in the reference undo step, see #write_id_undo_reuse_info. */
+static void write_id_undo_address_ids_add(WriteData *wd, const MemFileIDInfo &info)
+{
+  auto &stable_address_ids = wd->stable_address_ids;
+  for (const auto [address, address_id] : info.address_ids.items()) {
+    if (stable_address_ids.pointer_map.add(address, address_id)) {
+      stable_address_ids.used_ids.add_new(address_id);
+    }
+  }
+}
+
+/**
+ * Reuse the chunks of the reference undo step for an unchanged ID, instead of writing it. Not used
+ * in debug builds, see #write_id_undo_incremental.
+ */
+[[maybe_unused]] static void write_id_undo_reuse(WriteData *wd, const ID &id, const MemFileIDInfo &info)
+{
+  write_id_undo_address_ids_add(wd, info);
+
+  /* Shared data that the undo step took ownership of is not in the chunks. */
+  MemFile &memfile = *wd->mem.written_memfile;
+  if (const MemFileSharedStorage *reference_shared = wd->mem.reference_memfile->shared_storage) {
+    for (const uint64_t address_id : info.address_ids.values()) {
+      const blender::ImplicitSharingInfoAndData *shared_data =
+          reference_shared->sharing_info_by_address_id.lookup_ptr(address_id);
+      if (shared_data == nullptr) {
+        continue;
+      }
+      if (memfile.shared_storage == nullptr) {
+        memfile.shared_storage = MEM_new<MemFileSharedStorage>(__func__);
+      }
+      if (memfile.shared_storage->sharing_info_by_address_id.add(address_id, *shared_data)) {
+        shared_data->sharing_info->add_user();
+      }
+    }
+  }
+
+  BLO_memfile_chunks_reuse_for_id(&wd->mem, id.session_uid);
+  memfile.id_storage->info_by_session_uid.add_overwrite(id.session_uid, info);
+}
+
+#ifndef NDEBUG
+/**
+ * Check that the chunks written for an ID are all identical to the ones of the reference step,
+ * i.e. that reusing them would have given the same result as writing the ID.
+ */
+static void write_id_undo_reuse_validate(WriteData *wd, const ID &id)
+{
+  const MemFile &memfile = *wd->mem.written_memfile;
+  for (const MemFileChunk *chunk = static_cast<const MemFileChunk *>(memfile.chunks.last);
+       chunk != nullptr && chunk->id_session_uid == id.session_uid;
+       chunk = static_cast<const MemFileChunk *>(chunk->prev))
+  {
+    if (!chunk->is_identical) {
+      CLOG_ERROR(&LOG,
+                 "%s changed without being tagged for a depsgraph update, incremental undo "
+                 "would not store the change",
+                 id.name);
+      return;
+    }
+  }
+}
+#endif
+
+/**
+ * Version of #write_id for undo steps, that skips serializing IDs which were not changed since
+ * the previous undo step.
+ *
+ * Whether an ID changed is determined from its depsgraph recalc tags and a hash of the ID struct
+ * itself, instead of comparing all serialized data. Changes to the data of the ID that are not
+ * tagged are missed. In debug builds, unchanged IDs are still written, and compared with the
+ * reference step to report such changes.
+ */
+static void write_id_undo_incremental(WriteData *wd, ID *id)
+{
+  BLI_assert(wd->use_memfile);
+  const IDTypeInfo *id_type = BKE_idtype_get_info_from_id(id);
+  if (id_type->blend_write == nullptr) {
+    write_id(wd, id);
+    return;
+  }
+
+  MemFile &memfile = *wd->mem.written_memfile;
+  if (memfile.id_storage == nullptr) {
+    memfile.id_storage = MEM_new<MemFileIDStorage>(__func__);
+  }
+
+  /* UI data and texts are often edited without tagging them for depsgraph updates. */
+  const bool is_tagged = ELEM(GS(id->name), ID_WM, ID_SCR, ID_WS, ID_TXT) ||
+                         write_id_undo_recalc(*id) != 0;
+
+  BLO_Write_IDBuffer id_buffer{*id, true, false};
+  MemFileIDInfo info;
+  info.id_struct_hash = XXH3_64bits(id_buffer.get(), id_type->struct_size);
+
+  mywrite_id_begin(wd, id);
+  const MemFileIDInfo *reuse_info = is_tagged ?
+                                        nullptr :
+                                        write_id_undo_reuse_info(wd, *id, info.id_struct_hash);
+#ifdef NDEBUG
+  if (reuse_info) {
+    write_id_undo_reuse(wd, *id, *reuse_info);
+    mywrite_id_end(wd, id);
+    return;
+  }
+#else
+  if (reuse_info) {
+    write_id_undo_address_ids_add(wd, *reuse_info);
+  }
+#endif
+
+  wd->mem.current_id_address_ids = &info.address_ids;
+  BlendWriter writer = {wd};
+  id_type->blend_write(&writer, id_buffer.get(), id);
+  wd->mem.current_id_address_ids = nullptr;
+  mywrite_id_end(wd, id);
+
+#ifndef NDEBUG
+  if (reuse_info) {
+    write_id_undo_reuse_validate(wd, *id);
+  }
+#endif
+
+  memfile.id_storage->info_by_session_uid.add_overwrite(id->session_uid, std::move(info));
 }
 
 static void write_id_placeholder(WriteData *wd, ID *id)
@@ -1423,6 +1982,12 @@ static void write_global(WriteData *wd, const int fileflags, Main *mainvar)
   fg.subversion = BLENDER_FILE_SUBVERSION;
   fg.minversion = BLENDER_FILE_MIN_VERSION;
   fg.minsubversion = BLENDER_FILE_MIN_SUBVERSION;
+  if (wd->deduplicate.enabled) {
+    /* Older versions don't know #BLO_CODE_DATA_REFERENCE blocks and would silently read the
+     * referencing data as null, so they have to refuse loading the file instead. */
+    fg.minversion = BLENDER_FILE_VERSION;
+    fg.minsubversion = BLENDER_FILE_SUBVERSION;
+  }
 #ifdef WITH_BUILDINFO
   /* TODO(sergey): Add branch name to file as well? */
   fg.build_commit_timestamp = build_commit_timestamp;
@@ -1688,6 +2253,7 @@ static bool write_file_handle(Main *mainvar,
 
   wd = mywrite_begin(ww, compare, current);
   wd->debug_dst = debug_dst;
+  wd->use_io_stats = !wd->use_memfile && BLO_io_stats_is_enabled();
   BlendWriter writer = {wd};
 
   /* Clear 'directly linked' flag for all linked data, these are not necessarily valid/up-to-date
@@ -1735,6 +2301,11 @@ static bool write_file_handle(Main *mainvar,
     }
   }
 
+  const bool is_undo = wd->use_memfile;
+  /* Undo steps share unchanged data between steps already. */
+  wd->deduplicate.enabled = !is_undo &&
+                            USER_DEVELOPER_TOOL_TEST(&U, use_blend_file_deduplication);
+
   write_blend_file_header(wd);
   write_renderinfo(wd, mainvar);
   write_thumb(wd, thumb);
@@ -1744,7 +2315,6 @@ static bool write_file_handle(Main *mainvar,
    * avoid thumbnail detecting changes because of this. */
   mywrite_flush(wd);
 
-  const bool is_undo = wd->use_memfile;
   blender::Vector<ID *> local_ids_to_write = gather_local_ids_to_write(mainvar, is_undo);
 
   if (!is_undo) {
@@ -1765,9 +2335,22 @@ static bool write_file_handle(Main *mainvar,
     }
   }
 
-  /* Actually write local data-blocks to the file. */
-  for (ID *id : local_ids_to_write) {
-    write_id(wd, id);
+  /* Actually write local data-blocks to the file. The debug file prints the blocks while they are
+   * written, so it always uses the single-threaded writer. */
+  if (!is_undo && debug_dst == nullptr &&
+      USER_DEVELOPER_TOOL_TEST(&U, use_parallel_blend_file_write))
+  {
+    write_ids_parallel(wd, local_ids_to_write);
+  }
+  else if (is_undo && USER_DEVELOPER_TOOL_TEST(&U, use_incremental_undo)) {
+    for (ID *id : local_ids_to_write) {
+      write_id_undo_incremental(wd, id);
+    }
+  }
+  else {
+    for (ID *id : local_ids_to_write) {
+      write_id(wd, id);
+    }
   }
 
   /* Write libraries about libraries and linked data-blocks. */
@@ -1903,6 +2486,12 @@ static bool BLO_write_file_impl(Main *mainvar,
     return false;
   }
 
+  /* Data referenced from files that changed on disk in the meantime may be invalid, don't write
+   * it into a new file. */
+  if (!BLO_read_mapped_files_check(reports)) {
+    return false;
+  }
+
   /* Path backup/restore. */
   void *path_list_backup = nullptr;
   const eBPathForeachFlag path_list_flag = (BKE_BPATH_FOREACH_PATH_SKIP_LINKED |
@@ -2220,6 +2809,25 @@ void BLO_write_double_array(BlendWriter *writer, const int64_t num, const double
 
 void BLO_write_pointer_array(BlendWriter *writer, const int64_t num, const void *data_ptr)
 {
+  if (WriteRecording *recording = writer->wd->recording) {
+    if (num == 0) {
+      return;
+    }
+    /* The pointers are remapped when the recording is written, but whether the block is written
+     * at all has to be known now, because the validation data is per ID. */
+    const int64_t len = num * int64_t(sizeof(void *));
+    recording->blocks.append(
+        {WriteRecording::BlockType::PointerArray,
+         writedata_validate(writer->wd, BLO_CODE_DATA, size_t(len), data_ptr),
+         BLO_CODE_DATA,
+         SDNA_RAW_DATA_STRUCT_INDEX,
+         num,
+         data_ptr,
+         recording->copy_data(data_ptr, len),
+         len});
+    return;
+  }
+
   /* Create a temporary copy of the pointer array, because all pointers need to be remapped to
    * their stable address ids. */
   blender::Array<const void *, 32> data = blender::Span<const void *>(
@@ -2252,7 +2860,15 @@ void BLO_write_shared(BlendWriter *writer,
   if (data == nullptr) {
     return;
   }
-  const uint64_t address_id = get_address_id_int(*writer->wd, data);
+  uint64_t address_id = 0;
+  if (WriteRecording *recording = writer->wd->recording) {
+    /* The address id is generated when the recording is written. */
+    recording->blocks.append(
+        {WriteRecording::BlockType::Address, false, 0, 0, 0, data, nullptr, 0});
+  }
+  else {
+    address_id = get_address_id_int(*writer->wd, data);
+  }
   if (BLO_write_is_undo(writer)) {
     MemFile &memfile = *writer->wd->mem.written_memfile;
     if (sharing_info != nullptr) {
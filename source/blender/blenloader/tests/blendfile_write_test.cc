@@ -0,0 +1,399 @@
+/* SPDX-FileCopyrightText: 2026 Blender Authors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later */
+#include "blendfile_loading_base_test.h"
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unistd.h>
+
+#include "BKE_attribute.hh"
+#include "BKE_blender_version.h"
+#include "BKE_global.hh"
+#include "BKE_lib_id.hh"
+#include "BKE_main.hh"
+#include "BKE_mesh.hh"
+#include "BKE_object.hh"
+#include "BKE_report.hh"
+
+#include "BLI_fileops.h"
+#include "BLI_math_vector_types.hh"
+#include "BLI_path_utils.hh"
+#include "BLI_string.h"
+#include "BLI_tempfile.h"
+
+#include "BLO_readfile.hh"
+#include "BLO_undofile.hh"
+#include "BLO_writefile.hh"
+
+#include "DNA_mesh_types.h"
+#include "DNA_object_types.h"
+#include "DNA_userdef_types.h"
+
+namespace blender::blenloader::tests {
+
+class BlendfileWriteTest : public BlendfileLoadingBaseTest {
+ protected:
+  Main *bmain = nullptr;
+  std::string temp_dir;
+  int userdef_flag_backup = 0;
+  UserDef_Experimental experimental_backup;
+
+  void SetUp() override
+  {
+    BlendfileLoadingBaseTest::SetUp();
+
+    char temp_dir_c[FILE_MAX];
+    BLI_temp_directory_path_get(temp_dir_c, sizeof(temp_dir_c));
+    temp_dir = std::string(temp_dir_c) + SEP_STR + "blender_blendfile_write_test_" +
+               std::to_string(getpid());
+    BLI_dir_create_recursive(temp_dir.c_str());
+
+    /* The tested options are developer options. */
+    userdef_flag_backup = U.flag;
+    experimental_backup = U.experimental;
+    U.flag |= USER_DEVELOPER_UI;
+
+    bmain = BKE_main_new();
+  }
+
+  void TearDown() override
+  {
+    BKE_main_free(bmain);
+    U.flag = userdef_flag_backup;
+    U.experimental = experimental_backup;
+    BLI_delete(temp_dir.c_str(), true, true);
+
+    BlendfileLoadingBaseTest::TearDown();
+  }
+
+  /** Write #bmain to a file in the temporary directory, and return its path. */
+  std::string write_file(const char *filename)
+  {
+    const std::string filepath = temp_dir + SEP_STR + filename;
+    BlendFileWriteParams params{};
+    params.remap_mode = BLO_WRITE_PATH_REMAP_NONE;
+    ReportList reports;
+    BKE_reports_init(&reports, RPT_STORE);
+    EXPECT_TRUE(BLO_write_file(bmain, filepath.c_str(), 0, &params, &reports));
+    BKE_reports_free(&reports);
+    return filepath;
+  }
+
+  /** Read the file into #bfile, replacing any previously read file. */
+  Main *read_file(const std::string &filepath)
+  {
+    blendfile_free();
+    BlendFileReadReport reports{};
+    bfile = BLO_read_from_file(filepath.c_str(), BLO_READ_SKIP_USERDEF, &reports);
+    EXPECT_NE(bfile, nullptr);
+    return bfile ? bfile->main : nullptr;
+  }
+};
+
+static std::string file_read_contents(const std::string &filepath)
+{
+  std::ifstream stream(filepath, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+}
+
+/**
+ * Add a mesh with a grid of quads and a generic attribute, with values depending on \a seed.
+ */
+static Mesh *test_mesh_add(Main *bmain, const char *name, const int size, const int seed)
+{
+  const int verts_x = size + 1;
+  Mesh *mesh_src = BKE_mesh_new_nomain(verts_x * verts_x, 0, size * size, size * size * 4);
+
+  MutableSpan<float3> positions = mesh_src->vert_positions_for_write();
+  for (const int y : IndexRange(verts_x)) {
+    for (const int x : IndexRange(verts_x)) {
+      positions[y * verts_x + x] = float3(x, y, float((x * y + seed) % 7));
+    }
+  }
+  MutableSpan<int> face_offsets = mesh_src->face_offsets_for_write();
+  MutableSpan<int> corner_verts = mesh_src->corner_verts_for_write();
+  for (const int y : IndexRange(size)) {
+    for (const int x : IndexRange(size)) {
+      const int face = y * size + x;
+      face_offsets[face] = face * 4;
+      corner_verts[face * 4 + 0] = y * verts_x + x;
+      corner_verts[face * 4 + 1] = y * verts_x + x + 1;
+      corner_verts[face * 4 + 2] = (y + 1) * verts_x + x + 1;
+      corner_verts[face * 4 + 3] = (y + 1) * verts_x + x;
+    }
+  }
+  bke::mesh_calc_edges(*mesh_src, false, false);
+
+  bke::MutableAttributeAccessor attributes = mesh_src->attributes_for_write();
+  bke::SpanAttributeWriter<float> weights = attributes.lookup_or_add_for_write_only_span<float>(
+      "weight", bke::AttrDomain::Point);
+  for (const int i : weights.span.index_range()) {
+    weights.span[i] = float((i * 31 + seed) % 101);
+  }
+  weights.finish();
+
+  Mesh *mesh = BKE_mesh_add(bmain, name);
+  BKE_mesh_nomain_to_mesh(mesh_src, mesh, nullptr);
+  return mesh;
+}
+
+static void expect_meshes_equal(const Mesh &a, const Mesh &b)
+{
+  EXPECT_EQ(a.verts_num, b.verts_num);
+  EXPECT_EQ(a.edges_num, b.edges_num);
+  EXPECT_EQ(a.faces_num, b.faces_num);
+  EXPECT_EQ(a.corners_num, b.corners_num);
+  if (a.verts_num != b.verts_num || a.faces_num != b.faces_num) {
+    return;
+  }
+  EXPECT_EQ_SPAN(a.vert_positions(), b.vert_positions());
+  EXPECT_EQ_SPAN(a.edges(), b.edges());
+  EXPECT_EQ_SPAN(a.face_offsets(), b.face_offsets());
+  EXPECT_EQ_SPAN(a.corner_verts(), b.corner_verts());
+  const VArraySpan<float> weights_a = *a.attributes().lookup<float>("weight");
+  const VArraySpan<float> weights_b = *b.attributes().lookup<float>("weight");
+  EXPECT_EQ_SPAN(Span<float>(weights_a), Span<float>(weights_b));
+}
+
+static Mesh *find_mesh(Main *bmain, const char *name)
+{
+  return reinterpret_cast<Mesh *>(BKE_libblock_find_name(bmain, ID_ME, name));
+}
+
+/** Concatenated data of all chunks, the same as if the undo step was written to a file. */
+static std::string memfile_contents(const MemFile &memfile)
+{
+  std::string contents;
+  LISTBASE_FOREACH (const MemFileChunk *, chunk, &memfile.chunks) {
+    contents.append(chunk->buf, chunk->size);
+  }
+  return contents;
+}
+
+/** Whether all chunks written for the ID are shared with the previous undo step. */
+static bool memfile_id_chunks_identical(const MemFile &memfile, const ID &id)
+{
+  bool found = false;
+  LISTBASE_FOREACH (const MemFileChunk *, chunk, &memfile.chunks) {
+    if (chunk->id_session_uid == id.session_uid) {
+      found = true;
+      if (!chunk->is_identical) {
+        return false;
+      }
+    }
+  }
+  return found;
+}
+
+TEST_F(BlendfileWriteTest, ParallelWriteMatchesSerial)
+{
+  /* More IDs than in a single batch of the parallel writer, with types that are written on the
+   * main thread (objects) in between. */
+  for (const int i : IndexRange(100)) {
+    const std::string name = "Mesh" + std::to_string(i);
+    Mesh *mesh = test_mesh_add(bmain, name.c_str(), 4 + i % 13, i);
+    BKE_object_add_only_object(bmain, OB_MESH, name.c_str())->data = mesh;
+  }
+
+  U.experimental.use_parallel_blend_file_write = 0;
+  const std::string serial_contents = file_read_contents(write_file("serial.blend"));
+  U.experimental.use_parallel_blend_file_write = 1;
+  const std::string parallel_contents = file_read_contents(write_file("parallel.blend"));
+
+  EXPECT_FALSE(serial_contents.empty());
+  EXPECT_TRUE(serial_contents == parallel_contents);
+}
+
+TEST_F(BlendfileWriteTest, DeduplicatedDataRoundTrip)
+{
+  /* Two meshes with identical arrays, and a different one. */
+  test_mesh_add(bmain, "MeshA", 16, 0);
+  test_mesh_add(bmain, "MeshB", 16, 0);
+  test_mesh_add(bmain, "MeshC", 16, 1);
+
+  U.experimental.use_blend_file_deduplication = 0;
+  const std::string regular_filepath = write_file("regular.blend");
+  U.experimental.use_blend_file_deduplication = 1;
+  const std::string deduplicated_filepath = write_file("deduplicated.blend");
+
+  EXPECT_LT(file_read_contents(deduplicated_filepath).size(),
+            file_read_contents(regular_filepath).size());
+
+  Main *read_main = read_file(deduplicated_filepath);
+  ASSERT_NE(read_main, nullptr);
+  /* Older versions must refuse to open the file. */
+  EXPECT_EQ(read_main->minversionfile, BLENDER_FILE_VERSION);
+  EXPECT_EQ(read_main->minsubversionfile, BLENDER_FILE_SUBVERSION);
+  for (const char *name : {"MeshA", "MeshB", "MeshC"}) {
+    const Mesh *mesh = find_mesh(read_main, name);
+    ASSERT_NE(mesh, nullptr);
+    expect_meshes_equal(*find_mesh(bmain, name), *mesh);
+  }
+}
+
+TEST_F(BlendfileWriteTest, IncrementalUndoMatchesFullWrite)
+{
+  Mesh *mesh_a = test_mesh_add(bmain, "MeshA", 16, 0);
+  Mesh *mesh_b = test_mesh_add(bmain, "MeshB", 12, 1);
+
+  U.experimental.use_incremental_undo = 1;
+  MemFile step1{};
+  BLO_write_file_mem(bmain, nullptr, &step1, 0);
+
+  /* Nothing changed: all ID data is reused from the previous step. */
+  U.experimental.use_incremental_undo = 0;
+  MemFile full2{};
+  BLO_write_file_mem(bmain, &step1, &full2, 0);
+  U.experimental.use_incremental_undo = 1;
+  MemFile step2{};
+  BLO_write_file_mem(bmain, &step1, &step2, 0);
+
+  EXPECT_TRUE(memfile_contents(step2) == memfile_contents(full2));
+  EXPECT_TRUE(memfile_id_chunks_identical(step2, mesh_a->id));
+  EXPECT_TRUE(memfile_id_chunks_identical(step2, mesh_b->id));
+
+  /* Change and tag one mesh, like an edit followed by a depsgraph update. Writing an undo step
+   * clears the tags (and stores them in the ID), so they are set again for each write. */
+  mesh_a->vert_positions_for_write()[0] = float3(-1.0f, -2.0f, -3.0f);
+  mesh_a->tag_positions_changed();
+  mesh_a->id.recalc_after_undo_push = ID_RECALC_GEOMETRY;
+
+  U.experimental.use_incremental_undo = 0;
+  MemFile full3{};
+  BLO_write_file_mem(bmain, &step2, &full3, 0);
+  mesh_a->id.recalc_up_to_undo_push = 0;
+  mesh_a->id.recalc_after_undo_push = ID_RECALC_GEOMETRY;
+  U.experimental.use_incremental_undo = 1;
+  MemFile step3{};
+  BLO_write_file_mem(bmain, &step2, &step3, 0);
+
+  EXPECT_TRUE(memfile_contents(step3) == memfile_contents(full3));
+  EXPECT_FALSE(memfile_id_chunks_identical(step3, mesh_a->id));
+  EXPECT_TRUE(memfile_id_chunks_identical(step3, mesh_b->id));
+
+  /* Read the incrementally written step back. */
+  BlendFileReadParams params{};
+  params.skip_flags = BLO_READ_SKIP_UNDO_OLD_MAIN;
+  bfile = BLO_read_from_memfile(bmain, "", &step3, &params, nullptr);
+  ASSERT_NE(bfile, nullptr);
+  for (const char *name : {"MeshA", "MeshB"}) {
+    const Mesh *mesh = find_mesh(bfile->main, name);
+    ASSERT_NE(mesh, nullptr);
+    expect_meshes_equal(*find_mesh(bmain, name), *mesh);
+  }
+
+  BLO_memfile_free(&step3);
+  BLO_memfile_free(&full3);
+  BLO_memfile_free(&step2);
+  BLO_memfile_free(&full2);
+  BLO_memfile_free(&step1);
+}
+
+/** Names of the IDs in a list of #Main, in order. */
+static Vector<std::string> id_names(const ListBase &ids)
+{
+  Vector<std::string> names;
+  LISTBASE_FOREACH (const ID *, id, &ids) {
+    names.append(id->name);
+  }
+  return names;
+}
+
+TEST_F(BlendfileWriteTest, ParallelReadMatchesSerial)
+{
+  /* Deferred mesh data, with objects that are read serially referencing it. */
+  for (const int i : IndexRange(50)) {
+    const std::string name = "Mesh" + std::to_string(i);
+    Mesh *mesh = test_mesh_add(bmain, name.c_str(), 4 + i % 13, i);
+    BKE_object_add_only_object(bmain, OB_MESH, name.c_str())->data = mesh;
+  }
+  const std::string filepath = write_file("parallel_read.blend");
+
+  U.experimental.use_parallel_blend_file_read = 0;
+  BlendFileReadReport serial_reports{};
+  BlendFileData *serial_bfd = BLO_read_from_file(
+      filepath.c_str(), BLO_READ_SKIP_USERDEF, &serial_reports);
+  ASSERT_NE(serial_bfd, nullptr);
+  Main *serial_main = serial_bfd->main;
+
+  U.experimental.use_parallel_blend_file_read = 1;
+  Main *read_main = read_file(filepath);
+  if (read_main == nullptr) {
+    BLO_blendfiledata_free(serial_bfd);
+    return;
+  }
+
+  EXPECT_EQ(id_names(read_main->meshes), id_names(serial_main->meshes));
+  EXPECT_EQ(id_names(read_main->objects), id_names(serial_main->objects));
+  for (const int i : IndexRange(50)) {
+    const std::string name = "Mesh" + std::to_string(i);
+    const Mesh *mesh = find_mesh(read_main, name.c_str());
+    const Mesh *serial_mesh = find_mesh(serial_main, name.c_str());
+    const Object *object = reinterpret_cast<const Object *>(
+        BKE_libblock_find_name(read_main, ID_OB, name.c_str()));
+    const Object *serial_object = reinterpret_cast<const Object *>(
+        BKE_libblock_find_name(serial_main, ID_OB, name.c_str()));
+    EXPECT_NE(mesh, nullptr);
+    EXPECT_NE(serial_mesh, nullptr);
+    EXPECT_NE(object, nullptr);
+    EXPECT_NE(serial_object, nullptr);
+    if (!mesh || !serial_mesh || !object || !serial_object) {
+      continue;
+    }
+    expect_meshes_equal(*serial_mesh, *mesh);
+    EXPECT_EQ(serial_object->data, serial_mesh);
+    EXPECT_EQ(object->data, mesh);
+  }
+
+  BLO_blendfiledata_free(serial_bfd);
+}
+
+/** Identity flags of all chunks, in order. */
+static Vector<bool> memfile_chunks_identical(const MemFile &memfile)
+{
+  Vector<bool> flags;
+  LISTBASE_FOREACH (const MemFileChunk *, chunk, &memfile.chunks) {
+    flags.append(chunk->is_identical);
+  }
+  return flags;
+}
+
+TEST_F(BlendfileWriteTest, UndoArchiveRoundTrip)
+{
+  Mesh *mesh = test_mesh_add(bmain, "Mesh", 16, 0);
+
+  MemFile step1{};
+  BLO_write_file_mem(bmain, nullptr, &step1, 0);
+  MemFile step2{};
+  BLO_write_file_mem(bmain, &step1, &step2, 0);
+  mesh->vert_positions_for_write()[0] = float3(-1.0f, -2.0f, -3.0f);
+  mesh->tag_positions_changed();
+  MemFile step3{};
+  BLO_write_file_mem(bmain, &step2, &step3, 0);
+
+  const std::string step2_contents = memfile_contents(step2);
+  const std::string step3_contents = memfile_contents(step3);
+  const Vector<bool> step2_identical = memfile_chunks_identical(step2);
+  const Vector<bool> step3_identical = memfile_chunks_identical(step3);
+
+  /* Archive the two older steps, which hands over the buffers they own to the last one. */
+  const Vector<MemFile *> later_memfiles = {&step3};
+  BLO_memfile_archive(&step1, {});
+  BLO_memfile_archive(&step2, later_memfiles);
+  EXPECT_TRUE(memfile_contents(step3) == step3_contents);
+  EXPECT_EQ(memfile_chunks_identical(step3), step3_identical);
+
+  /* Restoring gives the same data, and keeps the flags that undo uses to reuse unchanged IDs. */
+  EXPECT_TRUE(BLO_memfile_archive_restore(&step2));
+  EXPECT_TRUE(memfile_contents(step2) == step2_contents);
+  EXPECT_EQ(memfile_chunks_identical(step2), step2_identical);
+  EXPECT_TRUE(memfile_id_chunks_identical(step2, mesh->id));
+
+  BLO_memfile_free(&step3);
+  BLO_memfile_free(&step2);
+  BLO_memfile_free(&step1);
+}
+
+}  // namespace blender::blenloader::tests
@@ -75,6 +75,12 @@ enum {
    * (typically owned by #ID's, will be freed when there are no users).
    */
   BLO_CODE_DATA = BLEND_MAKE_ID('D', 'A', 'T', 'A'),
+  /**
+   * Data that is identical to a #BLO_CODE_DATA block written earlier in the file. Instead of the
+   * data itself, it only stores the address (#BHead.old) of that block as `uint64_t`, and is read
+   * as a copy of it.
+   */
+  BLO_CODE_DATA_REFERENCE = BLEND_MAKE_ID('D', 'R', 'E', 'F'),
   /**
    * Used for #Global struct.
    */
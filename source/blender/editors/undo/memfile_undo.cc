@@ -12,12 +12,14 @@
 
 #include "BLI_ghash.h"
 #include "BLI_listbase.h"
+#include "BLI_vector.hh"
 
 #include "DNA_ID.h"
 #include "DNA_collection_types.h"
 #include "DNA_node_types.h"
 #include "DNA_object_types.h"
 #include "DNA_scene_types.h"
+#include "DNA_userdef_types.h"
 
 #include "BKE_blender_undo.hh"
 #include "BKE_context.hh"
@@ -67,6 +69,43 @@ static bool memfile_undosys_poll(bContext *C)
   return true;
 }
 
+/**
+ * Archive the memfiles of all steps before \a us_prev, which is still needed as reference when
+ * writing the next step. The new step \a us is not part of the stack yet.
+ */
+static void memfile_undosys_archive_steps(UndoStack *ustack,
+                                          MemFileUndoStep *us_prev,
+                                          MemFileUndoStep *us)
+{
+  blender::Vector<MemFileUndoStep *> steps;
+  LISTBASE_FOREACH (UndoStep *, us_iter, &ustack->steps) {
+    if (us_iter->type == BKE_UNDOSYS_TYPE_MEMFILE) {
+      steps.append((MemFileUndoStep *)us_iter);
+    }
+  }
+  steps.append(us);
+
+  blender::Vector<MemFile *> memfiles;
+  for (MemFileUndoStep *us_iter : steps) {
+    memfiles.append(&us_iter->data->memfile);
+  }
+
+  for (const int i : steps.index_range()) {
+    if (ELEM(steps[i], us_prev, us)) {
+      break;
+    }
+    BLO_memfile_archive(memfiles[i], memfiles.as_span().drop_front(i + 1));
+  }
+
+  BLO_memfile_archive_evict(U.undo_archive_memory > 0 ?
+                                size_t(U.undo_archive_memory) * 1024 * 1024 :
+                                SIZE_MAX);
+
+  for (MemFileUndoStep *us_iter : steps) {
+    us_iter->step.data_size = BLO_memfile_memory_size(&us_iter->data->memfile);
+  }
+}
+
 static bool memfile_undosys_step_encode(bContext * /*C*/, Main *bmain, UndoStep *us_p)
 {
   MemFileUndoStep *us = (MemFileUndoStep *)us_p;
@@ -84,6 +123,10 @@ static bool memfile_undosys_step_encode(bContext * /*C*/, Main *bmain, UndoStep
   us->data = BKE_memfile_undo_encode(bmain, us_prev ? us_prev->data : nullptr);
   us->step.data_size = us->data->undo_size;
 
+  if (us_prev && USER_DEVELOPER_TOOL_TEST(&U, use_undo_archive)) {
+    memfile_undosys_archive_steps(ustack, us_prev, us);
+  }
+
   /* Store the fact that we should not re-use old data with that undo step, and reset the Main
    * flag. */
   us->step.use_old_bmain_data = !bmain->use_memfile_full_barrier;
@@ -161,6 +204,14 @@ static void memfile_undosys_unfinished_id_previews_restart(ID *id)
   }
 }
 
+static bool memfile_undosys_step_decode_prepare(UndoStep *us_p)
+{
+  MemFileUndoStep *us = (MemFileUndoStep *)us_p;
+  /* The data of archived steps may be lost, which has to be detected before the current state is
+   * freed. */
+  return BLO_memfile_archive_restore(&us->data->memfile);
+}
+
 static void memfile_undosys_step_decode(
     bContext *C, Main *bmain, UndoStep *us_p, const eUndoStepDir undo_direction, bool /*is_final*/)
 {
@@ -349,6 +400,7 @@ void ED_memfile_undosys_type(UndoType *ut)
   ut->poll = memfile_undosys_poll;
   ut->step_encode = memfile_undosys_step_encode;
   ut->step_decode = memfile_undosys_step_decode;
+  ut->step_decode_prepare = memfile_undosys_step_decode_prepare;
   ut->step_free = memfile_undosys_step_free;
 
   ut->flags = 0;
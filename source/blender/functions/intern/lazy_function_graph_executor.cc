@@ -49,6 +49,7 @@
 #include "BLI_stack.hh"
 #include "BLI_task.h"
 #include "BLI_task.hh"
+#include "BLI_trace.hh"
 
 #include "FN_lazy_function_graph_executor.hh"
 
@@ -1447,6 +1448,7 @@ inline void Executor::execute_node(const FunctionNode &node,
   };
 
   lazy_threading::HintReceiver blocking_hint_receiver{blocking_hint_fn};
+  trace::ScopedEvent trace_event("lazy_function", [&]() { return fn.name(); });
   if (self_.node_execute_wrapper_) {
     self_.node_execute_wrapper_->execute_node(node, node_params, fn_context);
   }
@@ -19,6 +19,7 @@
 
 #  include <optional>
 
+#  include "BLI_index_mask_fwd.hh"
 #  include "BLI_math_vector_types.hh"
 #  include "BLI_memory_counter_fwd.hh"
 #  include "BLI_vector_set.hh"
@@ -352,6 +353,14 @@ typedef struct Mesh {
    * Cached map from each vertex to the faces using it.
    */
   blender::GroupedSpan<int> vert_to_face_map() const;
+  /**
+   * Cached map from each vertex to the edges using it.
+   */
+  blender::GroupedSpan<int> vert_to_edge_map() const;
+  /**
+   * Cached map from each edge to the faces using it.
+   */
+  blender::GroupedSpan<int> edge_to_face_map() const;
 
   /**
    * Cached information about loose edges, calculated lazily when necessary.
@@ -444,6 +453,12 @@ typedef struct Mesh {
 
   /** Call after changing vertex positions to tag lazily calculated caches for recomputation. */
   void tag_positions_changed();
+  /**
+   * Call after changing the positions of only some vertices. Cached normals of the faces and
+   * vertices around the changed vertices are updated in place when that is cheaper than
+   * recomputing all normals later on.
+   */
+  void tag_positions_changed(const blender::IndexMask &changed_verts);
   /** Call after moving every mesh vertex by the same translation. */
   void tag_positions_changed_uniformly();
   /** Like #tag_positions_changed but doesn't tag normals; they must be updated separately. */
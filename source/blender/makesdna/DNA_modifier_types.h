@@ -235,6 +235,7 @@ typedef enum {
   eSubsurfModifierFlag_UseCustomNormals = (1 << 5),
   eSubsurfModifierFlag_UseRecursiveSubdivision = (1 << 6),
   eSubsurfModifierFlag_UseAdaptiveSubdivision = (1 << 7),
+  eSubsurfModifierFlag_UseAdaptiveLevels = (1 << 8),
 } SubsurfModifierFlag;
 
 typedef enum {
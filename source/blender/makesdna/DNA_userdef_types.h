@@ -233,6 +233,15 @@ typedef struct UserDef_Experimental {
   char use_recompute_usercount_on_save_debug;
   char write_legacy_blend_file_format;
   char no_data_block_packing;
+  char use_blend_file_zero_copy;
+  char use_lazy_library_data;
+  char use_parallel_blend_file_write;
+  char use_blend_file_deduplication;
+  char use_incremental_undo;
+  char use_undo_archive;
+  char use_versioning_cache;
+  char use_parallel_blend_file_read;
+  char use_memory_cache_disk;
   char SANITIZE_AFTER_HERE;
   /* The following options are automatically sanitized (set to 0)
    * when the release cycle is not alpha. */
@@ -241,7 +250,7 @@ typedef struct UserDef_Experimental {
   char use_sculpt_texture_paint;
   char use_shader_node_previews;
   char use_geometry_nodes_lists;
-  char _pad[6];
+  char _pad[5];
 } UserDef_Experimental;
 
 #define USER_EXPERIMENTAL_TEST(userdef, member) (((userdef)->experimental).member)
@@ -453,7 +462,8 @@ typedef struct UserDef {
   short gp_manhattandist, gp_euclideandist, gp_eraser;
   /** #eGP_UserdefSettings. */
   short gp_settings;
-  char _pad13[4];
+  /** Memory limit of archived undo steps in megabytes (see #UserDef_Experimental). */
+  int undo_archive_memory;
   struct SolidLight light_param[4];
   float light_ambient[3];
   char gizmo_flag;
@@ -183,6 +183,9 @@ PointerRNA RNA_main_pointer_create(Main *main)
 PointerRNA RNA_id_pointer_create(ID *id)
 {
   if (id) {
+    /* Linked data that is accessed through RNA (e.g. from Python) has to be read from its
+     * library file. */
+    BKE_libblock_lazy_data_ensure(*id);
     PointerRNA ptr{id, ID_code_to_RNA_type(GS(id->name)), id};
     rna_pointer_refine(ptr);
     return ptr;
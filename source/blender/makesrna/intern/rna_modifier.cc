@@ -2532,10 +2532,19 @@ static void rna_def_modifier_subsurf(BlenderRNA *brna)
       prop, "Use Adaptive Subdivision", "Adaptively subdivide mesh based on camera distance");
   RNA_def_property_update(prop, 0, "rna_Modifier_update");
 
+  prop = RNA_def_property(srna, "use_adaptive_levels", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, nullptr, "flags", eSubsurfModifierFlag_UseAdaptiveLevels);
+  RNA_def_property_ui_text(prop,
+                           "Adaptive Levels",
+                           "Clamp the subdivision levels of the object so that its largest edge "
+                           "is not subdivided below the adaptive subdivision size, for all render "
+                           "engines. The whole object uses the same level");
+  RNA_def_property_update(prop, 0, "rna_Modifier_dependency_update");
+
   prop = RNA_def_property(srna, "adaptive_space", PROP_ENUM, PROP_NONE);
   RNA_def_property_enum_items(prop, prop_adaptive_space_items);
   RNA_def_property_ui_text(prop, "Adaptive Space", "How to adaptively subdivide the mesh");
-  RNA_def_property_update(prop, 0, "rna_Modifier_update");
+  RNA_def_property_update(prop, 0, "rna_Modifier_dependency_update");
 
   prop = RNA_def_property(srna, "adaptive_pixel_size", PROP_FLOAT, PROP_PIXEL);
   RNA_def_property_ui_text(
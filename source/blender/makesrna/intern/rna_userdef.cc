@@ -933,6 +933,8 @@ static void rna_Userdef_memcache_update(Main * /*bmain*/, Scene * /*scene*/, Poi
   const int64_t new_limit = int64_t(U.memcachelimit) * 1024 * 1024;
   MEM_CacheLimiter_set_maximum(new_limit);
   blender::memory_cache::set_approximate_size_limit(new_limit);
+  blender::memory_cache::set_approximate_disk_size_limit(
+      USER_DEVELOPER_TOOL_TEST(&U, use_memory_cache_disk) ? new_limit : 0);
   USERDEF_TAG_DIRTY;
 }
 
@@ -5507,6 +5509,14 @@ static void rna_def_userdef_edit(BlenderRNA *brna)
   RNA_def_property_ui_text(
       prop, "Undo Memory Size", "Maximum memory usage in megabytes (0 means unlimited)");
 
+  prop = RNA_def_property(srna, "undo_archive_memory_limit", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, nullptr, "undo_archive_memory");
+  RNA_def_property_range(prop, 0, max_memory_in_megabytes_int());
+  RNA_def_property_ui_text(prop,
+                           "Undo Archive Memory Size",
+                           "Maximum memory usage in megabytes of archived undo steps, before the "
+                           "oldest ones are moved to disk (0 means unlimited)");
+
   prop = RNA_def_property(srna, "use_global_undo", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_sdna(prop, nullptr, "uiflag", USER_GLOBALUNDO);
   RNA_def_property_ui_text(
@@ -7398,6 +7408,73 @@ static void rna_def_userdef_experimental(BlenderRNA *brna)
   RNA_def_property_flag(prop, PROP_CONTEXT_UPDATE);
   RNA_def_property_update(prop, 0, "rna_experimental_no_data_block_packing_update");
 
+  prop = RNA_def_property(srna, "use_blend_file_zero_copy", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_ui_text(prop,
+                           "Zero-Copy Blend File Reading",
+                           "Reference large arrays (like mesh attributes) directly from "
+                           "memory-mapped uncompressed blend-files instead of copying them when "
+                           "loading. Reduces memory usage and load time for large files, but "
+                           "keeps the files mapped as long as the data is in use. Files must not "
+                           "be modified in place while they are mapped, saving fails then");
+
+  prop = RNA_def_property(srna, "use_lazy_library_data", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_ui_text(prop,
+                           "Lazy Library Data",
+                           "Only read large mesh attribute arrays of data linked from "
+                           "uncompressed library files saved with this Blender version once the "
+                           "data is used. Data of library files that were changed in the "
+                           "meantime is replaced by zeros, reload the library then");
+
+  prop = RNA_def_property(srna, "use_parallel_blend_file_write", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_ui_text(prop,
+                           "Multithreaded Blend File Writing",
+                           "Serialize independent data-blocks on multiple threads when saving "
+                           "files. The written file is identical to the one written by a single "
+                           "thread, but more memory is used temporarily");
+
+  prop = RNA_def_property(srna, "use_blend_file_deduplication", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_ui_text(prop,
+                           "Deduplicate Blend File Data",
+                           "Store identical large arrays only once when saving files, other "
+                           "occurrences reference the stored data. Such files can only be "
+                           "opened with this Blender version or newer");
+
+  prop = RNA_def_property(srna, "use_incremental_undo", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_ui_text(prop,
+                           "Incremental Undo",
+                           "Only store data-blocks that were tagged as changed since the previous "
+                           "undo step, and reuse the stored data of all others. Changes that are "
+                           "not tagged for updates may not be undone correctly");
+
+  prop = RNA_def_property(srna, "use_undo_archive", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_ui_text(prop,
+                           "Undo Archive",
+                           "Store older global undo steps de-duplicated against each other, and "
+                           "move the oldest ones to compressed files on disk when the archive "
+                           "memory limit is exceeded");
+
+  prop = RNA_def_property(srna, "use_versioning_cache", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_ui_text(prop,
+                           "Versioning Cache",
+                           "Keep versioned copies of libraries saved by older Blender versions in "
+                           "the cache directory, so linking from them does not have to run "
+                           "versioning code again. Copies are created in the background after "
+                           "linking, and the least recently used ones are removed");
+
+  prop = RNA_def_property(srna, "use_parallel_blend_file_read", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_ui_text(prop,
+                           "Multithreaded Blend File Reading",
+                           "Link the data of independent data-blocks like meshes, materials and "
+                           "node trees in parallel when opening a blend-file");
+
+  prop = RNA_def_property(srna, "use_memory_cache_disk", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_ui_text(prop,
+                           "Memory Cache on Disk",
+                           "Write values evicted from the memory cache, like geometry imported "
+                           "by nodes, to the temporary directory and read them back from there. "
+                           "Uses up to the memory cache limit of disk space");
+  RNA_def_property_update(prop, 0, "rna_Userdef_memcache_update");
+
   prop = RNA_def_property(srna, "use_all_linked_data_direct", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_ui_text(
       prop,
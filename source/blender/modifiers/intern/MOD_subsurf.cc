@@ -46,6 +46,7 @@
 #include "RNA_prototypes.hh"
 
 #include "DEG_depsgraph.hh"
+#include "DEG_depsgraph_build.hh"
 #include "DEG_depsgraph_query.hh"
 
 #include "MOD_modifiertypes.hh"
@@ -91,21 +92,25 @@ static bool is_disabled(const Scene *scene, ModifierData *md, bool use_render_pa
 }
 
 static int subdiv_levels_for_modifier_get(const SubsurfModifierData *smd,
-                                          const ModifierEvalContext *ctx)
+                                          const ModifierEvalContext *ctx,
+                                          const Mesh &mesh)
 {
   Scene *scene = DEG_get_evaluated_scene(ctx->depsgraph);
   const bool use_render_params = (ctx->flag & MOD_APPLY_RENDER);
   const int requested_levels = (use_render_params) ? smd->renderLevels : smd->levels;
-  return get_render_subsurf_level(&scene->r, requested_levels, use_render_params);
+  const int levels = get_render_subsurf_level(&scene->r, requested_levels, use_render_params);
+  return BKE_subsurf_modifier_adaptive_levels_get(
+      smd, scene, ctx->object, &mesh, use_render_params, levels);
 }
 
 /* Subdivide into fully qualified mesh. */
 
 static void subdiv_mesh_settings_init(blender::bke::subdiv::ToMeshSettings *settings,
                                       const SubsurfModifierData *smd,
-                                      const ModifierEvalContext *ctx)
+                                      const ModifierEvalContext *ctx,
+                                      const Mesh &mesh)
 {
-  const int level = subdiv_levels_for_modifier_get(smd, ctx);
+  const int level = subdiv_levels_for_modifier_get(smd, ctx, mesh);
   settings->resolution = (1 << level) + 1;
   settings->use_optimal_display = (smd->flags & eSubsurfModifierFlag_ControlEdges) &&
                                   !(ctx->flag & MOD_APPLY_TO_ORIGINAL);
@@ -118,7 +123,7 @@ static Mesh *subdiv_as_mesh(SubsurfModifierData *smd,
 {
   Mesh *result = mesh;
   blender::bke::subdiv::ToMeshSettings mesh_settings;
-  subdiv_mesh_settings_init(&mesh_settings, smd, ctx);
+  subdiv_mesh_settings_init(&mesh_settings, smd, ctx, *mesh);
   if (mesh_settings.resolution < 3) {
     return result;
   }
@@ -130,9 +135,10 @@ static Mesh *subdiv_as_mesh(SubsurfModifierData *smd,
 
 static void subdiv_ccg_settings_init(SubdivToCCGSettings *settings,
                                      const SubsurfModifierData *smd,
-                                     const ModifierEvalContext *ctx)
+                                     const ModifierEvalContext *ctx,
+                                     const Mesh &mesh)
 {
-  const int level = subdiv_levels_for_modifier_get(smd, ctx);
+  const int level = subdiv_levels_for_modifier_get(smd, ctx, mesh);
   settings->resolution = (1 << level) + 1;
   settings->need_normal = true;
   settings->need_mask = false;
@@ -145,7 +151,7 @@ static Mesh *subdiv_as_ccg(SubsurfModifierData *smd,
 {
   Mesh *result = mesh;
   SubdivToCCGSettings ccg_settings;
-  subdiv_ccg_settings_init(&ccg_settings, smd, ctx);
+  subdiv_ccg_settings_init(&ccg_settings, smd, ctx, *mesh);
   if (ccg_settings.resolution < 3) {
     return result;
   }
@@ -162,7 +168,7 @@ static void subdiv_cache_mesh_wrapper_settings(const ModifierEvalContext *ctx,
                                                const bool has_gpu_subdiv)
 {
   blender::bke::subdiv::ToMeshSettings mesh_settings;
-  subdiv_mesh_settings_init(&mesh_settings, smd, ctx);
+  subdiv_mesh_settings_init(&mesh_settings, smd, ctx, *mesh);
 
   runtime_data->has_gpu_subdiv = has_gpu_subdiv;
   runtime_data->resolution = mesh_settings.resolution;
@@ -316,15 +322,31 @@ static void deform_matrices(ModifierData *md,
   }
 }
 
-static bool get_show_adaptive_options(const bContext *C, Panel *panel)
+static void update_depsgraph(ModifierData *md, const ModifierUpdateDepsgraphContext *ctx)
 {
-  /* Don't show adaptive options if cycles isn't the active engine. */
+  SubsurfModifierData *smd = (SubsurfModifierData *)md;
+  if (!(smd->flags & eSubsurfModifierFlag_UseAdaptiveLevels)) {
+    return;
+  }
+  if (smd->adaptive_space == SUBSURF_ADAPTIVE_SPACE_PIXEL) {
+    DEG_add_depends_on_transform_relation(ctx->node, "Subdivision Modifier");
+    DEG_add_scene_camera_relation(
+        ctx->node, ctx->scene, DEG_OB_COMP_TRANSFORM, "Subdivision Modifier");
+    /* The active camera and the render resolution are scene parameters. */
+    DEG_add_scene_relation(
+        ctx->node, ctx->scene, DEG_SCENE_COMP_PARAMETERS, "Subdivision Modifier");
+  }
+}
+
+static bool get_show_cycles_adaptive_options(const bContext *C, Panel *panel)
+{
+  /* Don't show Cycles adaptive options if cycles isn't the active engine. */
   const RenderEngineType *engine_type = CTX_data_engine_type(C);
   if (!STREQ(engine_type->idname, "CYCLES")) {
     return false;
   }
 
-  /* Only show adaptive options if this is the last modifier. */
+  /* Only show Cycles adaptive options if this is the last modifier. */
   PointerRNA *ptr = modifier_panel_get_property_pointers(panel, nullptr);
   ModifierData *md = static_cast<ModifierData *>(ptr->data);
   if (md->next != nullptr) {
@@ -374,7 +396,11 @@ static void panel_draw(const bContext *C, Panel *panel)
     }
   }
 
-  if (get_show_adaptive_options(C, panel)) {
+  /* Adaptive levels work with all render engines, and use the same size settings as the adaptive
+   * subdivision done by Cycles. */
+  const bool show_cycles_adaptive = get_show_cycles_adaptive_options(C, panel);
+  uiLayout *adaptive_layout;
+  if (show_cycles_adaptive) {
     PanelLayout adaptive_panel = layout->panel_prop_with_bool_header(
         C,
         ptr,
@@ -382,7 +408,27 @@ static void panel_draw(const bContext *C, Panel *panel)
         ptr,
         "use_adaptive_subdivision",
         IFACE_("Adaptive Subdivision"));
-    if (adaptive_panel.body) {
+    adaptive_layout = adaptive_panel.body;
+  }
+  else {
+    adaptive_layout = layout->panel_prop(
+        C, ptr, "open_adaptive_subdivision_panel", IFACE_("Adaptive Subdivision"));
+  }
+  if (adaptive_layout) {
+    adaptive_layout->prop(ptr, "use_adaptive_levels", UI_ITEM_NONE, std::nullopt, ICON_NONE);
+    uiLayout *col = &adaptive_layout->column(false);
+    col->active_set((smd->flags & eSubsurfModifierFlag_UseAdaptiveLevels) ||
+                    (show_cycles_adaptive &&
+                     (smd->flags & eSubsurfModifierFlag_UseAdaptiveSubdivision)));
+    col->prop(ptr, "adaptive_space", UI_ITEM_NONE, IFACE_("Space"), ICON_NONE);
+    if (smd->adaptive_space == SUBSURF_ADAPTIVE_SPACE_OBJECT) {
+      col->prop(ptr, "adaptive_object_edge_length", UI_ITEM_NONE, std::nullopt, ICON_NONE);
+    }
+    else {
+      col->prop(ptr, "adaptive_pixel_size", UI_ITEM_NONE, std::nullopt, ICON_NONE);
+    }
+
+    if (show_cycles_adaptive) {
       Scene *scene = CTX_data_scene(C);
       PointerRNA scene_ptr = RNA_id_pointer_create(&scene->id);
       PointerRNA cycles_ptr = RNA_pointer_get(&scene_ptr, "cycles");
@@ -390,31 +436,25 @@ static void panel_draw(const bContext *C, Panel *panel)
       const float preview_rate = RNA_float_get(&cycles_ptr, "preview_dicing_rate");
       std::string render_str, preview_str;
 
-      adaptive_panel.body->active_set(smd->flags & eSubsurfModifierFlag_UseAdaptiveSubdivision);
-      adaptive_panel.body->prop(ptr, "adaptive_space", UI_ITEM_NONE, IFACE_("Space"), ICON_NONE);
       if (smd->adaptive_space == SUBSURF_ADAPTIVE_SPACE_OBJECT) {
-        adaptive_panel.body->prop(
-            ptr, "adaptive_object_edge_length", UI_ITEM_NONE, std::nullopt, ICON_NONE);
         preview_str = fmt::format("{:.5g}", preview_rate * smd->adaptive_object_edge_length);
         render_str = fmt::format("{:.5g}", render_rate * smd->adaptive_object_edge_length);
       }
       else {
-        adaptive_panel.body->prop(
-            ptr, "adaptive_pixel_size", UI_ITEM_NONE, std::nullopt, ICON_NONE);
         preview_str = fmt::format("{:.2f} px",
                                   std::max(preview_rate * smd->adaptive_pixel_size, 0.1f));
         render_str = fmt::format("{:.2f} px",
                                  std::max(render_rate * smd->adaptive_pixel_size, 0.1f));
       }
 
-      uiLayout *split = &adaptive_panel.body->split(0.4f, false);
-      uiLayout *col = &split->column(true);
-      col->alignment_set(blender::ui::LayoutAlign::Right);
-      col->label(IFACE_("Viewport"), ICON_NONE);
-      col->label(IFACE_("Render"), ICON_NONE);
-      col = &split->column(true);
-      col->label(preview_str, ICON_NONE);
-      col->label(render_str, ICON_NONE);
+      uiLayout *split = &col->split(0.4f, false);
+      uiLayout *split_col = &split->column(true);
+      split_col->alignment_set(blender::ui::LayoutAlign::Right);
+      split_col->label(IFACE_("Viewport"), ICON_NONE);
+      split_col->label(IFACE_("Render"), ICON_NONE);
+      split_col = &split->column(true);
+      split_col->label(preview_str, ICON_NONE);
+      split_col->label(render_str, ICON_NONE);
     }
   }
 
@@ -469,7 +509,7 @@ ModifierTypeInfo modifierType_Subsurf = {
     /*required_data_mask*/ nullptr,
     /*free_data*/ free_data,
     /*is_disabled*/ is_disabled,
-    /*update_depsgraph*/ nullptr,
+    /*update_depsgraph*/ update_depsgraph,
     /*depends_on_time*/ nullptr,
     /*depends_on_normals*/ nullptr,
     /*foreach_ID_link*/ nullptr,
@@ -2,8 +2,11 @@
  *
  * SPDX-License-Identifier: GPL-2.0-or-later */
 
+#include <istream>
 #include <optional>
+#include <ostream>
 
+#include "BLI_memory_counter.hh"
 #include "BLI_string.h"
 
 #include "node_geometry_util.hh"
@@ -12,6 +15,7 @@
 #include "DNA_space_types.h"
 #include "DNA_userdef_types.h"
 
+#include "BKE_bake_items_serialize.hh"
 #include "BKE_node.hh"
 
 #include "NOD_rna_define.hh"
@@ -103,6 +107,60 @@ void node_geo_exec_with_missing_openvdb(GeoNodeExecParams &params)
                            TIP_("Disabled, Blender was compiled without OpenVDB"));
 }
 
+void LoadGeometryCache::count_memory(MemoryCounter &counter) const
+{
+  this->geometry.count_memory(counter);
+}
+
+bool LoadGeometryCache::serialize(std::ostream &stream) const
+{
+  if (!bke::bake::serialize_geometry(this->geometry, stream)) {
+    return false;
+  }
+  const int64_t warnings_num = this->warnings.size();
+  stream.write(reinterpret_cast<const char *>(&warnings_num), sizeof(warnings_num));
+  for (const geo_eval_log::NodeWarning &warning : this->warnings) {
+    const int type = int(warning.type);
+    const int64_t message_size = warning.message.size();
+    stream.write(reinterpret_cast<const char *>(&type), sizeof(type));
+    stream.write(reinterpret_cast<const char *>(&message_size), sizeof(message_size));
+    stream.write(warning.message.data(), message_size);
+  }
+  return stream.good();
+}
+
+std::unique_ptr<LoadGeometryCache> LoadGeometryCache::deserialize(std::istream &stream)
+{
+  std::optional<GeometrySet> geometry = bke::bake::deserialize_geometry(stream);
+  if (!geometry) {
+    return {};
+  }
+  auto cached_value = std::make_unique<LoadGeometryCache>();
+  cached_value->geometry = std::move(*geometry);
+  int64_t warnings_num;
+  if (!stream.read(reinterpret_cast<char *>(&warnings_num), sizeof(warnings_num)) ||
+      warnings_num < 0)
+  {
+    return {};
+  }
+  for ([[maybe_unused]] const int64_t i : IndexRange(warnings_num)) {
+    int type;
+    int64_t message_size;
+    if (!stream.read(reinterpret_cast<char *>(&type), sizeof(type)) ||
+        !stream.read(reinterpret_cast<char *>(&message_size), sizeof(message_size)) ||
+        message_size < 0)
+    {
+      return {};
+    }
+    std::string message(message_size, '\0');
+    if (!stream.read(message.data(), message_size)) {
+      return {};
+    }
+    cached_value->warnings.append({NodeWarningType(type), message});
+  }
+  return cached_value;
+}
+
 }  // namespace blender::nodes
 
 bool geo_node_poll_default(const blender::bke::bNodeType * /*ntype*/,
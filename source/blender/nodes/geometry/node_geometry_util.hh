@@ -8,6 +8,8 @@
 
 #include "MEM_guardedalloc.h"  // IWYU pragma: export
 
+#include "BLI_memory_cache.hh"
+
 #include "BKE_node.hh"
 #include "BKE_node_legacy_types.hh"  // IWYU pragma: export
 #include "BKE_node_socket_value.hh"  // IWYU pragma: export
@@ -83,4 +85,18 @@ void node_geo_exec_with_missing_openvdb(GeoNodeExecParams &params);
 
 void draw_data_blocks(const bContext *C, uiLayout *layout, PointerRNA &bake_rna);
 
+/**
+ * Cached result of the nodes that import geometry from files. It can be moved to the disk cache,
+ * reading it from there is usually much faster than importing the file again.
+ */
+class LoadGeometryCache : public memory_cache::CachedValue {
+ public:
+  GeometrySet geometry;
+  Vector<geo_eval_log::NodeWarning> warnings;
+
+  void count_memory(MemoryCounter &counter) const override;
+  bool serialize(std::ostream &stream) const override;
+  static std::unique_ptr<LoadGeometryCache> deserialize(std::istream &stream);
+};
+
 }  // namespace blender::nodes
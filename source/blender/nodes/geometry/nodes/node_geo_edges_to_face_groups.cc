@@ -55,10 +55,7 @@ class FaceSetFromBoundariesInput final : public bke::MeshFieldInput {
 
     const OffsetIndices faces = mesh.faces();
 
-    Array<int> edge_to_face_offsets;
-    Array<int> edge_to_face_indices;
-    const GroupedSpan<int> edge_to_face_map = bke::mesh::build_edge_to_face_map(
-        faces, mesh.corner_edges(), mesh.edges_num, edge_to_face_offsets, edge_to_face_indices);
+    const GroupedSpan<int> edge_to_face_map = mesh.edge_to_face_map();
 
     AtomicDisjointSet islands(faces.size());
     non_boundary_edges.foreach_index(
@@ -29,17 +29,6 @@ static void node_declare(NodeDeclarationBuilder &b)
   b.add_output<decl::Geometry>("Point Cloud");
 }
 
-class LoadCsvCache : public memory_cache::CachedValue {
- public:
-  GeometrySet geometry;
-  Vector<geo_eval_log::NodeWarning> warnings;
-
-  void count_memory(MemoryCounter &counter) const override
-  {
-    this->geometry.count_memory(counter);
-  }
-};
-
 static void node_geo_exec(GeoNodeExecParams params)
 {
   const std::optional<std::string> path = params.ensure_absolute_path(
@@ -63,7 +52,7 @@ static void node_geo_exec(GeoNodeExecParams params)
 
   /* Encode delimiter in key because it affects the result. */
   const std::string loader_key = fmt::format("import_csv_node_{}", delimiter[0]);
-  std::shared_ptr<const LoadCsvCache> cached_value = memory_cache::get_loaded<LoadCsvCache>(
+  const auto cached_value = memory_cache::get_loaded<LoadGeometryCache>(
       GenericStringKey{loader_key}, {StringRefNull(*path)}, [&]() {
         blender::io::csv::CSVImportParams import_params{};
         import_params.delimiter = delimiter[0];
@@ -76,7 +65,7 @@ static void node_geo_exec(GeoNodeExecParams params)
 
         PointCloud *pointcloud = blender::io::csv::import_csv_as_pointcloud(import_params);
 
-        auto cached_value = std::make_unique<LoadCsvCache>();
+        auto cached_value = std::make_unique<LoadGeometryCache>();
         cached_value->geometry = GeometrySet::from_pointcloud(pointcloud);
 
         LISTBASE_FOREACH (Report *, report, &(import_params.reports)->list) {
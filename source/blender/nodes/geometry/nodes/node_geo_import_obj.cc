@@ -27,17 +27,6 @@ static void node_declare(NodeDeclarationBuilder &b)
   b.add_output<decl::Geometry>("Instances");
 }
 
-class LoadObjCache : public memory_cache::CachedValue {
- public:
-  GeometrySet geometry;
-  Vector<geo_eval_log::NodeWarning> warnings;
-
-  void count_memory(MemoryCounter &counter) const override
-  {
-    this->geometry.count_memory(counter);
-  }
-};
-
 static void node_geo_exec(GeoNodeExecParams params)
 {
 #ifdef WITH_IO_WAVEFRONT_OBJ
@@ -48,7 +37,7 @@ static void node_geo_exec(GeoNodeExecParams params)
     return;
   }
 
-  std::shared_ptr<const LoadObjCache> cached_value = memory_cache::get_loaded<LoadObjCache>(
+  const auto cached_value = memory_cache::get_loaded<LoadGeometryCache>(
       GenericStringKey{"import_obj_node"}, {StringRefNull(*path)}, [&]() {
         OBJImportParams import_params;
         STRNCPY(import_params.filepath, path->c_str());
@@ -67,7 +56,7 @@ static void node_geo_exec(GeoNodeExecParams params)
           instances->add_instance(handle, float4x4::identity());
         }
 
-        auto cached_value = std::make_unique<LoadObjCache>();
+        auto cached_value = std::make_unique<LoadGeometryCache>();
         cached_value->geometry = GeometrySet::from_instances(instances);
 
         LISTBASE_FOREACH (Report *, report, &(import_params.reports)->list) {
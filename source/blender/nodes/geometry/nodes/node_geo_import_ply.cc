@@ -26,17 +26,6 @@ static void node_declare(NodeDeclarationBuilder &b)
   b.add_output<decl::Geometry>("Mesh");
 }
 
-class LoadPlyCache : public memory_cache::CachedValue {
- public:
-  GeometrySet geometry;
-  Vector<geo_eval_log::NodeWarning> warnings;
-
-  void count_memory(MemoryCounter &counter) const override
-  {
-    this->geometry.count_memory(counter);
-  }
-};
-
 static void node_geo_exec(GeoNodeExecParams params)
 {
 #ifdef WITH_IO_PLY
@@ -47,7 +36,7 @@ static void node_geo_exec(GeoNodeExecParams params)
     return;
   }
 
-  std::shared_ptr<const LoadPlyCache> cached_value = memory_cache::get_loaded<LoadPlyCache>(
+  const auto cached_value = memory_cache::get_loaded<LoadGeometryCache>(
       GenericStringKey{"import_ply_node"}, {StringRefNull(*path)}, [&]() {
         PLYImportParams import_params;
         STRNCPY(import_params.filepath, path->c_str());
@@ -60,7 +49,7 @@ static void node_geo_exec(GeoNodeExecParams params)
 
         Mesh *mesh = PLY_import_mesh(import_params);
 
-        auto cached_value = std::make_unique<LoadPlyCache>();
+        auto cached_value = std::make_unique<LoadGeometryCache>();
         cached_value->geometry = GeometrySet::from_mesh(mesh);
 
         LISTBASE_FOREACH (Report *, report, &(import_params.reports)->list) {
@@ -28,17 +28,6 @@ static void node_declare(NodeDeclarationBuilder &b)
   b.add_output<decl::Geometry>("Mesh");
 }
 
-class LoadStlCache : public memory_cache::CachedValue {
- public:
-  GeometrySet geometry;
-  Vector<geo_eval_log::NodeWarning> warnings;
-
-  void count_memory(MemoryCounter &counter) const override
-  {
-    this->geometry.count_memory(counter);
-  }
-};
-
 static void node_geo_exec(GeoNodeExecParams params)
 {
 #ifdef WITH_IO_STL
@@ -49,7 +38,7 @@ static void node_geo_exec(GeoNodeExecParams params)
     return;
   }
 
-  std::shared_ptr<const LoadStlCache> cached_value = memory_cache::get_loaded<LoadStlCache>(
+  const auto cached_value = memory_cache::get_loaded<LoadGeometryCache>(
       GenericStringKey{"import_stl_node"}, {StringRefNull(*path)}, [&]() {
         STLImportParams import_params;
         STRNCPY(import_params.filepath, path->c_str());
@@ -64,7 +53,7 @@ static void node_geo_exec(GeoNodeExecParams params)
 
         Mesh *mesh = STL_import_mesh(&import_params);
 
-        auto cached_value = std::make_unique<LoadStlCache>();
+        auto cached_value = std::make_unique<LoadGeometryCache>();
         cached_value->geometry = GeometrySet::from_mesh(mesh);
 
         LISTBASE_FOREACH (Report *, report, &(import_params.reports)->list) {
@@ -55,11 +55,7 @@ static int unique_num(const GroupedSpan<int> values, const Span<int> indices)
 static VArray<int> construct_neighbor_count_varray(const Mesh &mesh, const AttrDomain domain)
 {
   const GroupedSpan<int> face_edges(mesh.faces(), mesh.corner_edges());
-
-  Array<int> offsets;
-  Array<int> indices;
-  GroupedSpan<int> edge_to_faces_map = bke::mesh::build_edge_to_face_map(
-      face_edges.offsets, face_edges.data, mesh.edges_num, offsets, indices);
+  const GroupedSpan<int> edge_to_faces_map = mesh.edge_to_face_map();
 
   Array<int> face_count(face_edges.size());
   threading::parallel_for(face_edges.index_range(), 2048, [&](const IndexRange range) {
@@ -526,7 +526,11 @@ static void node_geo_exec(GeoNodeExecParams params)
           break;
         }
       }
-      mesh->tag_positions_changed();
+      /* Islands don't share vertices, so only sorting is necessary to create a mask of the moved
+       * vertices, which allows updating only the normals around them. */
+      parallel_sort(vert_indices.begin(), vert_indices.end());
+      IndexMaskMemory memory;
+      mesh->tag_positions_changed(IndexMask::from_indices<int>(vert_indices, memory));
     }
   });
 
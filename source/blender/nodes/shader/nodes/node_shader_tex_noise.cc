@@ -239,6 +239,73 @@ class NoiseFunction : public mf::MultiFunction {
     return signature;
   }
 
+  /**
+   * Evaluate the noise of many positions at once with the batched noise functions, which is
+   * possible when all inputs except the position and scale are the same for all elements.
+   *
+   * The compositor evaluates this function as well, unlinked inputs are constants in its
+   * procedure and inputs linked to single value results are passed as single values, so only
+   * the texture coordinates vary per pixel there.
+   */
+  void call_batched_3d(const IndexMask &mask,
+                       const VArray<float3> &vector,
+                       const VArray<float> &scale,
+                       const float detail,
+                       const float roughness,
+                       const float lacunarity,
+                       const float offset,
+                       const float gain,
+                       const float distortion,
+                       MutableSpan<float> r_factor,
+                       MutableSpan<ColorGeometry4f> r_color) const
+  {
+    constexpr int64_t chunk_size = 1024;
+    Array<float3> positions_buffer(std::min(chunk_size, mask.size()));
+    Array<float> factors_buffer(r_factor.is_empty() ? 0 : positions_buffer.size());
+    Array<float3> colors_buffer(r_color.is_empty() ? 0 : positions_buffer.size());
+    for (int64_t start = 0; start < mask.size(); start += chunk_size) {
+      const IndexMask chunk = mask.slice(start, std::min(chunk_size, mask.size() - start));
+      const MutableSpan<float3> positions = positions_buffer.as_mutable_span().take_front(
+          chunk.size());
+      chunk.foreach_index([&](const int64_t i, const int64_t pos) {
+        positions[pos] = vector[i] * scale[i];
+      });
+      if (!r_factor.is_empty()) {
+        const MutableSpan<float> factors = factors_buffer.as_mutable_span().take_front(
+            chunk.size());
+        noise::perlin_fractal_distorted_batch(positions,
+                                              math::clamp(detail, 0.0f, 15.0f),
+                                              math::max(roughness, 0.0f),
+                                              lacunarity,
+                                              offset,
+                                              gain,
+                                              distortion,
+                                              type_,
+                                              normalize_,
+                                              factors);
+        chunk.foreach_index(
+            [&](const int64_t i, const int64_t pos) { r_factor[i] = factors[pos]; });
+      }
+      if (!r_color.is_empty()) {
+        const MutableSpan<float3> colors = colors_buffer.as_mutable_span().take_front(
+            chunk.size());
+        noise::perlin_float3_fractal_distorted_batch(positions,
+                                                     math::clamp(detail, 0.0f, 15.0f),
+                                                     math::max(roughness, 0.0f),
+                                                     lacunarity,
+                                                     offset,
+                                                     gain,
+                                                     distortion,
+                                                     type_,
+                                                     normalize_,
+                                                     colors);
+        chunk.foreach_index([&](const int64_t i, const int64_t pos) {
+          r_color[i] = ColorGeometry4f(colors[pos].x, colors[pos].y, colors[pos].z, 1.0f);
+        });
+      }
+    }
+  }
+
   void call(const IndexMask &mask, mf::Params params, mf::Context /*context*/) const override
   {
     int param = ELEM(dimensions_, 2, 3, 4) + ELEM(dimensions_, 1, 4);
@@ -340,6 +407,22 @@ class NoiseFunction : public mf::MultiFunction {
       }
       case 3: {
         const VArray<float3> &vector = params.readonly_single_input<float3>(0, "Vector");
+        if (detail.is_single() && roughness.is_single() && lacunarity.is_single() &&
+            offset.is_single() && gain.is_single() && distortion.is_single())
+        {
+          this->call_batched_3d(mask,
+                                vector,
+                                scale,
+                                detail.get_internal_single(),
+                                roughness.get_internal_single(),
+                                lacunarity.get_internal_single(),
+                                offset.get_internal_single(),
+                                gain.get_internal_single(),
+                                distortion.get_internal_single(),
+                                r_factor,
+                                r_color);
+          break;
+        }
         if (compute_factor) {
           mask.foreach_index([&](const int64_t i) {
             const float3 position = vector[i] * scale[i];
@@ -312,6 +312,45 @@ class VoronoiMetricFunction : public mf::MultiFunction {
     return signature;
   }
 
+  /**
+   * Evaluate the Voronoi texture of many coordinates at once with the batched noise functions,
+   * which is possible when all inputs except the coordinates are the same for all elements. This
+   * is also the case in the compositor, which passes unlinked inputs as single values.
+   */
+  void call_batched_3d(const IndexMask &mask,
+                       const VArray<float3> &vector,
+                       const noise::VoronoiParams &params,
+                       MutableSpan<float> r_distance,
+                       MutableSpan<ColorGeometry4f> r_color,
+                       MutableSpan<float3> r_position) const
+  {
+    constexpr int64_t chunk_size = 1024;
+    Array<float3> coords(std::min(chunk_size, mask.size()));
+    Array<noise::VoronoiOutput> outputs(coords.size());
+    for (int64_t start = 0; start < mask.size(); start += chunk_size) {
+      const IndexMask chunk = mask.slice(start, std::min(chunk_size, mask.size() - start));
+      chunk.foreach_index([&](const int64_t i, const int64_t pos) {
+        coords[pos] = vector[i] * params.scale;
+      });
+      noise::fractal_voronoi_x_fx_batch(params,
+                                        coords.as_span().take_front(chunk.size()),
+                                        !r_color.is_empty(),
+                                        outputs.as_mutable_span().take_front(chunk.size()));
+      chunk.foreach_index([&](const int64_t i, const int64_t pos) {
+        const noise::VoronoiOutput &output = outputs[pos];
+        if (!r_distance.is_empty()) {
+          r_distance[i] = output.distance;
+        }
+        if (!r_color.is_empty()) {
+          r_color[i] = ColorGeometry4f(output.color.x, output.color.y, output.color.z, 1.0f);
+        }
+        if (!r_position.is_empty()) {
+          r_position[i] = float3{output.position.x, output.position.y, output.position.z};
+        }
+      });
+    }
+  }
+
   void call(const IndexMask &mask, mf::Params mf_params, mf::Context /*context*/) const override
   {
     auto get_vector = [&](int param_index) -> VArray<float3> {
@@ -448,6 +487,25 @@ class VoronoiMetricFunction : public mf::MultiFunction {
         break;
       }
       case 3: {
+        if (feature_ == SHD_VORONOI_F1 && metric_ != SHD_VORONOI_MINKOWSKI && scale.is_single() &&
+            detail.is_single() && roughness.is_single() && lacunarity.is_single() &&
+            randomness.is_single())
+        {
+          params.scale = scale.get_internal_single();
+          params.detail = detail.get_internal_single();
+          params.roughness = roughness.get_internal_single();
+          params.lacunarity = lacunarity.get_internal_single();
+          params.smoothness = 0.0f;
+          params.exponent = 0.0f;
+          params.randomness = std::min(std::max(randomness.get_internal_single(), 0.0f), 1.0f);
+          params.max_distance = noise::voronoi_distance(float3{0.0f, 0.0f, 0.0f},
+                                                        float3(0.5f + 0.5f * params.randomness,
+                                                               0.5f + 0.5f * params.randomness,
+                                                               0.5f + 0.5f * params.randomness),
+                                                        params);
+          this->call_batched_3d(mask, vector, params, r_distance, r_color, r_position);
+          break;
+        }
         mask.foreach_index([&](const int64_t i) {
           params.scale = scale[i];
           params.detail = detail[i];
@@ -476,7 +476,7 @@ static PyObject *bpy_lib_enter(BPy_Library *self)
   memset(bf_reports, 0, sizeof(*bf_reports));
   bf_reports->reports = reports;
 
-  self->blo_handle = BLO_blendhandle_from_file(self->abspath, bf_reports);
+  self->blo_handle = BLO_blendhandle_from_file_for_link(self->abspath, bf_reports);
 
   if (self->blo_handle == nullptr) {
     if (BPy_reports_to_error(reports, PyExc_IOError, true) != -1) {
@@ -19,6 +19,7 @@
 #include "DNA_space_types.h"
 
 #include "BLI_listbase.h"
+#include "BLI_task.hh"
 #include "BLI_threads.h"
 #include "BLI_vector_set.hh"
 
@@ -82,7 +83,8 @@ struct PrefetchJob {
   /* Set by prefetch. */
   bool running = false;
   bool waiting = false;
-  bool stop = false;
+  /** Canceled from the main thread while the prefetch thread is running. */
+  threading::CancellationToken stop_token;
   /* Set from outside. */
   bool is_scrubbing = false;
 };
@@ -313,7 +315,7 @@ void prefetch_stop(Scene *scene)
     return;
   }
 
-  pfjob->stop = true;
+  pfjob->stop_token.cancel();
 
   while (pfjob->running) {
     BLI_condition_notify_one(&pfjob->prefetch_suspend_cond);
@@ -498,7 +500,8 @@ static void seq_prefetch_do_suspend(PrefetchJob *pfjob)
 {
   BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
   while (seq_prefetch_need_suspend(pfjob) &&
-         (pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) && !pfjob->stop)
+         (pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) &&
+         !pfjob->stop_token.is_canceled())
   {
     pfjob->waiting = true;
     BLI_condition_wait(&pfjob->prefetch_suspend_cond, &pfjob->prefetch_suspend_mutex);
@@ -508,10 +511,8 @@ static void seq_prefetch_do_suspend(PrefetchJob *pfjob)
   BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
 }
 
-static void *seq_prefetch_frames(void *job)
+static void seq_prefetch_frames_loop(PrefetchJob *pfjob)
 {
-  PrefetchJob *pfjob = (PrefetchJob *)job;
-
   while (true) {
     if (pfjob->cfra < pfjob->timeline_start || pfjob->cfra > pfjob->timeline_end) {
       /* Don't try to prefetch anything when we are outside of the timeline range. */
@@ -539,7 +540,8 @@ static void *seq_prefetch_frames(void *job)
       pfjob->num_frames_prefetched++;
       /* Break instead of keep looping if the job should be terminated. */
       if (!(pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) ||
-          !(pfjob->scene->ed->cache_flag & SEQ_CACHE_ALL_TYPES) || pfjob->stop)
+          !(pfjob->scene->ed->cache_flag & SEQ_CACHE_ALL_TYPES) ||
+          pfjob->stop_token.is_canceled())
       {
         break;
       }
@@ -554,13 +556,22 @@ static void *seq_prefetch_frames(void *job)
     seq_prefetch_do_suspend(pfjob);
 
     if (!(pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) ||
-        !(pfjob->scene->ed->cache_flag & SEQ_CACHE_ALL_TYPES) || pfjob->stop)
+        !(pfjob->scene->ed->cache_flag & SEQ_CACHE_ALL_TYPES) || pfjob->stop_token.is_canceled())
     {
       break;
     }
 
     seq_prefetch_update_area(pfjob);
   }
+}
+
+static void *seq_prefetch_frames(void *job)
+{
+  PrefetchJob *pfjob = (PrefetchJob *)job;
+
+  /* Prefetching must not take threads away from the evaluation for the frame that is shown. */
+  threading::run_with_priority(threading::TaskPriorityClass::Background,
+                               [&]() { seq_prefetch_frames_loop(pfjob); });
 
   pfjob->running = false;
   pfjob->scene_eval->ed->prefetch_job = nullptr;
@@ -598,7 +609,7 @@ static PrefetchJob *seq_prefetch_start_ex(const RenderData *context, float cfra)
   pfjob->cache_flags = scene->ed->cache_flag;
 
   pfjob->waiting = false;
-  pfjob->stop = false;
+  pfjob->stop_token = {};
   pfjob->running = true;
 
   seq_prefetch_update_scene(context->scene);
@@ -49,6 +49,7 @@
 #include "BLI_utildefines.h"
 #include BLI_SYSTEM_PID_H
 
+#include "BLO_io_stats.hh"
 #include "BLO_readfile.hh"
 #include "BLT_translation.hh"
 
@@ -535,6 +536,8 @@ static void wm_init_userdef(Main *bmain)
   const int64_t cache_limit = int64_t(U.memcachelimit) * 1024 * 1024;
   MEM_CacheLimiter_set_maximum(cache_limit);
   blender::memory_cache::set_approximate_size_limit(cache_limit);
+  blender::memory_cache::set_approximate_disk_size_limit(
+      USER_DEVELOPER_TOOL_TEST(&U, use_memory_cache_disk) ? cache_limit : 0);
 
   BKE_sound_init(bmain);
 
@@ -823,6 +826,8 @@ static void wm_file_read_post(bContext *C,
     /* After load post, so for example the driver namespace can be filled
      * before evaluating the depsgraph. */
     if (!G.background || (G.fileflags & G_BACKGROUND_NO_DEPSGRAPH) == 0) {
+      const BLOIOStatsScopedPhase stats_phase(BLO_IO_STATS_PHASE_DEPSGRAPH,
+                                              BLO_io_stats_is_enabled());
       wm_event_do_depsgraph(C, true);
     }
 
@@ -1091,6 +1096,7 @@ bool WM_file_read(bContext *C,
     BlendFileReadReport bf_reports{};
     bf_reports.reports = reports;
     bf_reports.duration.whole = BLI_time_now_seconds();
+    BLO_io_stats_reset();
     BlendFileData *bfd = BKE_blendfile_read(filepath, &params, &bf_reports);
     if (bfd != nullptr) {
       wm_file_read_pre(use_data, use_userdef);
@@ -1147,6 +1153,9 @@ bool WM_file_read(bContext *C,
 
       bf_reports.duration.whole = BLI_time_now_seconds() - bf_reports.duration.whole;
       file_read_reports_finalize(&bf_reports);
+      if (BLO_io_stats_is_enabled()) {
+        BLO_io_stats_report(filepath);
+      }
 
       success = true;
     }
@@ -2249,7 +2258,11 @@ static bool wm_file_write(bContext *C,
   blend_write_params.use_save_as_copy = use_save_as_copy;
   blend_write_params.thumb = thumb;
 
+  BLO_io_stats_reset();
   const bool success = BLO_write_file(bmain, filepath, fileflags, &blend_write_params, reports);
+  if (success && BLO_io_stats_is_enabled()) {
+    BLO_io_stats_report(filepath);
+  }
 
   if (success) {
     const bool do_history_file_update = (G.background == false) &&
@@ -27,6 +27,7 @@
 #include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_timer.h"
+#include "BLI_trace.hh"
 #include "BLI_utildefines.h"
 
 #include "BLO_undofile.hh"
@@ -663,6 +664,9 @@ void WM_exit_ex(bContext *C, const bool do_python_exit, const bool do_user_exit_
 
   DNA_sdna_current_free();
 
+  /* All other threads have finished their work at this point. */
+  blender::trace::stop();
+
   BLI_threadapi_exit();
   BLI_task_scheduler_exit();
 
@@ -17,6 +17,7 @@
 #include "BLI_build_config.h"
 #include "BLI_listbase.h"
 #include "BLI_string.h"
+#include "BLI_task.hh"
 #include "BLI_threads.h"
 #include "BLI_time.h"
 #include "BLI_utildefines.h"
@@ -415,11 +416,36 @@ static void wm_jobs_reports_update(wmWindowManager *wm, wmJob *wm_job)
   WM_reports_from_reports_move(wm, wm_job->worker_status.reports);
 }
 
+/**
+ * Jobs creating previews run with low priority, so that they don't slow down evaluation.
+ */
+static bool wm_job_is_background(const wmJob *wm_job)
+{
+  return ELEM(wm_job->job_type,
+              WM_JOB_TYPE_RENDER_PREVIEW,
+              WM_JOB_TYPE_LOAD_PREVIEW,
+              WM_JOB_TYPE_SEQ_BUILD_PREVIEW,
+              WM_JOB_TYPE_SEQ_DRAG_DROP_PREVIEW);
+}
+
 static void *do_job_thread(void *job_v)
 {
   wmJob *wm_job = static_cast<wmJob *>(job_v);
 
-  wm_job->startjob(wm_job->run_customdata, &wm_job->worker_status);
+  if (wm_job_is_background(wm_job)) {
+    blender::threading::run_with_priority(
+        blender::threading::TaskPriorityClass::Background,
+        [&]() { wm_job->startjob(wm_job->run_customdata, &wm_job->worker_status); });
+  }
+  else if (wm_job->flag & WM_JOB_PRIORITY) {
+    /* Priority jobs stop other jobs, so the user is waiting for them. */
+    blender::threading::run_with_priority(
+        blender::threading::TaskPriorityClass::Interactive,
+        [&]() { wm_job->startjob(wm_job->run_customdata, &wm_job->worker_status); });
+  }
+  else {
+    wm_job->startjob(wm_job->run_customdata, &wm_job->worker_status);
+  }
   wm_job->ready = true;
 
   return nullptr;
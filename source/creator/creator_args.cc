@@ -29,6 +29,7 @@
 #  include "BLI_string_utf8.h"
 #  include "BLI_system.h"
 #  include "BLI_threads.h"
+#  include "BLI_trace.hh"
 #  include "BLI_utildefines.h"
 #  ifndef NDEBUG
 #    include "BLI_mempool.h"
@@ -49,6 +50,8 @@
 #  include "BKE_scene.hh"
 #  include "BKE_sound.h"
 
+#  include "BLO_io_stats.hh"
+
 #  include "GPU_context.hh"
 #  ifdef WITH_OPENGL_BACKEND
 #    include "GPU_capabilities.hh"
@@ -776,6 +779,9 @@ static void print_help(bArgs *ba, bool all)
   }
   BLI_args_print_arg_doc(ba, "--debug-all");
   BLI_args_print_arg_doc(ba, "--debug-io");
+  BLI_args_print_arg_doc(ba, "--debug-io-stats");
+  BLI_args_print_arg_doc(ba, "--debug-io-stats-json");
+  BLI_args_print_arg_doc(ba, "--profile-trace");
 
   PRINT("\n");
   BLI_args_print_arg_doc(ba, "--debug-fpe");
@@ -804,6 +810,7 @@ static void print_help(bArgs *ba, bool all)
   BLI_args_print_arg_doc(ba, "--app-template");
   BLI_args_print_arg_doc(ba, "--factory-startup");
   BLI_args_print_arg_doc(ba, "--enable-event-simulate");
+  BLI_args_print_arg_doc(ba, "--enable-huge-pages");
   PRINT("\n");
   BLI_args_print_arg_doc(ba, "--env-system-datafiles");
   BLI_args_print_arg_doc(ba, "--env-system-scripts");
@@ -1429,6 +1436,41 @@ static int arg_handle_debug_mode_io(int /*argc*/, const char ** /*argv*/, void *
   return 0;
 }
 
+static const char arg_handle_debug_mode_generic_set_doc_io_stats[] =
+    "\n\t"
+    "Print the time and size of each phase, ID type and block type when reading or writing\n"
+    "\tblend-files.";
+
+static const char arg_handle_debug_mode_io_stats_json_doc[] =
+    "<filepath>\n"
+    "\tLike '--debug-io-stats', also writing the statistics to a JSON file.";
+static int arg_handle_debug_mode_io_stats_json(int argc, const char **argv, void * /*data*/)
+{
+  const char *arg_id = "--debug-io-stats-json";
+  if (argc > 1) {
+    G.debug |= G_DEBUG_IO_STATS;
+    BLO_io_stats_json_filepath_set(argv[1]);
+    return 1;
+  }
+  fprintf(stderr, "\nError: '%s' no args given.\n", arg_id);
+  return 0;
+}
+
+static const char arg_handle_profile_trace_doc[] =
+    "<filepath>\n"
+    "\tRecord what all threads are doing, and write it to a file in the Chrome trace format on\n"
+    "\texit. Open it with 'chrome://tracing' or 'https://ui.perfetto.dev'.";
+static int arg_handle_profile_trace(int argc, const char **argv, void * /*data*/)
+{
+  const char *arg_id = "--profile-trace";
+  if (argc > 1) {
+    blender::trace::start(argv[1]);
+    return 1;
+  }
+  fprintf(stderr, "\nError: '%s' no args given.\n", arg_id);
+  return 0;
+}
+
 static const char arg_handle_debug_mode_all_doc[] =
     "\n\t"
     "Enable all debug messages.";
@@ -2049,6 +2091,16 @@ static int arg_handle_qos_set(int argc, const char **argv, void * /*data*/)
   return 0;
 }
 
+static const char arg_handle_huge_pages_enable_doc[] =
+    "\n\t"
+    "Use transparent huge pages for large memory allocations (Linux only).\n"
+    "\tThis can speed up processing of large meshes, at the cost of more memory usage.";
+static int arg_handle_huge_pages_enable(int /*argc*/, const char ** /*argv*/, void * /*data*/)
+{
+  MEM_use_huge_pages(true);
+  return 0;
+}
+
 static const char arg_handle_audio_disable_doc[] =
     "\n\t"
     "Force sound system to None.";
@@ -2907,6 +2959,7 @@ void main_args_setup(bContext *C, bArgs *ba, bool all)
   BLI_args_add(ba, "-c", "--command", CB(arg_handle_command_set), C);
 
   BLI_args_add(ba, nullptr, "--qos", CB(arg_handle_qos_set), nullptr);
+  BLI_args_add(ba, nullptr, "--enable-huge-pages", CB(arg_handle_huge_pages_enable), nullptr);
 
   BLI_args_add(ba,
                nullptr,
@@ -2977,6 +3030,17 @@ void main_args_setup(bContext *C, bArgs *ba, bool all)
   BLI_args_add(ba, nullptr, "--debug-all", CB(arg_handle_debug_mode_all), nullptr);
 
   BLI_args_add(ba, nullptr, "--debug-io", CB(arg_handle_debug_mode_io), nullptr);
+  BLI_args_add(ba,
+               nullptr,
+               "--debug-io-stats",
+               CB_EX(arg_handle_debug_mode_generic_set, io_stats),
+               (void *)G_DEBUG_IO_STATS);
+  BLI_args_add(ba,
+               nullptr,
+               "--debug-io-stats-json",
+               CB(arg_handle_debug_mode_io_stats_json),
+               nullptr);
+  BLI_args_add(ba, nullptr, "--profile-trace", CB(arg_handle_profile_trace), nullptr);
 
   BLI_args_add(ba, nullptr, "--debug-fpe", CB(arg_handle_debug_fpe_set), nullptr);
 